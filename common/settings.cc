@@ -62,6 +62,17 @@ std::string Settings::ToString() const {
   stream << "frame_rasterized_callback set: " << !!frame_rasterized_callback
          << std::endl;
   stream << "old_gen_heap_size: " << old_gen_heap_size << std::endl;
+  stream << "image_memory_budget_mb: " << image_memory_budget_mb << std::endl;
+  stream << "shaping_cache_budget_mb: " << shaping_cache_budget_mb
+         << std::endl;
+  stream << "enable_platform_message_stats: "
+         << enable_platform_message_stats << std::endl;
+  stream << "enable_parallel_text_layout: " << enable_parallel_text_layout
+         << std::endl;
+  stream << "fallback_font_index_path: " << fallback_font_index_path
+         << std::endl;
+  stream << "hyphenation_patterns_path: " << hyphenation_patterns_path
+         << std::endl;
   return stream.str();
 }
 
@@ -163,6 +163,10 @@ struct Settings {
   // Selects the SkParagraph implementation of the text layout engine.
   bool enable_skparagraph = false;
 
+  // Lets very long paragraphs be broken into lines and shaped on the
+  // concurrent worker pool. Only used by the libtxt text layout engine.
+  bool enable_parallel_text_layout = false;
+
   // All shells in the process share the same VM. The last shell to shutdown
   // should typically shut down the VM as well. However, applications depend on
   // the behavior of "warming-up" the VM by creating a shell that does not do
@@ -214,6 +218,9 @@ struct Settings {
   // thread and embedders must re-thread if necessary. Performing blocking
   // calls in this callback will cause applications to jank.
   LogMessageCallback log_message_callback;
+  // Whether the shell renders without a GPU. Set from the command line on
+  // Android and from the renderer config by the embedder API. Picture
+  // snapshots are then rasterized on the worker pool.
   bool enable_software_rendering = false;
   bool skia_deterministic_rendering_on_cpu = false;
   bool verbose_logging = false;
@@ -251,6 +258,34 @@ struct Settings {
   /// https://github.com/dart-lang/sdk/blob/ca64509108b3e7219c50d6c52877c85ab6a35ff2/runtime/vm/flag_list.h#L150
   int64_t old_gen_heap_size = -1;
 
+  /// The budget in MB for image memory tracked by the `ImageMemoryLedger`, or
+  /// 0 for no budget. When exceeded, the engine evicts cached rasterizations
+  /// and GPU resources before asking the Dart VM to collect unreachable
+  /// images. The ledger is shared by every engine in the process, so the
+  /// smallest budget of the running engines applies.
+  size_t image_memory_budget_mb = 0;
+
+  /// The budget in MB for the text shaping cache, which keeps the glyphs of
+  /// recently laid out words so that laying them out again is cheap, or 0 to
+  /// keep the default. The cache is shared by every engine in the process, so
+  /// the smallest budget of the running engines applies.
+  size_t shaping_cache_budget_mb = 0;
+
+  /// Whether to record the counts and timings of the platform messages on
+  /// each channel from launch. Recording can also be turned on and off later
+  /// through the service protocol.
+  bool enable_platform_message_stats = false;
+
+  /// The directory in which to save the index of the code points covered by
+  /// the installed fonts, which speeds up finding fallback fonts for new
+  /// characters. The index is not used if this is empty.
+  std::string fallback_font_index_path;
+
+  /// The directory holding the hyphenation patterns, as a hyph-<language>.hyb
+  /// file per language. Each file is mapped the first time a paragraph in its
+  /// language is laid out. Text is not hyphenated if this is empty.
+  std::string hyphenation_patterns_path;
+
   /// A timestamp representing when the engine started. The value is based
   /// on the clock used by the Dart timeline APIs. This timestamp is used
   /// to log a timeline event that tracks the latency of engine startup.
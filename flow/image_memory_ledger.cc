@@ -0,0 +1,206 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/image_memory_ledger.h"
+
+#include <vector>
+
+#include "flutter/common/constants.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+ImageMemoryLedger::Allocation::Allocation() = default;
+
+ImageMemoryLedger::Allocation::Allocation(ImageMemoryLedger* ledger,
+                                          ImageMemoryCategory category,
+                                          size_t bytes)
+    : ledger_(ledger), category_(category), bytes_(0) {
+  FML_DCHECK(ledger_);
+  FML_DCHECK(category_ < ImageMemoryCategory::kCount);
+  Update(bytes);
+}
+
+ImageMemoryLedger::Allocation::Allocation(Allocation&& other)
+    : ledger_(other.ledger_), category_(other.category_), bytes_(other.bytes_) {
+  other.ledger_ = nullptr;
+  other.bytes_ = 0;
+}
+
+ImageMemoryLedger::Allocation& ImageMemoryLedger::Allocation::operator=(
+    Allocation&& other) {
+  if (this != &other) {
+    Release();
+    ledger_ = other.ledger_;
+    category_ = other.category_;
+    bytes_ = other.bytes_;
+    other.ledger_ = nullptr;
+    other.bytes_ = 0;
+  }
+  return *this;
+}
+
+ImageMemoryLedger::Allocation::~Allocation() {
+  Release();
+}
+
+void ImageMemoryLedger::Allocation::Update(size_t bytes) {
+  if (!ledger_ || bytes == bytes_) {
+    return;
+  }
+  if (bytes > bytes_) {
+    ledger_->Add(category_, bytes - bytes_);
+  } else {
+    ledger_->Subtract(category_, bytes_ - bytes);
+  }
+  bytes_ = bytes;
+}
+
+void ImageMemoryLedger::Allocation::Release() {
+  Update(0);
+  ledger_ = nullptr;
+}
+
+ImageMemoryLedger& ImageMemoryLedger::GetInstance() {
+  // Allocations may be released during static destruction.
+  static ImageMemoryLedger* instance = new ImageMemoryLedger();
+  return *instance;
+}
+
+size_t ImageMemoryLedger::GetImageByteSize(const SkImage* image) {
+  if (!image) {
+    return 0;
+  }
+  if (image->isTextureBacked()) {
+    return image->textureSize();
+  }
+  return image->imageInfo().computeMinByteSize();
+}
+
+ImageMemoryLedger::ImageMemoryLedger() = default;
+
+ImageMemoryLedger::~ImageMemoryLedger() = default;
+
+ImageMemoryLedger::Allocation ImageMemoryLedger::Track(
+    ImageMemoryCategory category,
+    size_t bytes) {
+  return Allocation(this, category, bytes);
+}
+
+ImageMemoryLedger::Usage ImageMemoryLedger::GetUsage() const {
+  Usage usage;
+  for (size_t i = 0; i < category_bytes_.size(); i++) {
+    usage.category_bytes[i] = category_bytes_[i].load();
+  }
+  usage.total_bytes = total_bytes_.load();
+  usage.budget_bytes = budget_bytes_.load();
+  return usage;
+}
+
+size_t ImageMemoryLedger::AddBudget(size_t budget_bytes) {
+  if (budget_bytes == 0) {
+    return 0;
+  }
+  size_t budget_id = 0;
+  {
+    std::scoped_lock lock(budgets_mutex_);
+    budget_id = next_budget_id_++;
+    budgets_[budget_id] = budget_bytes;
+    UpdateBudget();
+  }
+  const size_t budget = budget_bytes_.load();
+  const size_t total = total_bytes_.load();
+  if (total > budget) {
+    NotifyListeners(total - budget);
+  }
+  return budget_id;
+}
+
+void ImageMemoryLedger::RemoveBudget(size_t budget_id) {
+  std::scoped_lock lock(budgets_mutex_);
+  if (budgets_.erase(budget_id) > 0) {
+    UpdateBudget();
+  }
+}
+
+void ImageMemoryLedger::UpdateBudget() {
+  size_t budget = 0;
+  for (const auto& entry : budgets_) {
+    if (budget == 0 || entry.second < budget) {
+      budget = entry.second;
+    }
+  }
+  budget_bytes_ = budget;
+}
+
+size_t ImageMemoryLedger::AddPressureListener(PressureCallback callback) {
+  std::scoped_lock lock(listeners_mutex_);
+  const size_t listener_id = next_listener_id_++;
+  listeners_[listener_id] = std::move(callback);
+  return listener_id;
+}
+
+void ImageMemoryLedger::RemovePressureListener(size_t listener_id) {
+  std::scoped_lock lock(listeners_mutex_);
+  listeners_.erase(listener_id);
+}
+
+bool ImageMemoryLedger::IsOverBudget() const {
+  const size_t budget = budget_bytes_.load();
+  return budget > 0 && total_bytes_.load() > budget;
+}
+
+void ImageMemoryLedger::TraceCountersToTimeline() const {
+#if !FLUTTER_RELEASE
+  const Usage usage = GetUsage();
+  FML_TRACE_COUNTER(
+      "flutter", "ImageMemory", reinterpret_cast<int64_t>(this),  //
+      "PendingDecodesMBytes",
+      usage.GetBytes(ImageMemoryCategory::kPendingDecodes) /
+          kMegaByteSizeInBytes,
+      "DartImagesMBytes",
+      usage.GetBytes(ImageMemoryCategory::kDartImages) / kMegaByteSizeInBytes,
+      "RasterCacheMBytes",
+      usage.GetBytes(ImageMemoryCategory::kRasterCache) / kMegaByteSizeInBytes,
+      "ResourceCacheMBytes",
+      usage.GetBytes(ImageMemoryCategory::kResourceCache) /
+          kMegaByteSizeInBytes,
+      "TotalMBytes", usage.total_bytes / kMegaByteSizeInBytes);
+#endif  // !FLUTTER_RELEASE
+}
+
+void ImageMemoryLedger::Add(ImageMemoryCategory category, size_t bytes) {
+  category_bytes_[static_cast<size_t>(category)].fetch_add(bytes);
+  const size_t before = total_bytes_.fetch_add(bytes);
+  const size_t after = before + bytes;
+  const size_t budget = budget_bytes_.load();
+  // Only the allocation that crosses the budget notifies listeners. Further
+  // allocations made while still over the budget don't, so that listeners
+  // aren't flooded while they are evicting.
+  if (budget > 0 && before <= budget && after > budget) {
+    NotifyListeners(after - budget);
+  }
+}
+
+void ImageMemoryLedger::Subtract(ImageMemoryCategory category, size_t bytes) {
+  category_bytes_[static_cast<size_t>(category)].fetch_sub(bytes);
+  total_bytes_.fetch_sub(bytes);
+}
+
+void ImageMemoryLedger::NotifyListeners(size_t bytes_over_budget) {
+  std::vector<PressureCallback> listeners;
+  {
+    std::scoped_lock lock(listeners_mutex_);
+    listeners.reserve(listeners_.size());
+    for (const auto& listener : listeners_) {
+      listeners.push_back(listener.second);
+    }
+  }
+  for (const auto& listener : listeners) {
+    listener(bytes_over_budget);
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,168 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_IMAGE_MEMORY_LEDGER_H_
+#define FLUTTER_FLOW_IMAGE_MEMORY_LEDGER_H_
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+/// The owners of image memory tracked by the `ImageMemoryLedger`.
+enum class ImageMemoryCategory : size_t {
+  /// Images that have been decoded (and possibly uploaded) by the
+  /// `ImageDecoder` but not yet handed to Dart.
+  kPendingDecodes,
+  /// Images referenced by `ui.Image` objects.
+  kDartImages,
+  /// Layers and pictures rasterized into the raster cache.
+  kRasterCache,
+  /// Skia's GPU resource cache on the raster thread, without the surfaces
+  /// of the raster cache.
+  kResourceCache,
+  kCount,
+};
+
+//------------------------------------------------------------------------------
+/// @brief      Keeps track of the bytes of image memory held by the engine.
+///
+///             The ledger is shared by every engine in the process because the
+///             process as a whole is what runs out of memory. Owners of image
+///             memory hold an `Allocation` for as long as they hold the
+///             memory. When the total crosses the budget, pressure listeners
+///             are notified so they can evict what they can, in the order
+///             documented by `Shell`.
+///
+///             All methods may be called on any thread.
+///
+class ImageMemoryLedger {
+ public:
+  /// Invoked with the number of bytes over the budget. Listeners must not
+  /// block. They are invoked on the thread whose allocation crossed the
+  /// budget.
+  using PressureCallback = std::function<void(size_t bytes_over_budget)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      The bytes held by a single owner. The bytes are released
+  ///             back to the ledger when the allocation is collected.
+  ///
+  class Allocation {
+   public:
+    Allocation();
+
+    Allocation(ImageMemoryLedger* ledger,
+               ImageMemoryCategory category,
+               size_t bytes);
+
+    Allocation(Allocation&& other);
+
+    Allocation& operator=(Allocation&& other);
+
+    ~Allocation();
+
+    /// Replaces the bytes held by this allocation.
+    void Update(size_t bytes);
+
+    size_t bytes() const { return bytes_; }
+
+   private:
+    ImageMemoryLedger* ledger_ = nullptr;
+    ImageMemoryCategory category_ = ImageMemoryCategory::kCount;
+    size_t bytes_ = 0;
+
+    void Release();
+
+    FML_DISALLOW_COPY_AND_ASSIGN(Allocation);
+  };
+
+  struct Usage {
+    std::array<size_t, static_cast<size_t>(ImageMemoryCategory::kCount)>
+        category_bytes = {};
+    size_t total_bytes = 0;
+    /// Zero if no budget has been set.
+    size_t budget_bytes = 0;
+
+    size_t GetBytes(ImageMemoryCategory category) const {
+      return category_bytes[static_cast<size_t>(category)];
+    }
+  };
+
+  /// The ledger used by the engine.
+  static ImageMemoryLedger& GetInstance();
+
+  /// The bytes to charge for `image`. Texture-backed images are charged the
+  /// size of their texture, which is much smaller than their pixels for
+  /// block-compressed textures. Returns zero for a null image.
+  static size_t GetImageByteSize(const SkImage* image);
+
+  ImageMemoryLedger();
+
+  ~ImageMemoryLedger();
+
+  /// Records that the caller holds `bytes` of image memory until the returned
+  /// allocation is collected or updated.
+  Allocation Track(ImageMemoryCategory category, size_t bytes);
+
+  Usage GetUsage() const;
+
+  /// Asks that the total stay under `budget_bytes` until the budget is
+  /// removed. Because the ledger is shared by every engine in the process,
+  /// the smallest of the budgets in effect applies.
+  ///
+  /// @return     An identifier to pass to `RemoveBudget`, or zero if
+  ///             `budget_bytes` is zero, which requests no budget.
+  size_t AddBudget(size_t budget_bytes);
+
+  /// Removes a budget, which relaxes the budget in effect if it was the
+  /// smallest one.
+  void RemoveBudget(size_t budget_id);
+
+  /// @return     An identifier to pass to `RemovePressureListener`.
+  size_t AddPressureListener(PressureCallback callback);
+
+  void RemovePressureListener(size_t listener_id);
+
+  /// Whether the total exceeds the budget.
+  bool IsOverBudget() const;
+
+  void TraceCountersToTimeline() const;
+
+ private:
+  std::array<std::atomic<size_t>,
+             static_cast<size_t>(ImageMemoryCategory::kCount)>
+      category_bytes_ = {};
+  std::atomic<size_t> total_bytes_ = 0;
+  std::atomic<size_t> budget_bytes_ = 0;
+
+  mutable std::mutex listeners_mutex_;
+  std::map<size_t, PressureCallback> listeners_;
+  size_t next_listener_id_ = 1;
+
+  std::mutex budgets_mutex_;
+  std::map<size_t, size_t> budgets_;
+  size_t next_budget_id_ = 1;
+
+  // Sets `budget_bytes_` to the smallest of `budgets_`. Called with
+  // `budgets_mutex_` held.
+  void UpdateBudget();
+
+  void Add(ImageMemoryCategory category, size_t bytes);
+
+  void Subtract(ImageMemoryCategory category, size_t bytes);
+
+  void NotifyListeners(size_t bytes_over_budget);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ImageMemoryLedger);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_IMAGE_MEMORY_LEDGER_H_
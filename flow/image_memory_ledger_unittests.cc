@@ -0,0 +1,119 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/image_memory_ledger.h"
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(ImageMemoryLedgerTest, TracksBytesPerCategory) {
+  ImageMemoryLedger ledger;
+  {
+    auto images = ledger.Track(ImageMemoryCategory::kDartImages, 100);
+    auto cache = ledger.Track(ImageMemoryCategory::kRasterCache, 50);
+
+    auto usage = ledger.GetUsage();
+    EXPECT_EQ(usage.GetBytes(ImageMemoryCategory::kDartImages), 100u);
+    EXPECT_EQ(usage.GetBytes(ImageMemoryCategory::kRasterCache), 50u);
+    EXPECT_EQ(usage.GetBytes(ImageMemoryCategory::kResourceCache), 0u);
+    EXPECT_EQ(usage.total_bytes, 150u);
+
+    cache.Update(20);
+    EXPECT_EQ(ledger.GetUsage().total_bytes, 120u);
+
+    // Moving an allocation doesn't release its bytes.
+    auto moved = std::move(images);
+    EXPECT_EQ(moved.bytes(), 100u);
+    EXPECT_EQ(images.bytes(), 0u);
+    EXPECT_EQ(ledger.GetUsage().total_bytes, 120u);
+  }
+  EXPECT_EQ(ledger.GetUsage().total_bytes, 0u);
+}
+
+TEST(ImageMemoryLedgerTest, NotifiesListenersWhenCrossingBudget) {
+  ImageMemoryLedger ledger;
+  std::vector<size_t> notifications;
+  auto listener = ledger.AddPressureListener(
+      [&](size_t bytes_over_budget) {
+        notifications.push_back(bytes_over_budget);
+      });
+  ledger.AddBudget(100);
+
+  auto first = ledger.Track(ImageMemoryCategory::kDartImages, 80);
+  EXPECT_TRUE(notifications.empty());
+  EXPECT_FALSE(ledger.IsOverBudget());
+
+  auto second = ledger.Track(ImageMemoryCategory::kRasterCache, 30);
+  ASSERT_EQ(notifications.size(), 1u);
+  EXPECT_EQ(notifications[0], 10u);
+  EXPECT_TRUE(ledger.IsOverBudget());
+
+  // Listeners are not notified again until the total drops below the budget.
+  second.Update(40);
+  EXPECT_EQ(notifications.size(), 1u);
+
+  second.Update(0);
+  EXPECT_FALSE(ledger.IsOverBudget());
+  second.Update(25);
+  ASSERT_EQ(notifications.size(), 2u);
+  EXPECT_EQ(notifications[1], 5u);
+
+  ledger.RemovePressureListener(listener);
+  second.Update(0);
+  second.Update(50);
+  EXPECT_EQ(notifications.size(), 2u);
+}
+
+TEST(ImageMemoryLedgerTest, SmallestBudgetWins) {
+  ImageMemoryLedger ledger;
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 0u);
+
+  const size_t first = ledger.AddBudget(200);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 200u);
+
+  EXPECT_EQ(ledger.AddBudget(0), 0u);
+  const size_t second = ledger.AddBudget(300);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 200u);
+
+  const size_t third = ledger.AddBudget(100);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 100u);
+
+  // The budget relaxes when the engine that set the smallest one goes away.
+  ledger.RemoveBudget(third);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 200u);
+  ledger.RemoveBudget(first);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 300u);
+  ledger.RemoveBudget(first);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 300u);
+  ledger.RemoveBudget(second);
+  EXPECT_EQ(ledger.GetUsage().budget_bytes, 0u);
+}
+
+TEST(ImageMemoryLedgerTest, AddingBudgetBelowUsageNotifiesListeners) {
+  ImageMemoryLedger ledger;
+  size_t notified_bytes = 0;
+  auto listener = ledger.AddPressureListener(
+      [&](size_t bytes_over_budget) { notified_bytes = bytes_over_budget; });
+  auto allocation = ledger.Track(ImageMemoryCategory::kResourceCache, 150);
+
+  ledger.AddBudget(100);
+  EXPECT_EQ(notified_bytes, 50u);
+  ledger.RemovePressureListener(listener);
+}
+
+TEST(ImageMemoryLedgerTest, ChargesRasterImagesTheirPixels) {
+  EXPECT_EQ(ImageMemoryLedger::GetImageByteSize(nullptr), 0u);
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(10, 20);
+  sk_sp<SkImage> image = surface->makeImageSnapshot();
+  EXPECT_EQ(ImageMemoryLedger::GetImageByteSize(image.get()), 10u * 20u * 4u);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -40,7 +40,9 @@ RasterCache::RasterCache(size_t access_threshold,
                          size_t picture_cache_limit_per_frame)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
-      checkerboard_images_(false) {}
+      checkerboard_images_(false),
+      ledger_allocation_(ImageMemoryLedger::GetInstance().Track(
+          ImageMemoryCategory::kRasterCache, 0)) {}
 
 static bool CanRasterizePicture(SkPicture* picture) {
   if (picture == nullptr) {
@@ -267,12 +269,19 @@ void RasterCache::SweepAfterFrame() {
   SweepOneCacheAfterFrame(picture_cache_);
   SweepOneCacheAfterFrame(layer_cache_);
   picture_cached_this_frame_ = 0;
+  UpdateLedgerAllocation();
   TraceStatsToTimeline();
 }
 
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  UpdateLedgerAllocation();
+}
+
+void RasterCache::UpdateLedgerAllocation() {
+  ledger_allocation_.Update(EstimateLayerCacheByteSize() +
+                            EstimatePictureCacheByteSize());
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
@@ -8,6 +8,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/flow/raster_cache_key.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
@@ -218,9 +219,12 @@ class RasterCache {
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
+  ImageMemoryLedger::Allocation ledger_allocation_;
 
   void TraceStatsToTimeline() const;
 
+  void UpdateLedgerAllocation();
+
   FML_DISALLOW_COPY_AND_ASSIGN(RasterCache);
 };
 
@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
 #include <map>
 #include <queue>
@@ -12,6 +13,7 @@
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/task_runner.h"
 
 namespace fml {
@@ -75,6 +77,37 @@ class ConcurrentTaskRunner : public BasicTaskRunner {
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentTaskRunner);
 };
 
+// Calls |task| with each index in [0, count), on the workers of |runner| and
+// on the calling thread, and returns once every call has finished. The
+// calling thread claims indices too, so it never waits on a worker that has
+// not started yet.
+template <typename Task>
+void RunConcurrently(const std::shared_ptr<ConcurrentTaskRunner>& runner,
+                     size_t count,
+                     const Task& task) {
+  struct State {
+    explicit State(size_t count) : latch(count) {}
+    std::atomic<size_t> next_index{0};
+    CountDownLatch latch;
+  };
+  // A worker may only get to its task after every index has been claimed, so
+  // the counters outlive this call. |task| is only used while indices remain,
+  // which keeps the caller waiting on the latch.
+  auto state = std::make_shared<State>(count);
+  auto drain = [state, count, &task]() {
+    for (size_t index = state->next_index++; index < count;
+         index = state->next_index++) {
+      task(index);
+      state->latch.CountDown();
+    }
+  };
+  for (size_t i = 1; i < count; ++i) {
+    runner->PostTask(drain);
+  }
+  drain();
+  state->latch.Wait();
+}
+
 }  // namespace fml
 
 #endif  // FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
@@ -9,8 +9,18 @@
 
 namespace fml {
 
+// Mapping
+
+bool Mapping::IsWritable() const {
+  return false;
+}
+
 // FileMapping
 
+bool FileMapping::IsWritable() const {
+  return mutable_mapping_ != nullptr;
+}
+
 uint8_t* FileMapping::GetMutableMapping() {
   return mutable_mapping_;
 }
@@ -81,6 +91,10 @@ const uint8_t* DataMapping::GetMapping() const {
   return data_.data();
 }
 
+bool DataMapping::IsWritable() const {
+  return true;
+}
+
 // NonOwnedMapping
 NonOwnedMapping::NonOwnedMapping(const uint8_t* data,
                                  size_t size,
@@ -134,6 +148,10 @@ const uint8_t* MallocMapping::GetMapping() const {
   return data_;
 }
 
+bool MallocMapping::IsWritable() const {
+  return true;
+}
+
 uint8_t* MallocMapping::Release() {
   uint8_t* result = data_;
   data_ = nullptr;
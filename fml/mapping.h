@@ -28,6 +28,11 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  /// Whether the mapped memory may be written to for as long as the mapping
+  /// is alive. Such memory can be handed to code that expects a mutable
+  /// buffer, like a Dart `ByteData`, instead of being copied.
+  virtual bool IsWritable() const;
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -65,6 +70,9 @@ class FileMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
   uint8_t* GetMutableMapping();
 
   bool IsValid() const;
@@ -96,6 +104,9 @@ class DataMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -162,6 +173,9 @@ class MallocMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  bool IsWritable() const override;
+
   /// Removes ownership of the data buffer.
   /// After this is called; the mapping will point to nullptr.
   [[nodiscard]] uint8_t* Release();
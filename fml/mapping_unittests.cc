@@ -52,4 +52,14 @@ TEST(MallocMapping, Release) {
   ASSERT_EQ(0u, mapping.GetSize());
 }
 
+TEST(Mapping, IsWritable) {
+  MallocMapping malloc_mapping = MallocMapping::Copy("abc", 3);
+  ASSERT_TRUE(malloc_mapping.IsWritable());
+  DataMapping data_mapping(std::vector<uint8_t>{1, 2, 3});
+  ASSERT_TRUE(data_mapping.IsWritable());
+  const uint8_t data[] = {1, 2, 3};
+  NonOwnedMapping non_owned_mapping(data, sizeof(data));
+  ASSERT_FALSE(non_owned_mapping.IsWritable());
+}
+
 }  // namespace fml
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/concurrent_message_loop.h"
@@ -316,3 +317,22 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, RunConcurrentlyDoesNotWaitForBusyWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1u);
+  auto task_runner = loop->GetTaskRunner();
+  fml::ManualResetWaitableEvent worker_blocked;
+  fml::ManualResetWaitableEvent release_worker;
+  task_runner->PostTask([&]() {
+    worker_blocked.Signal();
+    release_worker.Wait();
+  });
+  worker_blocked.Wait();
+
+  // The only worker is busy, so every index is run on this thread.
+  std::vector<int> runs(5);
+  fml::RunConcurrently(task_runner, runs.size(),
+                       [&](size_t index) { runs[index]++; });
+  EXPECT_EQ(runs, std::vector<int>(5, 1));
+  release_worker.Signal();
+}
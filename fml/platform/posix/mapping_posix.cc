@@ -36,7 +36,7 @@ static int ToPosixProtectionFlags(
   return flags;
 }
 
-static bool IsWritable(
+static bool HasWritableProtection(
     std::initializer_list<FileMapping::Protection> protection_flags) {
   for (auto protection : protection_flags) {
     if (protection == FileMapping::Protection::kWrite) {
@@ -68,7 +68,7 @@ FileMapping::FileMapping(const fml::UniqueFD& handle,
     return;
   }
 
-  const auto is_writable = IsWritable(protection);
+  const auto is_writable = HasWritableProtection(protection);
 
   auto* mapping =
       ::mmap(nullptr, stat_buffer.st_size, ToPosixProtectionFlags(protection),
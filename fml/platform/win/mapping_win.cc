@@ -20,7 +20,7 @@ Mapping::Mapping() = default;
 
 Mapping::~Mapping() = default;
 
-static bool IsWritable(
+static bool HasWritableProtection(
     std::initializer_list<FileMapping::Protection> protection_flags) {
   for (auto protection : protection_flags) {
     if (protection == FileMapping::Protection::kWrite) {
@@ -60,7 +60,7 @@ FileMapping::FileMapping(const fml::UniqueFD& fd,
   }
 
   DWORD protect_flags = 0;
-  bool read_only = !IsWritable(protections);
+  bool read_only = !HasWritableProtection(protections);
 
   if (IsExecutable(protections)) {
     protect_flags = PAGE_EXECUTE_READ;
@@ -96,7 +96,7 @@ FileMapping::FileMapping(const fml::UniqueFD& fd,
   mapping_ = mapping;
   size_ = mapping_size;
   valid_ = true;
-  if (IsWritable(protections)) {
+  if (HasWritableProtection(protections)) {
     mutable_mapping_ = mapping_;
   }
 }
@@ -29,6 +29,24 @@ typedef DrainChannelCallback = Future<void> Function(ByteData? data, PlatformMes
 ///  * [PlatformMessageResponseCallback], the type used for replies.
 typedef ChannelCallback = void Function(ByteData? data, PlatformMessageResponseCallback callback);
 
+/// How urgently the buffered messages on a channel are drained, from the most
+/// urgent to the least urgent.
+///
+/// See [ChannelBuffers.setLane].
+enum ChannelLane {
+  /// Messages that carry user input.
+  input,
+
+  /// Messages that the next frame depends on.
+  frameCritical,
+
+  /// Messages that are drained in the order they arrived. This is the default.
+  normal,
+
+  /// Messages that can wait until frames and other events have been handled.
+  background,
+}
+
 /// The data and logic required to store and invoke a callback.
 ///
 /// This tracks (and applies) the [Zone].
@@ -72,9 +90,12 @@ class _StoredMessage {
 /// This consists of a fixed-size circular queue of [_StoredMessage]s,
 /// and the channel's callback, if any has been registered.
 class _Channel {
-  _Channel([ this._capacity = ChannelBuffers.kDefaultBufferSize ])
+  _Channel(this._buffers, [ this._capacity = ChannelBuffers.kDefaultBufferSize ])
     : _queue = collection.ListQueue<_StoredMessage>(_capacity);
 
+  /// The [ChannelBuffers] that schedule the draining of this channel.
+  final ChannelBuffers _buffers;
+
   /// The underlying data for the buffered messages.
   final collection.ListQueue<_StoredMessage> _queue;
 
@@ -106,7 +127,12 @@ class _Channel {
     _dropOverflowMessages(newSize);
   }
 
-  /// Whether a microtask is queued to call [_drainStep].
+  /// How urgently the messages in the channel are drained.
+  ///
+  /// A channel that is already draining keeps draining in its previous lane.
+  ChannelLane lane = ChannelLane.normal;
+
+  /// Whether the channel is waiting for [ChannelBuffers] to call [_drainStep].
   ///
   /// This is used to queue messages received while draining, rather
   /// than sending them out of order. This generally cannot happen in
@@ -197,7 +223,9 @@ class _Channel {
   /// Drains all the messages in the channel (invoking the currently
   /// registered listener for each one).
   ///
-  /// Each message is handled in its own microtask. No messages can
+  /// Each message is handled in its own microtask, or in its own event
+  /// loop task if the channel is in the [ChannelLane.background] lane.
+  /// Channels in more urgent lanes are drained first. No messages can
   /// be queued by plugins while the queue is being drained, but any
   /// microtasks queued by the handler itself will be processed before
   /// the next message is handled.
@@ -211,21 +239,22 @@ class _Channel {
   void _drain() {
     assert(!_draining);
     _draining = true;
-    scheduleMicrotask(_drainStep);
+    _buffers._scheduleDrain(this);
   }
 
-  /// Drains a single message and then reinvokes itself asynchronously.
+  /// Drains a single message.
   ///
-  /// See [_drain] for more details.
-  void _drainStep() {
+  /// Returns whether the channel is still draining. See [_drain] for more
+  /// details.
+  bool _drainStep() {
     assert(_draining);
     if (_queue.isNotEmpty && _channelCallbackRecord != null) {
       final _StoredMessage message = pop();
       _channelCallbackRecord!.invoke(message.data, message.invoke);
-      scheduleMicrotask(_drainStep);
-    } else {
-      _draining = false;
+      return true;
     }
+    _draining = false;
+    return false;
   }
 }
 
@@ -294,9 +323,9 @@ class _Channel {
 /// A plugin can configure its channel's buffers by sending messages to the
 /// control channel, `dev.flutter/channel-buffers` (see [kControlChannelName]).
 ///
-/// There are two messages that can be sent to this control channel, to adjust
-/// the buffer size and to disable the overflow warnings. See [handleMessage]
-/// for details on these messages.
+/// There are three messages that can be sent to this control channel, to adjust
+/// the buffer size, to disable the overflow warnings, and to set the lane of
+/// the channel. See [handleMessage] for details on these messages.
 class ChannelBuffers {
   /// Create a buffer pool for platform messages.
   ///
@@ -316,6 +345,70 @@ class ChannelBuffers {
   /// A mapping between a channel name and its associated [_Channel].
   final Map<String, _Channel> _channels = <String, _Channel>{};
 
+  /// The channels that are draining, for each lane, in the order they
+  /// started draining.
+  final List<collection.ListQueue<_Channel>> _drainingChannels = List<collection.ListQueue<_Channel>>.generate(
+    ChannelLane.values.length,
+    (int index) => collection.ListQueue<_Channel>(),
+  );
+
+  /// Whether a microtask is queued to call [_drainStep].
+  bool _drainMicrotaskScheduled = false;
+
+  /// Whether a timer is set to call [_drainStep].
+  bool _drainTimerScheduled = false;
+
+  /// Starts draining a channel, once the channels in more urgent lanes and the
+  /// channels in its lane that started draining earlier have had their turn.
+  void _scheduleDrain(_Channel channel) {
+    _drainingChannels[channel.lane.index].addLast(channel);
+    _scheduleDrainStep();
+  }
+
+  /// Schedules the next [_drainStep], in a microtask if a channel outside the
+  /// background lane is draining, and otherwise in an event loop task, so that
+  /// frames and other events are handled first.
+  void _scheduleDrainStep() {
+    for (int index = 0; index < ChannelLane.background.index; index += 1) {
+      if (_drainingChannels[index].isNotEmpty) {
+        if (!_drainMicrotaskScheduled) {
+          _drainMicrotaskScheduled = true;
+          scheduleMicrotask(() {
+            _drainMicrotaskScheduled = false;
+            _drainStep();
+          });
+        }
+        return;
+      }
+    }
+    if (_drainingChannels[ChannelLane.background.index].isNotEmpty && !_drainTimerScheduled) {
+      _drainTimerScheduled = true;
+      Timer.run(() {
+        _drainTimerScheduled = false;
+        _drainStep();
+      });
+    }
+  }
+
+  /// Drains a single message from the first draining channel in the most
+  /// urgent lane, and then schedules the next step.
+  ///
+  /// Channels in the same lane take turns.
+  void _drainStep() {
+    try {
+      for (final collection.ListQueue<_Channel> channels in _drainingChannels) {
+        if (channels.isNotEmpty) {
+          final _Channel channel = channels.removeFirst();
+          if (channel._drainStep())
+            channels.addLast(channel);
+          break;
+        }
+      }
+    } finally {
+      _scheduleDrainStep();
+    }
+  }
+
   /// Adds a message (`data`) to the named channel buffer (`name`).
   ///
   /// The `callback` argument is a closure that, when called, will send messages
@@ -325,7 +418,7 @@ class ChannelBuffers {
   /// configured to expect overflow, then, in debug mode, a message
   /// will be printed to the console warning about the overflow.
   void push(String name, ByteData? data, PlatformMessageResponseCallback callback) {
-    final _Channel channel = _channels.putIfAbsent(name, () => _Channel());
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
     if (channel.push(_StoredMessage(data, callback))) {
       _printDebug(
         'A message on the $name channel was discarded before it could be handled.\n'
@@ -355,14 +448,17 @@ class ChannelBuffers {
   /// If any messages were queued before the listener is added,
   /// they are drained asynchronously after this method returns.
   ///
-  /// Each message is handled in its own microtask. No messages can
+  /// Each message is handled in its own microtask, or in its own
+  /// event loop task if the channel is in the [ChannelLane.background]
+  /// lane. Channels in more urgent lanes are drained first (see
+  /// [setLane]). No messages can
   /// be queued by plugins while the queue is being drained, but any
   /// microtasks queued by the handler itself will be processed before
   /// the next message is handled.
   ///
   /// The draining stops if the listener is removed.
   void setListener(String name, ChannelCallback callback) {
-    final _Channel channel = _channels.putIfAbsent(name, () => _Channel());
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
     channel.setListener(callback);
   }
 
@@ -399,10 +495,11 @@ class ChannelBuffers {
   /// This is intended to be called by the platform messages dispatcher, forwarding
   /// messages from plugins to the [kControlChannelName] channel.
   ///
-  /// Messages use the [StandardMethodCodec] format. There are two methods
-  /// supported: `resize` and `overflow`. The `resize` method changes the size
-  /// of the buffer, and the `overflow` method controls whether overflow is
-  /// expected or not.
+  /// Messages use the [StandardMethodCodec] format. There are three methods
+  /// supported: `resize`, `overflow` and `lane`. The `resize` method changes
+  /// the size of the buffer, the `overflow` method controls whether overflow
+  /// is expected or not, and the `lane` method sets how urgently the channel
+  /// is drained.
   ///
   /// ## `resize`
   ///
@@ -432,6 +529,16 @@ class ChannelBuffers {
   /// channel. When the flag is set, messages are discarded silently. When the
   /// flag is cleared (the default), any overflow on the channel causes a message
   /// to be printed to the console, warning that a message was lost.
+  ///
+  /// ## `lane`
+  ///
+  /// The `lane` method takes as its argument a list with two values, first
+  /// the channel name (a UTF-8 string less than 254 bytes long), and second the
+  /// index of the lane in [ChannelLane.values] (an integer). See [setLane].
+  ///
+  /// The engine sends this message when the embedder puts a channel in a lane,
+  /// so that the messages on the channel are buffered in the same lane that
+  /// the engine delivers them in.
   void handleMessage(ByteData data) {
     // We hard-code the deserialization here because the StandardMethodCodec class
     // is part of the framework, not dart:ui.
@@ -485,6 +592,30 @@ class ChannelBuffers {
             throw Exception('Invalid arguments for \'overflow\' method sent to $kControlChannelName (second argument must be a boolean)');
           allowOverflow(channelName, bytes[index] == 0x01);
           break;
+        case 'lane':
+          if (bytes[index] != 0x0C) // 12 = value code for list
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (arguments must be a two-element list, channel name and lane)');
+          index += 1;
+          if (bytes[index] < 0x02) // We ignore extra arguments, in case we need to support them in the future, hence <2 rather than !=2.
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (arguments must be a two-element list, channel name and lane)');
+          index += 1;
+          if (bytes[index] != 0x07) // 7 = value code for string
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (first argument must be a string)');
+          index += 1;
+          final int channelNameLength = bytes[index];
+          if (channelNameLength >= 254) // lengths greater than 253 have more elaborate encoding
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (channel name must be less than 254 characters long)');
+          index += 1;
+          final String channelName = utf8.decode(bytes.sublist(index, index + channelNameLength));
+          index += channelNameLength;
+          if (bytes[index] != 0x03) // 3 = value code for uint32
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (second argument must be an integer in the range 0 to ${ChannelLane.values.length - 1})');
+          index += 1;
+          final int lane = data.getUint32(index, Endian.host);
+          if (lane >= ChannelLane.values.length)
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (second argument must be an integer in the range 0 to ${ChannelLane.values.length - 1})');
+          setLane(channelName, ChannelLane.values[lane]);
+          break;
         default:
           throw Exception('Unrecognized method \'$methodName\' sent to $kControlChannelName');
       }
@@ -515,7 +646,7 @@ class ChannelBuffers {
   void resize(String name, int newSize) {
     _Channel? channel = _channels[name];
     if (channel == null) {
-      channel = _Channel(newSize);
+      channel = _Channel(this, newSize);
       _channels[name] = channel;
     } else {
       channel.capacity = newSize;
@@ -538,13 +669,28 @@ class ChannelBuffers {
     assert(() {
       _Channel? channel = _channels[name];
       if (channel == null && allowed) {
-        channel = _Channel();
+        channel = _Channel(this);
         _channels[name] = channel;
       }
       channel?.debugEnableDiscardWarnings = !allowed;
       return true;
     }());
   }
+
+  /// Sets how urgently the buffered messages on the given channel are drained
+  /// once a listener is set.
+  ///
+  /// Channels in more urgent lanes are drained first. Channels in the
+  /// [ChannelLane.background] lane are drained in event loop tasks rather than
+  /// in microtasks, so that frames and other events are handled first.
+  ///
+  /// This is expected to be called by the engine (indirectly via the control
+  /// channel), which delivers the messages on the channel in the same lane.
+  /// See [handleMessage].
+  void setLane(String name, ChannelLane lane) {
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
+    channel.lane = lane;
+  }
 }
 
 /// [ChannelBuffers] that allow the storage of messages between the
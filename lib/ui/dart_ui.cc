@@ -29,6 +29,7 @@
 #include "flutter/lib/ui/semantics/string_attribute.h"
 #include "flutter/lib/ui/text/font_collection.h"
 #include "flutter/lib/ui/text/paragraph.h"
+#include "flutter/lib/ui/text/paragraph_batch.h"
 #include "flutter/lib/ui/text/paragraph_builder.h"
 #include "flutter/lib/ui/window/platform_configuration.h"
 #include "third_party/tonic/converter/dart_converter.h"
@@ -77,6 +78,7 @@ void DartUI::InitForGlobal() {
     IsolateNameServerNatives::RegisterNatives(g_natives);
     NativeStringAttribute::RegisterNatives(g_natives);
     Paragraph::RegisterNatives(g_natives);
+    ParagraphBatch::RegisterNatives(g_natives);
     ParagraphBuilder::RegisterNatives(g_natives);
     Picture::RegisterNatives(g_natives);
     PictureRecorder::RegisterNatives(g_natives);
@@ -72,6 +72,29 @@ class IsolateNameServer {
     return _removePortNameMapping(name);
   }
 
+  /// Sends `buffer` to the [SendPort] registered with a given name.
+  ///
+  /// Returns true if a port is registered with the name, and false otherwise.
+  ///
+  /// Unlike a [Uint8List], a [TransferableTypedData] is not copied when it is
+  /// sent, so background isolates can hand large results to another isolate
+  /// this way. Sending moves the bytes to the receiving isolate, which gets
+  /// them with [TransferableTypedData.materialize]; the sending isolate can no
+  /// longer access them.
+  ///
+  /// The `name` and `buffer` arguments must not be null.
+  static bool sendBufferToPortByName(
+      String name, TransferableTypedData buffer) {
+    assert(name != null, "'name' cannot be null.");
+    assert(buffer != null, "'buffer' cannot be null.");
+    final SendPort? port = _lookupPortByName(name);
+    if (port == null) {
+      return false;
+    }
+    port.send(buffer);
+    return true;
+  }
+
   static SendPort? _lookupPortByName(String name)
       native 'IsolateNameServerNatives_LookupPortByName';
   static bool _registerPortWithName(SendPort port, String name)
@@ -0,0 +1,26 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/isolate_name_server/isolate_name_server.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(IsolateNameServerTest, RegistersPortsByName) {
+  IsolateNameServer name_server;
+  EXPECT_EQ(name_server.LookupIsolatePortByName("port"), ILLEGAL_PORT);
+
+  EXPECT_TRUE(name_server.RegisterIsolatePortWithName(42, "port"));
+  EXPECT_FALSE(name_server.RegisterIsolatePortWithName(43, "port"));
+  EXPECT_EQ(name_server.LookupIsolatePortByName("port"), 42);
+
+  EXPECT_TRUE(name_server.RemoveIsolateNameMapping("port"));
+  EXPECT_FALSE(name_server.RemoveIsolateNameMapping("port"));
+  EXPECT_EQ(name_server.LookupIsolatePortByName("port"), ILLEGAL_PORT);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,204 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
+
+#include <cstring>
+#include <limits>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+// https://github.khronos.org/KTX-Specification/#_identifier
+constexpr uint8_t kKTX2Identifier[] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A,
+};
+
+// Size of the identifier, header and index sections that precede the level
+// index.
+constexpr size_t kKTX2HeaderSize = 80;
+
+// Offset of the first level index entry. Each entry is three uint64 values:
+// byteOffset, byteLength and uncompressedByteLength.
+constexpr size_t kKTX2LevelIndexOffset = kKTX2HeaderSize;
+
+// The subset of VkFormat values that map onto an `SkImage::CompressionType`.
+constexpr uint32_t kVkFormatBC1RGBUnormBlock = 131;
+constexpr uint32_t kVkFormatBC1RGBAUnormBlock = 133;
+constexpr uint32_t kVkFormatETC2R8G8B8UnormBlock = 147;
+
+// All of the supported formats use 4x4 blocks of 8 bytes each.
+constexpr uint32_t kBlockDimension = 4;
+constexpr uint32_t kBytesPerBlock = 8;
+
+uint32_t ReadUint32(const uint8_t* bytes) {
+  return static_cast<uint32_t>(bytes[0]) |
+         static_cast<uint32_t>(bytes[1]) << 8 |
+         static_cast<uint32_t>(bytes[2]) << 16 |
+         static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+uint64_t ReadUint64(const uint8_t* bytes) {
+  return static_cast<uint64_t>(ReadUint32(bytes)) |
+         static_cast<uint64_t>(ReadUint32(bytes + 4)) << 32;
+}
+
+std::optional<SkImage::CompressionType> CompressionTypeForVkFormat(
+    uint32_t vk_format) {
+  switch (vk_format) {
+    case kVkFormatBC1RGBUnormBlock:
+      return SkImage::CompressionType::kBC1_RGB8_UNORM;
+    case kVkFormatBC1RGBAUnormBlock:
+      return SkImage::CompressionType::kBC1_RGBA8_UNORM;
+    case kVkFormatETC2R8G8B8UnormBlock:
+      return SkImage::CompressionType::kETC2_RGB8_UNORM;
+    default:
+      return std::nullopt;
+  }
+}
+
+}  // namespace
+
+CompressedTextureImageGenerator::~CompressedTextureImageGenerator() = default;
+
+CompressedTextureImageGenerator::CompressedTextureImageGenerator(
+    sk_sp<SkData> texture_data,
+    SkImage::CompressionType compression_type,
+    const SkImageInfo& info)
+    : texture_data_(std::move(texture_data)),
+      compression_type_(compression_type),
+      info_(info) {}
+
+const SkImageInfo& CompressedTextureImageGenerator::GetInfo() const {
+  return info_;
+}
+
+unsigned int CompressedTextureImageGenerator::GetFrameCount() const {
+  return 1;
+}
+
+unsigned int CompressedTextureImageGenerator::GetPlayCount() const {
+  return 1;
+}
+
+const ImageGenerator::FrameInfo CompressedTextureImageGenerator::GetFrameInfo(
+    unsigned int frame_index) const {
+  return {.required_frame = std::nullopt,
+          .duration = 0,
+          .disposal_method = SkCodecAnimation::DisposalMethod::kKeep};
+}
+
+SkISize CompressedTextureImageGenerator::GetScaledDimensions(
+    float desired_scale) const {
+  return info_.dimensions();
+}
+
+bool CompressedTextureImageGenerator::GetPixels(
+    const SkImageInfo& info,
+    void* pixels,
+    size_t row_bytes,
+    unsigned int frame_index,
+    std::optional<unsigned int> prior_frame) const {
+  TRACE_EVENT0("flutter", "CompressedTextureImageGenerator::GetPixels");
+  if (info.dimensions() != info_.dimensions()) {
+    FML_DLOG(ERROR) << "Compressed textures can only be decoded at their "
+                       "native dimensions.";
+    return false;
+  }
+
+  // Decompresses the blocks on the CPU.
+  sk_sp<SkImage> image = SkImage::MakeRasterFromCompressed(
+      texture_data_, info_.width(), info_.height(), compression_type_);
+  if (!image) {
+    return false;
+  }
+  return image->readPixels(info, pixels, row_bytes, 0, 0);
+}
+
+std::optional<ImageGenerator::CompressedTexture>
+CompressedTextureImageGenerator::GetCompressedTexture() const {
+  return CompressedTexture{.data = texture_data_, .type = compression_type_};
+}
+
+std::unique_ptr<ImageGenerator> CompressedTextureImageGenerator::MakeFromData(
+    sk_sp<SkData> data) {
+  if (!data || data->size() < kKTX2HeaderSize ||
+      ::memcmp(data->data(), kKTX2Identifier, sizeof(kKTX2Identifier)) != 0) {
+    return nullptr;
+  }
+
+  const uint8_t* bytes = data->bytes();
+  const uint32_t vk_format = ReadUint32(bytes + 12);
+  const uint32_t pixel_width = ReadUint32(bytes + 20);
+  const uint32_t pixel_height = ReadUint32(bytes + 24);
+  const uint32_t pixel_depth = ReadUint32(bytes + 28);
+  const uint32_t layer_count = ReadUint32(bytes + 32);
+  const uint32_t face_count = ReadUint32(bytes + 36);
+  const uint32_t supercompression_scheme = ReadUint32(bytes + 44);
+
+  auto compression_type = CompressionTypeForVkFormat(vk_format);
+  if (!compression_type.has_value()) {
+    FML_DLOG(ERROR) << "Unsupported KTX2 texture format: " << vk_format;
+    return nullptr;
+  }
+
+  if (supercompression_scheme != 0) {
+    FML_DLOG(ERROR) << "Supercompressed KTX2 textures are not supported.";
+    return nullptr;
+  }
+
+  // Only simple 2D textures can be used as images.
+  if (pixel_width == 0 || pixel_height == 0 || pixel_depth != 0 ||
+      layer_count > 1 || face_count != 1 ||
+      pixel_width > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+      pixel_height > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+    FML_DLOG(ERROR) << "Only 2D KTX2 textures are supported.";
+    return nullptr;
+  }
+
+  if (data->size() < kKTX2LevelIndexOffset + 3 * sizeof(uint64_t)) {
+    return nullptr;
+  }
+
+  // Level 0 is always the base level regardless of how many levels are
+  // present.
+  const uint64_t level_offset = ReadUint64(bytes + kKTX2LevelIndexOffset);
+  const uint64_t level_length = ReadUint64(bytes + kKTX2LevelIndexOffset + 8);
+
+  const uint64_t blocks_wide =
+      (static_cast<uint64_t>(pixel_width) + kBlockDimension - 1) /
+      kBlockDimension;
+  const uint64_t blocks_high =
+      (static_cast<uint64_t>(pixel_height) + kBlockDimension - 1) /
+      kBlockDimension;
+  const uint64_t expected_length = blocks_wide * blocks_high * kBytesPerBlock;
+
+  if (level_length != expected_length || level_offset > data->size() ||
+      level_length > data->size() - level_offset) {
+    FML_DLOG(ERROR) << "Malformed KTX2 level index.";
+    return nullptr;
+  }
+
+  auto texture_data =
+      SkData::MakeSubset(data.get(), level_offset, level_length);
+  if (!texture_data) {
+    return nullptr;
+  }
+
+  const SkAlphaType alpha_type =
+      compression_type.value() == SkImage::CompressionType::kBC1_RGBA8_UNORM
+          ? kPremul_SkAlphaType
+          : kOpaque_SkAlphaType;
+  const SkImageInfo info = SkImageInfo::Make(
+      pixel_width, pixel_height, kRGBA_8888_SkColorType, alpha_type);
+
+  return std::make_unique<CompressedTextureImageGenerator>(
+      std::move(texture_data), compression_type.value(), info);
+}
+
+}  // namespace flutter
@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
+#define FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
+
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/painting/image_generator.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+
+/// @brief  An `ImageGenerator` for KTX2 containers holding GPU
+///         block-compressed texture data (ETC2 RGB8, BC1 RGB and BC1 RGBA).
+///
+///         The block-compressed payload of the base mip level is exposed via
+///         `GetCompressedTexture` so that it can be uploaded directly to
+///         contexts that support the format. For contexts that don't, and for
+///         the software backend, `GetPixels` decompresses the blocks on the CPU
+///         into regular RGBA pixels.
+///
+///         Supercompressed containers (BasisLZ, Zstandard) are not supported
+///         as there is no transcoder available in the engine.
+class CompressedTextureImageGenerator : public ImageGenerator {
+ public:
+  ~CompressedTextureImageGenerator();
+
+  CompressedTextureImageGenerator(sk_sp<SkData> texture_data,
+                                  SkImage::CompressionType compression_type,
+                                  const SkImageInfo& info);
+
+  // |ImageGenerator|
+  const SkImageInfo& GetInfo() const override;
+
+  // |ImageGenerator|
+  unsigned int GetFrameCount() const override;
+
+  // |ImageGenerator|
+  unsigned int GetPlayCount() const override;
+
+  // |ImageGenerator|
+  const ImageGenerator::FrameInfo GetFrameInfo(
+      unsigned int frame_index) const override;
+
+  // |ImageGenerator|
+  SkISize GetScaledDimensions(float desired_scale) const override;
+
+  // |ImageGenerator|
+  bool GetPixels(
+      const SkImageInfo& info,
+      void* pixels,
+      size_t row_bytes,
+      unsigned int frame_index = 0,
+      std::optional<unsigned int> prior_frame = std::nullopt) const override;
+
+  // |ImageGenerator|
+  std::optional<CompressedTexture> GetCompressedTexture() const override;
+
+  /// @brief      Creates a generator for the given buffer if it is a KTX2
+  ///             container holding a supported block-compressed format.
+  /// @param[in]  data  The raw encoded image data.
+  /// @return     The generator, or `nullptr` if the buffer is not a supported
+  ///             KTX2 container.
+  static std::unique_ptr<ImageGenerator> MakeFromData(sk_sp<SkData> data);
+
+ private:
+  sk_sp<SkData> texture_data_;
+  const SkImage::CompressionType compression_type_;
+  const SkImageInfo info_;
+
+  FML_DISALLOW_COPY_ASSIGN_AND_MOVE(CompressedTextureImageGenerator);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_COMPRESSED_TEXTURE_IMAGE_GENERATOR_H_
@@ -35,7 +35,9 @@ void CanvasImage::RegisterNatives(tonic::DartLibraryNatives* natives) {
   natives->Register({FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
 }
 
-CanvasImage::CanvasImage() = default;
+CanvasImage::CanvasImage()
+    : ledger_allocation_(ImageMemoryLedger::GetInstance().Track(
+          ImageMemoryCategory::kDartImages, 0)) {}
 
 CanvasImage::~CanvasImage() = default;
 
@@ -43,6 +45,12 @@ Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
   return EncodeImage(this, format, callback);
 }
 
+void CanvasImage::set_image(flutter::SkiaGPUObject<SkImage> image) {
+  image_ = std::move(image);
+  ledger_allocation_.Update(
+      ImageMemoryLedger::GetImageByteSize(image_.get().get()));
+}
+
 void CanvasImage::dispose() {
   // TODO(dnfield): Remove the hint freed delegate once Picture disposal is in
   // the framework https://github.com/flutter/flutter/issues/81514
@@ -51,6 +59,7 @@ void CanvasImage::dispose() {
     hint_freed_delegate->HintFreed(GetAllocationSize());
   }
   image_.reset();
+  ledger_allocation_.Update(0);
   ClearDartWrapper();
 }
 
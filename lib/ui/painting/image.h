@@ -5,6 +5,7 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_H_
 #define FLUTTER_LIB_UI_PAINTING_IMAGE_H_
 
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/lib/ui/dart_wrapper.h"
 #include "flutter/lib/ui/ui_dart_state.h"
@@ -35,9 +36,7 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   void dispose();
 
   sk_sp<SkImage> image() const { return image_.get(); }
-  void set_image(flutter::SkiaGPUObject<SkImage> image) {
-    image_ = std::move(image);
-  }
+  void set_image(flutter::SkiaGPUObject<SkImage> image);
 
   size_t GetAllocationSize() const override;
 
@@ -47,6 +46,7 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
   CanvasImage();
 
   flutter::SkiaGPUObject<SkImage> image_;
+  ImageMemoryLedger::Allocation ledger_allocation_;
 };
 
 }  // namespace flutter
@@ -6,7 +6,9 @@
 
 #include <algorithm>
 
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/lib/ui/painting/image_resize_kernels.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 
 namespace flutter {
@@ -43,8 +45,17 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return image->makeRasterImage();
   }
 
-  const auto scaled_image_info =
+  const bool downscaling =
+      resized_dimensions.width() <= image->width() &&
+      resized_dimensions.height() <= image->height();
+
+  auto scaled_image_info =
       image->imageInfo().makeDimensions(resized_dimensions);
+  if (downscaling && scaled_image_info.alphaType() == kUnpremul_SkAlphaType) {
+    // The downscale kernels filter premultiplied pixels, which is also what
+    // the image will be drawn as.
+    scaled_image_info = scaled_image_info.makeAlphaType(kPremul_SkAlphaType);
+  }
 
   SkBitmap scaled_bitmap;
   if (!scaled_bitmap.tryAllocPixels(scaled_image_info)) {
@@ -53,7 +64,15 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return nullptr;
   }
 
-  if (!image->scalePixels(
+  SkPixmap source_pixmap;
+  const bool downscaled =
+      downscaling && image->peekPixels(&source_pixmap) &&
+      DownscalePixels(
+          source_pixmap, scaled_bitmap.pixmap(),
+          ChooseResizeFilter(image->dimensions(), resized_dimensions));
+
+  if (!downscaled &&
+      !image->scalePixels(
           scaled_bitmap.pixmap(),
           SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone),
           SkImage::kDisallow_CachingHint)) {
@@ -216,6 +235,114 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
+static SkiaGPUObject<SkImage> UploadCompressedTexture(
+    const ImageGenerator::CompressedTexture& texture,
+    const SkISize& dimensions,
+    fml::WeakPtr<IOManager> io_manager,
+    const fml::tracing::TraceFlow& flow) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  auto context = io_manager->GetResourceContext();
+  auto queue = io_manager->GetSkiaUnrefQueue();
+  if (!context || !queue) {
+    return {};
+  }
+
+  // Not all backends can sample every block compression format. The caller is
+  // expected to fall back to decompressing the texture on the CPU.
+  if (!context->compressedBackendFormat(texture.type).isValid()) {
+    return {};
+  }
+
+  SkiaGPUObject<SkImage> result;
+  io_manager->GetIsGpuDisabledSyncSwitch()->Execute(
+      fml::SyncSwitch::Handlers().SetIfFalse(
+          [&result, &texture, &dimensions, &context, &queue] {
+            TRACE_EVENT0("flutter", "MakeTextureFromCompressed");
+            sk_sp<SkImage> texture_image = SkImage::MakeTextureFromCompressed(
+                context.get(),        // context
+                texture.data,         // data
+                dimensions.width(),   // width
+                dimensions.height(),  // height
+                texture.type          // type
+            );
+            if (!texture_image) {
+              FML_LOG(ERROR) << "Could not make compressed texture image.";
+              result = {};
+            } else {
+              result = {std::move(texture_image), queue};
+            }
+          }));
+
+  return result;
+}
+
+using DecodeResult =
+    std::function<void(SkiaGPUObject<SkImage>, fml::tracing::TraceFlow)>;
+
+// Decompresses the image described by the raw descriptor on the current
+// (worker) thread and then uploads the result on the IO thread.
+static void DecompressAndUpload(ImageDescriptor* raw_descriptor,
+                                fml::WeakPtr<IOManager> io_manager,
+                                fml::RefPtr<fml::TaskRunner> io_runner,
+                                DecodeResult result,
+                                uint32_t target_width,
+                                uint32_t target_height,
+                                fml::tracing::TraceFlow flow) {
+  // Step 1: Decompress the image.
+  // On Worker.
+
+  auto decompressed = raw_descriptor->is_compressed()
+                          ? ImageFromCompressedData(raw_descriptor,  //
+                                                    target_width,    //
+                                                    target_height,   //
+                                                    flow)
+                          : ImageFromDecompressedData(raw_descriptor,  //
+                                                      target_width,    //
+                                                      target_height,   //
+                                                      flow);
+
+  if (!decompressed) {
+    FML_DLOG(ERROR) << "Could not decompress image.";
+    result({}, std::move(flow));
+    return;
+  }
+
+  // Step 2: Update the image to the GPU.
+  // On IO Thread.
+
+  io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                         flow = std::move(flow)]() mutable {
+    if (!io_manager) {
+      FML_DLOG(ERROR) << "Could not acquire IO manager.";
+      result({}, std::move(flow));
+      return;
+    }
+
+    // If the IO manager does not have a resource context, the caller
+    // might not have set one or a software backend could be in use.
+    // Either way, just return the image as-is.
+    if (!io_manager->GetResourceContext()) {
+      result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
+             std::move(flow));
+      return;
+    }
+
+    auto uploaded =
+        UploadRasterImage(std::move(decompressed), io_manager, flow);
+
+    if (!uploaded.get()) {
+      FML_DLOG(ERROR) << "Could not upload image to the GPU.";
+      result({}, std::move(flow));
+      return;
+    }
+
+    // Finally, all done.
+    result(std::move(uploaded), std::move(flow));
+  }));
+}
+
 void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
                           uint32_t target_width,
                           uint32_t target_height,
@@ -243,17 +370,24 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
   // Always service the callback (and cleanup the descriptor) on the UI thread.
-  auto result =
+  DecodeResult result =
       [callback, raw_descriptor, ui_runner = runners_.GetUITaskRunner()](
           SkiaGPUObject<SkImage> image, fml::tracing::TraceFlow flow) {
+        // The decoded image is accounted for until the callback hands it over
+        // to its `ui.Image`.
+        auto pending_allocation = ImageMemoryLedger::GetInstance().Track(
+            ImageMemoryCategory::kPendingDecodes,
+            ImageMemoryLedger::GetImageByteSize(image.get().get()));
         ui_runner->PostTask(fml::MakeCopyable(
             [callback, raw_descriptor, image = std::move(image),
-             flow = std::move(flow)]() mutable {
+             flow = std::move(flow),
+             pending_allocation = std::move(pending_allocation)]() mutable {
               // We are going to terminate the trace flow here. Flows cannot
               // terminate without a base trace. Add one explicitly.
               TRACE_EVENT0("flutter", "ImageDecodeCallback");
               flow.End();
               callback(std::move(image));
+              pending_allocation.Update(0);
               raw_descriptor->Release();
             }));
       };
@@ -263,67 +397,64 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
     return;
   }
 
-  concurrent_task_runner_->PostTask(
-      fml::MakeCopyable([raw_descriptor,                          //
-                         io_manager = io_manager_,                //
-                         io_runner = runners_.GetIOTaskRunner(),  //
-                         result,                                  //
-                         target_width = target_width,             //
-                         target_height = target_height,           //
-                         flow = std::move(flow)                   //
-  ]() mutable {
-        // Step 1: Decompress the image.
-        // On Worker.
-
-        auto decompressed = raw_descriptor->is_compressed()
-                                ? ImageFromCompressedData(raw_descriptor,  //
-                                                          target_width,    //
-                                                          target_height,   //
-                                                          flow)
-                                : ImageFromDecompressedData(raw_descriptor,  //
-                                                            target_width,    //
-                                                            target_height,   //
-                                                            flow);
-
-        if (!decompressed) {
-          FML_DLOG(ERROR) << "Could not decompress image.";
-          result({}, std::move(flow));
-          return;
-        }
-
-        // Step 2: Update the image to the GPU.
-        // On IO Thread.
-
-        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
-                                               flow =
-                                                   std::move(flow)]() mutable {
+  // GPU block-compressed textures that don't need to be resized are handed to
+  // the IO thread as-is. They are only decompressed on a worker if the
+  // resource context can't sample their format or there is no resource
+  // context at all.
+  auto compressed_texture = raw_descriptor->compressed_texture();
+  if (compressed_texture.has_value() &&
+      !raw_descriptor->should_resize(target_width, target_height)) {
+    runners_.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
+        [raw_descriptor,                                    //
+         texture = std::move(compressed_texture.value()),   //
+         io_manager = io_manager_,                          //
+         io_runner = runners_.GetIOTaskRunner(),            //
+         concurrent_task_runner = concurrent_task_runner_,  //
+         result,                                            //
+         target_width = target_width,                       //
+         target_height = target_height,                     //
+         flow = std::move(flow)                             //
+    ]() mutable {
           if (!io_manager) {
             FML_DLOG(ERROR) << "Could not acquire IO manager.";
             result({}, std::move(flow));
             return;
           }
 
-          // If the IO manager does not have a resource context, the caller
-          // might not have set one or a software backend could be in use.
-          // Either way, just return the image as-is.
-          if (!io_manager->GetResourceContext()) {
-            result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
-                   std::move(flow));
+          auto uploaded = UploadCompressedTexture(
+              texture, raw_descriptor->image_info().dimensions(), io_manager,
+              flow);
+          if (uploaded.get()) {
+            result(std::move(uploaded), std::move(flow));
             return;
           }
 
-          auto uploaded =
-              UploadRasterImage(std::move(decompressed), io_manager, flow);
-
-          if (!uploaded.get()) {
-            FML_DLOG(ERROR) << "Could not upload image to the GPU.";
-            result({}, std::move(flow));
-            return;
-          }
-
-          // Finally, all done.
-          result(std::move(uploaded), std::move(flow));
+          concurrent_task_runner->PostTask(fml::MakeCopyable(
+              [raw_descriptor, io_manager = std::move(io_manager),
+               io_runner = std::move(io_runner), result = std::move(result),
+               target_width, target_height,
+               flow = std::move(flow)]() mutable {
+                DecompressAndUpload(raw_descriptor, std::move(io_manager),
+                                    std::move(io_runner), std::move(result),
+                                    target_width, target_height,
+                                    std::move(flow));
+              }));
         }));
+    return;
+  }
+
+  concurrent_task_runner_->PostTask(
+      fml::MakeCopyable([raw_descriptor,                          //
+                         io_manager = io_manager_,                //
+                         io_runner = runners_.GetIOTaskRunner(),  //
+                         result,                                  //
+                         target_width = target_width,             //
+                         target_height = target_height,           //
+                         flow = std::move(flow)                   //
+  ]() mutable {
+        DecompressAndUpload(raw_descriptor, std::move(io_manager),
+                            std::move(io_runner), std::move(result),
+                            target_width, target_height, std::move(flow));
       }));
 }
 
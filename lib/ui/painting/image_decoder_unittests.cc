@@ -7,6 +7,7 @@
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
@@ -121,6 +122,63 @@ static sk_sp<SkData> OpenFixtureAsSkData(const char* name) {
   return data;
 }
 
+// Creates a KTX2 container with a single BC1 compressed level in which every
+// texel decodes to the given RGB565 color.
+static sk_sp<SkData> MakeSolidColorBC1KTX2(uint32_t width,
+                                           uint32_t height,
+                                           uint16_t rgb565,
+                                           uint32_t supercompression = 0) {
+  constexpr size_t kLevelIndexOffset = 80;
+  constexpr size_t kLevelDataOffset = kLevelIndexOffset + 24;
+  const size_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+  const size_t level_length = blocks * 8;
+
+  std::vector<uint8_t> bytes(kLevelDataOffset + level_length, 0);
+  auto write32 = [&bytes](size_t offset, uint32_t value) {
+    for (size_t i = 0; i < 4; i++) {
+      bytes[offset + i] = (value >> (8 * i)) & 0xFF;
+    }
+  };
+
+  const uint8_t identifier[] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+  std::copy(std::begin(identifier), std::end(identifier), bytes.begin());
+  write32(12, 131);  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+  write32(16, 1);    // typeSize
+  write32(20, width);
+  write32(24, height);
+  write32(36, 1);  // faceCount
+  write32(40, 1);  // levelCount
+  write32(44, supercompression);
+  write32(kLevelIndexOffset, kLevelDataOffset);
+  write32(kLevelIndexOffset + 8, level_length);
+
+  // Both endpoints are the same color and all indices select the first one.
+  for (size_t block = 0; block < blocks; block++) {
+    const size_t offset = kLevelDataOffset + block * 8;
+    bytes[offset + 0] = rgb565 & 0xFF;
+    bytes[offset + 1] = rgb565 >> 8;
+    bytes[offset + 2] = rgb565 & 0xFF;
+    bytes[offset + 3] = rgb565 >> 8;
+  }
+
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+static void AssertImageIsSolidColor(const sk_sp<SkImage>& image,
+                                    SkColor color) {
+  ASSERT_TRUE(image);
+  SkBitmap bitmap;
+  ASSERT_TRUE(bitmap.tryAllocPixels(
+      SkImageInfo::MakeN32Premul(image->width(), image->height())));
+  ASSERT_TRUE(image->readPixels(bitmap.pixmap(), 0, 0));
+  for (int y = 0; y < image->height(); y++) {
+    for (int x = 0; x < image->width(); x++) {
+      ASSERT_EQ(bitmap.getColor(x, y), color);
+    }
+  }
+}
+
 class ImageDecoderFixtureTest : public FixtureTest {};
 
 TEST_F(ImageDecoderFixtureTest, CanCreateImageDecoder) {
@@ -563,6 +621,64 @@ TEST_F(ImageDecoderFixtureTest, DISABLED_CanResizeWithoutDecode) {
   latch.Wait();
 }
 
+TEST_F(ImageDecoderFixtureTest,
+       CanDecodeCompressedTextureWithoutAGPUContext) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+
+  std::unique_ptr<IOManager> io_manager;
+
+  auto release_io_manager = [&]() {
+    io_manager.reset();
+    latch.Signal();
+  };
+
+  auto decode_image = [&]() {
+    std::unique_ptr<ImageDecoder> image_decoder =
+        std::make_unique<ImageDecoder>(runners, loop->GetTaskRunner(),
+                                       io_manager->GetWeakIOManager());
+
+    auto data = MakeSolidColorBC1KTX2(16, 8, 0xF800);
+
+    ImageGeneratorRegistry registry;
+    std::unique_ptr<ImageGenerator> generator =
+        registry.CreateCompatibleGenerator(data);
+    ASSERT_TRUE(generator);
+    ASSERT_TRUE(generator->GetCompressedTexture().has_value());
+
+    auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+        std::move(data), std::move(generator));
+
+    ImageDecoder::ImageResult callback = [&](SkiaGPUObject<SkImage> image) {
+      ASSERT_TRUE(runners.GetUITaskRunner()->RunsTasksOnCurrentThread());
+      ASSERT_TRUE(image.get());
+      ASSERT_EQ(image.get()->dimensions(), SkISize::Make(16, 8));
+      ASSERT_FALSE(image.get()->isTextureBacked());
+      AssertImageIsSolidColor(image.get(), SK_ColorRED);
+      runners.GetIOTaskRunner()->PostTask(release_io_manager);
+    };
+    image_decoder->Decode(descriptor, descriptor->width(), descriptor->height(),
+                          callback);
+  };
+
+  auto setup_io_manager_and_decode = [&]() {
+    io_manager =
+        std::make_unique<TestIOManager>(runners.GetIOTaskRunner(), false);
+    runners.GetUITaskRunner()->PostTask(decode_image);
+  };
+
+  runners.GetIOTaskRunner()->PostTask(setup_io_manager_and_decode);
+
+  latch.Wait();
+}
+
 // Verifies https://skia-review.googlesource.com/c/skia/+/259161 is present in
 // Flutter.
 TEST(ImageDecoderTest,
@@ -606,6 +722,47 @@ TEST(ImageDecoderTest, VerifySimpleDecoding) {
             SkISize::Make(6, 2));
 }
 
+TEST(ImageDecoderTest, VerifyCompressedTextureDecoding) {
+  auto data = MakeSolidColorBC1KTX2(8, 8, 0x001F);
+
+  ImageGeneratorRegistry registry;
+  std::unique_ptr<ImageGenerator> generator =
+      registry.CreateCompatibleGenerator(data);
+  ASSERT_TRUE(generator);
+
+  auto texture = generator->GetCompressedTexture();
+  ASSERT_TRUE(texture.has_value());
+  ASSERT_EQ(texture->type, SkImage::CompressionType::kBC1_RGB8_UNORM);
+  ASSERT_EQ(texture->data->size(), 4u * 8u);
+
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                         std::move(generator));
+  ASSERT_EQ(descriptor->width(), 8);
+  ASSERT_EQ(descriptor->height(), 8);
+
+  auto image = ImageFromCompressedData(descriptor.get(), 8, 8,
+                                       fml::tracing::TraceFlow(""));
+  ASSERT_EQ(image->dimensions(), SkISize::Make(8, 8));
+  AssertImageIsSolidColor(image, SK_ColorBLUE);
+
+  // Resizing goes through the regular CPU path.
+  auto resized = ImageFromCompressedData(descriptor.get(), 4, 4,
+                                         fml::tracing::TraceFlow(""));
+  ASSERT_EQ(resized->dimensions(), SkISize::Make(4, 4));
+  AssertImageIsSolidColor(resized, SK_ColorBLUE);
+}
+
+TEST(ImageDecoderTest, RejectsUnsupportedCompressedTextures) {
+  // BasisLZ supercompression requires a transcoder.
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      MakeSolidColorBC1KTX2(8, 8, 0x001F, 1)));
+
+  // Truncated level data.
+  auto data = MakeSolidColorBC1KTX2(8, 8, 0x001F);
+  ASSERT_FALSE(CompressedTextureImageGenerator::MakeFromData(
+      SkData::MakeSubset(data.get(), 0, data->size() - 1)));
+}
+
 TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   auto data = OpenFixtureAsSkData("Horizontal.jpg");
 
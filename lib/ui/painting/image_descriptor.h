@@ -89,6 +89,16 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   ///         not.
   bool is_compressed() const { return !!generator_; }
 
+  /// @brief  The GPU block-compressed texture data backing this image, if it
+  ///         was created from a compressed texture container.
+  /// @see    `ImageGenerator::GetCompressedTexture`
+  std::optional<ImageGenerator::CompressedTexture> compressed_texture() const {
+    if (generator_) {
+      return generator_->GetCompressedTexture();
+    }
+    return std::nullopt;
+  }
+
   /// @brief  The orientation corrected image info for this image.
   const SkImageInfo& image_info() const { return image_info_; }
 
@@ -4,14 +4,18 @@
 
 #include "flutter/lib/ui/painting/image_encoding.h"
 
+#include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/macros.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/painting/png_strip_encoder.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
@@ -35,6 +39,34 @@ enum ImageByteFormat {
   kPNG,
 };
 
+// Owns the Dart callback of an encode request while the image is encoded on
+// other threads. The persistent handle may only be cleared on the UI thread, so
+// a callback that is dropped before it is invoked, for example because a task
+// runner discarded the encode task, is released there too.
+class EncodeCallback {
+ public:
+  EncodeCallback(std::unique_ptr<DartPersistentValue> callback,
+                 fml::RefPtr<fml::TaskRunner> ui_task_runner)
+      : callback_(std::move(callback)),
+        ui_task_runner_(std::move(ui_task_runner)) {}
+
+  ~EncodeCallback() {
+    if (callback_) {
+      ui_task_runner_->PostTask(fml::MakeCopyable(
+          [callback = std::move(callback_)]() mutable { callback.reset(); }));
+    }
+  }
+
+  // Must only be called on the UI thread.
+  std::unique_ptr<DartPersistentValue> Take() { return std::move(callback_); }
+
+ private:
+  std::unique_ptr<DartPersistentValue> callback_;
+  fml::RefPtr<fml::TaskRunner> ui_task_runner_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EncodeCallback);
+};
+
 void FinalizeSkData(void* isolate_callback_data, void* peer) {
   SkData* buffer = reinterpret_cast<SkData*>(peer);
   buffer->unref();
@@ -166,24 +198,21 @@ sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
     return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
   }
 
-  // Perform swizzle if the type doesnt match the specification.
-  auto surface = SkSurface::MakeRaster(
+  // Perform swizzle if the type doesnt match the specification. The pixels are
+  // converted directly into the buffer that is handed to Dart.
+  const SkImageInfo swizzled_info =
       SkImageInfo::Make(raster_image->width(), raster_image->height(),
-                        color_type, kPremul_SkAlphaType, nullptr));
+                        color_type, kPremul_SkAlphaType, nullptr);
+  sk_sp<SkData> swizzled =
+      SkData::MakeUninitialized(swizzled_info.computeMinByteSize());
 
-  if (!surface) {
-    FML_LOG(ERROR) << "Could not set up the surface for swizzle.";
+  if (!pixmap.readPixels(swizzled_info, swizzled->writable_data(),
+                         swizzled_info.minRowBytes(), 0, 0)) {
+    FML_LOG(ERROR) << "Could not swizzle the pixels of the raster image.";
     return nullptr;
   }
 
-  surface->writePixels(pixmap, 0, 0);
-
-  if (!surface->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Pixel address is not available.";
-    return nullptr;
-  }
-
-  return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
+  return swizzled;
 }
 
 sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
@@ -216,27 +245,80 @@ sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
   return nullptr;
 }
 
+// Encodes the PNG strips of the raster image concurrently and hands the
+// concatenated chunks to the callback once all of them are available.
+void EncodePNGInStrips(sk_sp<SkImage> raster_image,
+                       std::shared_ptr<fml::ConcurrentTaskRunner> runner,
+                       std::function<void(sk_sp<SkData>)> on_encoded) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+
+  auto chunks = std::make_shared<std::vector<sk_sp<SkData>>>();
+  PngStripEncoder::EncodeAsync(
+      std::move(raster_image), std::move(runner),
+      [chunks, on_encoded = std::move(on_encoded)](sk_sp<SkData> chunk,
+                                                   bool done) {
+        if (!chunk) {
+          FML_LOG(ERROR) << "Could not convert raster image to PNG.";
+          on_encoded(nullptr);
+          return;
+        }
+
+        chunks->push_back(std::move(chunk));
+        if (!done) {
+          return;
+        }
+
+        size_t size = 0;
+        for (const auto& data : *chunks) {
+          size += data->size();
+        }
+        sk_sp<SkData> encoded = SkData::MakeUninitialized(size);
+        auto* destination = static_cast<uint8_t*>(encoded->writable_data());
+        for (const auto& data : *chunks) {
+          ::memcpy(destination, data->data(), data->size());
+          destination += data->size();
+        }
+        chunks->clear();
+        on_encoded(std::move(encoded));
+      });
+}
+
 void EncodeImageAndInvokeDataCallback(
     sk_sp<SkImage> image,
-    std::unique_ptr<DartPersistentValue> callback,
+    std::unique_ptr<EncodeCallback> callback,
     ImageByteFormat format,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
     fml::RefPtr<fml::TaskRunner> raster_task_runner,
     fml::RefPtr<fml::TaskRunner> io_task_runner,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
     GrDirectContext* resource_context,
     fml::WeakPtr<SnapshotDelegate> snapshot_delegate) {
   auto callback_task = fml::MakeCopyable(
       [callback = std::move(callback)](sk_sp<SkData> encoded) mutable {
-        InvokeDataCallback(std::move(callback), std::move(encoded));
+        InvokeDataCallback(callback->Take(), std::move(encoded));
       });
 
-  auto encode_task = [callback_task = std::move(callback_task), format,
-                      ui_task_runner](sk_sp<SkImage> raster_image) {
-    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), format);
-    ui_task_runner->PostTask([callback_task = std::move(callback_task),
-                              encoded = std::move(encoded)]() mutable {
-      callback_task(std::move(encoded));
-    });
+  auto invoke_callback = [callback_task = std::move(callback_task),
+                          ui_task_runner](sk_sp<SkData> encoded) {
+    ui_task_runner->PostTask(
+        [callback_task, encoded = std::move(encoded)]() mutable {
+          callback_task(std::move(encoded));
+        });
+  };
+
+  auto encode_task = [invoke_callback = std::move(invoke_callback), format,
+                      concurrent_task_runner](sk_sp<SkImage> raster_image) {
+    // Large PNGs are compressed in strips across the worker pool instead of on
+    // the current thread. Images with wider channels are left to Skia's
+    // encoder so that they keep their 16-bit output.
+    if (format == kPNG && concurrent_task_runner && raster_image &&
+        PngStripEncoder::ShouldEncodeInStrips(raster_image->imageInfo())) {
+      EncodePNGInStrips(std::move(raster_image), concurrent_task_runner,
+                        invoke_callback);
+      return;
+    }
+
+    invoke_callback(EncodeImage(std::move(raster_image), format));
   };
 
   ConvertImageToRaster(std::move(image), encode_task, raster_task_runner,
@@ -258,23 +340,49 @@ Dart_Handle EncodeImage(CanvasImage* canvas_image,
 
   ImageByteFormat image_format = static_cast<ImageByteFormat>(format);
 
-  auto callback = std::make_unique<DartPersistentValue>(
-      tonic::DartState::Current(), callback_handle);
-
   const auto& task_runners = UIDartState::Current()->GetTaskRunners();
+  auto callback = std::make_unique<EncodeCallback>(
+      std::make_unique<DartPersistentValue>(tonic::DartState::Current(),
+                                            callback_handle),
+      task_runners.GetUITaskRunner());
+  auto concurrent_task_runner =
+      UIDartState::Current()->GetConcurrentTaskRunner();
+  sk_sp<SkImage> image = canvas_image->image();
+
+  // Images that are already backed by CPU memory never need the resource
+  // context or the rasterizer to be read back, and so are encoded directly on
+  // a worker instead of queueing behind texture uploads on the IO thread.
+  SkPixmap pixmap;
+  if (concurrent_task_runner && image && image->peekPixels(&pixmap)) {
+    concurrent_task_runner->PostTask(fml::MakeCopyable(
+        [callback = std::move(callback), image = std::move(image),
+         image_format, ui_task_runner = task_runners.GetUITaskRunner(),
+         raster_task_runner = task_runners.GetRasterTaskRunner(),
+         io_task_runner = task_runners.GetIOTaskRunner(),
+         concurrent_task_runner]() mutable {
+          EncodeImageAndInvokeDataCallback(
+              std::move(image), std::move(callback), image_format,
+              std::move(ui_task_runner), std::move(raster_task_runner),
+              std::move(io_task_runner), std::move(concurrent_task_runner),
+              nullptr, {});
+        }));
+    return Dart_Null();
+  }
 
   task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
-      [callback = std::move(callback), image = canvas_image->image(),
-       image_format, ui_task_runner = task_runners.GetUITaskRunner(),
+      [callback = std::move(callback), image = std::move(image), image_format,
+       ui_task_runner = task_runners.GetUITaskRunner(),
        raster_task_runner = task_runners.GetRasterTaskRunner(),
        io_task_runner = task_runners.GetIOTaskRunner(),
+       concurrent_task_runner = std::move(concurrent_task_runner),
        io_manager = UIDartState::Current()->GetIOManager(),
        snapshot_delegate =
            UIDartState::Current()->GetSnapshotDelegate()]() mutable {
         EncodeImageAndInvokeDataCallback(
             std::move(image), std::move(callback), image_format,
             std::move(ui_task_runner), std::move(raster_task_runner),
-            std::move(io_task_runner), io_manager->GetResourceContext().get(),
+            std::move(io_task_runner), std::move(concurrent_task_runner),
+            io_manager->GetResourceContext().get(),
             std::move(snapshot_delegate));
       }));
 
@@ -8,6 +8,11 @@ namespace flutter {
 
 ImageGenerator::~ImageGenerator() = default;
 
+std::optional<ImageGenerator::CompressedTexture>
+ImageGenerator::GetCompressedTexture() const {
+  return std::nullopt;
+}
+
 BuiltinSkiaImageGenerator::~BuiltinSkiaImageGenerator() = default;
 
 BuiltinSkiaImageGenerator::BuiltinSkiaImageGenerator(
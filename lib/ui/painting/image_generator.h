@@ -7,6 +7,8 @@
 
 #include <optional>
 #include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
@@ -39,6 +41,17 @@ class ImageGenerator {
     SkCodecAnimation::DisposalMethod disposal_method;
   };
 
+  /// @brief  GPU block-compressed texture data for the base level of an
+  ///         image, suitable for direct upload to contexts that support the
+  ///         compression format.
+  struct CompressedTexture {
+    /// The block-compressed pixel data.
+    sk_sp<SkData> data;
+
+    /// The block compression format of `data`.
+    SkImage::CompressionType type;
+  };
+
   virtual ~ImageGenerator();
 
   /// @brief   Returns basic information about the contents of the encoded
@@ -120,6 +133,16 @@ class ImageGenerator {
       size_t row_bytes,
       unsigned int frame_index = 0,
       std::optional<unsigned int> prior_frame = std::nullopt) const = 0;
+
+  /// @brief   If the encoded image is a container of GPU block-compressed
+  ///          texture data, returns that data so it may be uploaded without
+  ///          being decompressed first. Callers must still be able to fall
+  ///          back to `GetPixels` when the format is unsupported by the
+  ///          resource context, or when no resource context is available.
+  /// @return  The compressed texture data, or an empty value if the image is
+  ///          not a compressed texture. This is the default.
+  /// @see     `CompressedTextureImageGenerator`
+  virtual std::optional<CompressedTexture> GetCompressedTexture() const;
 };
 
 class BuiltinSkiaImageGenerator : public ImageGenerator {
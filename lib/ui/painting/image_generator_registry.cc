@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/compressed_texture_image_generator.h"
 #include "flutter/lib/ui/painting/image_generator_registry.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 #include "third_party/skia/include/core/SkImageGenerator.h"
@@ -24,6 +25,12 @@ ImageGeneratorRegistry::ImageGeneratorRegistry() : weak_factory_(this) {
       },
       0);
 
+  AddFactory(
+      [](sk_sp<SkData> buffer) {
+        return CompressedTextureImageGenerator::MakeFromData(buffer);
+      },
+      0);
+
   // todo(bdero): https://github.com/flutter/flutter/issues/82603
 #ifdef OS_MACOSX
   AddFactory(
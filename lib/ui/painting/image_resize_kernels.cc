@@ -0,0 +1,813 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_resize_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "flutter/fml/trace_event.h"
+
+// The instruction set is picked at compile time from the target flags. AVX2
+// implies SSE4.1, which the per pixel kernels use on both.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RESIZE_KERNELS_AVX2 1
+#endif
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#define RESIZE_KERNELS_SSE41 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESIZE_KERNELS_NEON 1
+#endif
+
+namespace flutter {
+
+namespace {
+
+// Filter weights are fixed point numbers with this many fractional bits. The
+// largest sum of weighted 8-bit values is well within 32 bits.
+constexpr int kWeightBits = 14;
+constexpr int32_t kWeightOne = 1 << kWeightBits;
+constexpr int32_t kWeightRound = 1 << (kWeightBits - 1);
+
+constexpr double kPi = 3.14159265358979323846;
+
+#if defined(RESIZE_KERNELS_SSE41) || defined(RESIZE_KERNELS_NEON)
+uint32_t Load32(const uint8_t* bytes) {
+  uint32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+void Store32(uint8_t* bytes, uint32_t value) {
+  memcpy(bytes, &value, sizeof(value));
+}
+#endif
+
+uint8_t ClampToByte(int32_t value) {
+  return static_cast<uint8_t>(std::clamp(value, 0, 255));
+}
+
+// (value * alpha) / 255, rounded to the nearest integer.
+uint8_t MultiplyAlpha(uint8_t value, uint8_t alpha) {
+  const uint32_t product = value * alpha + 128;
+  return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+}
+
+//------------------------------------------------------------------------------
+// The four channels of a single pixel as 32-bit integers.
+
+#if RESIZE_KERNELS_SSE41
+
+using Pixel = __m128i;
+
+Pixel PixelZero() {
+  return _mm_setzero_si128();
+}
+
+Pixel LoadPixel(const uint8_t* bytes) {
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(Load32(bytes)));
+}
+
+Pixel LoadPixelSums(const uint32_t* sums) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums));
+}
+
+Pixel AddPixels(Pixel a, Pixel b) {
+  return _mm_add_epi32(a, b);
+}
+
+Pixel MultiplyAddPixel(Pixel accumulator, Pixel pixel, int32_t weight) {
+  return _mm_add_epi32(accumulator,
+                       _mm_mullo_epi32(pixel, _mm_set1_epi32(weight)));
+}
+
+void StorePixel(uint8_t* bytes, Pixel pixel) {
+  pixel = _mm_packs_epi32(pixel, pixel);
+  pixel = _mm_packus_epi16(pixel, pixel);
+  Store32(bytes, static_cast<uint32_t>(_mm_cvtsi128_si32(pixel)));
+}
+
+void StoreWeightedPixel(uint8_t* bytes, Pixel accumulator) {
+  const __m128i rounded =
+      _mm_add_epi32(accumulator, _mm_set1_epi32(kWeightRound));
+  StorePixel(bytes, _mm_srai_epi32(rounded, kWeightBits));
+}
+
+void StoreAveragedPixel(uint8_t* bytes, Pixel sum, float scale) {
+  const __m128 average =
+      _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(scale)),
+                 _mm_set1_ps(0.5f));
+  StorePixel(bytes, _mm_cvttps_epi32(average));
+}
+
+#elif RESIZE_KERNELS_NEON
+
+using Pixel = int32x4_t;
+
+Pixel PixelZero() {
+  return vdupq_n_s32(0);
+}
+
+Pixel LoadPixel(const uint8_t* bytes) {
+  const uint8x8_t pixel = vreinterpret_u8_u32(vdup_n_u32(Load32(bytes)));
+  return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(pixel))));
+}
+
+Pixel LoadPixelSums(const uint32_t* sums) {
+  return vreinterpretq_s32_u32(vld1q_u32(sums));
+}
+
+Pixel AddPixels(Pixel a, Pixel b) {
+  return vaddq_s32(a, b);
+}
+
+Pixel MultiplyAddPixel(Pixel accumulator, Pixel pixel, int32_t weight) {
+  return vmlaq_n_s32(accumulator, pixel, weight);
+}
+
+void StoreWeightedPixel(uint8_t* bytes, Pixel accumulator) {
+  const int16x4_t narrow = vqrshrn_n_s32(accumulator, kWeightBits);
+  const uint8x8_t pixel = vqmovun_s16(vcombine_s16(narrow, narrow));
+  Store32(bytes, vget_lane_u32(vreinterpret_u32_u8(pixel), 0));
+}
+
+void StoreAveragedPixel(uint8_t* bytes, Pixel sum, float scale) {
+  const float32x4_t average =
+      vaddq_f32(vmulq_n_f32(vcvtq_f32_u32(vreinterpretq_u32_s32(sum)), scale),
+                vdupq_n_f32(0.5f));
+  const uint16x4_t narrow = vqmovn_u32(vcvtq_u32_f32(average));
+  const uint8x8_t pixel = vqmovn_u16(vcombine_u16(narrow, narrow));
+  Store32(bytes, vget_lane_u32(vreinterpret_u32_u8(pixel), 0));
+}
+
+#else  // Scalar
+
+struct Pixel {
+  int32_t channels[4];
+};
+
+Pixel PixelZero() {
+  return {};
+}
+
+Pixel LoadPixel(const uint8_t* bytes) {
+  return {{bytes[0], bytes[1], bytes[2], bytes[3]}};
+}
+
+Pixel LoadPixelSums(const uint32_t* sums) {
+  return {{static_cast<int32_t>(sums[0]), static_cast<int32_t>(sums[1]),
+           static_cast<int32_t>(sums[2]), static_cast<int32_t>(sums[3])}};
+}
+
+Pixel AddPixels(Pixel a, Pixel b) {
+  for (int i = 0; i < 4; i++) {
+    a.channels[i] += b.channels[i];
+  }
+  return a;
+}
+
+Pixel MultiplyAddPixel(Pixel accumulator, Pixel pixel, int32_t weight) {
+  for (int i = 0; i < 4; i++) {
+    accumulator.channels[i] += pixel.channels[i] * weight;
+  }
+  return accumulator;
+}
+
+void StoreWeightedPixel(uint8_t* bytes, Pixel accumulator) {
+  for (int i = 0; i < 4; i++) {
+    bytes[i] =
+        ClampToByte((accumulator.channels[i] + kWeightRound) >> kWeightBits);
+  }
+}
+
+void StoreAveragedPixel(uint8_t* bytes, Pixel sum, float scale) {
+  for (int i = 0; i < 4; i++) {
+    bytes[i] = ClampToByte(
+        static_cast<int32_t>(sum.channels[i] * scale + 0.5f));
+  }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+// Separable filters.
+
+double EvaluateMitchell(double x) {
+  constexpr double B = 1.0 / 3.0;
+  constexpr double C = 1.0 / 3.0;
+  x = std::fabs(x);
+  if (x < 1.0) {
+    return ((12 - 9 * B - 6 * C) * x * x * x + (-18 + 12 * B + 6 * C) * x * x +
+            (6 - 2 * B)) /
+           6.0;
+  }
+  if (x < 2.0) {
+    return ((-B - 6 * C) * x * x * x + (6 * B + 30 * C) * x * x +
+            (-12 * B - 48 * C) * x + (8 * B + 24 * C)) /
+           6.0;
+  }
+  return 0.0;
+}
+
+double Sinc(double x) {
+  if (x == 0.0) {
+    return 1.0;
+  }
+  x *= kPi;
+  return std::sin(x) / x;
+}
+
+double EvaluateLanczos3(double x) {
+  if (std::fabs(x) >= 3.0) {
+    return 0.0;
+  }
+  return Sinc(x) * Sinc(x / 3.0);
+}
+
+double FilterSupport(ResizeFilter filter) {
+  switch (filter) {
+    case ResizeFilter::kBox:
+      return 0.5;
+    case ResizeFilter::kMitchell:
+      return 2.0;
+    case ResizeFilter::kLanczos3:
+      return 3.0;
+  }
+  return 0.0;
+}
+
+double EvaluateFilter(ResizeFilter filter, double x) {
+  switch (filter) {
+    case ResizeFilter::kBox:
+      return std::fabs(x) <= 0.5 ? 1.0 : 0.0;
+    case ResizeFilter::kMitchell:
+      return EvaluateMitchell(x);
+    case ResizeFilter::kLanczos3:
+      return EvaluateLanczos3(x);
+  }
+  return 0.0;
+}
+
+// The source pixels and their weights that contribute to each pixel along one
+// axis of the destination.
+struct FilterTable {
+  size_t max_taps = 0;
+  std::vector<int> first;
+  std::vector<int> count;
+  // `max_taps` weights per destination pixel.
+  std::vector<int32_t> weights;
+
+  const int32_t* WeightsFor(int index) const {
+    return weights.data() + index * max_taps;
+  }
+};
+
+FilterTable BuildFilterTable(int src_size, int dst_size, ResizeFilter filter) {
+  const double scale = static_cast<double>(dst_size) / src_size;
+  // When downscaling, the filter is stretched to cover all the source pixels
+  // that fall under a destination pixel.
+  const double support = FilterSupport(filter) / scale;
+
+  FilterTable table;
+  table.max_taps = static_cast<size_t>(std::ceil(support * 2)) + 1;
+  table.first.resize(dst_size);
+  table.count.resize(dst_size);
+  table.weights.resize(dst_size * table.max_taps);
+
+  std::vector<double> weights(table.max_taps);
+  for (int i = 0; i < dst_size; i++) {
+    const double center = (i + 0.5) / scale;
+    const int first = std::max(0, static_cast<int>(center - support));
+    const int last = std::min(src_size - 1,
+                              static_cast<int>(std::ceil(center + support)));
+
+    int count = 0;
+    int first_nonzero = -1;
+    double sum = 0.0;
+    for (int j = first; j <= last; j++) {
+      const double weight = EvaluateFilter(filter, (j + 0.5 - center) * scale);
+      if (count == 0) {
+        // Leading zero weights don't contribute.
+        if (weight == 0.0) {
+          continue;
+        }
+        first_nonzero = j;
+      }
+      if (count == static_cast<int>(table.max_taps)) {
+        break;
+      }
+      weights[count++] = weight;
+      sum += weight;
+    }
+    // Neither do trailing ones.
+    while (count > 1 && weights[count - 1] == 0.0) {
+      count--;
+    }
+    if (count == 0 || sum == 0.0) {
+      // Can only happen for degenerate sizes. Sample the nearest pixel.
+      first_nonzero = std::clamp(static_cast<int>(center), 0, src_size - 1);
+      weights[0] = 1.0;
+      count = 1;
+      sum = 1.0;
+    }
+
+    // Normalize the weights so that they sum up to exactly one in fixed
+    // point. The rounding error goes to the largest weight.
+    int32_t* fixed = table.weights.data() + i * table.max_taps;
+    int32_t fixed_sum = 0;
+    int largest = 0;
+    for (int k = 0; k < count; k++) {
+      fixed[k] = static_cast<int32_t>(std::lround(weights[k] / sum *
+                                                  kWeightOne));
+      fixed_sum += fixed[k];
+      if (fixed[k] > fixed[largest]) {
+        largest = k;
+      }
+    }
+    fixed[largest] += kWeightOne - fixed_sum;
+
+    table.first[i] = first_nonzero;
+    table.count[i] = count;
+  }
+  return table;
+}
+
+//------------------------------------------------------------------------------
+// Row kernels.
+
+// Filters one row of pixels horizontally.
+void FilterRowHorizontally(const uint8_t* src,
+                           uint8_t* dst,
+                           const FilterTable& table) {
+  const int dst_width = table.first.size();
+  for (int x = 0; x < dst_width; x++) {
+    const uint8_t* taps = src + table.first[x] * 4;
+    const int32_t* weights = table.WeightsFor(x);
+    const int count = table.count[x];
+    int t = 0;
+#if RESIZE_KERNELS_AVX2
+    // Two adjacent source pixels per iteration.
+    __m256i wide = _mm256_setzero_si256();
+    for (; t + 1 < count; t += 2) {
+      const __m256i pixels = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(taps + t * 4)));
+      const __m256i pair_weights =
+          _mm256_setr_epi32(weights[t], weights[t], weights[t], weights[t],
+                            weights[t + 1], weights[t + 1], weights[t + 1],
+                            weights[t + 1]);
+      wide = _mm256_add_epi32(wide, _mm256_mullo_epi32(pixels, pair_weights));
+    }
+    Pixel accumulator = _mm_add_epi32(_mm256_castsi256_si128(wide),
+                                      _mm256_extracti128_si256(wide, 1));
+#else
+    Pixel accumulator = PixelZero();
+#endif
+    for (; t < count; t++) {
+      accumulator =
+          MultiplyAddPixel(accumulator, LoadPixel(taps + t * 4), weights[t]);
+    }
+    StoreWeightedPixel(dst + x * 4, accumulator);
+  }
+}
+
+// Filters the given rows vertically into a single row of `byte_count` bytes.
+void FilterRowsVertically(const uint8_t* const* rows,
+                          const int32_t* weights,
+                          int count,
+                          uint8_t* dst,
+                          size_t byte_count) {
+  size_t i = 0;
+#if RESIZE_KERNELS_AVX2
+  for (; i + 16 <= byte_count; i += 16) {
+    __m256i low = _mm256_setzero_si256();
+    __m256i high = _mm256_setzero_si256();
+    for (int t = 0; t < count; t++) {
+      const __m256i weight = _mm256_set1_epi32(weights[t]);
+      const __m128i bytes =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+      low = _mm256_add_epi32(
+          low, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(bytes), weight));
+      high = _mm256_add_epi32(
+          high, _mm256_mullo_epi32(
+                    _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), weight));
+    }
+    const __m256i round = _mm256_set1_epi32(kWeightRound);
+    low = _mm256_srai_epi32(_mm256_add_epi32(low, round), kWeightBits);
+    high = _mm256_srai_epi32(_mm256_add_epi32(high, round), kWeightBits);
+    // Packing works within 128-bit lanes, so the 64-bit quarters have to be
+    // put back in order.
+    const __m256i packed =
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(_mm256_castsi256_si128(packed),
+                                      _mm256_extracti128_si256(packed, 1)));
+  }
+#elif RESIZE_KERNELS_SSE41
+  for (; i + 16 <= byte_count; i += 16) {
+    __m128i accumulators[4] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                               _mm_setzero_si128(), _mm_setzero_si128()};
+    for (int t = 0; t < count; t++) {
+      const __m128i weight = _mm_set1_epi32(weights[t]);
+      const __m128i bytes =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+      accumulators[0] = _mm_add_epi32(
+          accumulators[0], _mm_mullo_epi32(_mm_cvtepu8_epi32(bytes), weight));
+      accumulators[1] = _mm_add_epi32(
+          accumulators[1],
+          _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)), weight));
+      accumulators[2] = _mm_add_epi32(
+          accumulators[2],
+          _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), weight));
+      accumulators[3] = _mm_add_epi32(
+          accumulators[3],
+          _mm_mullo_epi32(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)),
+                          weight));
+    }
+    const __m128i round = _mm_set1_epi32(kWeightRound);
+    for (auto& accumulator : accumulators) {
+      accumulator =
+          _mm_srai_epi32(_mm_add_epi32(accumulator, round), kWeightBits);
+    }
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm_packus_epi16(_mm_packs_epi32(accumulators[0], accumulators[1]),
+                         _mm_packs_epi32(accumulators[2], accumulators[3])));
+  }
+#elif RESIZE_KERNELS_NEON
+  for (; i + 16 <= byte_count; i += 16) {
+    int32x4_t accumulators[4] = {vdupq_n_s32(0), vdupq_n_s32(0),
+                                 vdupq_n_s32(0), vdupq_n_s32(0)};
+    for (int t = 0; t < count; t++) {
+      const uint8x16_t bytes = vld1q_u8(rows[t] + i);
+      const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+      const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+      accumulators[0] = vmlaq_n_s32(
+          accumulators[0],
+          vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))), weights[t]);
+      accumulators[1] = vmlaq_n_s32(
+          accumulators[1],
+          vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))), weights[t]);
+      accumulators[2] = vmlaq_n_s32(
+          accumulators[2],
+          vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(high))), weights[t]);
+      accumulators[3] = vmlaq_n_s32(
+          accumulators[3],
+          vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(high))), weights[t]);
+    }
+    const uint8x8_t low = vqmovun_s16(
+        vcombine_s16(vqrshrn_n_s32(accumulators[0], kWeightBits),
+                     vqrshrn_n_s32(accumulators[1], kWeightBits)));
+    const uint8x8_t high = vqmovun_s16(
+        vcombine_s16(vqrshrn_n_s32(accumulators[2], kWeightBits),
+                     vqrshrn_n_s32(accumulators[3], kWeightBits)));
+    vst1q_u8(dst + i, vcombine_u8(low, high));
+  }
+#endif
+  for (; i < byte_count; i++) {
+    int32_t accumulator = 0;
+    for (int t = 0; t < count; t++) {
+      accumulator += rows[t][i] * weights[t];
+    }
+    dst[i] = ClampToByte((accumulator + kWeightRound) >> kWeightBits);
+  }
+}
+
+// Adds a row of bytes to a row of 32-bit sums.
+void AccumulateRow(const uint8_t* src, uint32_t* sums, size_t byte_count) {
+  size_t i = 0;
+#if RESIZE_KERNELS_AVX2
+  for (; i + 16 <= byte_count; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    auto* low = reinterpret_cast<__m256i*>(sums + i);
+    auto* high = reinterpret_cast<__m256i*>(sums + i + 8);
+    _mm256_storeu_si256(low, _mm256_add_epi32(_mm256_loadu_si256(low),
+                                              _mm256_cvtepu8_epi32(bytes)));
+    _mm256_storeu_si256(
+        high, _mm256_add_epi32(_mm256_loadu_si256(high),
+                               _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8))));
+  }
+#elif RESIZE_KERNELS_SSE41
+  for (; i + 16 <= byte_count; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    for (int quarter = 0; quarter < 4; quarter++) {
+      auto* sum = reinterpret_cast<__m128i*>(sums + i + quarter * 4);
+      _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum),
+                                          _mm_cvtepu8_epi32(bytes)));
+      bytes = _mm_srli_si128(bytes, 4);
+    }
+  }
+#elif RESIZE_KERNELS_NEON
+  for (; i + 16 <= byte_count; i += 16) {
+    const uint8x16_t bytes = vld1q_u8(src + i);
+    const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+    const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+    uint32_t* sum = sums + i;
+    vst1q_u32(sum, vaddw_u16(vld1q_u32(sum), vget_low_u16(low)));
+    vst1q_u32(sum + 4, vaddw_u16(vld1q_u32(sum + 4), vget_high_u16(low)));
+    vst1q_u32(sum + 8, vaddw_u16(vld1q_u32(sum + 8), vget_low_u16(high)));
+    vst1q_u32(sum + 12, vaddw_u16(vld1q_u32(sum + 12), vget_high_u16(high)));
+  }
+#endif
+  for (; i < byte_count; i++) {
+    sums[i] += src[i];
+  }
+}
+
+// Premultiplies and/or swaps the red and blue channels of `count` pixels.
+void ConvertRow(const uint8_t* src,
+                uint8_t* dst,
+                int count,
+                bool swap_red_blue,
+                bool premultiply) {
+  int i = 0;
+#if RESIZE_KERNELS_SSE41
+  const __m128i swap_mask =
+      _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  // Broadcasts the alpha of each pixel to its 16-bit color channels.
+  const __m128i alpha_mask =
+      _mm_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+  // Alpha itself is multiplied by 255, which leaves it unchanged.
+  const __m128i alpha_one = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+#endif
+#if RESIZE_KERNELS_AVX2
+  const __m256i swap_mask_wide = _mm256_broadcastsi128_si256(swap_mask);
+  const __m256i alpha_mask_wide = _mm256_broadcastsi128_si256(alpha_mask);
+  const __m256i alpha_one_wide = _mm256_broadcastsi128_si256(alpha_one);
+  for (; i + 8 <= count; i += 8) {
+    __m256i pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    if (swap_red_blue) {
+      pixels = _mm256_shuffle_epi8(pixels, swap_mask_wide);
+    }
+    if (premultiply) {
+      const __m256i zero = _mm256_setzero_si256();
+      __m256i halves[2] = {_mm256_unpacklo_epi8(pixels, zero),
+                           _mm256_unpackhi_epi8(pixels, zero)};
+      for (auto& half : halves) {
+        const __m256i alpha = _mm256_or_si256(
+            _mm256_shuffle_epi8(half, alpha_mask_wide), alpha_one_wide);
+        __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(half, alpha),
+                                           _mm256_set1_epi16(128));
+        half = _mm256_srli_epi16(
+            _mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+      }
+      // Unpacking and packing both work within 128-bit lanes, so the pixel
+      // order is preserved.
+      pixels = _mm256_packus_epi16(halves[0], halves[1]);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), pixels);
+  }
+#endif
+#if RESIZE_KERNELS_SSE41
+  for (; i + 4 <= count; i += 4) {
+    __m128i pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    if (swap_red_blue) {
+      pixels = _mm_shuffle_epi8(pixels, swap_mask);
+    }
+    if (premultiply) {
+      const __m128i zero = _mm_setzero_si128();
+      __m128i halves[2] = {_mm_unpacklo_epi8(pixels, zero),
+                           _mm_unpackhi_epi8(pixels, zero)};
+      for (auto& half : halves) {
+        const __m128i alpha =
+            _mm_or_si128(_mm_shuffle_epi8(half, alpha_mask), alpha_one);
+        __m128i product =
+            _mm_add_epi16(_mm_mullo_epi16(half, alpha), _mm_set1_epi16(128));
+        half = _mm_srli_epi16(
+            _mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+      }
+      pixels = _mm_packus_epi16(halves[0], halves[1]);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), pixels);
+  }
+#elif RESIZE_KERNELS_NEON
+  for (; i + 16 <= count; i += 16) {
+    uint8x16x4_t pixels = vld4q_u8(src + i * 4);
+    if (premultiply) {
+      const uint8x16_t alpha = pixels.val[3];
+      for (int channel = 0; channel < 3; channel++) {
+        const uint16x8_t low =
+            vmull_u8(vget_low_u8(pixels.val[channel]), vget_low_u8(alpha));
+        const uint16x8_t high =
+            vmull_u8(vget_high_u8(pixels.val[channel]), vget_high_u8(alpha));
+        pixels.val[channel] =
+            vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)),
+                        vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+      }
+    }
+    if (swap_red_blue) {
+      std::swap(pixels.val[0], pixels.val[2]);
+    }
+    vst4q_u8(dst + i * 4, pixels);
+  }
+#endif
+  for (; i < count; i++) {
+    const uint8_t* in = src + i * 4;
+    uint8_t* out = dst + i * 4;
+    uint8_t red = in[0], green = in[1], blue = in[2];
+    const uint8_t alpha = in[3];
+    if (premultiply) {
+      red = MultiplyAlpha(red, alpha);
+      green = MultiplyAlpha(green, alpha);
+      blue = MultiplyAlpha(blue, alpha);
+    }
+    if (swap_red_blue) {
+      std::swap(red, blue);
+    }
+    out[0] = red;
+    out[1] = green;
+    out[2] = blue;
+    out[3] = alpha;
+  }
+}
+
+// Filters with negative lobes can produce color values larger than the alpha
+// of a premultiplied pixel.
+void ClampColorsToAlpha(uint8_t* row, int count) {
+  for (int i = 0; i < count; i++) {
+    uint8_t* pixel = row + i * 4;
+    pixel[0] = std::min(pixel[0], pixel[3]);
+    pixel[1] = std::min(pixel[1], pixel[3]);
+    pixel[2] = std::min(pixel[2], pixel[3]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Whole image kernels. All pixmaps are 4 bytes per pixel.
+
+const uint8_t* RowAt(const SkPixmap& pixmap, int y) {
+  return static_cast<const uint8_t*>(pixmap.addr()) + y * pixmap.rowBytes();
+}
+
+uint8_t* WritableRowAt(const SkPixmap& pixmap, int y) {
+  return static_cast<uint8_t*>(pixmap.writable_addr()) + y * pixmap.rowBytes();
+}
+
+void BoxDownscale(const SkPixmap& src, const SkPixmap& dst) {
+  const int factor_x = src.width() / dst.width();
+  const int factor_y = src.height() / dst.height();
+  const float scale = 1.0f / (factor_x * factor_y);
+  const size_t src_row_bytes = src.width() * 4;
+
+  std::vector<uint32_t> sums(src_row_bytes);
+  for (int y = 0; y < dst.height(); y++) {
+    std::fill(sums.begin(), sums.end(), 0);
+    for (int k = 0; k < factor_y; k++) {
+      AccumulateRow(RowAt(src, y * factor_y + k), sums.data(), src_row_bytes);
+    }
+    uint8_t* dst_row = WritableRowAt(dst, y);
+    for (int x = 0; x < dst.width(); x++) {
+      Pixel sum = PixelZero();
+      for (int k = 0; k < factor_x; k++) {
+        sum = AddPixels(sum, LoadPixelSums(&sums[(x * factor_x + k) * 4]));
+      }
+      StoreAveragedPixel(dst_row + x * 4, sum, scale);
+    }
+  }
+}
+
+void SeparableDownscale(const SkPixmap& src,
+                        const SkPixmap& dst,
+                        ResizeFilter filter) {
+  const FilterTable horizontal =
+      BuildFilterTable(src.width(), dst.width(), filter);
+  const FilterTable vertical =
+      BuildFilterTable(src.height(), dst.height(), filter);
+
+  // Only the source rows that contribute to some destination row are filtered
+  // horizontally.
+  const size_t intermediate_row_bytes = dst.width() * 4;
+  std::vector<uint8_t> intermediate(intermediate_row_bytes * src.height());
+  std::vector<bool> filtered(src.height(), false);
+
+  std::vector<const uint8_t*> rows(vertical.max_taps);
+  for (int y = 0; y < dst.height(); y++) {
+    const int first = vertical.first[y];
+    const int count = vertical.count[y];
+    for (int t = 0; t < count; t++) {
+      const int row = first + t;
+      uint8_t* intermediate_row =
+          intermediate.data() + row * intermediate_row_bytes;
+      if (!filtered[row]) {
+        FilterRowHorizontally(RowAt(src, row), intermediate_row, horizontal);
+        filtered[row] = true;
+      }
+      rows[t] = intermediate_row;
+    }
+    uint8_t* dst_row = WritableRowAt(dst, y);
+    FilterRowsVertically(rows.data(), vertical.WeightsFor(y), count, dst_row,
+                         intermediate_row_bytes);
+    if (dst.alphaType() != kOpaque_SkAlphaType) {
+      ClampColorsToAlpha(dst_row, dst.width());
+    }
+  }
+}
+
+bool IsFourByteColorType(SkColorType color_type) {
+  return color_type == kRGBA_8888_SkColorType ||
+         color_type == kBGRA_8888_SkColorType;
+}
+
+}  // namespace
+
+ResizeFilter ChooseResizeFilter(const SkISize& source, const SkISize& target) {
+  if (!target.isEmpty() && source.width() % target.width() == 0 &&
+      source.height() % target.height() == 0) {
+    return ResizeFilter::kBox;
+  }
+  return ResizeFilter::kMitchell;
+}
+
+bool DownscalePixels(const SkPixmap& src,
+                     const SkPixmap& dst,
+                     ResizeFilter filter) {
+  TRACE_EVENT0("flutter", "DownscalePixels");
+  if (src.dimensions().isEmpty() || dst.dimensions().isEmpty() ||
+      dst.width() > src.width() || dst.height() > src.height() ||
+      !src.addr() || !dst.writable_addr()) {
+    return false;
+  }
+  if (!IsFourByteColorType(src.colorType()) ||
+      src.colorType() != dst.colorType() ||
+      !SkColorSpace::Equals(src.colorSpace(), dst.colorSpace())) {
+    return false;
+  }
+  if (dst.alphaType() == kUnpremul_SkAlphaType ||
+      dst.alphaType() == kUnknown_SkAlphaType ||
+      src.alphaType() == kUnknown_SkAlphaType) {
+    return false;
+  }
+  if (dst.alphaType() == kOpaque_SkAlphaType &&
+      src.alphaType() != kOpaque_SkAlphaType) {
+    return false;
+  }
+  if (filter == ResizeFilter::kBox &&
+      ChooseResizeFilter(src.dimensions(), dst.dimensions()) !=
+          ResizeFilter::kBox) {
+    return false;
+  }
+
+  // Filtering is only correct on premultiplied colors.
+  SkPixmap source = src;
+  std::vector<uint8_t> premultiplied;
+  if (src.alphaType() == kUnpremul_SkAlphaType) {
+    const size_t row_bytes = src.width() * 4;
+    premultiplied.resize(row_bytes * src.height());
+    for (int y = 0; y < src.height(); y++) {
+      ConvertRow(RowAt(src, y), premultiplied.data() + y * row_bytes,
+                 src.width(), false, true);
+    }
+    source = SkPixmap(src.info().makeAlphaType(kPremul_SkAlphaType),
+                      premultiplied.data(), row_bytes);
+  }
+
+  if (filter == ResizeFilter::kBox) {
+    BoxDownscale(source, dst);
+  } else {
+    SeparableDownscale(source, dst, filter);
+  }
+  return true;
+}
+
+bool ConvertPixels(const SkPixmap& src, const SkPixmap& dst) {
+  if (src.dimensions() != dst.dimensions() || !src.addr() ||
+      !dst.writable_addr()) {
+    return false;
+  }
+  if (!IsFourByteColorType(src.colorType()) ||
+      !IsFourByteColorType(dst.colorType()) ||
+      src.alphaType() == kUnknown_SkAlphaType ||
+      !SkColorSpace::Equals(src.colorSpace(), dst.colorSpace())) {
+    return false;
+  }
+
+  bool premultiply = false;
+  if (src.alphaType() != dst.alphaType()) {
+    if (src.alphaType() == kUnpremul_SkAlphaType &&
+        dst.alphaType() == kPremul_SkAlphaType) {
+      premultiply = true;
+    } else if (!(src.alphaType() == kOpaque_SkAlphaType &&
+                 dst.alphaType() != kUnknown_SkAlphaType)) {
+      return false;
+    }
+  }
+  const bool swap_red_blue = src.colorType() != dst.colorType();
+
+  for (int y = 0; y < src.height(); y++) {
+    ConvertRow(RowAt(src, y), WritableRowAt(dst, y), src.width(),
+               swap_red_blue, premultiply);
+  }
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,60 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_RESIZE_KERNELS_H_
+#define FLUTTER_LIB_UI_PAINTING_IMAGE_RESIZE_KERNELS_H_
+
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSize.h"
+
+namespace flutter {
+
+/// The filters available to `DownscalePixels`.
+enum class ResizeFilter {
+  /// Averages each block of source pixels. Only valid when the source
+  /// dimensions are integer multiples of the destination dimensions.
+  kBox,
+  /// The Mitchell-Netravali cubic with B = C = 1/3.
+  kMitchell,
+  /// The three lobed Lanczos windowed sinc.
+  kLanczos3,
+};
+
+//------------------------------------------------------------------------------
+/// @brief      Picks the filter to downscale between the given dimensions. A
+///             box filter is used for integer factors and the Mitchell cubic
+///             for everything else.
+///
+ResizeFilter ChooseResizeFilter(const SkISize& source, const SkISize& target);
+
+//------------------------------------------------------------------------------
+/// @brief      Downscales 8-bit RGBA or BGRA pixels using kernels vectorized
+///             for the target CPU.
+///
+///             The destination may not be larger than the source in either
+///             dimension, must have the same color type and color space as
+///             the source, and must be premultiplied or opaque. Unpremultiplied
+///             sources are premultiplied before they are filtered.
+///
+/// @return     Whether the pixels were resized. If not, the destination is
+///             untouched and the caller should fall back to
+///             `SkPixmap::scalePixels`.
+///
+bool DownscalePixels(const SkPixmap& src,
+                     const SkPixmap& dst,
+                     ResizeFilter filter);
+
+//------------------------------------------------------------------------------
+/// @brief      Copies pixels between 8-bit RGBA and BGRA pixmaps of the same
+///             dimensions and color space, premultiplying them if the source
+///             is unpremultiplied and the destination is not.
+///
+/// @return     Whether the pixels were converted. If not, the caller should
+///             fall back to `SkPixmap::readPixels`.
+///
+bool ConvertPixels(const SkPixmap& src, const SkPixmap& dst);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_RESIZE_KERNELS_H_
@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/image_resize_kernels.h"
+
+#include <cstdlib>
+
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+static SkBitmap MakeBitmap(int width,
+                           int height,
+                           SkColorType color_type,
+                           SkAlphaType alpha_type) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(
+      SkImageInfo::Make(width, height, color_type, alpha_type, nullptr));
+  return bitmap;
+}
+
+// Fills the bitmap with premultiplied noise that is the same on every run.
+static void FillWithNoise(SkBitmap& bitmap) {
+  uint32_t state = 0x12345678;
+  for (int y = 0; y < bitmap.height(); y++) {
+    auto* row = static_cast<uint8_t*>(bitmap.getAddr(0, y));
+    for (int x = 0; x < bitmap.width(); x++) {
+      state = state * 1664525 + 1013904223;
+      const uint8_t alpha = x % 5 == 0 ? 255 : state >> 24;
+      for (int c = 0; c < 3; c++) {
+        state = state * 1664525 + 1013904223;
+        row[x * 4 + c] = (state >> 24) % (alpha + 1);
+      }
+      row[x * 4 + 3] = alpha;
+    }
+  }
+}
+
+TEST(ImageResizeKernelsTest, ChoosesBoxFilterForIntegerFactors) {
+  EXPECT_EQ(ChooseResizeFilter({400, 300}, {200, 100}), ResizeFilter::kBox);
+  EXPECT_EQ(ChooseResizeFilter({400, 300}, {400, 300}), ResizeFilter::kBox);
+  EXPECT_EQ(ChooseResizeFilter({400, 300}, {300, 100}),
+            ResizeFilter::kMitchell);
+}
+
+TEST(ImageResizeKernelsTest, BoxDownscaleAveragesBlocks) {
+  SkBitmap src = MakeBitmap(120, 90, kRGBA_8888_SkColorType,
+                            kPremul_SkAlphaType);
+  FillWithNoise(src);
+  SkBitmap dst = MakeBitmap(30, 45, kRGBA_8888_SkColorType,
+                            kPremul_SkAlphaType);
+
+  ASSERT_TRUE(DownscalePixels(src.pixmap(), dst.pixmap(), ResizeFilter::kBox));
+
+  for (int y = 0; y < dst.height(); y++) {
+    for (int x = 0; x < dst.width(); x++) {
+      const auto* pixel = static_cast<const uint8_t*>(dst.getAddr(x, y));
+      for (int c = 0; c < 4; c++) {
+        int sum = 0;
+        for (int j = 0; j < 2; j++) {
+          for (int i = 0; i < 4; i++) {
+            sum += static_cast<const uint8_t*>(
+                src.getAddr(x * 4 + i, y * 2 + j))[c];
+          }
+        }
+        EXPECT_NEAR(pixel[c], sum / 8.0, 0.5);
+      }
+    }
+  }
+}
+
+TEST(ImageResizeKernelsTest, SeparableFiltersPreserveSolidColors) {
+  SkBitmap src = MakeBitmap(203, 157, kBGRA_8888_SkColorType,
+                            kOpaque_SkAlphaType);
+  src.eraseARGB(255, 200, 100, 10);
+
+  for (auto filter : {ResizeFilter::kMitchell, ResizeFilter::kLanczos3}) {
+    SkBitmap dst = MakeBitmap(100, 77, kBGRA_8888_SkColorType,
+                              kOpaque_SkAlphaType);
+    ASSERT_TRUE(DownscalePixels(src.pixmap(), dst.pixmap(), filter));
+    for (int y = 0; y < dst.height(); y++) {
+      for (int x = 0; x < dst.width(); x++) {
+        ASSERT_EQ(dst.getColor(x, y), SkColorSetARGB(255, 200, 100, 10));
+      }
+    }
+  }
+}
+
+TEST(ImageResizeKernelsTest, SeparableFiltersKeepColorsWithinAlpha) {
+  SkBitmap src = MakeBitmap(203, 157, kRGBA_8888_SkColorType,
+                            kPremul_SkAlphaType);
+  FillWithNoise(src);
+  SkBitmap dst = MakeBitmap(57, 150, kRGBA_8888_SkColorType,
+                            kPremul_SkAlphaType);
+
+  ASSERT_TRUE(
+      DownscalePixels(src.pixmap(), dst.pixmap(), ResizeFilter::kLanczos3));
+
+  for (int y = 0; y < dst.height(); y++) {
+    for (int x = 0; x < dst.width(); x++) {
+      const auto* pixel = static_cast<const uint8_t*>(dst.getAddr(x, y));
+      ASSERT_LE(pixel[0], pixel[3]);
+      ASSERT_LE(pixel[1], pixel[3]);
+      ASSERT_LE(pixel[2], pixel[3]);
+    }
+  }
+}
+
+TEST(ImageResizeKernelsTest, RejectsUnsupportedPixmaps) {
+  SkBitmap src = MakeBitmap(64, 64, kRGBA_8888_SkColorType,
+                            kPremul_SkAlphaType);
+  SkBitmap larger = MakeBitmap(128, 32, kRGBA_8888_SkColorType,
+                               kPremul_SkAlphaType);
+  SkBitmap swizzled = MakeBitmap(32, 32, kBGRA_8888_SkColorType,
+                                 kPremul_SkAlphaType);
+  SkBitmap unpremul = MakeBitmap(32, 32, kRGBA_8888_SkColorType,
+                                 kUnpremul_SkAlphaType);
+  SkBitmap f16 = MakeBitmap(64, 64, kRGBA_F16_SkColorType,
+                            kPremul_SkAlphaType);
+  SkBitmap not_a_factor = MakeBitmap(48, 32, kRGBA_8888_SkColorType,
+                                     kPremul_SkAlphaType);
+
+  EXPECT_FALSE(DownscalePixels(src.pixmap(), larger.pixmap(),
+                               ResizeFilter::kMitchell));
+  EXPECT_FALSE(DownscalePixels(src.pixmap(), swizzled.pixmap(),
+                               ResizeFilter::kMitchell));
+  EXPECT_FALSE(DownscalePixels(src.pixmap(), unpremul.pixmap(),
+                               ResizeFilter::kMitchell));
+  EXPECT_FALSE(
+      DownscalePixels(src.pixmap(), not_a_factor.pixmap(), ResizeFilter::kBox));
+  EXPECT_FALSE(ConvertPixels(src.pixmap(), f16.pixmap()));
+  EXPECT_FALSE(ConvertPixels(src.pixmap(), larger.pixmap()));
+}
+
+TEST(ImageResizeKernelsTest, ConvertPixelsMatchesSkia) {
+  SkBitmap src = MakeBitmap(67, 31, kRGBA_8888_SkColorType,
+                            kUnpremul_SkAlphaType);
+  FillWithNoise(src);
+
+  for (auto color_type : {kRGBA_8888_SkColorType, kBGRA_8888_SkColorType}) {
+    for (auto alpha_type : {kPremul_SkAlphaType, kUnpremul_SkAlphaType}) {
+      SkBitmap expected = MakeBitmap(67, 31, color_type, alpha_type);
+      SkBitmap actual = MakeBitmap(67, 31, color_type, alpha_type);
+      ASSERT_TRUE(src.pixmap().readPixels(expected.pixmap()));
+      ASSERT_TRUE(ConvertPixels(src.pixmap(), actual.pixmap()));
+
+      for (int y = 0; y < src.height(); y++) {
+        const auto* expected_row =
+            static_cast<const uint8_t*>(expected.getAddr(0, y));
+        const auto* actual_row =
+            static_cast<const uint8_t*>(actual.getAddr(0, y));
+        for (int i = 0; i < src.width() * 4; i++) {
+          ASSERT_LE(std::abs(expected_row[i] - actual_row[i]), 1);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -6,6 +6,7 @@
 
 #include "flutter/fml/make_copyable.h"
 #include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/painting/image_resize_kernels.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/logging/dart_invoke.h"
@@ -67,7 +68,7 @@ static bool CopyToBitmap(SkBitmap* dst,
     return false;
   }
 
-  if (!srcPM.readPixels(dstPM)) {
+  if (!ConvertPixels(srcPM, dstPM) && !srcPM.readPixels(dstPM)) {
     return false;
   }
 
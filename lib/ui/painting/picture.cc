@@ -8,6 +8,7 @@
 
 #include "flutter/fml/make_copyable.h"
 #include "flutter/lib/ui/painting/canvas.h"
+#include "flutter/lib/ui/painting/picture_snapshot_queue.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/tonic/converter/dart_converter.h"
@@ -81,9 +82,6 @@ Dart_Handle Picture::RasterizeToImage(sk_sp<SkPicture> picture,
   auto image_callback = std::make_unique<tonic::DartPersistentValue>(
       dart_state, raw_image_callback);
   auto unref_queue = dart_state->GetSkiaUnrefQueue();
-  auto ui_task_runner = dart_state->GetTaskRunners().GetUITaskRunner();
-  auto raster_task_runner = dart_state->GetTaskRunners().GetRasterTaskRunner();
-  auto snapshot_delegate = dart_state->GetSnapshotDelegate();
 
   // We can't create an image on this task runner because we don't have a
   // graphics context. Even if we did, it would be slow anyway. Also, this
@@ -119,17 +117,10 @@ Dart_Handle Picture::RasterizeToImage(sk_sp<SkPicture> picture,
     image_callback.reset();
   });
 
-  // Kick things off on the raster rask runner.
-  fml::TaskRunner::RunNowOrPostTask(
-      raster_task_runner,
-      [ui_task_runner, snapshot_delegate, picture, picture_bounds, ui_task] {
-        sk_sp<SkImage> raster_image =
-            snapshot_delegate->MakeRasterSnapshot(picture, picture_bounds);
-
-        fml::TaskRunner::RunNowOrPostTask(
-            ui_task_runner,
-            [ui_task, raster_image]() { ui_task(raster_image); });
-      });
+  // Snapshots requested in the same frame share a single raster task, or are
+  // rasterized on the worker pool when rendering in software.
+  dart_state->GetPictureSnapshotQueue()->MakeRasterSnapshot(
+      std::move(picture), picture_bounds, std::move(ui_task));
 
   return Dart_Null();
 }
@@ -0,0 +1,172 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/picture_snapshot_queue.h"
+
+#include <string>
+#include <utility>
+
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+namespace {
+
+SkImageInfo SnapshotImageInfo(SkISize picture_size) {
+  return SkImageInfo::MakeN32Premul(picture_size.width(),
+                                    picture_size.height(),
+                                    SkColorSpace::MakeSRGB());
+}
+
+// Matches the software path of `Rasterizer::MakeRasterSnapshot`.
+sk_sp<SkImage> RasterizeOnCPU(const sk_sp<SkPicture>& picture,
+                              SkISize picture_size) {
+  TRACE_EVENT0("flutter", "PictureSnapshotQueue::RasterizeOnCPU");
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRaster(SnapshotImageInfo(picture_size));
+  if (!surface || !surface->getCanvas()) {
+    return nullptr;
+  }
+  surface->getCanvas()->drawPicture(picture);
+  surface->getCanvas()->flush();
+  return surface->makeImageSnapshot();
+}
+
+}  // namespace
+
+size_t PictureSnapshotQueue::Request::ByteSize() const {
+  return SnapshotImageInfo(picture_size).computeMinByteSize();
+}
+
+PictureSnapshotQueue::PictureSnapshotQueue(
+    TaskRunners task_runners,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner)
+    : task_runners_(std::move(task_runners)),
+      snapshot_delegate_(std::move(snapshot_delegate)),
+      concurrent_task_runner_(std::move(concurrent_task_runner)) {}
+
+PictureSnapshotQueue::~PictureSnapshotQueue() = default;
+
+void PictureSnapshotQueue::MakeRasterSnapshot(sk_sp<SkPicture> picture,
+                                              SkISize picture_size,
+                                              ImageCallback callback) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  FML_DCHECK(callback);
+
+  Request request{std::move(picture), picture_size, std::move(callback)};
+
+  if (concurrent_task_runner_) {
+    {
+      std::scoped_lock lock(mutex_);
+      worker_requests_.push_back(std::move(request));
+    }
+    PumpWorkers();
+    return;
+  }
+
+  bool needs_drain = false;
+  {
+    std::scoped_lock lock(mutex_);
+    // If there are pending requests, a drain has already been scheduled and
+    // has not started yet. It will pick this request up too.
+    needs_drain = raster_requests_.empty();
+    raster_requests_.push_back(std::move(request));
+  }
+
+  if (needs_drain) {
+    fml::TaskRunner::RunNowOrPostTask(
+        task_runners_.GetRasterTaskRunner(),
+        [self = shared_from_this()]() { self->DrainOnRasterThread(); });
+  }
+}
+
+void PictureSnapshotQueue::DrainOnRasterThread() {
+  std::vector<Request> requests;
+  {
+    std::scoped_lock lock(mutex_);
+    std::swap(requests, raster_requests_);
+  }
+
+  TRACE_EVENT1("flutter", "PictureSnapshotQueue::DrainOnRasterThread",
+               "count", std::to_string(requests.size()).c_str());
+
+  std::vector<sk_sp<SkImage>> images;
+  images.reserve(requests.size());
+  for (const auto& request : requests) {
+    images.push_back(
+        snapshot_delegate_
+            ? snapshot_delegate_->MakeRasterSnapshot(request.picture,
+                                                     request.picture_size)
+            : nullptr);
+  }
+
+  // All results of the batch are delivered in a single UI task.
+  fml::TaskRunner::RunNowOrPostTask(
+      task_runners_.GetUITaskRunner(),
+      fml::MakeCopyable([requests = std::move(requests),
+                         images = std::move(images)]() mutable {
+        for (size_t i = 0; i < requests.size(); i++) {
+          requests[i].callback(std::move(images[i]));
+        }
+        // The callbacks are associated with the Dart isolate and must be
+        // collected on the UI thread.
+        requests.clear();
+      }));
+}
+
+void PictureSnapshotQueue::PumpWorkers() {
+  std::vector<Request> ready;
+  {
+    std::scoped_lock lock(mutex_);
+    while (!worker_requests_.empty() &&
+           worker_snapshots_in_flight_ < kMaxConcurrentWorkerSnapshots) {
+      const size_t byte_size = worker_requests_.front().ByteSize();
+      if (worker_bytes_in_flight_ > 0 &&
+          worker_bytes_in_flight_ + byte_size > kMaxWorkerSnapshotBytes) {
+        break;
+      }
+      worker_snapshots_in_flight_++;
+      worker_bytes_in_flight_ += byte_size;
+      ready.push_back(std::move(worker_requests_.front()));
+      worker_requests_.pop_front();
+    }
+  }
+
+  for (auto& request : ready) {
+    concurrent_task_runner_->PostTask(fml::MakeCopyable(
+        [self = shared_from_this(), request = std::move(request)]() mutable {
+          const size_t byte_size = request.ByteSize();
+          sk_sp<SkImage> image =
+              RasterizeOnCPU(request.picture, request.picture_size);
+
+          // The picture may hold the last reference to resources that must be
+          // collected on the UI thread, so it goes back along with the
+          // callback.
+          self->task_runners_.GetUITaskRunner()->PostTask(
+              fml::MakeCopyable([request = std::move(request),
+                                 image = std::move(image)]() mutable {
+                request.callback(std::move(image));
+              }));
+
+          self->OnWorkerSnapshotDone(byte_size);
+        }));
+  }
+}
+
+void PictureSnapshotQueue::OnWorkerSnapshotDone(size_t byte_size) {
+  {
+    std::scoped_lock lock(mutex_);
+    FML_DCHECK(worker_snapshots_in_flight_ > 0);
+    worker_snapshots_in_flight_--;
+    worker_bytes_in_flight_ -= byte_size;
+  }
+  PumpWorkers();
+}
+
+}  // namespace flutter
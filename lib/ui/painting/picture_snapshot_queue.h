@@ -0,0 +1,110 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PICTURE_SNAPSHOT_QUEUE_H_
+#define FLUTTER_LIB_UI_PAINTING_PICTURE_SNAPSHOT_QUEUE_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/common/task_runners.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/lib/ui/snapshot_delegate.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPicture.h"
+
+namespace flutter {
+
+/// @brief  Rasterizes pictures into images on behalf of `Picture.toImage` and
+///         `Scene.toImage`.
+///
+///         Requests made while earlier ones are still waiting for the raster
+///         thread are rasterized in the same raster task, and their results
+///         are delivered to the UI thread together. This turns many snapshots
+///         requested in a single frame into one round trip instead of one per
+///         picture.
+///
+///         When the shell renders in software, nothing a picture references
+///         can be backed by a GPU texture. Pictures are then rasterized on the
+///         concurrent worker pool instead of the raster thread. Worker
+///         rasterization is bounded both in the number of pictures in flight
+///         and in the bytes of pixels those pictures will allocate.
+///
+///         This object must be created and accessed on the UI thread, but may
+///         be kept alive by pending tasks on other threads.
+class PictureSnapshotQueue
+    : public std::enable_shared_from_this<PictureSnapshotQueue> {
+ public:
+  /// Invoked on the UI thread with the rasterized image, or null on failure.
+  using ImageCallback = std::function<void(sk_sp<SkImage>)>;
+
+  /// The maximum number of pictures rasterized concurrently on workers.
+  static constexpr size_t kMaxConcurrentWorkerSnapshots = 4;
+
+  /// The maximum bytes of pixels being rasterized concurrently on workers. A
+  /// single snapshot larger than this is still rasterized, but only when no
+  /// other snapshot is in flight.
+  static constexpr size_t kMaxWorkerSnapshotBytes = 64 * 1024 * 1024;
+
+  /// @brief      Creates a queue for snapshots of the given runners.
+  ///
+  /// @param[in]  task_runners            The runners of the shell.
+  /// @param[in]  snapshot_delegate       The delegate used to rasterize
+  ///                                     pictures on the raster thread.
+  /// @param[in]  concurrent_task_runner  If not null, pictures are rasterized
+  ///                                     on this runner instead of the raster
+  ///                                     thread. This must only be set when no
+  ///                                     picture can reference GPU resources.
+  PictureSnapshotQueue(
+      TaskRunners task_runners,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+      std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner);
+
+  ~PictureSnapshotQueue();
+
+  /// @brief      Schedules the picture to be rasterized into an image of the
+  ///             given size. Must be called on the UI thread.
+  void MakeRasterSnapshot(sk_sp<SkPicture> picture,
+                          SkISize picture_size,
+                          ImageCallback callback);
+
+  /// @brief      Whether pictures are rasterized on the concurrent worker pool.
+  bool RasterizesOnWorkers() const { return !!concurrent_task_runner_; }
+
+ private:
+  struct Request {
+    sk_sp<SkPicture> picture;
+    SkISize picture_size;
+    ImageCallback callback;
+
+    size_t ByteSize() const;
+  };
+
+  const TaskRunners task_runners_;
+  const fml::WeakPtr<SnapshotDelegate> snapshot_delegate_;
+  const std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+
+  std::mutex mutex_;
+  std::vector<Request> raster_requests_;
+  std::deque<Request> worker_requests_;
+  size_t worker_snapshots_in_flight_ = 0;
+  size_t worker_bytes_in_flight_ = 0;
+
+  void DrainOnRasterThread();
+
+  void PumpWorkers();
+
+  void OnWorkerSnapshotDone(size_t byte_size);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PictureSnapshotQueue);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PICTURE_SNAPSHOT_QUEUE_H_
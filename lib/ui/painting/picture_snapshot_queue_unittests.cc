@@ -0,0 +1,182 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/picture_snapshot_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/testing.h"
+#include "flutter/testing/thread_test.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+class FakeSnapshotDelegate : public SnapshotDelegate {
+ public:
+  explicit FakeSnapshotDelegate(fml::RefPtr<fml::TaskRunner> raster_runner)
+      : raster_runner_(std::move(raster_runner)), weak_factory_(this) {}
+
+  fml::WeakPtr<SnapshotDelegate> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+  size_t snapshot_count() const { return snapshot_count_; }
+
+  // |SnapshotDelegate|
+  sk_sp<SkImage> MakeRasterSnapshot(sk_sp<SkPicture> picture,
+                                    SkISize picture_size) override {
+    EXPECT_TRUE(raster_runner_->RunsTasksOnCurrentThread());
+    snapshot_count_++;
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(picture_size.width(), picture_size.height());
+    SkCanvas canvas(bitmap);
+    canvas.drawPicture(picture);
+    bitmap.setImmutable();
+    return SkImage::MakeFromBitmap(bitmap);
+  }
+
+  // |SnapshotDelegate|
+  sk_sp<SkImage> ConvertToRasterImage(sk_sp<SkImage> image) override {
+    return image;
+  }
+
+ private:
+  fml::RefPtr<fml::TaskRunner> raster_runner_;
+  std::atomic<size_t> snapshot_count_ = 0;
+  fml::WeakPtrFactory<SnapshotDelegate> weak_factory_;
+};
+
+// Weak pointers to the delegate are checked against the thread that created
+// them, so the delegate lives on the raster thread just like the rasterizer.
+std::unique_ptr<FakeSnapshotDelegate> CreateDelegateOnRasterThread(
+    fml::RefPtr<fml::TaskRunner> raster_runner) {
+  std::unique_ptr<FakeSnapshotDelegate> delegate;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(raster_runner, [&]() {
+    delegate = std::make_unique<FakeSnapshotDelegate>(raster_runner);
+    latch.Signal();
+  });
+  latch.Wait();
+  return delegate;
+}
+
+void DestroyDelegateOnRasterThread(
+    fml::RefPtr<fml::TaskRunner> raster_runner,
+    std::unique_ptr<FakeSnapshotDelegate> delegate) {
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(raster_runner, [&]() {
+    delegate.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
+sk_sp<SkPicture> MakeSolidColorPicture(SkColor color) {
+  SkPictureRecorder recorder;
+  auto* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+  canvas->drawColor(color);
+  return recorder.finishRecordingAsPicture();
+}
+
+SkColor ReadColorAt(const sk_sp<SkImage>& image, int x, int y) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(1, 1);
+  if (!image->readPixels(bitmap.pixmap(), x, y)) {
+    return SK_ColorTRANSPARENT;
+  }
+  return bitmap.getColor(0, 0);
+}
+
+}  // namespace
+
+using PictureSnapshotQueueTest = ThreadTest;
+
+TEST_F(PictureSnapshotQueueTest, DeliversBatchedSnapshotsInOrderOnUIThread) {
+  auto ui_runner = CreateNewThread("ui");
+  auto raster_runner = CreateNewThread("raster");
+  TaskRunners runners(GetCurrentTestName(), ui_runner, raster_runner,
+                      ui_runner, ui_runner);
+  auto delegate = CreateDelegateOnRasterThread(raster_runner);
+  auto weak_delegate = delegate->GetWeakPtr();
+
+  const std::vector<SkColor> colors = {SK_ColorRED, SK_ColorGREEN,
+                                       SK_ColorBLUE};
+  std::vector<SkColor> delivered;
+  fml::AutoResetWaitableEvent latch;
+
+  fml::TaskRunner::RunNowOrPostTask(ui_runner, [&]() {
+    auto queue = std::make_shared<PictureSnapshotQueue>(
+        runners, weak_delegate, nullptr);
+    ASSERT_FALSE(queue->RasterizesOnWorkers());
+    for (auto color : colors) {
+      queue->MakeRasterSnapshot(
+          MakeSolidColorPicture(color), SkISize::Make(10, 10),
+          [&, ui_runner](sk_sp<SkImage> image) {
+            EXPECT_TRUE(ui_runner->RunsTasksOnCurrentThread());
+            ASSERT_TRUE(image);
+            delivered.push_back(ReadColorAt(image, 5, 5));
+            if (delivered.size() == colors.size()) {
+              latch.Signal();
+            }
+          });
+    }
+  });
+
+  latch.Wait();
+  EXPECT_EQ(delivered, colors);
+  EXPECT_EQ(delegate->snapshot_count(), colors.size());
+  DestroyDelegateOnRasterThread(raster_runner, std::move(delegate));
+}
+
+TEST_F(PictureSnapshotQueueTest, RasterizesOnWorkersWithoutSnapshotDelegate) {
+  auto ui_runner = CreateNewThread("ui");
+  auto raster_runner = CreateNewThread("raster");
+  TaskRunners runners(GetCurrentTestName(), ui_runner, raster_runner,
+                      ui_runner, ui_runner);
+  auto delegate = CreateDelegateOnRasterThread(raster_runner);
+  auto weak_delegate = delegate->GetWeakPtr();
+  auto concurrent_loop = fml::ConcurrentMessageLoop::Create(2);
+
+  // More requests than may be in flight at once.
+  const size_t request_count =
+      PictureSnapshotQueue::kMaxConcurrentWorkerSnapshots * 3;
+  size_t delivered = 0;
+  fml::AutoResetWaitableEvent latch;
+
+  fml::TaskRunner::RunNowOrPostTask(ui_runner, [&]() {
+    auto queue = std::make_shared<PictureSnapshotQueue>(
+        runners, weak_delegate, concurrent_loop->GetTaskRunner());
+    ASSERT_TRUE(queue->RasterizesOnWorkers());
+    for (size_t i = 0; i < request_count; i++) {
+      queue->MakeRasterSnapshot(
+          MakeSolidColorPicture(SK_ColorRED), SkISize::Make(10, 10),
+          [&, ui_runner](sk_sp<SkImage> image) {
+            EXPECT_TRUE(ui_runner->RunsTasksOnCurrentThread());
+            ASSERT_TRUE(image);
+            EXPECT_EQ(image->dimensions(), SkISize::Make(10, 10));
+            EXPECT_EQ(ReadColorAt(image, 5, 5), SK_ColorRED);
+            if (++delivered == request_count) {
+              latch.Signal();
+            }
+          });
+    }
+  });
+
+  latch.Wait();
+  EXPECT_EQ(delivered, request_count);
+  EXPECT_EQ(delegate->snapshot_count(), 0u);
+  DestroyDelegateOnRasterThread(raster_runner, std::move(delegate));
+}
+
+}  // namespace testing
+}  // namespace flutter
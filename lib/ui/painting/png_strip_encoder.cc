@@ -0,0 +1,428 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/png_strip_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkICC.h"
+#include "third_party/zlib/zlib.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint8_t kPngSignature[] = {0x89, 0x50, 0x4E, 0x47,
+                                     0x0D, 0x0A, 0x1A, 0x0A};
+
+// CMF and FLG bytes of a zlib stream using a 32K window and the default
+// compression level.
+constexpr uint8_t kZlibHeader[] = {0x78, 0x9C};
+
+constexpr int kCompressionLevel = 6;
+
+constexpr size_t kBytesPerPixel = 4;
+
+// Below this size the cost of posting tasks outweighs the benefit of
+// compressing strips concurrently.
+constexpr int64_t kMinStripEncodePixels = 512 * 512;
+
+// Whether every channel of the color type fits in the 8-bit RGBA output of
+// this encoder without losing precision.
+bool HasAtMost8BitChannels(SkColorType color_type) {
+  switch (color_type) {
+    case kAlpha_8_SkColorType:
+    case kRGB_565_SkColorType:
+    case kARGB_4444_SkColorType:
+    case kRGBA_8888_SkColorType:
+    case kRGB_888x_SkColorType:
+    case kBGRA_8888_SkColorType:
+    case kGray_8_SkColorType:
+      return true;
+    default:
+      return false;
+  }
+}
+
+enum FilterType : uint8_t {
+  kFilterNone = 0,
+  kFilterSub = 1,
+  kFilterUp = 2,
+  kFilterAverage = 3,
+  kFilterPaeth = 4,
+  kFilterTypeCount = 5,
+};
+
+struct CompressedStrip {
+  std::vector<uint8_t> deflated;
+  uLong adler = 0;
+  size_t filtered_size = 0;
+};
+
+void AppendUint32(std::vector<uint8_t>* out, uint32_t value) {
+  out->push_back((value >> 24) & 0xFF);
+  out->push_back((value >> 16) & 0xFF);
+  out->push_back((value >> 8) & 0xFF);
+  out->push_back(value & 0xFF);
+}
+
+using ByteSpan = std::pair<const uint8_t*, size_t>;
+
+// Appends a PNG chunk whose data is the concatenation of the given spans.
+void AppendChunk(std::vector<uint8_t>* out,
+                 const char type[4],
+                 std::initializer_list<ByteSpan> data) {
+  size_t length = 0;
+  for (const auto& span : data) {
+    length += span.second;
+  }
+  AppendUint32(out, length);
+  const size_t crc_offset = out->size();
+  out->insert(out->end(), type, type + 4);
+  for (const auto& span : data) {
+    out->insert(out->end(), span.first, span.first + span.second);
+  }
+  const uLong crc =
+      crc32(crc32(0L, Z_NULL, 0), out->data() + crc_offset, length + 4);
+  AppendUint32(out, crc);
+}
+
+// Appends the chunk that describes the color space of the pixels, which is
+// the same chunk SkPngEncoder writes: sRGB for sRGB images, an ICC profile for
+// other color spaces it can describe, and nothing for images without a color
+// space.
+void AppendColorSpaceChunk(std::vector<uint8_t>* out,
+                           const SkColorSpace* color_space) {
+  if (!color_space) {
+    return;
+  }
+  if (color_space->isSRGB()) {
+    const uint8_t rendering_intent = 0;  // Perceptual.
+    AppendChunk(out, "sRGB", {{&rendering_intent, 1}});
+    return;
+  }
+
+  skcms_TransferFunction transfer_function;
+  skcms_Matrix3x3 to_xyz_d50;
+  if (!color_space->isNumericalTransferFn(&transfer_function) ||
+      !color_space->toXYZD50(&to_xyz_d50)) {
+    return;
+  }
+  sk_sp<SkData> profile = SkWriteICCProfile(transfer_function, to_xyz_d50);
+  if (!profile) {
+    return;
+  }
+  uLongf compressed_size = compressBound(profile->size());
+  std::vector<uint8_t> compressed(compressed_size);
+  if (compress2(compressed.data(), &compressed_size, profile->bytes(),
+                profile->size(), kCompressionLevel) != Z_OK) {
+    return;
+  }
+  // The profile name, with its null terminator, and the compression method.
+  constexpr uint8_t kProfileName[] = {'S', 'k', 'i', 'a', 0, 0};
+  AppendChunk(out, "iCCP",
+              {{kProfileName, sizeof(kProfileName)},
+               {compressed.data(), compressed_size}});
+}
+
+std::vector<uint8_t> CreateHeader(const SkImageInfo& info) {
+  std::vector<uint8_t> header(std::begin(kPngSignature),
+                              std::end(kPngSignature));
+  std::vector<uint8_t> ihdr;
+  AppendUint32(&ihdr, info.width());
+  AppendUint32(&ihdr, info.height());
+  ihdr.push_back(8);  // Bit depth.
+  ihdr.push_back(6);  // Color type: RGBA.
+  ihdr.push_back(0);  // Compression method: deflate.
+  ihdr.push_back(0);  // Filter method: adaptive.
+  ihdr.push_back(0);  // Interlace method: none.
+  AppendChunk(&header, "IHDR", {{ihdr.data(), ihdr.size()}});
+  AppendColorSpaceChunk(&header, info.colorSpace());
+  return header;
+}
+
+// Appends the IDAT chunk for a strip. The first strip carries the zlib header
+// and the last strip carries the Adler-32 checksum of the whole stream,
+// followed by the IEND chunk.
+void AppendStrip(std::vector<uint8_t>* out,
+                 const CompressedStrip& strip,
+                 bool first,
+                 bool last,
+                 uLong stream_adler) {
+  std::vector<uint8_t> trailer;
+  if (last) {
+    AppendUint32(&trailer, stream_adler);
+  }
+  AppendChunk(out, "IDAT",
+              {{kZlibHeader, first ? sizeof(kZlibHeader) : 0},
+               {strip.deflated.data(), strip.deflated.size()},
+               {trailer.data(), trailer.size()}});
+  if (last) {
+    AppendChunk(out, "IEND", {});
+  }
+}
+
+uint8_t PaethPredictor(int a, int b, int c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  if (pb <= pc) {
+    return b;
+  }
+  return c;
+}
+
+// Filters a row with each of the PNG filter types and writes the one with the
+// smallest sum of absolute differences, preceded by its filter type byte, to
+// `out`. This is the heuristic recommended by the PNG specification.
+void FilterRow(const uint8_t* row,
+               const uint8_t* prior,
+               size_t length,
+               uint8_t* candidates,
+               uint8_t* out) {
+  uint8_t* filtered[kFilterTypeCount];
+  uint64_t sums[kFilterTypeCount] = {};
+  for (size_t type = 0; type < kFilterTypeCount; type++) {
+    filtered[type] = candidates + type * length;
+  }
+
+  for (size_t i = 0; i < length; i++) {
+    const int x = row[i];
+    const int a = i >= kBytesPerPixel ? row[i - kBytesPerPixel] : 0;
+    const int b = prior ? prior[i] : 0;
+    const int c = prior && i >= kBytesPerPixel ? prior[i - kBytesPerPixel] : 0;
+
+    filtered[kFilterNone][i] = x;
+    filtered[kFilterSub][i] = x - a;
+    filtered[kFilterUp][i] = x - b;
+    filtered[kFilterAverage][i] = x - ((a + b) >> 1);
+    filtered[kFilterPaeth][i] = x - PaethPredictor(a, b, c);
+
+    for (size_t type = 0; type < kFilterTypeCount; type++) {
+      sums[type] += std::abs(static_cast<int8_t>(filtered[type][i]));
+    }
+  }
+
+  const size_t best =
+      std::min_element(std::begin(sums), std::end(sums)) - std::begin(sums);
+  out[0] = best;
+  ::memcpy(out + 1, filtered[best], length);
+}
+
+// Filters and deflates the given rows of the pixmap. All strips but the last
+// end with a sync flush so that their output is byte aligned and can be
+// concatenated with the output of the next strip.
+bool CompressStrip(const SkPixmap& pixmap,
+                   int first_row,
+                   int row_count,
+                   bool last,
+                   CompressedStrip* strip) {
+  TRACE_EVENT0("flutter", "PngStripEncoder::CompressStrip");
+
+  const size_t row_bytes = pixmap.width() * kBytesPerPixel;
+  const SkImageInfo row_info = SkImageInfo::Make(
+      pixmap.width(), 1, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+
+  std::vector<uint8_t> prior(row_bytes);
+  std::vector<uint8_t> current(row_bytes);
+  std::vector<uint8_t> candidates(row_bytes * kFilterTypeCount);
+  std::vector<uint8_t> filtered((row_bytes + 1) * row_count);
+
+  // The filters of the first row depend on the last row of the previous strip.
+  bool has_prior = first_row > 0;
+  if (has_prior &&
+      !pixmap.readPixels(row_info, prior.data(), row_bytes, 0, first_row - 1)) {
+    return false;
+  }
+
+  for (int row = 0; row < row_count; row++) {
+    if (!pixmap.readPixels(row_info, current.data(), row_bytes, 0,
+                           first_row + row)) {
+      return false;
+    }
+    FilterRow(current.data(), has_prior ? prior.data() : nullptr, row_bytes,
+              candidates.data(), filtered.data() + row * (row_bytes + 1));
+    std::swap(prior, current);
+    has_prior = true;
+  }
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, kCompressionLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+
+  // The sync flush marker is not accounted for by the bound.
+  strip->deflated.resize(deflateBound(&stream, filtered.size()) + 16);
+  stream.next_in = filtered.data();
+  stream.avail_in = filtered.size();
+  stream.next_out = strip->deflated.data();
+  stream.avail_out = strip->deflated.size();
+
+  const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+  const bool success =
+      last ? result == Z_STREAM_END
+           : result == Z_OK && stream.avail_in == 0 && stream.avail_out > 0;
+  strip->deflated.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  if (!success) {
+    FML_LOG(ERROR) << "Could not deflate PNG strip.";
+    return false;
+  }
+
+  strip->adler =
+      adler32(adler32(0L, Z_NULL, 0), filtered.data(), filtered.size());
+  strip->filtered_size = filtered.size();
+  return true;
+}
+
+int StripCount(int height, int strip_rows) {
+  return (height + strip_rows - 1) / strip_rows;
+}
+
+int StripRowCount(int height, int strip_rows, int strip) {
+  return std::min(strip_rows, height - strip * strip_rows);
+}
+
+struct AsyncEncodeState {
+  sk_sp<SkImage> image;
+  SkPixmap pixmap;
+  int strip_rows = 0;
+  int strip_count = 0;
+  PngStripEncoder::ChunkCallback on_chunk;
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<CompressedStrip>> strips;
+  int next_strip_to_emit = 0;
+  uLong stream_adler = 0;
+  bool failed = false;
+
+  // Emits all completed strips that follow the ones already emitted. Must be
+  // called with the mutex held.
+  void EmitCompletedStrips() {
+    while (next_strip_to_emit < strip_count && strips[next_strip_to_emit]) {
+      const int index = next_strip_to_emit++;
+      std::unique_ptr<CompressedStrip> strip = std::move(strips[index]);
+      const bool first = index == 0;
+      const bool last = index == strip_count - 1;
+
+      stream_adler = adler32_combine(stream_adler, strip->adler,
+                                     strip->filtered_size);
+
+      std::vector<uint8_t> out;
+      if (first) {
+        out = CreateHeader(pixmap.info());
+      }
+      AppendStrip(&out, *strip, first, last, stream_adler);
+      on_chunk(SkData::MakeWithCopy(out.data(), out.size()), last);
+    }
+  }
+};
+
+}  // namespace
+
+bool PngStripEncoder::ShouldEncodeInStrips(const SkImageInfo& info,
+                                           int strip_rows) {
+  return HasAtMost8BitChannels(info.colorType()) && strip_rows > 0 &&
+         info.height() > strip_rows &&
+         static_cast<int64_t>(info.width()) * info.height() >=
+             kMinStripEncodePixels;
+}
+
+sk_sp<SkData> PngStripEncoder::Encode(const SkPixmap& pixmap, int strip_rows) {
+  TRACE_EVENT0("flutter", "PngStripEncoder::Encode");
+
+  if (pixmap.dimensions().isEmpty() || !pixmap.addr() || strip_rows <= 0) {
+    return nullptr;
+  }
+
+  std::vector<uint8_t> out = CreateHeader(pixmap.info());
+  uLong stream_adler = adler32(0L, Z_NULL, 0);
+  const int strip_count = StripCount(pixmap.height(), strip_rows);
+  for (int index = 0; index < strip_count; index++) {
+    const bool last = index == strip_count - 1;
+    CompressedStrip strip;
+    if (!CompressStrip(pixmap, index * strip_rows,
+                       StripRowCount(pixmap.height(), strip_rows, index), last,
+                       &strip)) {
+      return nullptr;
+    }
+    stream_adler =
+        adler32_combine(stream_adler, strip.adler, strip.filtered_size);
+    AppendStrip(&out, strip, index == 0, last, stream_adler);
+  }
+
+  return SkData::MakeWithCopy(out.data(), out.size());
+}
+
+void PngStripEncoder::EncodeAsync(
+    sk_sp<SkImage> raster_image,
+    std::shared_ptr<fml::ConcurrentTaskRunner> runner,
+    ChunkCallback on_chunk,
+    int strip_rows) {
+  TRACE_EVENT0("flutter", "PngStripEncoder::EncodeAsync");
+  FML_DCHECK(runner);
+  FML_DCHECK(on_chunk);
+
+  auto state = std::make_shared<AsyncEncodeState>();
+  if (!raster_image || strip_rows <= 0 ||
+      !raster_image->peekPixels(&state->pixmap) ||
+      state->pixmap.dimensions().isEmpty()) {
+    FML_LOG(ERROR) << "Could not access the pixels of the image to encode.";
+    on_chunk(nullptr, true);
+    return;
+  }
+
+  state->image = std::move(raster_image);
+  state->strip_rows = strip_rows;
+  state->strip_count = StripCount(state->pixmap.height(), strip_rows);
+  state->on_chunk = std::move(on_chunk);
+  state->strips.resize(state->strip_count);
+  state->stream_adler = adler32(0L, Z_NULL, 0);
+
+  for (int index = 0; index < state->strip_count; index++) {
+    runner->PostTask([state, index]() {
+      {
+        std::scoped_lock lock(state->mutex);
+        if (state->failed) {
+          return;
+        }
+      }
+
+      auto strip = std::make_unique<CompressedStrip>();
+      const bool compressed = CompressStrip(
+          state->pixmap, index * state->strip_rows,
+          StripRowCount(state->pixmap.height(), state->strip_rows, index),
+          index == state->strip_count - 1, strip.get());
+
+      std::scoped_lock lock(state->mutex);
+      if (state->failed) {
+        return;
+      }
+      if (!compressed) {
+        state->failed = true;
+        state->on_chunk(nullptr, true);
+        return;
+      }
+      state->strips[index] = std::move(strip);
+      state->EmitCompletedStrips();
+    });
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,76 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PNG_STRIP_ENCODER_H_
+#define FLUTTER_LIB_UI_PAINTING_PNG_STRIP_ENCODER_H_
+
+#include <functional>
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+
+namespace flutter {
+
+/// @brief  Encodes raster images as 8-bit RGBA PNGs by splitting them into
+///         horizontal strips that are filtered and deflated independently.
+///
+///         Each strip is compressed into its own sync-flushed deflate block
+///         so that the strips can simply be concatenated into a single zlib
+///         stream, with the Adler-32 checksums of the strips combined at the
+///         end. This allows the strips of large images to be compressed
+///         concurrently on the worker pool and handed to the caller as soon as
+///         all strips before them are done.
+class PngStripEncoder {
+ public:
+  /// Receives the encoded PNG, in order, one or more PNG chunks at a time.
+  /// The final invocation has `done` set. On failure, the final invocation
+  /// has a null `data`. Chunks that were already delivered must then be
+  /// discarded by the caller.
+  using ChunkCallback = std::function<void(sk_sp<SkData> data, bool done)>;
+
+  /// The number of image rows in each strip when none is specified.
+  static constexpr int kDefaultStripRows = 64;
+
+  /// @brief      Whether encoding an image with the given info in strips on a
+  ///             worker pool is likely to be faster than encoding it on a
+  ///             single thread.
+  ///
+  ///             Images with more than 8 bits per channel, such as F16 and
+  ///             10-bit wide gamut images, are never encoded in strips since
+  ///             this encoder would reduce them to 8 bits per channel.
+  static bool ShouldEncodeInStrips(const SkImageInfo& info,
+                                   int strip_rows = kDefaultStripRows);
+
+  /// @brief      Synchronously encodes the pixmap on the calling thread.
+  ///             Pixels with more than 8 bits per channel are reduced to 8.
+  /// @return     The encoded PNG, or null if the pixels could not be encoded.
+  static sk_sp<SkData> Encode(const SkPixmap& pixmap,
+                              int strip_rows = kDefaultStripRows);
+
+  /// @brief      Encodes the raster image by compressing its strips
+  ///             concurrently on the given task runner.
+  ///
+  /// @param[in]  raster_image  The image to encode. It must be backed by CPU
+  ///                           memory.
+  /// @param[in]  runner        The task runner the strips are compressed on.
+  /// @param[in]  on_chunk      Invoked on the worker threads as the encoded
+  ///                           data becomes available. Invocations are
+  ///                           serialized and in stream order.
+  /// @param[in]  strip_rows    The number of image rows in each strip.
+  static void EncodeAsync(sk_sp<SkImage> raster_image,
+                          std::shared_ptr<fml::ConcurrentTaskRunner> runner,
+                          ChunkCallback on_chunk,
+                          int strip_rows = kDefaultStripRows);
+
+ private:
+  FML_DISALLOW_IMPLICIT_CONSTRUCTORS(PngStripEncoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PNG_STRIP_ENCODER_H_
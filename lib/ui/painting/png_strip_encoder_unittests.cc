@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/png_strip_encoder.h"
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// An opaque image with enough variation to exercise every PNG filter type.
+sk_sp<SkImage> MakeTestImage(int width,
+                             int height,
+                             sk_sp<SkColorSpace> color_space = nullptr) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::Make(width, height, kRGBA_8888_SkColorType,
+                                       kOpaque_SkAlphaType,
+                                       std::move(color_space)));
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      auto* pixel = static_cast<uint8_t*>(bitmap.getAddr(x, y));
+      pixel[0] = (x * 7 + y) & 0xFF;
+      pixel[1] = (y * 3) & 0xFF;
+      pixel[2] = (x ^ y) & 0xFF;
+      pixel[3] = 0xFF;
+    }
+  }
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+void AssertDecodesTo(const sk_sp<SkData>& encoded,
+                     const sk_sp<SkImage>& expected) {
+  ASSERT_TRUE(encoded);
+  auto decoded = SkImage::MakeFromEncoded(encoded);
+  ASSERT_TRUE(decoded);
+  ASSERT_EQ(decoded->dimensions(), expected->dimensions());
+
+  const SkImageInfo info = SkImageInfo::Make(
+      expected->dimensions(), kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
+  std::vector<uint32_t> decoded_pixels(info.width() * info.height());
+  std::vector<uint32_t> expected_pixels(info.width() * info.height());
+  ASSERT_TRUE(decoded->readPixels(info, decoded_pixels.data(),
+                                  info.minRowBytes(), 0, 0));
+  ASSERT_TRUE(expected->readPixels(info, expected_pixels.data(),
+                                   info.minRowBytes(), 0, 0));
+  ASSERT_EQ(decoded_pixels, expected_pixels);
+}
+
+}  // namespace
+
+TEST(PngStripEncoderTest, EncodedImageDecodesToSourcePixels) {
+  auto image = MakeTestImage(97, 131);
+  SkPixmap pixmap;
+  ASSERT_TRUE(image->peekPixels(&pixmap));
+
+  // Strip sizes that do and don't evenly divide the image height, as well as a
+  // single strip covering the whole image.
+  for (int strip_rows : {1, 16, 131, 500}) {
+    AssertDecodesTo(PngStripEncoder::Encode(pixmap, strip_rows), image);
+  }
+}
+
+TEST(PngStripEncoderTest, AsyncEncodingMatchesSyncEncoding) {
+  auto image = MakeTestImage(300, 257);
+  SkPixmap pixmap;
+  ASSERT_TRUE(image->peekPixels(&pixmap));
+  auto expected = PngStripEncoder::Encode(pixmap, 32);
+  ASSERT_TRUE(expected);
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  fml::AutoResetWaitableEvent latch;
+  std::vector<uint8_t> encoded;
+  size_t chunk_count = 0;
+  PngStripEncoder::EncodeAsync(
+      image, loop->GetTaskRunner(),
+      [&](sk_sp<SkData> chunk, bool done) {
+        ASSERT_TRUE(chunk);
+        chunk_count++;
+        encoded.insert(encoded.end(), chunk->bytes(),
+                       chunk->bytes() + chunk->size());
+        if (done) {
+          latch.Signal();
+        }
+      },
+      32);
+  latch.Wait();
+
+  // One chunk per strip.
+  ASSERT_EQ(chunk_count, 9u);
+  ASSERT_TRUE(expected->equals(
+      SkData::MakeWithoutCopy(encoded.data(), encoded.size()).get()));
+}
+
+TEST(PngStripEncoderTest, EncodedImageKeepsColorSpace) {
+  // sRGB images are tagged with an sRGB chunk.
+  auto srgb_image = MakeTestImage(40, 40, SkColorSpace::MakeSRGB());
+  SkPixmap srgb_pixmap;
+  ASSERT_TRUE(srgb_image->peekPixels(&srgb_pixmap));
+  auto srgb_encoded = PngStripEncoder::Encode(srgb_pixmap, 16);
+  ASSERT_TRUE(srgb_encoded);
+  const std::string srgb_bytes(
+      static_cast<const char*>(srgb_encoded->data()), srgb_encoded->size());
+  ASSERT_NE(srgb_bytes.find("sRGB"), std::string::npos);
+  ASSERT_EQ(srgb_bytes.find("iCCP"), std::string::npos);
+
+  // Other color spaces are tagged with an ICC profile.
+  auto p3_image = MakeTestImage(
+      40, 40,
+      SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB,
+                            SkNamedGamut::kDisplayP3));
+  SkPixmap p3_pixmap;
+  ASSERT_TRUE(p3_image->peekPixels(&p3_pixmap));
+  auto p3_encoded = PngStripEncoder::Encode(p3_pixmap, 16);
+  AssertDecodesTo(p3_encoded, p3_image);
+  auto p3_decoded = SkImage::MakeFromEncoded(p3_encoded);
+  ASSERT_TRUE(p3_decoded);
+  ASSERT_TRUE(
+      SkColorSpace::Equals(p3_decoded->colorSpace(), p3_image->colorSpace()));
+
+  // Images without a color space are left untagged.
+  auto untagged_image = MakeTestImage(40, 40);
+  SkPixmap untagged_pixmap;
+  ASSERT_TRUE(untagged_image->peekPixels(&untagged_pixmap));
+  auto untagged_encoded = PngStripEncoder::Encode(untagged_pixmap, 16);
+  ASSERT_TRUE(untagged_encoded);
+  const std::string untagged_bytes(
+      static_cast<const char*>(untagged_encoded->data()),
+      untagged_encoded->size());
+  ASSERT_EQ(untagged_bytes.find("sRGB"), std::string::npos);
+  ASSERT_EQ(untagged_bytes.find("iCCP"), std::string::npos);
+}
+
+TEST(PngStripEncoderTest, OnlyLargeImagesAreEncodedInStrips) {
+  ASSERT_FALSE(PngStripEncoder::ShouldEncodeInStrips(
+      SkImageInfo::MakeN32Premul(64, 64)));
+  ASSERT_FALSE(PngStripEncoder::ShouldEncodeInStrips(
+      SkImageInfo::MakeN32Premul(8192, 32)));
+  ASSERT_TRUE(PngStripEncoder::ShouldEncodeInStrips(
+      SkImageInfo::MakeN32Premul(3840, 2160)));
+}
+
+TEST(PngStripEncoderTest, WideImagesAreNotEncodedInStrips) {
+  // These are left to Skia's encoder, which keeps their 16-bit channels.
+  ASSERT_FALSE(PngStripEncoder::ShouldEncodeInStrips(SkImageInfo::Make(
+      3840, 2160, kRGBA_F16_SkColorType, kPremul_SkAlphaType,
+      SkColorSpace::MakeSRGBLinear())));
+  ASSERT_FALSE(PngStripEncoder::ShouldEncodeInStrips(SkImageInfo::Make(
+      3840, 2160, kRGBA_1010102_SkColorType, kPremul_SkAlphaType,
+      SkColorSpace::MakeRGB(SkNamedTransferFn::kSRGB,
+                            SkNamedGamut::kDisplayP3))));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -3527,6 +3527,63 @@ class ParagraphBuilder extends NativeFieldWrapperClass2 {
   void _build(Paragraph outParagraph) native 'ParagraphBuilder_build';
 }
 
+/// Lays out many paragraphs that share a [ParagraphStyle] in a single call.
+///
+/// Laying out text with a [ParagraphBuilder] and a [Paragraph] calls into the
+/// engine once per style, text run, layout, and metric. Lists and tables that
+/// measure thousands of small cells per frame spend much of that time on the
+/// calls themselves. A batch is given its text styles once, and then measures
+/// any number of paragraphs described by flat lists in one call to [layout].
+///
+/// The paragraphs are only measured. To paint a paragraph, build it with a
+/// [ParagraphBuilder].
+class ParagraphBatch extends NativeFieldWrapperClass2 {
+  /// Creates a batch of paragraphs with the given style, whose runs of text
+  /// use the styles in `textStyles`, referred to by their index.
+  @pragma('vm:entry-point')
+  ParagraphBatch(ParagraphStyle style, List<TextStyle> textStyles) {
+    _constructor();
+    // The builder decodes the styles, which the batch then keeps.
+    final ParagraphBuilder builder = ParagraphBuilder(style);
+    _setParagraphStyle(builder);
+    for (final TextStyle textStyle in textStyles) {
+      builder.pushStyle(textStyle);
+      _addTextStyle(builder);
+      builder.pop();
+    }
+  }
+
+  void _constructor() native 'ParagraphBatch_constructor';
+  void _setParagraphStyle(ParagraphBuilder builder) native 'ParagraphBatch_setParagraphStyle';
+  void _addTextStyle(ParagraphBuilder builder) native 'ParagraphBatch_addTextStyle';
+
+  /// The number of values [layout] returns for each paragraph.
+  static const int metricsPerParagraph = 7;
+
+  /// Lays out the paragraphs described by `text`, `runs`, and `widths`, and
+  /// returns their metrics.
+  ///
+  /// The `text` of every paragraph is given one after the other. For each
+  /// paragraph, `runs` holds the number of its runs of text, followed by the
+  /// length of each run in UTF-16 code units and the index of its style in the
+  /// styles given to the batch. Each paragraph is laid out with the width at
+  /// its index in `widths`.
+  ///
+  /// The returned list holds [metricsPerParagraph] values for each paragraph:
+  /// its [Paragraph.height], [Paragraph.longestLine],
+  /// [Paragraph.minIntrinsicWidth], [Paragraph.maxIntrinsicWidth],
+  /// [Paragraph.alphabeticBaseline], [Paragraph.ideographicBaseline], and 1.0
+  /// if it [Paragraph.didExceedMaxLines] or 0.0 otherwise.
+  Float64List layout(String text, Int32List runs, Float64List widths) {
+    final Float64List metrics = Float64List(widths.length * metricsPerParagraph);
+    final String? error = _layout(text, runs, widths, metrics);
+    if (error != null)
+      throw ArgumentError(error);
+    return metrics;
+  }
+  String? _layout(String text, Int32List runs, Float64List widths, Float64List metrics) native 'ParagraphBatch_layout';
+}
+
 /// Loads a font from a buffer and makes it available for rendering text.
 ///
 /// * `list`: A list of bytes containing the font file.
@@ -5,21 +5,12 @@
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
 
 #include "flutter/fml/logging.h"
-#include "third_party/skia/include/core/SkData.h"
-#include "third_party/skia/include/core/SkStream.h"
+#include "flutter/lib/ui/text/font_data_registry.h"
 #include "third_party/skia/include/core/SkString.h"
 #include "third_party/skia/include/core/SkTypeface.h"
 
 namespace flutter {
 
-namespace {
-
-void MappingReleaseProc(const void* ptr, void* context) {
-  delete reinterpret_cast<fml::Mapping*>(context);
-}
-
-}  // anonymous namespace
-
 AssetManagerFontProvider::AssetManagerFontProvider(
     std::shared_ptr<AssetManager> asset_manager)
     : asset_manager_(asset_manager) {}
@@ -108,14 +99,10 @@ SkTypeface* AssetManagerFontStyleSet::createTypeface(int i) {
       return nullptr;
     }
 
-    fml::Mapping* asset_mapping_ptr = asset_mapping.release();
-    sk_sp<SkData> asset_data = SkData::MakeWithProc(
-        asset_mapping_ptr->GetMapping(), asset_mapping_ptr->GetSize(),
-        MappingReleaseProc, asset_mapping_ptr);
-    std::unique_ptr<SkMemoryStream> stream = SkMemoryStream::Make(asset_data);
-
-    // Ownership of the stream is transferred.
-    asset.typeface = SkTypeface::MakeFromStream(std::move(stream));
+    // Asset mappings are usually file mappings. Engines that register the
+    // same font share the typeface and a single mapping of it.
+    asset.typeface =
+        FontDataRegistry::GetInstance().GetTypeface(std::move(asset_mapping));
     if (!asset.typeface) {
       FML_DLOG(ERROR) << "Unable to load font asset for family: "
                       << family_name_;
@@ -7,6 +7,7 @@
 #include <mutex>
 
 #include "flutter/lib/ui/text/asset_manager_font_provider.h"
+#include "flutter/lib/ui/text/font_data_registry.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/platform_configuration.h"
 #include "flutter/runtime/test_font_data.h"
@@ -159,10 +160,11 @@ void FontCollection::RegisterTestFonts() {
 void FontCollection::LoadFontFromList(const uint8_t* font_data,
                                       int length,
                                       std::string family_name) {
-  std::unique_ptr<SkStreamAsset> font_stream =
-      std::make_unique<SkMemoryStream>(font_data, length, true);
-  sk_sp<SkTypeface> typeface =
-      SkTypeface::MakeFromStream(std::move(font_stream));
+  // The bytes belong to Dart, so they are copied. The copy is dropped if
+  // another engine has already loaded the same font.
+  sk_sp<SkTypeface> typeface = FontDataRegistry::GetInstance().GetTypeface(
+      std::make_unique<fml::MallocMapping>(
+          fml::MallocMapping::Copy(font_data, length)));
   txt::TypefaceFontAssetProvider& font_provider =
       dynamic_font_manager_->font_provider();
   if (family_name.empty()) {
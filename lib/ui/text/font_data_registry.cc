@@ -0,0 +1,166 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/text/font_data_registry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkStream.h"
+
+namespace flutter {
+
+// The font data behind a typeface, released by Skia along with the typeface.
+struct FontDataRegistry::Data {
+  FontDataRegistry* registry;
+  Key key;
+  std::unique_ptr<fml::Mapping> mapping;
+};
+
+FontDataRegistry& FontDataRegistry::GetInstance() {
+  static FontDataRegistry* instance = new FontDataRegistry();
+  return *instance;
+}
+
+FontDataRegistry::FontDataRegistry() = default;
+
+FontDataRegistry::~FontDataRegistry() = default;
+
+FontDataRegistry::Key FontDataRegistry::MakeKey(const fml::Mapping& mapping) {
+  const char* bytes = reinterpret_cast<const char*>(mapping.GetMapping());
+  const size_t size = mapping.GetSize();
+  const size_t hashed = std::min(size, kHashedBytes);
+  const std::hash<std::string_view> hash;
+  size_t key_hash = hash(std::string_view(bytes, hashed));
+  if (size > kHashedBytes) {
+    key_hash ^= hash(std::string_view(bytes + size - hashed, hashed)) * 31;
+  }
+  return {key_hash, size};
+}
+
+sk_sp<SkTypeface> FontDataRegistry::GetTypeface(
+    std::unique_ptr<fml::Mapping> mapping) {
+  if (!mapping || mapping->GetMapping() == nullptr ||
+      mapping->GetSize() == 0) {
+    return nullptr;
+  }
+
+  const size_t size = mapping->GetSize();
+  const Key key = MakeKey(*mapping);
+
+  sk_sp<SkTypeface> shared;
+  std::vector<SkTypeface*> expired;
+  {
+    std::scoped_lock lock(mutex_);
+    expired = RemoveExpiredLocked();
+    auto found = typefaces_.find(key);
+    // Different fonts may have the same key, so the data is compared too.
+    // The typeface may expire after the entries were checked, in which case
+    // a new typeface is made below.
+    if (found != typefaces_.end() &&
+        ::memcmp(found->second.second->mapping->GetMapping(),
+                 mapping->GetMapping(), size) == 0 &&
+        found->second.first->try_ref()) {
+      shared.reset(found->second.first);
+    }
+  }
+  DropWeakRefs(expired);
+  if (shared) {
+    return shared;
+  }
+
+  Data* data = new Data{this, key, std::move(mapping)};
+  bytes_ += size;
+  sk_sp<SkData> font_data = SkData::MakeWithProc(
+      data->mapping->GetMapping(), size, &FontDataRegistry::ReleaseData, data);
+  sk_sp<SkTypeface> typeface =
+      SkTypeface::MakeFromStream(SkMemoryStream::Make(font_data));
+  if (!typeface) {
+    return nullptr;
+  }
+
+  // Only typefaces that keep the data alive can be shared, since the entry is
+  // removed when the data is released. A font whose hash is taken by a
+  // different font is not shared.
+  if (!font_data->unique()) {
+    std::scoped_lock lock(mutex_);
+    if (typefaces_.try_emplace(key, typeface.get(), data).second) {
+      typeface->weak_ref();
+    }
+  }
+  return typeface;
+}
+
+std::vector<SkTypeface*> FontDataRegistry::RemoveExpiredLocked() {
+  std::vector<SkTypeface*> expired;
+  for (auto it = typefaces_.begin(); it != typefaces_.end();) {
+    if (it->second.first->weak_expired()) {
+      expired.push_back(it->second.first);
+      it = typefaces_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return expired;
+}
+
+void FontDataRegistry::DropWeakRefs(const std::vector<SkTypeface*>& typefaces) {
+  for (SkTypeface* typeface : typefaces) {
+    typeface->weak_unref();
+  }
+}
+
+void FontDataRegistry::ReleaseData(const void* ptr, void* context) {
+  Data* data = reinterpret_cast<Data*>(context);
+  FontDataRegistry* registry = data->registry;
+  // The data is usually released by the typeface once its last weak
+  // reference is dropped, in which case the entry is already gone. Some font
+  // managers release the data of a typeface that is still alive.
+  SkTypeface* typeface = nullptr;
+  {
+    std::scoped_lock lock(registry->mutex_);
+    auto found = registry->typefaces_.find(data->key);
+    if (found != registry->typefaces_.end() && found->second.second == data) {
+      typeface = found->second.first;
+      registry->typefaces_.erase(found);
+    }
+  }
+  if (typeface) {
+    typeface->weak_unref();
+  }
+  registry->bytes_ -= data->key.size;
+  delete data;
+}
+
+FontDataRegistry::Usage FontDataRegistry::GetUsage() {
+  Usage usage;
+  std::vector<SkTypeface*> expired;
+  {
+    std::scoped_lock lock(mutex_);
+    expired = RemoveExpiredLocked();
+    usage.typeface_count = typefaces_.size();
+  }
+  DropWeakRefs(expired);
+  usage.bytes = bytes_.load();
+  return usage;
+}
+
+// The registry is shared by every engine in the process, so its counters are
+// traced with a single counter id.
+void FontDataRegistry::TraceCountersToTimeline() {
+#if !FLUTTER_RELEASE
+  const size_t bytes = bytes_.load();
+  if (traced_bytes_.exchange(bytes) == bytes) {
+    return;
+  }
+  const Usage usage = GetUsage();
+  FML_TRACE_COUNTER("flutter", "FontData", 0, "Typefaces",
+                    usage.typeface_count, "KBytes", usage.bytes >> 10);
+#endif  // !FLUTTER_RELEASE
+}
+
+}  // namespace flutter
@@ -0,0 +1,119 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_TEXT_FONT_DATA_REGISTRY_H_
+#define FLUTTER_LIB_UI_TEXT_FONT_DATA_REGISTRY_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "third_party/skia/include/core/SkTypeface.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Shares the typefaces made from font data between every engine
+///             in the process, keyed by the contents of the data.
+///
+///             Only the size and the first and last `kHashedBytes` of the data
+///             are hashed, so that registering a large file mapping does not
+///             read all of its pages. The start of a font holds its table
+///             directory, with a checksum of each table. The whole data is
+///             only compared when the keys of two fonts match.
+///
+///             Each engine loads the fonts in its assets and the fonts passed
+///             to `loadFontFromList` on its own. Without sharing, a process
+///             running several engines keeps a copy of each font, and of its
+///             glyph caches, per engine. The registry only keeps weak
+///             references, so the font data is released once no engine uses
+///             the typeface. A typeface keeps its data until the registry
+///             drops its weak reference, which happens at the next
+///             registration or usage query after the typeface expires.
+///
+class FontDataRegistry {
+ public:
+  struct Usage {
+    /// The number of typefaces that are alive.
+    size_t typeface_count = 0;
+    /// The bytes of font data held by those typefaces.
+    size_t bytes = 0;
+  };
+
+  static FontDataRegistry& GetInstance();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Returns the typeface for the font in the mapping. If another
+  ///             caller already made a typeface from the same bytes and it is
+  ///             still alive, that typeface is returned and the mapping is
+  ///             released. Otherwise the new typeface keeps the mapping alive.
+  ///
+  /// @param[in]  mapping  The font data. File mappings are used in place, so
+  ///                      the data is not copied onto the heap.
+  ///
+  /// @return     The typeface, or nullptr if the data is not a valid font.
+  ///
+  sk_sp<SkTypeface> GetTypeface(std::unique_ptr<fml::Mapping> mapping);
+
+  Usage GetUsage();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Emits the usage of the registry as counters on the timeline,
+  ///             if the bytes of font data changed since they were last
+  ///             emitted.
+  ///
+  void TraceCountersToTimeline();
+
+  static constexpr size_t kHashedBytes = 4096;
+
+ private:
+  struct Key {
+    size_t hash;
+    size_t size;
+
+    bool operator==(const Key& other) const {
+      return hash == other.hash && size == other.size;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash ^ key.size; }
+  };
+
+  struct Data;
+
+  std::mutex mutex_;
+  // The typefaces by the hash of their data. Each entry holds a weak
+  // reference to its typeface, and is removed when the typeface expires or
+  // its data is released.
+  std::unordered_map<Key, std::pair<SkTypeface*, Data*>, KeyHash> typefaces_;
+  std::atomic<size_t> bytes_ = 0;
+  std::atomic<size_t> traced_bytes_ = 0;
+
+  FontDataRegistry();
+
+  ~FontDataRegistry();
+
+  static Key MakeKey(const fml::Mapping& mapping);
+
+  // Removes the entries whose typeface expired. Their weak references are
+  // returned to be dropped once the lock is released, since dropping them may
+  // release their data.
+  std::vector<SkTypeface*> RemoveExpiredLocked();
+
+  static void DropWeakRefs(const std::vector<SkTypeface*>& typefaces);
+
+  static void ReleaseData(const void* ptr, void* context);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FontDataRegistry);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_TEXT_FONT_DATA_REGISTRY_H_
@@ -0,0 +1,77 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/text/font_data_registry.h"
+
+#include <vector>
+
+#include "flutter/runtime/test_font_data.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+static std::unique_ptr<fml::Mapping> GetTestFontMapping() {
+  std::vector<std::unique_ptr<SkStreamAsset>> fonts = GetTestFontData();
+  std::vector<uint8_t> bytes(fonts[0]->getLength());
+  fonts[0]->read(bytes.data(), bytes.size());
+  return std::make_unique<fml::MallocMapping>(
+      fml::MallocMapping::Copy(bytes.data(), bytes.size()));
+}
+
+TEST(FontDataRegistryTest, SharesTypefacesMadeFromTheSameData) {
+  FontDataRegistry& registry = FontDataRegistry::GetInstance();
+  const size_t initial_bytes = registry.GetUsage().bytes;
+
+  sk_sp<SkTypeface> first = registry.GetTypeface(GetTestFontMapping());
+  ASSERT_TRUE(first);
+  const size_t loaded_bytes = registry.GetUsage().bytes;
+  EXPECT_GT(loaded_bytes, initial_bytes);
+
+  sk_sp<SkTypeface> second = registry.GetTypeface(GetTestFontMapping());
+  EXPECT_EQ(second.get(), first.get());
+  EXPECT_EQ(registry.GetUsage().bytes, loaded_bytes);
+
+  first.reset();
+  second.reset();
+  EXPECT_EQ(registry.GetUsage().bytes, initial_bytes);
+
+  // Once the typeface is gone, the same data makes a new one.
+  sk_sp<SkTypeface> third = registry.GetTypeface(GetTestFontMapping());
+  ASSERT_TRUE(third);
+  EXPECT_EQ(registry.GetUsage().bytes, loaded_bytes);
+}
+
+TEST(FontDataRegistryTest, ComparesTheDataOfFontsWithTheSameKey) {
+  FontDataRegistry& registry = FontDataRegistry::GetInstance();
+  std::unique_ptr<fml::Mapping> original = GetTestFontMapping();
+  ASSERT_GT(original->GetSize(), 2 * FontDataRegistry::kHashedBytes);
+
+  // A font that only differs in the bytes that are not hashed.
+  std::vector<uint8_t> bytes(original->GetMapping(),
+                             original->GetMapping() + original->GetSize());
+  bytes[bytes.size() / 2] ^= 0xFF;
+  auto modified = std::make_unique<fml::MallocMapping>(
+      fml::MallocMapping::Copy(bytes.data(), bytes.size()));
+
+  sk_sp<SkTypeface> first = registry.GetTypeface(std::move(original));
+  sk_sp<SkTypeface> second = registry.GetTypeface(std::move(modified));
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(second.get(), first.get());
+}
+
+TEST(FontDataRegistryTest, RejectsInvalidData) {
+  FontDataRegistry& registry = FontDataRegistry::GetInstance();
+  const size_t initial_bytes = registry.GetUsage().bytes;
+
+  const char garbage[] = "This is not a font.";
+  EXPECT_FALSE(registry.GetTypeface(std::make_unique<fml::MallocMapping>(
+      fml::MallocMapping::Copy(garbage, sizeof(garbage)))));
+  EXPECT_FALSE(registry.GetTypeface(nullptr));
+  EXPECT_EQ(registry.GetUsage().bytes, initial_bytes);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,184 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/text/paragraph_batch.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/ui_dart_state.h"
+#include "third_party/icu/source/common/unicode/ustring.h"
+#include "third_party/tonic/converter/dart_converter.h"
+#include "third_party/tonic/dart_args.h"
+#include "third_party/tonic/dart_binding_macros.h"
+#include "third_party/tonic/dart_library_natives.h"
+
+namespace flutter {
+namespace {
+
+// The fewest paragraphs given to a worker. Smaller batches are laid out on
+// the calling thread, as handing them to the worker pool costs more than it
+// saves.
+constexpr size_t kMinParagraphsPerTask = 32;
+
+}  // namespace
+
+static void ParagraphBatch_constructor(Dart_NativeArguments args) {
+  UIDartState::ThrowIfUIOperationsProhibited();
+  DartCallConstructor(&ParagraphBatch::Create, args);
+}
+
+IMPLEMENT_WRAPPERTYPEINFO(ui, ParagraphBatch);
+
+#define FOR_EACH_BINDING(V)            \
+  V(ParagraphBatch, setParagraphStyle) \
+  V(ParagraphBatch, addTextStyle)      \
+  V(ParagraphBatch, layout)
+
+FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
+
+void ParagraphBatch::RegisterNatives(tonic::DartLibraryNatives* natives) {
+  natives->Register(
+      {{"ParagraphBatch_constructor", ParagraphBatch_constructor, 1, true},
+       FOR_EACH_BINDING(DART_REGISTER_NATIVE)});
+}
+
+fml::RefPtr<ParagraphBatch> ParagraphBatch::Create() {
+  return fml::MakeRefCounted<ParagraphBatch>();
+}
+
+ParagraphBatch::ParagraphBatch() = default;
+
+ParagraphBatch::~ParagraphBatch() = default;
+
+void ParagraphBatch::setParagraphStyle(ParagraphBuilder* builder) {
+  paragraph_style_ = builder->paragraph_style();
+}
+
+void ParagraphBatch::addTextStyle(ParagraphBuilder* builder) {
+  text_styles_.push_back(builder->PeekStyle());
+}
+
+Dart_Handle ParagraphBatch::layout(const std::u16string& text,
+                                   tonic::Int32List& runs,
+                                   tonic::Float64List& widths,
+                                   tonic::Float64List& metrics) {
+  TRACE_EVENT0("flutter", "ParagraphBatch::layout");
+  const size_t paragraph_count = widths.num_elements();
+  if (metrics.num_elements() != paragraph_count * kMetricsPerParagraph) {
+    return tonic::ToDart("metrics does not fit the paragraphs");
+  }
+
+  // Check the whole description before building anything, so that a bad
+  // batch fails without side effects.
+  struct Run {
+    size_t start;
+    size_t length;
+    size_t style;
+  };
+  std::vector<Run> paragraph_runs;
+  std::vector<size_t> paragraph_run_ends;
+  paragraph_run_ends.reserve(paragraph_count);
+  const size_t run_values = runs.num_elements();
+  size_t position = 0;
+  size_t text_offset = 0;
+  for (size_t i = 0; i < paragraph_count; ++i) {
+    if (position >= run_values || runs[position] < 0 ||
+        static_cast<size_t>(runs[position]) >
+            (run_values - position - 1) / 2) {
+      return tonic::ToDart("runs does not describe every paragraph");
+    }
+    const size_t run_count = runs[position++];
+    for (size_t run = 0; run < run_count; ++run, position += 2) {
+      const int32_t length = runs[position];
+      const int32_t style = runs[position + 1];
+      if (length < 0 ||
+          static_cast<size_t>(length) > text.size() - text_offset) {
+        return tonic::ToDart("runs extend past the end of the text");
+      }
+      if (style < 0 || static_cast<size_t>(style) >= text_styles_.size()) {
+        return tonic::ToDart("runs refer to a missing text style");
+      }
+      paragraph_runs.push_back({text_offset, static_cast<size_t>(length),
+                                static_cast<size_t>(style)});
+      text_offset += length;
+    }
+    paragraph_run_ends.push_back(paragraph_runs.size());
+  }
+  if (position != run_values || text_offset != text.size()) {
+    return tonic::ToDart("runs do not cover the text");
+  }
+
+  // Use ICU to validate the UTF-16 input, as ParagraphBuilder.addText does.
+  if (!text.empty()) {
+    const UChar* text_ptr = reinterpret_cast<const UChar*>(text.data());
+    UErrorCode error_code = U_ZERO_ERROR;
+    u_strToUTF8(nullptr, 0, nullptr, text_ptr, text.size(), &error_code);
+    if (error_code != U_BUFFER_OVERFLOW_ERROR) {
+      return tonic::ToDart("string is not well-formed UTF-16");
+    }
+  }
+
+  // Building only copies the text and styles, so it stays on this thread
+  // where the builders can read the settings of the isolate.
+  std::vector<std::unique_ptr<txt::Paragraph>> paragraphs;
+  paragraphs.reserve(paragraph_count);
+  size_t run_index = 0;
+  for (size_t i = 0; i < paragraph_count; ++i) {
+    std::unique_ptr<txt::ParagraphBuilder> builder =
+        ParagraphBuilder::CreateTxtParagraphBuilder(paragraph_style_);
+    for (; run_index < paragraph_run_ends[i]; ++run_index) {
+      const Run& run = paragraph_runs[run_index];
+      builder->PushStyle(text_styles_[run.style]);
+      builder->AddText(text.substr(run.start, run.length));
+      builder->Pop();
+    }
+    paragraphs.push_back(builder->Build());
+  }
+
+  auto layout_range = [&paragraphs, &widths](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      paragraphs[i]->Layout(widths[i]);
+    }
+  };
+  UIDartState* dart_state = UIDartState::Current();
+  size_t task_count = 1;
+  // SkParagraph caches typefaces in its font collection without guarding
+  // them against concurrent use, so only libtxt paragraphs are laid out on
+  // several threads at once.
+  if (dart_state->enable_parallel_text_layout() &&
+      !ParagraphBuilder::UsesSkParagraph()) {
+    size_t max_tasks = std::max(std::thread::hardware_concurrency(), 1u);
+    task_count = std::clamp<size_t>(paragraph_count / kMinParagraphsPerTask, 1,
+                                    max_tasks);
+  }
+  if (task_count > 1) {
+    // This thread lays out the ranges no worker has claimed yet, so a busy
+    // worker pool does not hold it up.
+    fml::RunConcurrently(dart_state->GetConcurrentTaskRunner(), task_count,
+                         [&](size_t task) {
+                           layout_range(
+                               paragraph_count * task / task_count,
+                               paragraph_count * (task + 1) / task_count);
+                         });
+  } else {
+    layout_range(0, paragraph_count);
+  }
+
+  size_t metric = 0;
+  for (const std::unique_ptr<txt::Paragraph>& paragraph : paragraphs) {
+    metrics[metric++] = paragraph->GetHeight();
+    metrics[metric++] = paragraph->GetLongestLine();
+    metrics[metric++] = paragraph->GetMinIntrinsicWidth();
+    metrics[metric++] = paragraph->GetMaxIntrinsicWidth();
+    metrics[metric++] = paragraph->GetAlphabeticBaseline();
+    metrics[metric++] = paragraph->GetIdeographicBaseline();
+    metrics[metric++] = paragraph->DidExceedMaxLines() ? 1.0 : 0.0;
+  }
+  return Dart_Null();
+}
+
+}  // namespace flutter
@@ -0,0 +1,97 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_TEXT_PARAGRAPH_BATCH_H_
+#define FLUTTER_LIB_UI_TEXT_PARAGRAPH_BATCH_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/lib/ui/dart_wrapper.h"
+#include "flutter/lib/ui/text/paragraph_builder.h"
+#include "flutter/third_party/txt/src/txt/paragraph.h"
+#include "flutter/third_party/txt/src/txt/paragraph_style.h"
+#include "flutter/third_party/txt/src/txt/text_style.h"
+#include "third_party/tonic/typed_data/typed_list.h"
+
+namespace tonic {
+class DartLibraryNatives;
+}  // namespace tonic
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Lays out many paragraphs that share a paragraph style in a
+///             single call and reports their metrics.
+///
+///             Laying out a paragraph through `ParagraphBuilder` and
+///             `Paragraph` crosses into the engine for every style, text run,
+///             layout and metric, and allocates a wrapper for the builder and
+///             for the paragraph. Lists and tables lay out thousands of small
+///             cells per frame, for which that overhead outweighs the layout.
+///             A batch decodes its text styles once and then takes the text,
+///             runs and widths of all its paragraphs in flat lists.
+///
+class ParagraphBatch : public RefCountedDartWrappable<ParagraphBatch> {
+  DEFINE_WRAPPERTYPEINFO();
+  FML_FRIEND_MAKE_REF_COUNTED(ParagraphBatch);
+
+ public:
+  /// The number of values `layout` writes for each paragraph.
+  static constexpr size_t kMetricsPerParagraph = 7;
+
+  static fml::RefPtr<ParagraphBatch> Create();
+
+  ~ParagraphBatch() override;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Uses the paragraph style of the builder for the paragraphs of
+  ///             the batch.
+  ///
+  void setParagraphStyle(ParagraphBuilder* builder);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Adds the style most recently pushed on the builder to the
+  ///             styles the runs of the batch refer to by index.
+  ///
+  void addTextStyle(ParagraphBuilder* builder);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Lays out a list of paragraphs and writes their metrics.
+  ///
+  ///             When parallel text layout is enabled, libtxt paragraphs are
+  ///             laid out on the worker pool. SkParagraph paragraphs are
+  ///             always laid out on the calling thread.
+  ///
+  /// @param[in]  text     The text of every paragraph, one after the other.
+  /// @param[in]  runs     For each paragraph, the number of its runs followed
+  ///                      by the length of each run in UTF-16 code units and
+  ///                      the index of its text style.
+  /// @param[in]  widths   The width to lay out each paragraph at.
+  /// @param[out] metrics  The height, longest line, minimum and maximum
+  ///                      intrinsic widths, alphabetic and ideographic
+  ///                      baselines, and whether the paragraph exceeded its
+  ///                      maximum number of lines, for each paragraph.
+  ///
+  /// @return     Null, or an error message if the lists do not describe the
+  ///             paragraphs.
+  ///
+  Dart_Handle layout(const std::u16string& text,
+                     tonic::Int32List& runs,
+                     tonic::Float64List& widths,
+                     tonic::Float64List& metrics);
+
+  static void RegisterNatives(tonic::DartLibraryNatives* natives);
+
+ private:
+  txt::ParagraphStyle paragraph_style_;
+  std::vector<txt::TextStyle> text_styles_;
+
+  ParagraphBatch();
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_TEXT_PARAGRAPH_BATCH_H_
@@ -296,6 +296,12 @@ ParagraphBuilder::ParagraphBuilder(
     style.locale = locale;
   }
 
+  m_paragraphStyle = style;
+  m_paragraphBuilder = CreateTxtParagraphBuilder(style);
+}
+
+std::unique_ptr<txt::ParagraphBuilder>
+ParagraphBuilder::CreateTxtParagraphBuilder(const txt::ParagraphStyle& style) {
   FontCollection& font_collection = UIDartState::Current()
                                         ->platform_configuration()
                                         ->client()
@@ -307,17 +313,30 @@ ParagraphBuilder::ParagraphBuilder(
   ParagraphBuilderFactory factory = txt::ParagraphBuilder::CreateTxtBuilder;
 
 #if FLUTTER_ENABLE_SKSHAPER
-#if FLUTTER_ALWAYS_USE_SKSHAPER
-  bool enable_skparagraph = true;
-#else
-  bool enable_skparagraph = UIDartState::Current()->enable_skparagraph();
-#endif
-  if (enable_skparagraph) {
+  if (UsesSkParagraph()) {
     factory = txt::ParagraphBuilder::CreateSkiaBuilder;
   }
 #endif  // FLUTTER_ENABLE_SKSHAPER
 
-  m_paragraphBuilder = factory(style, font_collection.GetFontCollection());
+  std::unique_ptr<txt::ParagraphBuilder> builder =
+      factory(style, font_collection.GetFontCollection());
+  if (UIDartState::Current()->enable_parallel_text_layout()) {
+    builder->SetLayoutTaskRunner(
+        UIDartState::Current()->GetConcurrentTaskRunner());
+  }
+  return builder;
+}
+
+bool ParagraphBuilder::UsesSkParagraph() {
+#if FLUTTER_ENABLE_SKSHAPER
+#if FLUTTER_ALWAYS_USE_SKSHAPER
+  return true;
+#else
+  return UIDartState::Current()->enable_skparagraph();
+#endif
+#else
+  return false;
+#endif  // FLUTTER_ENABLE_SKSHAPER
 }
 
 ParagraphBuilder::~ParagraphBuilder() = default;
@@ -71,6 +71,23 @@ class ParagraphBuilder : public RefCountedDartWrappable<ParagraphBuilder> {
 
   void build(Dart_Handle paragraph_handle);
 
+  const txt::ParagraphStyle& paragraph_style() const {
+    return m_paragraphStyle;
+  }
+
+  // The style of the text added next, which is the most recently pushed style.
+  const txt::TextStyle& PeekStyle() { return m_paragraphBuilder->PeekStyle(); }
+
+  // Creates the builder for paragraphs of the given style, using the text
+  // shaper and the worker pool configured for the current isolate. Must be
+  // called on the UI thread.
+  static std::unique_ptr<txt::ParagraphBuilder> CreateTxtParagraphBuilder(
+      const txt::ParagraphStyle& style);
+
+  // Whether the builders created for the current isolate use SkParagraph
+  // rather than libtxt. Must be called on the UI thread.
+  static bool UsesSkParagraph();
+
   static void RegisterNatives(tonic::DartLibraryNatives* natives);
 
  private:
@@ -83,6 +100,7 @@ class ParagraphBuilder : public RefCountedDartWrappable<ParagraphBuilder> {
                             const std::u16string& ellipsis,
                             const std::string& locale);
 
+  txt::ParagraphStyle m_paragraphStyle;
   std::unique_ptr<txt::ParagraphBuilder> m_paragraphBuilder;
 };
 
@@ -17,7 +17,7 @@ import 'dart:collection' as collection;
 import 'dart:convert';
 import 'dart:developer' as developer;
 import 'dart:io'; // ignore: unused_import
-import 'dart:isolate' show SendPort;
+import 'dart:isolate' show SendPort, TransferableTypedData;
 import 'dart:math' as math;
 import 'dart:nativewrappers';
 import 'dart:typed_data';
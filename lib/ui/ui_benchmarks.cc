@@ -4,12 +4,16 @@
 
 #include "flutter/benchmarking/benchmarking.h"
 #include "flutter/common/settings.h"
+#include "flutter/lib/ui/painting/image_resize_kernels.h"
 #include "flutter/lib/ui/volatile_path_tracker.h"
+#include "flutter/lib/ui/window/platform_message_data.h"
 #include "flutter/lib/ui/window/platform_message_response_dart.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/dart_isolate_runner.h"
 #include "flutter/testing/fixture_test.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/tonic/typed_data/dart_byte_data.h"
 
 #include <future>
 
@@ -57,9 +61,9 @@ static void BM_PlatformMessageResponseDartComplete(benchmark::State& state) {
     FML_CHECK(successful);
     state.ResumeTiming();
 
-    // We skip timing everything above because the copy triggered by
+    // We skip timing everything above because the work triggered by
     // message->Complete is a task posted on the UI thread. The following wait
-    // for a UI task would let us know when that copy is done.
+    // for a UI task would let us know when that work is done.
     std::promise<bool> completed;
     task_runners.GetUITaskRunner()->PostTask(
         [&completed] { completed.set_value(true); });
@@ -67,6 +71,61 @@ static void BM_PlatformMessageResponseDartComplete(benchmark::State& state) {
   }
 }
 
+// Moves a payload of `state.range(0)` bytes from native code to Dart and back,
+// the way a platform message and its echoed response do. With
+// `copy_to_dart`, the payload is copied into the `ByteData` like it was before
+// it could be handed to Dart without a copy.
+static void PlatformMessageRoundTrip(benchmark::State& state,
+                                     bool copy_to_dart) {
+  ThreadHost thread_host("test",
+                         ThreadHost::Type::Platform | ThreadHost::Type::RASTER |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  TaskRunners task_runners("test", thread_host.platform_thread->GetTaskRunner(),
+                           thread_host.raster_thread->GetTaskRunner(),
+                           thread_host.ui_thread->GetTaskRunner(),
+                           thread_host.io_thread->GetTaskRunner());
+  Fixture fixture;
+  auto settings = fixture.CreateSettingsForFixture();
+  auto vm_ref = DartVMRef::Create(settings);
+  auto isolate =
+      testing::RunDartCodeInIsolate(vm_ref, settings, task_runners, "main", {},
+                                    testing::GetDefaultKernelFilePath(), {});
+
+  const size_t size = state.range(0);
+  bool successful = isolate->RunInIsolateScope([&]() -> bool {
+    for (auto _ : state) {
+      state.PauseTiming();
+      fml::MallocMapping payload =
+          fml::MallocMapping(static_cast<uint8_t*>(malloc(size)), size);
+      memset(const_cast<uint8_t*>(payload.GetMapping()), 0xac, size);
+      state.ResumeTiming();
+
+      Dart_EnterScope();
+      Dart_Handle byte_data =
+          copy_to_dart
+              ? tonic::DartByteData::Create(payload.GetMapping(), size)
+              : WrapPlatformMessageData(std::move(payload));
+      tonic::DartByteData data(byte_data);
+      fml::MallocMapping response = fml::MallocMapping::Copy(
+          data.data(), static_cast<size_t>(data.length_in_bytes()));
+      data.Release();
+      benchmark::DoNotOptimize(response.GetMapping());
+      Dart_ExitScope();
+    }
+    return true;
+  });
+  FML_CHECK(successful);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+
+static void BM_PlatformMessageRoundTrip(benchmark::State& state) {
+  PlatformMessageRoundTrip(state, false);
+}
+
+static void BM_PlatformMessageRoundTripWithCopy(benchmark::State& state) {
+  PlatformMessageRoundTrip(state, true);
+}
+
 static void BM_PathVolatilityTracker(benchmark::State& state) {
   ThreadHost thread_host("test",
                          ThreadHost::Type::Platform | ThreadHost::Type::RASTER |
@@ -112,9 +171,107 @@ static void BM_PathVolatilityTracker(benchmark::State& state) {
   }
 }
 
+// A 12 megapixel camera image, which is what image decodes usually shrink.
+static SkBitmap MakeSourceBitmap(SkAlphaType alpha_type) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::Make(4032, 3024, kRGBA_8888_SkColorType,
+                                       alpha_type, nullptr));
+  uint32_t state = 1;
+  auto* pixels = static_cast<uint8_t*>(bitmap.getPixels());
+  for (size_t i = 0; i < bitmap.computeByteSize(); i += 4) {
+    state = state * 1664525 + 1013904223;
+    pixels[i + 3] = 255;
+    pixels[i + 2] = state >> 24;
+    pixels[i + 1] = state >> 16;
+    pixels[i] = state >> 8;
+  }
+  return bitmap;
+}
+
+static SkBitmap MakeResizedBitmap(const SkBitmap& source, int divisor) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(source.info().makeWH(source.width() * 2 / divisor,
+                                          source.height() * 2 / divisor));
+  return bitmap;
+}
+
+// The path used by `ResizeRasterImage` before the dedicated kernels. A
+// divisor of 4 is an integer downscale by 2. A divisor of 3 is not.
+static void BM_DownscaleWithSkia(benchmark::State& state) {
+  const SkBitmap source = MakeSourceBitmap(kOpaque_SkAlphaType);
+  SkBitmap resized = MakeResizedBitmap(source, state.range(0));
+  for (auto _ : state) {
+    source.pixmap().scalePixels(
+        resized.pixmap(),
+        SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone));
+  }
+}
+
+static void BM_DownscaleWithKernels(benchmark::State& state) {
+  const SkBitmap source = MakeSourceBitmap(kOpaque_SkAlphaType);
+  SkBitmap resized = MakeResizedBitmap(source, state.range(0));
+  const ResizeFilter filter =
+      ChooseResizeFilter(source.dimensions(), resized.dimensions());
+  for (auto _ : state) {
+    DownscalePixels(source.pixmap(), resized.pixmap(), filter);
+  }
+}
+
+static void BM_DownscaleWithLanczos3(benchmark::State& state) {
+  const SkBitmap source = MakeSourceBitmap(kOpaque_SkAlphaType);
+  SkBitmap resized = MakeResizedBitmap(source, state.range(0));
+  for (auto _ : state) {
+    DownscalePixels(source.pixmap(), resized.pixmap(), ResizeFilter::kLanczos3);
+  }
+}
+
+// The swizzle and premultiply done by `MultiFrameCodec` for every frame.
+static void BM_ConvertPixelsWithSkia(benchmark::State& state) {
+  const SkBitmap source = MakeSourceBitmap(kUnpremul_SkAlphaType);
+  SkBitmap converted;
+  converted.allocPixels(source.info()
+                            .makeColorType(kBGRA_8888_SkColorType)
+                            .makeAlphaType(kPremul_SkAlphaType));
+  for (auto _ : state) {
+    source.pixmap().readPixels(converted.pixmap());
+  }
+}
+
+static void BM_ConvertPixelsWithKernels(benchmark::State& state) {
+  const SkBitmap source = MakeSourceBitmap(kUnpremul_SkAlphaType);
+  SkBitmap converted;
+  converted.allocPixels(source.info()
+                            .makeColorType(kBGRA_8888_SkColorType)
+                            .makeAlphaType(kPremul_SkAlphaType));
+  for (auto _ : state) {
+    ConvertPixels(source.pixmap(), converted.pixmap());
+  }
+}
+
 BENCHMARK(BM_PlatformMessageResponseDartComplete)
     ->Unit(benchmark::kMicrosecond);
 
+BENCHMARK(BM_PlatformMessageRoundTrip)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 64 << 20)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PlatformMessageRoundTripWithCopy)
+    ->RangeMultiplier(8)
+    ->Range(1 << 10, 64 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
 BENCHMARK(BM_PathVolatilityTracker)->Unit(benchmark::kMillisecond);
 
+BENCHMARK(BM_DownscaleWithSkia)
+    ->Arg(4)
+    ->Arg(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DownscaleWithKernels)
+    ->Arg(4)
+    ->Arg(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DownscaleWithLanczos3)->Arg(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ConvertPixelsWithSkia)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ConvertPixelsWithKernels)->Unit(benchmark::kMillisecond);
+
 }  // namespace flutter
@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include "flutter/fml/message_loop.h"
+#include "flutter/lib/ui/painting/picture_snapshot_queue.h"
 #include "flutter/lib/ui/window/platform_configuration.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_message_handler.h"
@@ -37,7 +38,9 @@ UIDartState::Context::Context(
     fml::WeakPtr<ImageGeneratorRegistry> image_generator_registry,
     std::string advisory_script_uri,
     std::string advisory_script_entrypoint,
-    std::shared_ptr<VolatilePathTracker> volatile_path_tracker)
+    std::shared_ptr<VolatilePathTracker> volatile_path_tracker,
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+    bool enable_software_rendering)
     : task_runners(task_runners),
       snapshot_delegate(snapshot_delegate),
       hint_freed_delegate(hint_freed_delegate),
@@ -47,7 +50,9 @@ UIDartState::Context::Context(
       image_generator_registry(image_generator_registry),
       advisory_script_uri(advisory_script_uri),
       advisory_script_entrypoint(advisory_script_entrypoint),
-      volatile_path_tracker(volatile_path_tracker) {}
+      volatile_path_tracker(volatile_path_tracker),
+      concurrent_task_runner(concurrent_task_runner),
+      enable_software_rendering(enable_software_rendering) {}
 
 UIDartState::UIDartState(
     TaskObserverAdd add_callback,
@@ -58,6 +63,7 @@ UIDartState::UIDartState(
     std::shared_ptr<IsolateNameServer> isolate_name_server,
     bool is_root_isolate,
     bool enable_skparagraph,
+    bool enable_parallel_text_layout,
     const UIDartState::Context& context)
     : add_callback_(std::move(add_callback)),
       remove_callback_(std::move(remove_callback)),
@@ -67,6 +73,7 @@ UIDartState::UIDartState(
       log_message_callback_(log_message_callback),
       isolate_name_server_(std::move(isolate_name_server)),
       enable_skparagraph_(enable_skparagraph),
+      enable_parallel_text_layout_(enable_parallel_text_layout),
       context_(std::move(context)) {
   AddOrRemoveTaskObserver(true /* add */);
 }
@@ -137,6 +144,21 @@ std::shared_ptr<VolatilePathTracker> UIDartState::GetVolatilePathTracker()
   return context_.volatile_path_tracker;
 }
 
+std::shared_ptr<fml::ConcurrentTaskRunner>
+UIDartState::GetConcurrentTaskRunner() const {
+  return context_.concurrent_task_runner;
+}
+
+std::shared_ptr<PictureSnapshotQueue> UIDartState::GetPictureSnapshotQueue() {
+  if (!picture_snapshot_queue_) {
+    picture_snapshot_queue_ = std::make_shared<PictureSnapshotQueue>(
+        context_.task_runners, context_.snapshot_delegate,
+        context_.enable_software_rendering ? context_.concurrent_task_runner
+                                           : nullptr);
+  }
+  return picture_snapshot_queue_;
+}
+
 void UIDartState::ScheduleMicrotask(Dart_Handle closure) {
   if (tonic::LogIfError(closure) || !Dart_IsClosure(closure)) {
     return;
@@ -244,4 +266,12 @@ bool UIDartState::enable_skparagraph() const {
   return enable_skparagraph_;
 }
 
+bool UIDartState::enable_parallel_text_layout() const {
+  return enable_parallel_text_layout_;
+}
+
+bool UIDartState::enable_software_rendering() const {
+  return context_.enable_software_rendering;
+}
+
 }  // namespace flutter
@@ -13,6 +13,7 @@
 #include "flutter/common/task_runners.h"
 #include "flutter/flow/skia_gpu_object.h"
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/hint_freed_delegate.h"
@@ -30,6 +31,7 @@
 namespace flutter {
 class FontSelector;
 class ImageGeneratorRegistry;
+class PictureSnapshotQueue;
 class PlatformConfiguration;
 
 class UIDartState : public tonic::DartState {
@@ -53,7 +55,9 @@ class UIDartState : public tonic::DartState {
             fml::WeakPtr<ImageGeneratorRegistry> image_generator_registry,
             std::string advisory_script_uri,
             std::string advisory_script_entrypoint,
-            std::shared_ptr<VolatilePathTracker> volatile_path_tracker);
+            std::shared_ptr<VolatilePathTracker> volatile_path_tracker,
+            std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
+            bool enable_software_rendering);
 
     /// The task runners used by the shell hosting this runtime controller. This
     /// may be used by the isolate to scheduled asynchronous texture uploads or
@@ -95,6 +99,16 @@ class UIDartState : public tonic::DartState {
 
     /// Cache for tracking path volatility.
     std::shared_ptr<VolatilePathTracker> volatile_path_tracker;
+
+    /// The task runner whose tasks may be executed concurrently on a pool of
+    /// worker threads. This is used for CPU bound work that does not need to
+    /// happen on any particular thread, such as image encoding.
+    std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner;
+
+    /// Whether the shell renders with a CPU backed surface. When set, nothing
+    /// drawn by the isolate is backed by a GPU texture, and so pictures may be
+    /// rasterized on any thread.
+    bool enable_software_rendering = false;
   };
 
   Dart_Port main_port() const { return main_port_; }
@@ -124,6 +138,10 @@ class UIDartState : public tonic::DartState {
 
   std::shared_ptr<VolatilePathTracker> GetVolatilePathTracker() const;
 
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentTaskRunner() const;
+
+  std::shared_ptr<PictureSnapshotQueue> GetPictureSnapshotQueue();
+
   fml::WeakPtr<SnapshotDelegate> GetSnapshotDelegate() const;
 
   fml::WeakPtr<HintFreedDelegate> GetHintFreedDelegate() const;
@@ -151,6 +169,10 @@ class UIDartState : public tonic::DartState {
 
   bool enable_skparagraph() const;
 
+  bool enable_parallel_text_layout() const;
+
+  bool enable_software_rendering() const;
+
   template <class T>
   static flutter::SkiaGPUObject<T> CreateGPUObject(sk_sp<T> object) {
     if (!object) {
@@ -171,6 +193,7 @@ class UIDartState : public tonic::DartState {
               std::shared_ptr<IsolateNameServer> isolate_name_server,
               bool is_root_isolate_,
               bool enable_skparagraph,
+              bool enable_parallel_text_layout,
               const UIDartState::Context& context);
 
   ~UIDartState() override;
@@ -197,7 +220,9 @@ class UIDartState : public tonic::DartState {
   LogMessageCallback log_message_callback_;
   const std::shared_ptr<IsolateNameServer> isolate_name_server_;
   const bool enable_skparagraph_;
+  const bool enable_parallel_text_layout_;
   UIDartState::Context context_;
+  std::shared_ptr<PictureSnapshotQueue> picture_snapshot_queue_;
 
   void AddOrRemoveTaskObserver(bool add);
 };
@@ -8,6 +8,7 @@
 
 #include "flutter/lib/ui/compositing/scene.h"
 #include "flutter/lib/ui/ui_dart_state.h"
+#include "flutter/lib/ui/window/platform_message_data.h"
 #include "flutter/lib/ui/window/platform_message_response_dart.h"
 #include "flutter/lib/ui/window/viewport_metrics.h"
 #include "flutter/lib/ui/window/window.h"
@@ -190,10 +191,6 @@ void _RespondToKeyData(Dart_NativeArguments args) {
   tonic::DartCallStatic(&RespondToKeyData, args);
 }
 
-Dart_Handle ToByteData(const fml::Mapping& buffer) {
-  return tonic::DartByteData::Create(buffer.GetMapping(), buffer.GetSize());
-}
-
 }  // namespace
 
 PlatformConfigurationClient::~PlatformConfigurationClient() {}
@@ -316,7 +313,8 @@ void PlatformConfiguration::DispatchPlatformMessage(
   }
   tonic::DartState::Scope scope(dart_state);
   Dart_Handle data_handle =
-      (message->hasData()) ? ToByteData(message->data()) : Dart_Null();
+      (message->hasData()) ? WrapPlatformMessageData(message->releaseData())
+                           : Dart_Null();
   if (Dart_IsError(data_handle)) {
     FML_DLOG(WARNING)
         << "Dropping platform message because of a Dart error on channel: "
@@ -347,7 +345,8 @@ void PlatformConfiguration::DispatchSemanticsAction(int32_t id,
   tonic::DartState::Scope scope(dart_state);
 
   Dart_Handle args_handle =
-      (args.GetSize() <= 0) ? Dart_Null() : ToByteData(args);
+      (args.GetSize() <= 0) ? Dart_Null()
+                            : WrapPlatformMessageData(std::move(args));
 
   if (Dart_IsError(args_handle)) {
     return;
@@ -10,6 +10,7 @@
 
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/lib/ui/window/platform_message_response.h"
 
 namespace flutter {
@@ -30,6 +31,16 @@ class PlatformMessage {
   const fml::RefPtr<PlatformMessageResponse>& response() const {
     return response_;
   }
+  void set_response(fml::RefPtr<PlatformMessageResponse> response) {
+    response_ = std::move(response);
+  }
+
+  // When the message was sent, and the id of the trace flow that follows it
+  // from the sender to the handler and the response. Set by the shell.
+  fml::TimePoint send_time() const { return send_time_; }
+  void set_send_time(fml::TimePoint send_time) { send_time_ = send_time; }
+  uint64_t trace_flow_id() const { return trace_flow_id_; }
+  void set_trace_flow_id(uint64_t id) { trace_flow_id_ = id; }
 
   fml::MallocMapping releaseData() { return std::move(data_); }
 
@@ -38,6 +49,8 @@ class PlatformMessage {
   fml::MallocMapping data_;
   bool hasData_;
   fml::RefPtr<PlatformMessageResponse> response_;
+  fml::TimePoint send_time_;
+  uint64_t trace_flow_id_ = 0;
 };
 
 }  // namespace flutter
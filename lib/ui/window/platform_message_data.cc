@@ -0,0 +1,59 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/window/platform_message_data.h"
+
+#include <cstdlib>
+
+#include "third_party/tonic/typed_data/dart_byte_data.h"
+
+namespace flutter {
+namespace {
+
+// Payloads smaller than this are copied into the Dart heap. This matches the
+// threshold used by |tonic::DartByteData::Create|.
+constexpr size_t kExternalSizeThreshold = 1000;
+
+void FreeMallocData(void* isolate_callback_data, void* peer) {
+  free(peer);
+}
+
+void DeleteMapping(void* isolate_callback_data, void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
+}  // namespace
+
+Dart_Handle WrapPlatformMessageData(fml::MallocMapping data) {
+  const size_t size = data.GetSize();
+  if (size < kExternalSizeThreshold) {
+    return tonic::DartByteData::Create(data.GetMapping(), size);
+  }
+  uint8_t* bytes = data.Release();
+  Dart_Handle byte_data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, bytes, size, FreeMallocData);
+  // The finalizer only owns the data once the typed data is made.
+  if (Dart_IsError(byte_data)) {
+    FreeMallocData(nullptr, bytes);
+  }
+  return byte_data;
+}
+
+Dart_Handle WrapPlatformMessageData(std::unique_ptr<fml::Mapping> data) {
+  const size_t size = data->GetSize();
+  if (size < kExternalSizeThreshold || !data->IsWritable()) {
+    return tonic::DartByteData::Create(data->GetMapping(), size);
+  }
+  // The mapping is writable, so Dart may be given direct access to it.
+  void* bytes = const_cast<uint8_t*>(data->GetMapping());
+  fml::Mapping* peer = data.release();
+  Dart_Handle byte_data = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, bytes, size, peer, size, DeleteMapping);
+  if (Dart_IsError(byte_data)) {
+    DeleteMapping(nullptr, peer);
+  }
+  return byte_data;
+}
+
+}  // namespace flutter
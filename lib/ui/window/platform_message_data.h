@@ -0,0 +1,50 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_WINDOW_PLATFORM_MESSAGE_DATA_H_
+#define FLUTTER_LIB_UI_WINDOW_PLATFORM_MESSAGE_DATA_H_
+
+#include <memory>
+
+#include "flutter/fml/mapping.h"
+#include "third_party/dart/runtime/include/dart_api.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Creates the `ByteData` that the framework receives for the
+///             payload of a platform message.
+///
+///             Large payloads are handed to Dart as external typed data that
+///             owns the buffer, so that they are not copied. The buffer is
+///             freed when the `ByteData` is garbage collected. Small payloads
+///             are copied into the Dart heap, where they are cheaper to
+///             allocate and collect.
+///
+///             Must be called with a current isolate.
+///
+/// @param[in]  data  The payload.
+///
+/// @return     The `ByteData`, or an error handle.
+///
+Dart_Handle WrapPlatformMessageData(fml::MallocMapping data);
+
+//------------------------------------------------------------------------------
+/// @brief      Creates the `ByteData` that the framework receives for the
+///             payload of a platform message response.
+///
+///             Like the overload taking a `MallocMapping`, except that
+///             mappings that are not writable, such as read-only file
+///             mappings, are always copied because Dart may write to the
+///             `ByteData`.
+///
+/// @param[in]  data  The payload. Must not be null.
+///
+/// @return     The `ByteData`, or an error handle.
+///
+Dart_Handle WrapPlatformMessageData(std::unique_ptr<fml::Mapping> data);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_WINDOW_PLATFORM_MESSAGE_DATA_H_
@@ -8,9 +8,9 @@
 
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/lib/ui/window/platform_message_data.h"
 #include "third_party/tonic/dart_state.h"
 #include "third_party/tonic/logging/dart_invoke.h"
-#include "third_party/tonic/typed_data/dart_byte_data.h"
 
 namespace flutter {
 
@@ -42,8 +42,7 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
         }
         tonic::DartState::Scope scope(dart_state);
 
-        Dart_Handle byte_buffer =
-            tonic::DartByteData::Create(data->GetMapping(), data->GetSize());
+        Dart_Handle byte_buffer = WrapPlatformMessageData(std::move(data));
         tonic::DartInvoke(callback.Release(), {byte_buffer});
       }));
 }
@@ -16,6 +16,13 @@ typedef DrainChannelCallback = Future<void> Function(ByteData? data, PlatformMes
 
 typedef ChannelCallback = void Function(ByteData? data, PlatformMessageResponseCallback callback);
 
+enum ChannelLane {
+  input,
+  frameCritical,
+  normal,
+  background,
+}
+
 class _ChannelCallbackRecord {
   _ChannelCallbackRecord(this._callback) : _zone = Zone.current;
   final ChannelCallback _callback;
@@ -41,9 +48,11 @@ class _StoredMessage {
 }
 
 class _Channel {
-  _Channel([ this._capacity = ChannelBuffers.kDefaultBufferSize ])
+  _Channel(this._buffers, [ this._capacity = ChannelBuffers.kDefaultBufferSize ])
     : _queue = collection.ListQueue<_StoredMessage>(_capacity);
 
+  final ChannelBuffers _buffers;
+
   final collection.ListQueue<_StoredMessage> _queue;
 
   int get length => _queue.length;
@@ -57,6 +66,8 @@ class _Channel {
     _dropOverflowMessages(newSize);
   }
 
+  ChannelLane lane = ChannelLane.normal;
+
   bool _draining = false;
 
   bool push(_StoredMessage message) {
@@ -101,18 +112,18 @@ class _Channel {
   void _drain() {
     assert(!_draining);
     _draining = true;
-    scheduleMicrotask(_drainStep);
+    _buffers._scheduleDrain(this);
   }
 
-  void _drainStep() {
+  bool _drainStep() {
     assert(_draining);
     if (_queue.isNotEmpty && _channelCallbackRecord != null) {
       final _StoredMessage message = pop();
       _channelCallbackRecord!.invoke(message.data, message.invoke);
-      scheduleMicrotask(_drainStep);
-    } else {
-      _draining = false;
+      return true;
     }
+    _draining = false;
+    return false;
   }
 }
 
@@ -125,8 +136,59 @@ class ChannelBuffers {
 
   final Map<String, _Channel> _channels = <String, _Channel>{};
 
+  final List<collection.ListQueue<_Channel>> _drainingChannels = List<collection.ListQueue<_Channel>>.generate(
+    ChannelLane.values.length,
+    (int index) => collection.ListQueue<_Channel>(),
+  );
+
+  bool _drainMicrotaskScheduled = false;
+
+  bool _drainTimerScheduled = false;
+
+  void _scheduleDrain(_Channel channel) {
+    _drainingChannels[channel.lane.index].addLast(channel);
+    _scheduleDrainStep();
+  }
+
+  void _scheduleDrainStep() {
+    for (int index = 0; index < ChannelLane.background.index; index += 1) {
+      if (_drainingChannels[index].isNotEmpty) {
+        if (!_drainMicrotaskScheduled) {
+          _drainMicrotaskScheduled = true;
+          scheduleMicrotask(() {
+            _drainMicrotaskScheduled = false;
+            _drainStep();
+          });
+        }
+        return;
+      }
+    }
+    if (_drainingChannels[ChannelLane.background.index].isNotEmpty && !_drainTimerScheduled) {
+      _drainTimerScheduled = true;
+      Timer.run(() {
+        _drainTimerScheduled = false;
+        _drainStep();
+      });
+    }
+  }
+
+  void _drainStep() {
+    try {
+      for (final collection.ListQueue<_Channel> channels in _drainingChannels) {
+        if (channels.isNotEmpty) {
+          final _Channel channel = channels.removeFirst();
+          if (channel._drainStep())
+            channels.addLast(channel);
+          break;
+        }
+      }
+    } finally {
+      _scheduleDrainStep();
+    }
+  }
+
   void push(String name, ByteData? data, PlatformMessageResponseCallback callback) {
-    final _Channel channel = _channels.putIfAbsent(name, () => _Channel());
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
     if (channel.push(_StoredMessage(data, callback))) {
       assert(() {
         print(
@@ -143,7 +205,7 @@ class ChannelBuffers {
   }
 
   void setListener(String name, ChannelCallback callback) {
-    final _Channel channel = _channels.putIfAbsent(name, () => _Channel());
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
     channel.setListener(callback);
   }
 
@@ -212,6 +274,30 @@ class ChannelBuffers {
             throw Exception('Invalid arguments for \'overflow\' method sent to $kControlChannelName (second argument must be a boolean)');
           allowOverflow(channelName, bytes[index] == 0x01);
           break;
+        case 'lane':
+          if (bytes[index] != 0x0C) // 12 = value code for list
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (arguments must be a two-element list, channel name and lane)');
+          index += 1;
+          if (bytes[index] < 0x02) // We ignore extra arguments, in case we need to support them in the future, hence <2 rather than !=2.
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (arguments must be a two-element list, channel name and lane)');
+          index += 1;
+          if (bytes[index] != 0x07) // 7 = value code for string
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (first argument must be a string)');
+          index += 1;
+          final int channelNameLength = bytes[index];
+          if (channelNameLength >= 254) // lengths greater than 253 have more elaborate encoding
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (channel name must be less than 254 characters long)');
+          index += 1;
+          final String channelName = utf8.decode(bytes.sublist(index, index + channelNameLength));
+          index += channelNameLength;
+          if (bytes[index] != 0x03) // 3 = value code for uint32
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (second argument must be an integer in the range 0 to ${ChannelLane.values.length - 1})');
+          index += 1;
+          final int lane = data.getUint32(index, Endian.host);
+          if (lane >= ChannelLane.values.length)
+            throw Exception('Invalid arguments for \'lane\' method sent to $kControlChannelName (second argument must be an integer in the range 0 to ${ChannelLane.values.length - 1})');
+          setLane(channelName, ChannelLane.values[lane]);
+          break;
         default:
           throw Exception('Unrecognized method \'$methodName\' sent to $kControlChannelName');
       }
@@ -228,7 +314,7 @@ class ChannelBuffers {
   void resize(String name, int newSize) {
     _Channel? channel = _channels[name];
     if (channel == null) {
-      channel = _Channel(newSize);
+      channel = _Channel(this, newSize);
       _channels[name] = channel;
     } else {
       channel.capacity = newSize;
@@ -239,13 +325,18 @@ class ChannelBuffers {
     assert(() {
       _Channel? channel = _channels[name];
       if (channel == null && allowed) {
-        channel = _Channel();
+        channel = _Channel(this);
         _channels[name] = channel;
       }
       channel?.debugEnableDiscardWarnings = !allowed;
       return true;
     }());
   }
+
+  void setLane(String name, ChannelLane lane) {
+    final _Channel channel = _channels.putIfAbsent(name, () => _Channel(this));
+    channel.lane = lane;
+  }
 }
 
 final ChannelBuffers channelBuffers = ChannelBuffers();
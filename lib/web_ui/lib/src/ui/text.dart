@@ -729,6 +729,64 @@ abstract class ParagraphBuilder {
   });
 }
 
+class ParagraphBatch {
+  ParagraphBatch(ParagraphStyle style, List<TextStyle> textStyles)
+      : _style = style,
+        _textStyles = List<TextStyle>.of(textStyles);
+
+  final ParagraphStyle _style;
+  final List<TextStyle> _textStyles;
+
+  static const int metricsPerParagraph = 7;
+
+  // The web engines have no batch entry point, so each paragraph is built and
+  // measured on its own.
+  Float64List layout(String text, Int32List runs, Float64List widths) {
+    final Float64List metrics =
+        Float64List(widths.length * metricsPerParagraph);
+    int position = 0;
+    int textOffset = 0;
+    for (int i = 0; i < widths.length; i++) {
+      if (position >= runs.length) {
+        throw ArgumentError('runs does not describe every paragraph');
+      }
+      final int runCount = runs[position++];
+      if (runCount < 0 || runCount * 2 > runs.length - position) {
+        throw ArgumentError('runs does not describe every paragraph');
+      }
+      final ParagraphBuilder builder = ParagraphBuilder(_style);
+      for (int run = 0; run < runCount; run++, position += 2) {
+        final int length = runs[position];
+        final int style = runs[position + 1];
+        if (length < 0 || length > text.length - textOffset) {
+          throw ArgumentError('runs extend past the end of the text');
+        }
+        if (style < 0 || style >= _textStyles.length) {
+          throw ArgumentError('runs refer to a missing text style');
+        }
+        builder.pushStyle(_textStyles[style]);
+        builder.addText(text.substring(textOffset, textOffset + length));
+        builder.pop();
+        textOffset += length;
+      }
+      final Paragraph paragraph = builder.build();
+      paragraph.layout(ParagraphConstraints(width: widths[i]));
+      int metric = i * metricsPerParagraph;
+      metrics[metric++] = paragraph.height;
+      metrics[metric++] = paragraph.longestLine;
+      metrics[metric++] = paragraph.minIntrinsicWidth;
+      metrics[metric++] = paragraph.maxIntrinsicWidth;
+      metrics[metric++] = paragraph.alphabeticBaseline;
+      metrics[metric++] = paragraph.ideographicBaseline;
+      metrics[metric++] = paragraph.didExceedMaxLines ? 1.0 : 0.0;
+    }
+    if (position != runs.length || textOffset != text.length) {
+      throw ArgumentError('runs do not cover the text');
+    }
+    return metrics;
+  }
+}
+
 Future<void> loadFontFromList(Uint8List list, {String? fontFamily}) {
   if (engine.useCanvasKit) {
     return engine.skiaFontCollection
@@ -238,6 +238,10 @@ class IsolateNameServer {
   static bool removePortNameMapping(String name) {
     throw UnimplementedError();
   }
+
+  static bool sendBufferToPortByName(String name, dynamic buffer) {
+    throw UnimplementedError();
+  }
 }
 
 SingletonFlutterWindow get window => engine.window;
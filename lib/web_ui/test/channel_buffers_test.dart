@@ -339,6 +339,51 @@ void testMain() {
     expect(log, const <String>['allowOverflow abcdef false']);
   });
 
+  test('ChannelBuffers.handleMessage for lane', () async {
+    final List<String> log = <String>[];
+    final ui.ChannelBuffers buffers = _TestChannelBuffers(log);
+    // Created as follows:
+    //   print(StandardMethodCodec().encodeMethodCall(MethodCall('lane', ['abcdef', 3])).buffer.asUint8List());
+    // ...with three 0xFF bytes on either side to ensure the method works with an offset on the underlying buffer.
+    buffers.handleMessage(ByteData.sublistView(Uint8List.fromList(<int>[255, 255, 255, 7, 4, 108, 97, 110, 101, 12, 2, 7, 6, 97, 98, 99, 100, 101, 102, 3, 3, 0, 0, 0, 255, 255, 255]), 3, 24));
+    expect(log, const <String>['setLane abcdef ChannelLane.background']);
+  });
+
+  test('ChannelBuffers drains urgent lanes first', () async {
+    final List<String> log = <String>[];
+    final ui.ChannelBuffers buffers = ui.ChannelBuffers();
+    buffers.setLane('b', ui.ChannelLane.input);
+    for (final String name in <String>['a', 'b']) {
+      buffers.push(name, _makeByteData('${name}1'), (ByteData? data) { });
+      buffers.push(name, _makeByteData('${name}2'), (ByteData? data) { });
+    }
+    for (final String name in <String>['a', 'b']) {
+      buffers.setListener(name, (ByteData? data, ui.PlatformMessageResponseCallback callback) {
+        log.add(utf8.decode(data!.buffer.asUint8List()));
+      });
+    }
+    await Future<void>.delayed(Duration.zero);
+    expect(log, <String>['b1', 'b2', 'a1', 'a2']);
+  });
+
+  test('ChannelBuffers drains the background lane one message per task', () async {
+    final List<String> log = <String>[];
+    final ui.ChannelBuffers buffers = ui.ChannelBuffers();
+    buffers.setLane('a', ui.ChannelLane.background);
+    buffers.push('a', _makeByteData('a1'), (ByteData? data) { });
+    buffers.push('a', _makeByteData('a2'), (ByteData? data) { });
+    buffers.setListener('a', (ByteData? data, ui.PlatformMessageResponseCallback callback) {
+      log.add(utf8.decode(data!.buffer.asUint8List()));
+    });
+    scheduleMicrotask(() {
+      log.add('microtask');
+    });
+    await Future<void>.delayed(Duration.zero);
+    expect(log, <String>['microtask', 'a1']);
+    await Future<void>.delayed(Duration.zero);
+    expect(log, <String>['microtask', 'a1', 'a2']);
+  });
+
   test('ChannelBuffers uses the right zones', () async {
     final List<String> log = <String>[];
     final ui.ChannelBuffers buffers = ui.ChannelBuffers();
@@ -381,4 +426,9 @@ class _TestChannelBuffers extends ui.ChannelBuffers {
   void allowOverflow(String name, bool allowed) {
     log.add('allowOverflow $name $allowed');
   }
+
+  @override
+  void setLane(String name, ui.ChannelLane lane) {
+    log.add('setLane $name $lane');
+  }
 }
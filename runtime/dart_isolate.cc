@@ -92,26 +92,28 @@ std::weak_ptr<DartIsolate> DartIsolate::SpawnIsolate(
     std::optional<std::string> dart_entrypoint_library,
     std::unique_ptr<IsolateConfiguration> isolate_configration) const {
   return CreateRunningRootIsolate(
-      settings,                                          //
-      GetIsolateGroupData().GetIsolateSnapshot(),        //
-      std::move(platform_configuration),                 //
-      flags,                                             //
-      isolate_create_callback,                           //
-      isolate_shutdown_callback,                         //
-      dart_entrypoint,                                   //
-      dart_entrypoint_library,                           //
-      std::move(isolate_configration),                   //
-      UIDartState::Context{GetTaskRunners(),             //
-                           snapshot_delegate,            //
-                           hint_freed_delegate,          //
-                           GetIOManager(),               //
-                           GetSkiaUnrefQueue(),          //
-                           GetImageDecoder(),            //
-                           GetImageGeneratorRegistry(),  //
-                           advisory_script_uri,          //
-                           advisory_script_entrypoint,   //
-                           GetVolatilePathTracker()},    //
-      this                                               //
+      settings,                                           //
+      GetIsolateGroupData().GetIsolateSnapshot(),         //
+      std::move(platform_configuration),                  //
+      flags,                                              //
+      isolate_create_callback,                            //
+      isolate_shutdown_callback,                          //
+      dart_entrypoint,                                    //
+      dart_entrypoint_library,                            //
+      std::move(isolate_configration),                    //
+      UIDartState::Context{GetTaskRunners(),              //
+                           snapshot_delegate,             //
+                           hint_freed_delegate,           //
+                           GetIOManager(),                //
+                           GetSkiaUnrefQueue(),           //
+                           GetImageDecoder(),             //
+                           GetImageGeneratorRegistry(),   //
+                           advisory_script_uri,           //
+                           advisory_script_entrypoint,    //
+                           GetVolatilePathTracker(),      //
+                           GetConcurrentTaskRunner(),     //
+                           enable_software_rendering()},  //
+      this                                                //
   );
 }
 
@@ -313,6 +315,7 @@ DartIsolate::DartIsolate(const Settings& settings,
                   DartVMRef::GetIsolateNameServer(),
                   is_root_isolate,
                   settings.enable_skparagraph,
+                  settings.enable_parallel_text_layout,
                   std::move(context)),
       may_insecurely_connect_to_all_domains_(
           settings.may_insecurely_connect_to_all_domains),
@@ -37,6 +37,11 @@ const std::string_view ServiceProtocol::kGetSkSLsExtensionName =
 const std::string_view
     ServiceProtocol::kEstimateRasterCacheMemoryExtensionName =
         "_flutter.estimateRasterCacheMemory";
+const std::string_view ServiceProtocol::kGetPlatformMessageStatsExtensionName =
+    "_flutter.getPlatformMessageStats";
+const std::string_view
+    ServiceProtocol::kSetPlatformMessageStatsEnabledExtensionName =
+        "_flutter.setPlatformMessageStatsEnabled";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -56,6 +61,8 @@ ServiceProtocol::ServiceProtocol()
           kGetDisplayRefreshRateExtensionName,
           kGetSkSLsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
+          kGetPlatformMessageStatsExtensionName,
+          kSetPlatformMessageStatsEnabledExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
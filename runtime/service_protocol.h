@@ -29,6 +29,8 @@ class ServiceProtocol {
   static const std::string_view kGetDisplayRefreshRateExtensionName;
   static const std::string_view kGetSkSLsExtensionName;
   static const std::string_view kEstimateRasterCacheMemoryExtensionName;
+  static const std::string_view kGetPlatformMessageStatsExtensionName;
+  static const std::string_view kSetPlatformMessageStatsEnabledExtensionName;
 
   class Handler {
    public:
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/common/engine.h"
 
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -19,9 +20,11 @@
 #include "flutter/fml/unique_fd.h"
 #include "flutter/lib/snapshot/snapshot.h"
 #include "flutter/lib/ui/text/font_collection.h"
+#include "flutter/lib/ui/text/font_data_registry.h"
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/shell.h"
+#include "minikin/Layout.h"
 #include "rapidjson/document.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -40,6 +43,24 @@ namespace {
 fml::MallocMapping MakeMapping(const std::string& str) {
   return fml::MallocMapping::Copy(str.c_str(), str.length());
 }
+
+// The shaping cache is shared by every engine in the process, so its counters
+// are traced with a single counter id. They are only traced when words were
+// looked up since they were last traced, which is not the case for most
+// frames.
+void TraceShapingCacheStats() {
+#if !FLUTTER_RELEASE
+  static std::atomic<uint64_t> traced_lookups = 0;
+  minikin::Layout::CacheStats stats = minikin::Layout::getCacheStats();
+  const uint64_t lookups = stats.hits + stats.misses;
+  if (traced_lookups.exchange(lookups) == lookups) {
+    return;
+  }
+  FML_TRACE_COUNTER("flutter", "ShapingCache", 0, "Hits", stats.hits,
+                    "Misses", stats.misses, "Evictions", stats.evictions,
+                    "Entries", stats.entries, "KBytes", stats.bytes >> 10);
+#endif  // !FLUTTER_RELEASE
+}
 }  // namespace
 
 Engine::Engine(
@@ -106,7 +127,11 @@ Engine::Engine(Delegate& delegate,
           settings_.advisory_script_uri,           // advisory script uri
           settings_.advisory_script_entrypoint,    // advisory script entrypoint
           std::move(volatile_path_tracker),        // volatile path tracker
+          vm.GetConcurrentWorkerTaskRunner(),      // concurrent task runner
+          settings_.enable_software_rendering,     // software rendering
       });
+  font_collection_->GetFontCollection()->SetHyphenationPatternsDirectory(
+      settings_.hyphenation_patterns_path);
 }
 
 std::unique_ptr<Engine> Engine::Spawn(
@@ -146,6 +171,12 @@ fml::WeakPtr<Engine> Engine::GetWeakPtr() const {
 void Engine::SetupDefaultFontManager() {
   TRACE_EVENT0("flutter", "Engine::SetupDefaultFontManager");
   font_collection_->SetupDefaultFontManager();
+  DartVM* vm = runtime_controller_ ? runtime_controller_->GetDartVM() : nullptr;
+  if (!settings_.fallback_font_index_path.empty() && vm) {
+    font_collection_->GetFontCollection()->SetFallbackFontIndexDirectory(
+        settings_.fallback_font_index_path,
+        vm->GetConcurrentWorkerTaskRunner());
+  }
 }
 
 std::shared_ptr<AssetManager> Engine::GetAssetManager() {
@@ -224,6 +255,8 @@ Engine::RunStatus Engine::Run(RunConfiguration configuration) {
 void Engine::BeginFrame(fml::TimePoint frame_time) {
   TRACE_EVENT0("flutter", "Engine::BeginFrame");
   runtime_controller_->BeginFrame(frame_time);
+  TraceShapingCacheStats();
+  FontDataRegistry::GetInstance().TraceCountersToTimeline();
 }
 
 void Engine::ReportTimings(std::vector<int64_t> timings) {
@@ -0,0 +1,157 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_batcher.h"
+
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+PlatformMessageBatcher::PlatformMessageBatcher(
+    fml::BasicTaskRunner* task_runner,
+    Handler handler,
+    BackgroundScheduler background_scheduler)
+    : task_runner_(task_runner),
+      handler_(std::move(handler)),
+      background_scheduler_(std::move(background_scheduler)) {}
+
+PlatformMessageBatcher::~PlatformMessageBatcher() = default;
+
+void PlatformMessageBatcher::SetMode(const std::string& channel, Mode mode) {
+  std::scoped_lock lock(mutex_);
+  ChannelConfig& config = configs_[channel];
+  config.mode = mode;
+  if (config.mode == Mode::kNone && config.lane == Lane::kNormal) {
+    configs_.erase(channel);
+  }
+}
+
+void PlatformMessageBatcher::SetLane(const std::string& channel, Lane lane) {
+  std::scoped_lock lock(mutex_);
+  ChannelConfig& config = configs_[channel];
+  config.lane = lane;
+  if (config.mode == Mode::kNone && config.lane == Lane::kNormal) {
+    configs_.erase(channel);
+  }
+}
+
+void PlatformMessageBatcher::DispatchPlatformMessage(
+    std::unique_ptr<PlatformMessage> message) {
+  std::weak_ptr<PlatformMessageBatcher> weak_batcher = weak_from_this();
+  std::unique_ptr<PlatformMessage> replaced;
+  bool post_drain = false;
+  bool schedule_background = false;
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = configs_.find(message->channel());
+    const ChannelConfig config =
+        found == configs_.end() ? ChannelConfig() : found->second;
+    // Messages on batched channels and on the other lanes wait in their lane
+    // until it is delivered.
+    if (config.mode != Mode::kNone || config.lane != Lane::kNormal) {
+      auto& lane = lanes_[static_cast<size_t>(config.lane)];
+      if (config.mode == Mode::kLatestOnly) {
+        for (auto& pending : lane) {
+          if (pending->channel() == message->channel()) {
+            replaced = std::move(pending);
+            pending = std::move(message);
+            break;
+          }
+        }
+      }
+      if (message) {
+        lane.push_back(std::move(message));
+      }
+      if (config.lane == Lane::kBackground) {
+        schedule_background = !replaced && lane.size() == 1;
+      } else {
+        post_drain = !drain_posted_;
+        drain_posted_ = true;
+      }
+    }
+  }
+
+  if (replaced && replaced->response()) {
+    replaced->response()->CompleteEmpty();
+  }
+
+  if (message) {
+    // Messages on channels that are not batched are posted as they are. A
+    // batch that was posted earlier is drained before them, so messages on
+    // a channel that stopped being batched stay in order.
+    task_runner_->PostTask(fml::MakeCopyable(
+        [weak_batcher, message = std::move(message)]() mutable {
+          if (auto batcher = weak_batcher.lock()) {
+            batcher->DeliverUrgentMessages();
+            batcher->handler_(std::move(message));
+          }
+        }));
+  } else if (post_drain) {
+    task_runner_->PostTask([weak_batcher]() {
+      if (auto batcher = weak_batcher.lock()) {
+        batcher->Drain();
+      }
+    });
+  } else if (schedule_background) {
+    fml::closure deliver = [weak_batcher]() {
+      if (auto batcher = weak_batcher.lock()) {
+        batcher->DeliverBackgroundMessages(fml::TimePoint::Max());
+      }
+    };
+    if (background_scheduler_) {
+      background_scheduler_(std::move(deliver));
+    } else {
+      task_runner_->PostTask(std::move(deliver));
+    }
+  }
+}
+
+void PlatformMessageBatcher::DeliverUrgentMessages() {
+  DeliverLanes(Lane::kFrameCritical);
+}
+
+void PlatformMessageBatcher::DeliverBackgroundMessages(
+    fml::TimePoint deadline) {
+  TRACE_EVENT0("flutter", "PlatformMessageBatcher::DeliverBackgroundMessages");
+  // Messages that are dispatched while the background lane is delivered are
+  // delivered too, if there is time left.
+  auto& lane = lanes_[static_cast<size_t>(Lane::kBackground)];
+  while (fml::TimePoint::Now() < deadline) {
+    std::unique_ptr<PlatformMessage> message;
+    {
+      std::scoped_lock lock(mutex_);
+      if (lane.empty()) {
+        return;
+      }
+      message = std::move(lane.front());
+      lane.pop_front();
+    }
+    handler_(std::move(message));
+  }
+}
+
+void PlatformMessageBatcher::Drain() {
+  TRACE_EVENT0("flutter", "PlatformMessageBatcher::Drain");
+  {
+    std::scoped_lock lock(mutex_);
+    drain_posted_ = false;
+  }
+  DeliverLanes(Lane::kNormal);
+}
+
+void PlatformMessageBatcher::DeliverLanes(Lane last) {
+  for (size_t i = 0; i <= static_cast<size_t>(last); i++) {
+    std::deque<std::unique_ptr<PlatformMessage>> messages;
+    {
+      std::scoped_lock lock(mutex_);
+      messages.swap(lanes_[i]);
+    }
+    for (auto& message : messages) {
+      handler_(std::move(message));
+    }
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,175 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_BATCHER_H_
+#define FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/lib/ui/window/platform_message.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Hands the platform messages that the platform view sends to the
+///             framework over to the UI thread, batching the messages on busy
+///             channels.
+///
+///             Without batching every message is a task of its own, so
+///             channels that send many small messages per frame, like sensor
+///             streams, post dozens of tasks. Messages on a batched channel
+///             that are dispatched before the UI thread gets to the batch are
+///             instead delivered together, in a single task.
+///
+///             Channels that carry state rather than events can keep only
+///             their latest message. A new message on such a channel replaces
+///             the message on the same channel that is still waiting in the
+///             batch, and the response of the replaced message is completed
+///             empty.
+///
+///             Channels can also be put in a lane, so that plugin traffic does
+///             not hold up the frame. Messages on the input and frame-critical
+///             lanes are delivered before the messages on the normal lane that
+///             were dispatched earlier, and before the next frame. Messages on
+///             the background lane wait until the UI thread is idle, or until
+///             their deadline passes.
+///
+///             Messages on the same channel are always delivered in the order
+///             they were dispatched, unless the channel leaves the background
+///             lane while messages wait in it. This class is thread-safe, and
+///             must be created with `std::make_shared`.
+///
+/// @see        Shell::SetPlatformMessageBatching
+///
+class PlatformMessageBatcher
+    : public std::enable_shared_from_this<PlatformMessageBatcher> {
+ public:
+  /// How the messages on a channel are delivered.
+  enum class Mode {
+    /// Each message is delivered in a task of its own. This is the default.
+    kNone,
+    /// Messages are delivered in batches.
+    kBatch,
+    /// Messages are delivered in batches, which hold only the latest message
+    /// on the channel.
+    kLatestOnly,
+  };
+
+  /// How urgently the messages on a channel are delivered, from the most
+  /// urgent to the least urgent.
+  enum class Lane {
+    /// Messages that carry user input.
+    kInput,
+    /// Messages that the next frame depends on.
+    kFrameCritical,
+    /// Messages that are delivered in the order they were dispatched. This is
+    /// the default.
+    kNormal,
+    /// Messages that wait until the UI thread is idle.
+    kBackground,
+  };
+
+  static constexpr size_t kLaneCount = 4;
+
+  using Handler = std::function<void(std::unique_ptr<PlatformMessage>)>;
+
+  /// Schedules a closure that delivers the messages on the background lane.
+  /// It is called when messages start waiting in the lane, and should run the
+  /// closure on the task runner when the messages have waited long enough.
+  using BackgroundScheduler = std::function<void(fml::closure)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a batcher that delivers messages to a handler.
+  ///
+  /// @param[in]  task_runner           The task runner on which to call the
+  ///                                   handler. It must outlive the batcher.
+  /// @param[in]  handler               The handler of the messages.
+  /// @param[in]  background_scheduler  Schedules the delivery of the
+  ///                                   background lane. If null, the messages
+  ///                                   on it are delivered in a later task.
+  ///
+  PlatformMessageBatcher(fml::BasicTaskRunner* task_runner,
+                         Handler handler,
+                         BackgroundScheduler background_scheduler = nullptr);
+
+  ~PlatformMessageBatcher();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets how the messages on a channel are delivered. Messages
+  ///             that are already waiting in the batch stay in it.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  mode     The mode.
+  ///
+  void SetMode(const std::string& channel, Mode mode);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the lane of a channel. Messages that are already waiting
+  ///             stay in their lane.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  lane     The lane.
+  ///
+  void SetLane(const std::string& channel, Lane lane);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Delivers a message to the handler in a later task on the task
+  ///             runner, according to the mode of its channel.
+  ///
+  /// @param[in]  message  The message.
+  ///
+  void DispatchPlatformMessage(std::unique_ptr<PlatformMessage> message);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Delivers the waiting messages on the input and frame-critical
+  ///             lanes. Must be called on the task runner, before the frame
+  ///             is built.
+  ///
+  void DeliverUrgentMessages();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Delivers the waiting messages on the background lane, one by
+  ///             one, until the deadline passes. The messages that are left
+  ///             wait for the next call. Must be called on the task runner.
+  ///
+  /// @param[in]  deadline  The time after which no more messages are
+  ///                       delivered.
+  ///
+  void DeliverBackgroundMessages(fml::TimePoint deadline);
+
+ private:
+  struct ChannelConfig {
+    Mode mode = Mode::kNone;
+    Lane lane = Lane::kNormal;
+  };
+
+  fml::BasicTaskRunner* const task_runner_;
+  const Handler handler_;
+  const BackgroundScheduler background_scheduler_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, ChannelConfig> configs_;
+  // The messages that wait in each lane, in the order they were dispatched.
+  // The messages in the normal lane are the batch of the next drain task.
+  std::deque<std::unique_ptr<PlatformMessage>> lanes_[kLaneCount];
+  bool drain_posted_ = false;
+
+  void Drain();
+
+  // Delivers the waiting messages in the lanes up to and including |last|.
+  void DeliverLanes(Lane last);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PlatformMessageBatcher);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_BATCHER_H_
@@ -0,0 +1,261 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_batcher.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// A task runner that runs its tasks when the test says so.
+class TestTaskRunner : public fml::BasicTaskRunner {
+ public:
+  void PostTask(const fml::closure& task) override { tasks_.push_back(task); }
+
+  size_t task_count() const { return tasks_.size(); }
+
+  void RunTasks() {
+    std::vector<fml::closure> tasks;
+    tasks.swap(tasks_);
+    for (const auto& task : tasks) {
+      task();
+    }
+  }
+
+ private:
+  std::vector<fml::closure> tasks_;
+};
+
+class TestResponse : public PlatformMessageResponse {
+ public:
+  void Complete(std::unique_ptr<fml::Mapping> data) override {}
+
+  void CompleteEmpty() override { completed_empty_ = true; }
+
+  bool completed_empty() const { return completed_empty_; }
+
+ private:
+  bool completed_empty_ = false;
+};
+
+std::unique_ptr<PlatformMessage> MakeMessage(
+    const std::string& channel,
+    const std::string& data,
+    fml::RefPtr<PlatformMessageResponse> response = nullptr) {
+  return std::make_unique<PlatformMessage>(
+      channel, fml::MallocMapping::Copy(data.data(), data.size()),
+      std::move(response));
+}
+
+std::string GetData(const PlatformMessage& message) {
+  return std::string(reinterpret_cast<const char*>(message.data().GetMapping()),
+                     message.data().GetSize());
+}
+
+}  // namespace
+
+TEST(PlatformMessageBatcherTest, PostsOneTaskPerMessageByDefault) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(GetData(*message));
+      });
+
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("a", "2"));
+  EXPECT_EQ(task_runner.task_count(), 2u);
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"1", "2"}));
+}
+
+TEST(PlatformMessageBatcherTest, DeliversBatchInOneTask) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      });
+  batcher->SetMode("a", PlatformMessageBatcher::Mode::kBatch);
+  batcher->SetMode("b", PlatformMessageBatcher::Mode::kBatch);
+
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("b", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("a", "2"));
+  EXPECT_EQ(task_runner.task_count(), 1u);
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"a1", "b1", "a2"}));
+
+  // Messages dispatched after the drain start a new batch.
+  batcher->DispatchPlatformMessage(MakeMessage("a", "3"));
+  EXPECT_EQ(task_runner.task_count(), 1u);
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered.back(), "a3");
+}
+
+TEST(PlatformMessageBatcherTest, LatestOnlyReplacesPendingMessage) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      });
+  batcher->SetMode("state", PlatformMessageBatcher::Mode::kLatestOnly);
+  batcher->SetMode("events", PlatformMessageBatcher::Mode::kBatch);
+
+  auto replaced_response = fml::MakeRefCounted<TestResponse>();
+  batcher->DispatchPlatformMessage(
+      MakeMessage("state", "1", replaced_response));
+  batcher->DispatchPlatformMessage(MakeMessage("events", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("state", "2"));
+  batcher->DispatchPlatformMessage(MakeMessage("events", "2"));
+  EXPECT_TRUE(replaced_response->completed_empty());
+  EXPECT_EQ(task_runner.task_count(), 1u);
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered,
+            std::vector<std::string>({"state2", "events1", "events2"}));
+}
+
+TEST(PlatformMessageBatcherTest, KeepsOrderWhenBatchingIsTurnedOff) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(GetData(*message));
+      });
+  batcher->SetMode("a", PlatformMessageBatcher::Mode::kBatch);
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->SetMode("a", PlatformMessageBatcher::Mode::kNone);
+  batcher->DispatchPlatformMessage(MakeMessage("a", "2"));
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"1", "2"}));
+}
+
+TEST(PlatformMessageBatcherTest, DropsMessagesAfterDestruction) {
+  TestTaskRunner task_runner;
+  bool delivered = false;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner,
+      [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered = true;
+      });
+  batcher->SetMode("a", PlatformMessageBatcher::Mode::kBatch);
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("b", "1"));
+  batcher.reset();
+
+  task_runner.RunTasks();
+  EXPECT_FALSE(delivered);
+}
+
+TEST(PlatformMessageBatcherTest, UrgentLanesGoAheadOfNormalMessages) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      });
+  batcher->SetLane("input", PlatformMessageBatcher::Lane::kInput);
+  batcher->SetLane("layout", PlatformMessageBatcher::Lane::kFrameCritical);
+
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("layout", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("input", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("a", "2"));
+  EXPECT_EQ(task_runner.task_count(), 3u);
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>(
+                           {"input1", "layout1", "a1", "a2"}));
+}
+
+TEST(PlatformMessageBatcherTest, DeliversUrgentLanesBeforeFrame) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      });
+  batcher->SetLane("input", PlatformMessageBatcher::Lane::kInput);
+  batcher->SetMode("events", PlatformMessageBatcher::Mode::kBatch);
+
+  batcher->DispatchPlatformMessage(MakeMessage("events", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("input", "1"));
+  batcher->DeliverUrgentMessages();
+  EXPECT_EQ(delivered, std::vector<std::string>({"input1"}));
+
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"input1", "events1"}));
+}
+
+TEST(PlatformMessageBatcherTest, BackgroundLaneWaitsForIdle) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  std::vector<fml::closure> scheduled;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner,
+      [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      },
+      [&scheduled](fml::closure deliver) { scheduled.push_back(deliver); });
+  batcher->SetLane("sync", PlatformMessageBatcher::Lane::kBackground);
+
+  batcher->DispatchPlatformMessage(MakeMessage("sync", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("a", "1"));
+  batcher->DispatchPlatformMessage(MakeMessage("sync", "2"));
+  EXPECT_EQ(scheduled.size(), 1u);
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"a1"}));
+
+  // No messages are delivered once the deadline has passed.
+  batcher->DeliverBackgroundMessages(fml::TimePoint::Now());
+  EXPECT_EQ(delivered.size(), 1u);
+
+  batcher->DeliverBackgroundMessages(fml::TimePoint::Max());
+  EXPECT_EQ(delivered, std::vector<std::string>({"a1", "sync1", "sync2"}));
+
+  // The scheduled delivery has nothing left to do.
+  scheduled[0]();
+  EXPECT_EQ(delivered.size(), 3u);
+
+  batcher->DispatchPlatformMessage(MakeMessage("sync", "3"));
+  ASSERT_EQ(scheduled.size(), 2u);
+  scheduled[1]();
+  EXPECT_EQ(delivered.back(), "sync3");
+}
+
+TEST(PlatformMessageBatcherTest, BackgroundLaneKeepsLatestOnly) {
+  TestTaskRunner task_runner;
+  std::vector<std::string> delivered;
+  auto batcher = std::make_shared<PlatformMessageBatcher>(
+      &task_runner, [&delivered](std::unique_ptr<PlatformMessage> message) {
+        delivered.push_back(message->channel() + GetData(*message));
+      });
+  batcher->SetLane("state", PlatformMessageBatcher::Lane::kBackground);
+  batcher->SetMode("state", PlatformMessageBatcher::Mode::kLatestOnly);
+
+  auto replaced_response = fml::MakeRefCounted<TestResponse>();
+  batcher->DispatchPlatformMessage(
+      MakeMessage("state", "1", replaced_response));
+  batcher->DispatchPlatformMessage(MakeMessage("state", "2"));
+  EXPECT_TRUE(replaced_response->completed_empty());
+
+  // Without a scheduler, the lane is delivered in a later task.
+  EXPECT_EQ(task_runner.task_count(), 1u);
+  task_runner.RunTasks();
+  EXPECT_EQ(delivered, std::vector<std::string>({"state2"}));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,44 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_HANDLER_H_
+#define FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_HANDLER_H_
+
+#include <memory>
+
+#include "flutter/lib/ui/window/platform_message.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Handles the platform messages that the framework sends on
+///             channels that are not handled on the platform thread.
+///
+///             The shell hands messages on such channels straight from the UI
+///             thread to the task runner of their channel, so they do not wait
+///             behind other work on the platform thread. Responses may be
+///             completed on any thread and are delivered to the framework on
+///             the UI thread.
+///
+/// @see        Shell::SetPlatformMessageTaskRunner
+///
+class PlatformMessageHandler {
+ public:
+  virtual ~PlatformMessageHandler() = default;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Handles a message on the task runner of its channel. This may
+  ///             be called on any thread, and concurrently when a channel uses
+  ///             a concurrent task runner. The handler may outlive the platform
+  ///             view that created it.
+  ///
+  /// @param[in]  message  The message sent by the framework.
+  ///
+  virtual void HandlePlatformMessage(
+      std::unique_ptr<PlatformMessage> message) = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_HANDLER_H_
@@ -0,0 +1,184 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_ring.h"
+
+#include <cstring>
+
+#include "flutter/fml/logging.h"
+#include "flutter/lib/ui/window/platform_message_response.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr size_t kLengthSize = sizeof(uint32_t);
+
+size_t AlignRecord(size_t size) {
+  return (size + PlatformMessageRing::kRecordAlignment - 1) &
+         ~(PlatformMessageRing::kRecordAlignment - 1);
+}
+
+// Frees the records of a doorbell when the framework replies to it, or when
+// the doorbell is dropped without a reply.
+class DoorbellResponse : public PlatformMessageResponse {
+ public:
+  DoorbellResponse(fml::RefPtr<PlatformMessageRing> ring, uint64_t end)
+      : ring_(std::move(ring)), end_(end) {}
+
+  ~DoorbellResponse() override { Consume(); }
+
+  void Complete(std::unique_ptr<fml::Mapping> data) override { Consume(); }
+
+  void CompleteEmpty() override { Consume(); }
+
+ private:
+  fml::RefPtr<PlatformMessageRing> ring_;
+  const uint64_t end_;
+
+  void Consume() {
+    if (is_complete_) {
+      return;
+    }
+    is_complete_ = true;
+    ring_->Consume(end_);
+  }
+};
+
+// The buffer of a ring, as it is handed to the framework.
+class RingMapping : public fml::Mapping {
+ public:
+  RingMapping(fml::RefPtr<PlatformMessageRing> ring, uint8_t* buffer)
+      : ring_(std::move(ring)), buffer_(buffer) {}
+
+  size_t GetSize() const override { return ring_->GetCapacity(); }
+
+  const uint8_t* GetMapping() const override { return buffer_; }
+
+  // The framework must see the buffer itself rather than a copy of it.
+  bool IsWritable() const override { return true; }
+
+ private:
+  fml::RefPtr<PlatformMessageRing> ring_;
+  uint8_t* const buffer_;
+};
+
+}  // namespace
+
+fml::RefPtr<PlatformMessageRing> PlatformMessageRing::Create(
+    size_t capacity,
+    Doorbell doorbell) {
+  if (capacity < kMinCapacity || (capacity & (capacity - 1)) != 0 ||
+      !doorbell) {
+    return nullptr;
+  }
+  return fml::MakeRefCounted<PlatformMessageRing>(capacity,
+                                                  std::move(doorbell));
+}
+
+PlatformMessageRing::PlatformMessageRing(size_t capacity, Doorbell doorbell)
+    : capacity_(capacity),
+      doorbell_(std::move(doorbell)),
+      buffer_(new uint8_t[capacity]) {}
+
+PlatformMessageRing::~PlatformMessageRing() = default;
+
+bool PlatformMessageRing::Write(const uint8_t* data, size_t size) {
+  if (size >= kWrapMarker) {
+    return false;
+  }
+  const size_t record_size = AlignRecord(kLengthSize + size);
+  if (record_size > capacity_) {
+    return false;
+  }
+
+  uint64_t position = write_position_.load(std::memory_order_relaxed);
+  const uint64_t read_position =
+      read_position_.load(std::memory_order_acquire);
+  const size_t offset = position & (capacity_ - 1);
+  const size_t until_end = capacity_ - offset;
+  const bool wraps = record_size > until_end;
+  const size_t needed = wraps ? until_end + record_size : record_size;
+  if (position + needed - read_position > capacity_) {
+    return false;
+  }
+
+  if (wraps) {
+    // Records are always aligned, so there is room for the marker.
+    const uint32_t marker = kWrapMarker;
+    memcpy(buffer_.get() + offset, &marker, kLengthSize);
+    position += until_end;
+  }
+
+  uint8_t* record = buffer_.get() + (position & (capacity_ - 1));
+  const uint32_t length = static_cast<uint32_t>(size);
+  memcpy(record, &length, kLengthSize);
+  if (size > 0) {
+    memcpy(record + kLengthSize, data, size);
+  }
+
+  // Publishing the record must be ordered before the check of the pending
+  // doorbell, which pairs with the order in Consume.
+  write_position_.store(position + record_size);
+  RingDoorbellIfNeeded();
+  return true;
+}
+
+size_t PlatformMessageRing::GetFreeSpace() const {
+  const uint64_t read_position = read_position_.load();
+  const uint64_t write_position = write_position_.load();
+  return capacity_ - static_cast<size_t>(write_position - read_position);
+}
+
+std::unique_ptr<PlatformMessage> PlatformMessageRing::CreateDoorbellMessage(
+    const std::string& channel) {
+  const uint64_t positions[2] = {
+      read_position_.load(std::memory_order_acquire),
+      write_position_.load(std::memory_order_acquire),
+  };
+  return std::make_unique<PlatformMessage>(
+      channel,
+      fml::MallocMapping::Copy(reinterpret_cast<const uint8_t*>(positions),
+                               sizeof(positions)),
+      fml::MakeRefCounted<DoorbellResponse>(fml::Ref(this), positions[1]));
+}
+
+std::unique_ptr<fml::Mapping> PlatformMessageRing::CreateMapping() {
+  return std::make_unique<RingMapping>(fml::Ref(this), buffer_.get());
+}
+
+void PlatformMessageRing::ReadRecords(
+    uint64_t start,
+    uint64_t end,
+    const std::function<void(const uint8_t*, size_t)>& callback) const {
+  uint64_t position = start;
+  while (position < end) {
+    const uint8_t* record = buffer_.get() + (position & (capacity_ - 1));
+    uint32_t length;
+    memcpy(&length, record, kLengthSize);
+    if (length == kWrapMarker) {
+      position += capacity_ - (position & (capacity_ - 1));
+      continue;
+    }
+    callback(record + kLengthSize, length);
+    position += AlignRecord(kLengthSize + length);
+  }
+}
+
+void PlatformMessageRing::Consume(uint64_t position) {
+  FML_DCHECK(position <= write_position_.load());
+  read_position_.store(position, std::memory_order_release);
+  doorbell_pending_.store(false);
+  if (write_position_.load() != position) {
+    RingDoorbellIfNeeded();
+  }
+}
+
+void PlatformMessageRing::RingDoorbellIfNeeded() {
+  if (!doorbell_pending_.exchange(true)) {
+    doorbell_(fml::Ref(this));
+  }
+}
+
+}  // namespace flutter
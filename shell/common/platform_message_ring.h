@@ -0,0 +1,165 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_RING_H_
+#define FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_RING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/memory/ref_counted.h"
+#include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/lib/ui/window/platform_message.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      A single-producer, single-consumer ring buffer of records that
+///             native code streams to the framework on a channel, without
+///             allocating or copying a platform message per record.
+///
+///             The framework reads the records in place, from a `ByteData`
+///             that wraps the ring's buffer:
+///
+///             1. The framework sends any message on the channel. The reply is
+///                the `ByteData` of the buffer.
+///             2. When records are written to an empty ring, the framework is
+///                sent a doorbell message on the channel. The doorbell holds
+///                two host-endian uint64 positions, `start` and `end`. No
+///                other doorbell is sent until the framework replies to it.
+///             3. The framework reads the records between `start` and `end`
+///                and then replies to the doorbell, which frees their space.
+///                If more records were written in the meantime, the next
+///                doorbell is sent right away.
+///
+///             Positions only ever increase. The offset of a position in the
+///             buffer is the position modulo the capacity. A record is a
+///             host-endian uint32 length, followed by that many bytes, padded
+///             to `kRecordAlignment`. A length of `kWrapMarker` means that the
+///             next record starts at the beginning of the buffer.
+///
+///             Writes fail instead of blocking when the ring is full, which
+///             lets the producer apply backpressure, for example by dropping
+///             or merging samples.
+///
+class PlatformMessageRing final
+    : public fml::RefCountedThreadSafe<PlatformMessageRing> {
+ public:
+  /// Called when the ring needs to send a doorbell to the framework. This is
+  /// called on the thread that writes the record, or on the thread that
+  /// replies to the previous doorbell.
+  using Doorbell = std::function<void(fml::RefPtr<PlatformMessageRing>)>;
+
+  /// The smallest capacity of a ring. Smaller buffers would be copied rather
+  /// than wrapped when they are handed to the framework.
+  static constexpr size_t kMinCapacity = 1024;
+
+  /// The alignment of records in the buffer.
+  static constexpr size_t kRecordAlignment = 4;
+
+  /// The length of a record that tells the reader to wrap around.
+  static constexpr uint32_t kWrapMarker = 0xFFFFFFFF;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a ring.
+  ///
+  /// @param[in]  capacity  The size of the buffer in bytes. Must be a power of
+  ///                       two that is at least `kMinCapacity`.
+  /// @param[in]  doorbell  Called when the ring needs to send a doorbell.
+  ///
+  /// @return     The ring, or null if the capacity is invalid.
+  ///
+  static fml::RefPtr<PlatformMessageRing> Create(size_t capacity,
+                                                 Doorbell doorbell);
+
+  size_t GetCapacity() const { return capacity_; }
+
+  //----------------------------------------------------------------------------
+  /// @brief      Writes a record. Must only be called by one thread at a time.
+  ///             Does not allocate.
+  ///
+  /// @param[in]  data  The bytes of the record.
+  /// @param[in]  size  The number of bytes.
+  ///
+  /// @return     False if there is no room for the record, because the
+  ///             framework has not caught up yet or the record is larger than
+  ///             the ring.
+  ///
+  bool Write(const uint8_t* data, size_t size);
+
+  //----------------------------------------------------------------------------
+  /// @brief      The number of bytes that are not taken by unread records.
+  ///             This may be called on any thread.
+  ///
+  size_t GetFreeSpace() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates the doorbell message for the records that have been
+  ///             written so far. Replying to the message, or dropping it,
+  ///             frees the space of those records.
+  ///
+  /// @param[in]  channel  The channel of the ring.
+  ///
+  std::unique_ptr<PlatformMessage> CreateDoorbellMessage(
+      const std::string& channel);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a mapping of the buffer, which keeps the ring alive.
+  ///             This is the reply to messages from the framework on the
+  ///             channel of the ring.
+  ///
+  std::unique_ptr<fml::Mapping> CreateMapping();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Calls `callback` with each record between two positions, in
+  ///             the way the framework reads them. For native consumers and
+  ///             tests.
+  ///
+  /// @param[in]  start     The position of the first record.
+  /// @param[in]  end       The position past the last record.
+  /// @param[in]  callback  Called with the bytes of each record.
+  ///
+  void ReadRecords(
+      uint64_t start,
+      uint64_t end,
+      const std::function<void(const uint8_t*, size_t)>& callback) const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Frees the space of the records before `position`, and sends
+  ///             the next doorbell if there are more records.
+  ///
+  void Consume(uint64_t position);
+
+ private:
+  FML_FRIEND_MAKE_REF_COUNTED(PlatformMessageRing);
+  FML_FRIEND_REF_COUNTED_THREAD_SAFE(PlatformMessageRing);
+
+  PlatformMessageRing(size_t capacity, Doorbell doorbell);
+
+  ~PlatformMessageRing();
+
+  const size_t capacity_;
+  const Doorbell doorbell_;
+  // The buffer. It is never reallocated.
+  std::unique_ptr<uint8_t[]> buffer_;
+  // The position past the last written record. Written by the producer.
+  std::atomic<uint64_t> write_position_ = 0;
+  // The position of the first unread record. Written by the consumer.
+  std::atomic<uint64_t> read_position_ = 0;
+  // Whether a doorbell was sent and has not been replied to.
+  std::atomic<bool> doorbell_pending_ = false;
+
+  void RingDoorbellIfNeeded();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PlatformMessageRing);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_RING_H_
@@ -0,0 +1,155 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_ring.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "flutter/lib/ui/window/platform_message_response.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Collects the doorbells that a ring sends.
+class DoorbellRecorder {
+ public:
+  PlatformMessageRing::Doorbell GetDoorbell() {
+    return [this](fml::RefPtr<PlatformMessageRing> ring) {
+      messages_.push_back(ring->CreateDoorbellMessage("ring"));
+    };
+  }
+
+  size_t count() const { return messages_.size(); }
+
+  // Reads the records of the oldest doorbell and replies to it.
+  std::vector<std::string> Answer(PlatformMessageRing& ring) {
+    auto message = std::move(messages_.front());
+    messages_.erase(messages_.begin());
+    uint64_t positions[2];
+    EXPECT_EQ(message->data().GetSize(), sizeof(positions));
+    memcpy(positions, message->data().GetMapping(), sizeof(positions));
+    std::vector<std::string> records;
+    ring.ReadRecords(positions[0], positions[1],
+                     [&records](const uint8_t* data, size_t size) {
+                       records.emplace_back(
+                           reinterpret_cast<const char*>(data), size);
+                     });
+    message->response()->CompleteEmpty();
+    return records;
+  }
+
+  // Drops the oldest doorbell without replying to it.
+  void Drop() { messages_.erase(messages_.begin()); }
+
+ private:
+  std::vector<std::unique_ptr<PlatformMessage>> messages_;
+};
+
+bool Write(PlatformMessageRing& ring, const std::string& record) {
+  return ring.Write(reinterpret_cast<const uint8_t*>(record.data()),
+                    record.size());
+}
+
+}  // namespace
+
+TEST(PlatformMessageRingTest, RejectsInvalidCapacities) {
+  auto doorbell = [](fml::RefPtr<PlatformMessageRing> ring) {};
+  EXPECT_FALSE(PlatformMessageRing::Create(512, doorbell));
+  EXPECT_FALSE(PlatformMessageRing::Create(3000, doorbell));
+  EXPECT_TRUE(PlatformMessageRing::Create(4096, doorbell));
+}
+
+TEST(PlatformMessageRingTest, CoalescesDoorbells) {
+  DoorbellRecorder recorder;
+  auto ring = PlatformMessageRing::Create(1024, recorder.GetDoorbell());
+
+  EXPECT_TRUE(Write(*ring, "a"));
+  EXPECT_TRUE(Write(*ring, ""));
+  EXPECT_TRUE(Write(*ring, "bcdef"));
+  EXPECT_EQ(recorder.count(), 1u);
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({"a"}));
+  EXPECT_EQ(recorder.count(), 1u);
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({"", "bcdef"}));
+  EXPECT_EQ(recorder.count(), 0u);
+  EXPECT_EQ(ring->GetFreeSpace(), 1024u);
+
+  EXPECT_TRUE(Write(*ring, "g"));
+  EXPECT_EQ(recorder.count(), 1u);
+}
+
+TEST(PlatformMessageRingTest, RingsAgainForRecordsWrittenWhileReading) {
+  DoorbellRecorder recorder;
+  auto ring = PlatformMessageRing::Create(1024, recorder.GetDoorbell());
+
+  EXPECT_TRUE(Write(*ring, "a"));
+  EXPECT_TRUE(Write(*ring, "b"));
+  EXPECT_EQ(recorder.count(), 1u);
+  EXPECT_TRUE(Write(*ring, "c"));
+
+  // The doorbell was created when the first record was written. Replying to
+  // it sends the doorbell for the rest.
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({"a"}));
+  EXPECT_EQ(recorder.count(), 1u);
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({"b", "c"}));
+  EXPECT_EQ(recorder.count(), 0u);
+}
+
+TEST(PlatformMessageRingTest, FailsWhenFullAndWrapsAround) {
+  DoorbellRecorder recorder;
+  auto ring = PlatformMessageRing::Create(1024, recorder.GetDoorbell());
+  const std::string record(300, 'x');
+
+  // Each record takes 304 bytes, so three of them fit.
+  EXPECT_TRUE(Write(*ring, record));
+  EXPECT_TRUE(Write(*ring, record));
+  EXPECT_TRUE(Write(*ring, record));
+  EXPECT_FALSE(Write(*ring, record));
+  EXPECT_FALSE(Write(*ring, std::string(2000, 'y')));
+  EXPECT_EQ(ring->GetFreeSpace(), 1024u - 3 * 304);
+  EXPECT_EQ(recorder.Answer(*ring).size(), 1u);
+  EXPECT_EQ(recorder.Answer(*ring).size(), 2u);
+
+  // The last record does not fit before the end of the buffer, so it starts
+  // at the beginning.
+  EXPECT_TRUE(Write(*ring, "abc"));
+  EXPECT_TRUE(Write(*ring, record));
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({"abc"}));
+  EXPECT_EQ(recorder.Answer(*ring), std::vector<std::string>({record}));
+  EXPECT_EQ(ring->GetFreeSpace(), 1024u);
+}
+
+TEST(PlatformMessageRingTest, DroppedDoorbellFreesRecords) {
+  DoorbellRecorder recorder;
+  auto ring = PlatformMessageRing::Create(1024, recorder.GetDoorbell());
+  EXPECT_TRUE(Write(*ring, std::string(1000, 'x')));
+  EXPECT_EQ(recorder.count(), 1u);
+
+  recorder.Drop();
+  EXPECT_EQ(ring->GetFreeSpace(), 1024u);
+}
+
+TEST(PlatformMessageRingTest, MappingWrapsBuffer) {
+  auto ring = PlatformMessageRing::Create(
+      1024, [](fml::RefPtr<PlatformMessageRing> ring) {});
+  auto mapping = ring->CreateMapping();
+  EXPECT_EQ(mapping->GetSize(), 1024u);
+  EXPECT_TRUE(mapping->IsWritable());
+
+  EXPECT_TRUE(Write(*ring, "abc"));
+  uint32_t length;
+  memcpy(&length, mapping->GetMapping(), sizeof(length));
+  EXPECT_EQ(length, 3u);
+
+  // The mapping keeps the ring alive.
+  ring = nullptr;
+  EXPECT_EQ(memcmp(mapping->GetMapping() + sizeof(length), "abc", 3), 0);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,201 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_stats.h"
+
+#include <algorithm>
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+// Records the latency of a response and then completes the response it wraps.
+class PlatformMessageStats::Response : public PlatformMessageResponse {
+ public:
+  Response(std::weak_ptr<PlatformMessageStats> stats,
+           Direction direction,
+           std::string channel,
+           fml::TimePoint send_time,
+           uint64_t trace_flow_id,
+           fml::RefPtr<PlatformMessageResponse> response)
+      : stats_(std::move(stats)),
+        direction_(direction),
+        channel_(std::move(channel)),
+        send_time_(send_time),
+        trace_flow_id_(trace_flow_id),
+        response_(std::move(response)) {}
+
+  // |PlatformMessageResponse|
+  void Complete(std::unique_ptr<fml::Mapping> data) override {
+    Record();
+    response_->Complete(std::move(data));
+  }
+
+  // |PlatformMessageResponse|
+  void CompleteEmpty() override {
+    Record();
+    response_->CompleteEmpty();
+  }
+
+ private:
+  const std::weak_ptr<PlatformMessageStats> stats_;
+  const Direction direction_;
+  const std::string channel_;
+  const fml::TimePoint send_time_;
+  const uint64_t trace_flow_id_;
+  const fml::RefPtr<PlatformMessageResponse> response_;
+
+  void Record() {
+    is_complete_ = true;
+    TRACE_EVENT0("flutter", "PlatformMessageResponse");
+    TRACE_FLOW_END("flutter", "PlatformMessage", trace_flow_id_);
+    if (auto stats = stats_.lock()) {
+      stats->RecordResponse(direction_, channel_,
+                            fml::TimePoint::Now() - send_time_);
+    }
+  }
+};
+
+PlatformMessageStats::HandlerScope::HandlerScope(
+    PlatformMessageStats& stats,
+    Direction direction,
+    const PlatformMessage& message)
+    : stats_(stats),
+      is_recorded_(message.trace_flow_id() != 0),
+      direction_(direction),
+      channel_(is_recorded_ ? message.channel() : std::string()),
+      send_time_(message.send_time()),
+      start_time_(is_recorded_ ? fml::TimePoint::Now() : fml::TimePoint()),
+      trace_flow_id_(message.trace_flow_id()),
+      ends_flow_(!message.response()) {
+  if (!is_recorded_) {
+    return;
+  }
+  fml::tracing::TraceEvent1("flutter", "PlatformMessageHandler", "channel",
+                            channel_.c_str());
+  TRACE_FLOW_STEP("flutter", "PlatformMessage", trace_flow_id_);
+}
+
+PlatformMessageStats::HandlerScope::~HandlerScope() {
+  if (!is_recorded_) {
+    return;
+  }
+  if (ends_flow_) {
+    TRACE_FLOW_END("flutter", "PlatformMessage", trace_flow_id_);
+  }
+  fml::tracing::TraceEventEnd("PlatformMessageHandler");
+  stats_.RecordHandled(direction_, channel_, start_time_ - send_time_,
+                       fml::TimePoint::Now() - start_time_);
+}
+
+PlatformMessageStats::PlatformMessageStats() = default;
+
+PlatformMessageStats::~PlatformMessageStats() = default;
+
+void PlatformMessageStats::SetEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool PlatformMessageStats::IsEnabled() const {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+void PlatformMessageStats::RecordSend(Direction direction,
+                                      PlatformMessage& message) {
+  if (!IsEnabled()) {
+    return;
+  }
+  const uint64_t trace_flow_id = next_trace_flow_id_++;
+  fml::tracing::TraceEvent1("flutter", "PlatformMessageSend", "channel",
+                            message.channel().c_str());
+  TRACE_FLOW_BEGIN("flutter", "PlatformMessage", trace_flow_id);
+  fml::tracing::TraceEventEnd("PlatformMessageSend");
+
+  message.set_send_time(fml::TimePoint::Now());
+  message.set_trace_flow_id(trace_flow_id);
+  if (message.response()) {
+    message.set_response(fml::MakeRefCounted<Response>(
+        weak_from_this(), direction, message.channel(), message.send_time(),
+        trace_flow_id, message.response()));
+  }
+
+  std::scoped_lock lock(mutex_);
+  Channel& channel = GetChannel(direction, message.channel());
+  channel.stats.message_count++;
+  channel.stats.byte_count += message.data().GetSize();
+}
+
+void PlatformMessageStats::RecordHandled(Direction direction,
+                                         const std::string& channel,
+                                         fml::TimeDelta queueing_delay,
+                                         fml::TimeDelta handler_time) {
+  std::scoped_lock lock(mutex_);
+  ChannelStats& stats = GetChannel(direction, channel).stats;
+  stats.handled_count++;
+  stats.total_queueing_delay = stats.total_queueing_delay + queueing_delay;
+  stats.max_queueing_delay = std::max(stats.max_queueing_delay, queueing_delay);
+  stats.total_handler_time = stats.total_handler_time + handler_time;
+  stats.max_handler_time = std::max(stats.max_handler_time, handler_time);
+}
+
+void PlatformMessageStats::RecordResponse(Direction direction,
+                                          const std::string& channel,
+                                          fml::TimeDelta latency) {
+  std::scoped_lock lock(mutex_);
+  Channel& found = GetChannel(direction, channel);
+  found.stats.response_count++;
+  found.stats.max_response_latency =
+      std::max(found.stats.max_response_latency, latency);
+  if (found.latencies.size() < kMaxLatencySamples) {
+    found.latencies.push_back(latency);
+  } else {
+    found.latencies[found.latency_index] = latency;
+    found.latency_index = (found.latency_index + 1) % kMaxLatencySamples;
+  }
+}
+
+std::vector<PlatformMessageStats::ChannelStats>
+PlatformMessageStats::GetChannelStats() const {
+  std::vector<ChannelStats> result;
+  std::vector<fml::TimeDelta> latencies;
+  std::scoped_lock lock(mutex_);
+  for (const auto* channels : {&to_framework_, &to_platform_}) {
+    for (const auto& [name, channel] : *channels) {
+      ChannelStats stats = channel.stats;
+      if (!channel.latencies.empty()) {
+        latencies = channel.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        const size_t last = latencies.size() - 1;
+        stats.response_latency_p50 = latencies[last * 50 / 100];
+        stats.response_latency_p90 = latencies[last * 90 / 100];
+        stats.response_latency_p99 = latencies[last * 99 / 100];
+      }
+      result.push_back(std::move(stats));
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const ChannelStats& a, const ChannelStats& b) {
+              if (a.channel != b.channel) {
+                return a.channel < b.channel;
+              }
+              return a.direction < b.direction;
+            });
+  return result;
+}
+
+PlatformMessageStats::Channel& PlatformMessageStats::GetChannel(
+    Direction direction,
+    const std::string& channel) {
+  auto& channels =
+      direction == Direction::kToFramework ? to_framework_ : to_platform_;
+  auto found = channels.find(channel);
+  if (found == channels.end()) {
+    found = channels.emplace(channel, Channel()).first;
+    found->second.stats.channel = channel;
+    found->second.stats.direction = direction;
+  }
+  return found->second;
+}
+
+}  // namespace flutter
@@ -0,0 +1,177 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_STATS_H_
+#define FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_STATS_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/lib/ui/window/platform_message.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Counts the platform messages on each channel, and measures how
+///             long they wait for their handler, how long the handler takes,
+///             and how long the response takes.
+///
+///             The shell records a message when it is sent, which stamps the
+///             message with its send time and the id of a trace flow, and
+///             wraps its response. The flow goes from the sender to the
+///             handler, and ends at the response, or at the handler if the
+///             message has no response.
+///
+///             Response latencies are kept for the last
+///             `kMaxLatencySamples` responses of each channel, from which the
+///             percentiles are computed. This class is thread-safe, and must
+///             be created with `std::make_shared`.
+///
+///             Recording takes a lock and allocates for every message, so it
+///             is off until `SetEnabled` turns it on. While it is off, sending
+///             and handling a message only check a flag. Messages sent while
+///             recording was on are still followed to their response.
+///
+class PlatformMessageStats
+    : public std::enable_shared_from_this<PlatformMessageStats> {
+ public:
+  /// Which way the messages go.
+  enum class Direction {
+    /// From the platform to the framework.
+    kToFramework,
+    /// From the framework to the platform.
+    kToPlatform,
+  };
+
+  static constexpr size_t kMaxLatencySamples = 128;
+
+  /// The stats of the messages in one direction on one channel.
+  struct ChannelStats {
+    std::string channel;
+    Direction direction = Direction::kToFramework;
+    uint64_t message_count = 0;
+    uint64_t byte_count = 0;
+    /// The number of messages whose handler has returned.
+    uint64_t handled_count = 0;
+    fml::TimeDelta total_queueing_delay;
+    fml::TimeDelta max_queueing_delay;
+    fml::TimeDelta total_handler_time;
+    fml::TimeDelta max_handler_time;
+    uint64_t response_count = 0;
+    fml::TimeDelta response_latency_p50;
+    fml::TimeDelta response_latency_p90;
+    fml::TimeDelta response_latency_p99;
+    fml::TimeDelta max_response_latency;
+  };
+
+  //----------------------------------------------------------------------------
+  /// @brief      Measures a handler of a message for as long as it is in
+  ///             scope.
+  ///
+  class HandlerScope {
+   public:
+    HandlerScope(PlatformMessageStats& stats,
+                 Direction direction,
+                 const PlatformMessage& message);
+
+    ~HandlerScope();
+
+   private:
+    PlatformMessageStats& stats_;
+    // Whether the message was recorded when it was sent.
+    const bool is_recorded_;
+    const Direction direction_;
+    const std::string channel_;
+    const fml::TimePoint send_time_;
+    const fml::TimePoint start_time_;
+    const uint64_t trace_flow_id_;
+    const bool ends_flow_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(HandlerScope);
+  };
+
+  PlatformMessageStats();
+
+  ~PlatformMessageStats();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Starts or stops recording the messages that are sent from
+  ///             now on.
+  ///
+  void SetEnabled(bool enabled);
+
+  bool IsEnabled() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Records that a message was sent, and starts its trace flow.
+  ///             Does nothing unless recording is enabled.
+  ///
+  /// @param[in]  direction  Which way the message goes.
+  /// @param[in]  message    The message. Its response is replaced by one
+  ///                        that records the latency and then completes the
+  ///                        original response.
+  ///
+  void RecordSend(Direction direction, PlatformMessage& message);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Records that the handler of a message has returned.
+  ///
+  /// @param[in]  direction       Which way the message went.
+  /// @param[in]  channel         The channel of the message.
+  /// @param[in]  queueing_delay  The time from the send to the handler.
+  /// @param[in]  handler_time    The time the handler took.
+  ///
+  void RecordHandled(Direction direction,
+                     const std::string& channel,
+                     fml::TimeDelta queueing_delay,
+                     fml::TimeDelta handler_time);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Records that the response of a message was completed.
+  ///
+  /// @param[in]  direction  Which way the message went.
+  /// @param[in]  channel    The channel of the message.
+  /// @param[in]  latency    The time from the send to the response.
+  ///
+  void RecordResponse(Direction direction,
+                      const std::string& channel,
+                      fml::TimeDelta latency);
+
+  //----------------------------------------------------------------------------
+  /// @return     The stats of every channel and direction that carried a
+  ///             message, sorted by channel.
+  ///
+  std::vector<ChannelStats> GetChannelStats() const;
+
+ private:
+  class Response;
+
+  struct Channel {
+    ChannelStats stats;
+    // The latest response latencies, with the oldest at latency_index.
+    std::vector<fml::TimeDelta> latencies;
+    size_t latency_index = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Channel> to_framework_;
+  std::unordered_map<std::string, Channel> to_platform_;
+  std::atomic<uint64_t> next_trace_flow_id_ = 1;
+  std::atomic<bool> enabled_ = false;
+
+  Channel& GetChannel(Direction direction, const std::string& channel);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PlatformMessageStats);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PLATFORM_MESSAGE_STATS_H_
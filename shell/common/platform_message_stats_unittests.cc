@@ -0,0 +1,202 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/platform_message_stats.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+using Direction = PlatformMessageStats::Direction;
+
+class TestResponse : public PlatformMessageResponse {
+ public:
+  void Complete(std::unique_ptr<fml::Mapping> data) override {
+    completed_size_ = data->GetSize();
+  }
+
+  void CompleteEmpty() override { completed_size_ = 0; }
+
+  int64_t completed_size() const { return completed_size_; }
+
+ private:
+  int64_t completed_size_ = -1;
+};
+
+std::unique_ptr<PlatformMessage> MakeMessage(
+    const std::string& channel,
+    const std::string& data,
+    fml::RefPtr<PlatformMessageResponse> response = nullptr) {
+  return std::make_unique<PlatformMessage>(
+      channel, fml::MallocMapping::Copy(data.data(), data.size()),
+      std::move(response));
+}
+
+std::shared_ptr<PlatformMessageStats> MakeEnabledStats() {
+  auto stats = std::make_shared<PlatformMessageStats>();
+  stats->SetEnabled(true);
+  return stats;
+}
+
+}  // namespace
+
+TEST(PlatformMessageStatsTest, RecordsNothingUntilEnabled) {
+  auto stats = std::make_shared<PlatformMessageStats>();
+  EXPECT_FALSE(stats->IsEnabled());
+  auto response = fml::MakeRefCounted<TestResponse>();
+  auto message = MakeMessage("a", "abc", response);
+  stats->RecordSend(Direction::kToFramework, *message);
+  // The message is left as it is, so that its response is not wrapped.
+  EXPECT_EQ(message->trace_flow_id(), 0u);
+  EXPECT_EQ(message->response(), response);
+  {
+    PlatformMessageStats::HandlerScope scope(*stats, Direction::kToFramework,
+                                             *message);
+  }
+  EXPECT_TRUE(stats->GetChannelStats().empty());
+
+  stats->SetEnabled(true);
+  auto recorded = MakeMessage("a", "abc", response);
+  stats->RecordSend(Direction::kToFramework, *recorded);
+  stats->SetEnabled(false);
+  // A message sent while recording was on is still followed to the end.
+  {
+    PlatformMessageStats::HandlerScope scope(*stats, Direction::kToFramework,
+                                             *recorded);
+  }
+  recorded->response()->CompleteEmpty();
+  auto result = stats->GetChannelStats();
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].message_count, 1u);
+  EXPECT_EQ(result[0].handled_count, 1u);
+  EXPECT_EQ(result[0].response_count, 1u);
+}
+
+TEST(PlatformMessageStatsTest, CountsMessagesPerChannelAndDirection) {
+  auto stats = MakeEnabledStats();
+  stats->RecordSend(Direction::kToFramework, *MakeMessage("b", "abc"));
+  stats->RecordSend(Direction::kToFramework, *MakeMessage("b", "de"));
+  stats->RecordSend(Direction::kToPlatform, *MakeMessage("b", "f"));
+  stats->RecordSend(Direction::kToPlatform, *MakeMessage("a", ""));
+
+  auto result = stats->GetChannelStats();
+  ASSERT_EQ(result.size(), 3u);
+  EXPECT_EQ(result[0].channel, "a");
+  EXPECT_EQ(result[0].direction, Direction::kToPlatform);
+  EXPECT_EQ(result[0].message_count, 1u);
+  EXPECT_EQ(result[0].byte_count, 0u);
+  EXPECT_EQ(result[1].channel, "b");
+  EXPECT_EQ(result[1].direction, Direction::kToFramework);
+  EXPECT_EQ(result[1].message_count, 2u);
+  EXPECT_EQ(result[1].byte_count, 5u);
+  EXPECT_EQ(result[2].channel, "b");
+  EXPECT_EQ(result[2].direction, Direction::kToPlatform);
+  EXPECT_EQ(result[2].message_count, 1u);
+  EXPECT_EQ(result[2].byte_count, 1u);
+}
+
+TEST(PlatformMessageStatsTest, StampsMessagesWithDistinctFlows) {
+  auto stats = MakeEnabledStats();
+  auto first = MakeMessage("a", "");
+  auto second = MakeMessage("a", "");
+  const fml::TimePoint before = fml::TimePoint::Now();
+  stats->RecordSend(Direction::kToFramework, *first);
+  stats->RecordSend(Direction::kToFramework, *second);
+  EXPECT_NE(first->trace_flow_id(), 0u);
+  EXPECT_NE(first->trace_flow_id(), second->trace_flow_id());
+  EXPECT_GE(first->send_time(), before);
+}
+
+TEST(PlatformMessageStatsTest, WrapsResponsesToRecordLatency) {
+  auto stats = MakeEnabledStats();
+  auto response = fml::MakeRefCounted<TestResponse>();
+  auto message = MakeMessage("a", "abc", response);
+  stats->RecordSend(Direction::kToPlatform, *message);
+  ASSERT_TRUE(message->response());
+  EXPECT_NE(message->response().get(), response.get());
+  EXPECT_EQ(stats->GetChannelStats()[0].response_count, 0u);
+
+  message->response()->Complete(
+      std::make_unique<fml::DataMapping>(std::vector<uint8_t>(4)));
+  EXPECT_TRUE(message->response()->is_complete());
+  EXPECT_EQ(response->completed_size(), 4);
+  EXPECT_EQ(stats->GetChannelStats()[0].response_count, 1u);
+
+  // A response that outlives the stats still completes.
+  auto late_response = fml::MakeRefCounted<TestResponse>();
+  auto late_message = MakeMessage("a", "", late_response);
+  stats->RecordSend(Direction::kToPlatform, *late_message);
+  stats = nullptr;
+  late_message->response()->CompleteEmpty();
+  EXPECT_EQ(late_response->completed_size(), 0);
+}
+
+TEST(PlatformMessageStatsTest, KeepsMessagesWithoutResponsesAsTheyAre) {
+  auto stats = MakeEnabledStats();
+  auto message = std::make_unique<PlatformMessage>("a", nullptr);
+  stats->RecordSend(Direction::kToFramework, *message);
+  EXPECT_FALSE(message->response());
+  EXPECT_FALSE(message->hasData());
+
+  {
+    PlatformMessageStats::HandlerScope scope(*stats, Direction::kToFramework,
+                                             *message);
+  }
+  auto result = stats->GetChannelStats();
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].handled_count, 1u);
+  EXPECT_GE(result[0].total_queueing_delay, fml::TimeDelta::Zero());
+  EXPECT_EQ(result[0].response_count, 0u);
+}
+
+TEST(PlatformMessageStatsTest, AccumulatesHandlerTimes) {
+  auto stats = MakeEnabledStats();
+  stats->RecordHandled(Direction::kToFramework, "a",
+                       fml::TimeDelta::FromMicroseconds(10),
+                       fml::TimeDelta::FromMicroseconds(300));
+  stats->RecordHandled(Direction::kToFramework, "a",
+                       fml::TimeDelta::FromMicroseconds(40),
+                       fml::TimeDelta::FromMicroseconds(100));
+
+  auto result = stats->GetChannelStats();
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].handled_count, 2u);
+  EXPECT_EQ(result[0].total_queueing_delay.ToMicroseconds(), 50);
+  EXPECT_EQ(result[0].max_queueing_delay.ToMicroseconds(), 40);
+  EXPECT_EQ(result[0].total_handler_time.ToMicroseconds(), 400);
+  EXPECT_EQ(result[0].max_handler_time.ToMicroseconds(), 300);
+}
+
+TEST(PlatformMessageStatsTest, ComputesPercentilesOverLatestResponses) {
+  auto stats = MakeEnabledStats();
+  for (int64_t i = 1; i <= 100; i++) {
+    stats->RecordResponse(Direction::kToPlatform, "a",
+                          fml::TimeDelta::FromMilliseconds(i));
+  }
+  auto result = stats->GetChannelStats();
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].response_count, 100u);
+  EXPECT_EQ(result[0].response_latency_p50.ToMilliseconds(), 50);
+  EXPECT_EQ(result[0].response_latency_p90.ToMilliseconds(), 90);
+  EXPECT_EQ(result[0].response_latency_p99.ToMilliseconds(), 99);
+  EXPECT_EQ(result[0].max_response_latency.ToMilliseconds(), 100);
+
+  // Only the latest responses count towards the percentiles, but the maximum
+  // covers all of them.
+  for (size_t i = 0; i < PlatformMessageStats::kMaxLatencySamples; i++) {
+    stats->RecordResponse(Direction::kToPlatform, "a",
+                          fml::TimeDelta::FromMilliseconds(1));
+  }
+  result = stats->GetChannelStats();
+  EXPECT_EQ(result[0].response_latency_p99.ToMilliseconds(), 1);
+  EXPECT_EQ(result[0].max_response_latency.ToMilliseconds(), 100);
+}
+
+}  // namespace testing
+}  // namespace flutter
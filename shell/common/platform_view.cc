@@ -121,6 +121,11 @@ void PlatformView::HandlePlatformMessage(
     response->CompleteEmpty();
 }
 
+std::shared_ptr<PlatformMessageHandler>
+PlatformView::GetPlatformMessageHandler() const {
+  return nullptr;
+}
+
 void PlatformView::OnPreEngineRestart() const {}
 
 void PlatformView::RegisterTexture(std::shared_ptr<flutter::Texture> texture) {
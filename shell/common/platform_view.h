@@ -22,6 +22,7 @@
 #include "flutter/lib/ui/window/pointer_data_packet.h"
 #include "flutter/lib/ui/window/pointer_data_packet_converter.h"
 #include "flutter/lib/ui/window/viewport_metrics.h"
+#include "flutter/shell/common/platform_message_handler.h"
 #include "flutter/shell/common/pointer_data_dispatcher.h"
 #include "flutter/shell/common/vsync_waiter.h"
 #include "third_party/skia/include/core/SkSize.h"
@@ -397,6 +398,22 @@ class PlatformView {
   ///
   virtual void HandlePlatformMessage(std::unique_ptr<PlatformMessage> message);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Overridden by embedders that can handle some platform messages
+  ///             away from the platform thread. The shell calls this once when
+  ///             it is set up. Messages on the channels given to
+  ///             `Shell::SetPlatformMessageTaskRunner` go to the returned
+  ///             handler on the task runner of their channel instead of
+  ///             `HandlePlatformMessage`.
+  ///
+  /// @see        Shell::SetPlatformMessageTaskRunner()
+  ///
+  /// @return     The handler, or null if every message must be handled on the
+  ///             platform thread, which is the default.
+  ///
+  virtual std::shared_ptr<PlatformMessageHandler> GetPlatformMessageHandler()
+      const;
+
   //----------------------------------------------------------------------------
   /// @brief      Used by embedders to dispatch an accessibility action to a
   ///             running isolate hosted by the engine.
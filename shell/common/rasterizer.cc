@@ -137,6 +137,8 @@ void Rasterizer::DisableThreadMergerIfNeeded() {
 }
 
 void Rasterizer::NotifyLowMemoryWarning() const {
+  // Cached rasterizations are the cheapest to regenerate, so they go first.
+  compositor_context_->raster_cache().Clear();
   if (!surface_) {
     FML_DLOG(INFO)
         << "Rasterizer::NotifyLowMemoryWarning called with no surface.";
@@ -155,6 +157,39 @@ void Rasterizer::NotifyLowMemoryWarning() const {
   context->performDeferredCleanup(std::chrono::milliseconds(0));
 }
 
+void Rasterizer::PurgeImageMemory() {
+  TRACE_EVENT0("flutter", "Rasterizer::PurgeImageMemory");
+  compositor_context_->raster_cache().Clear();
+  if (!ImageMemoryLedger::GetInstance().IsOverBudget() || !surface_) {
+    return;
+  }
+  auto context = surface_->GetContext();
+  if (!context) {
+    return;
+  }
+  auto context_switch = surface_->MakeRenderContextCurrent();
+  if (!context_switch->GetResult()) {
+    return;
+  }
+  context->purgeUnlockedResources(/*scratchResourcesOnly=*/false);
+  UpdateResourceCacheAllocation();
+}
+
+void Rasterizer::UpdateResourceCacheAllocation() {
+  size_t resource_bytes = 0;
+  if (surface_ && surface_->GetContext()) {
+    surface_->GetContext()->getResourceCacheUsage(nullptr, &resource_bytes);
+    // The surfaces of the raster cache are resources of this context too, and
+    // are already charged to kRasterCache.
+    const RasterCache& raster_cache = compositor_context_->raster_cache();
+    const size_t raster_cache_bytes =
+        raster_cache.EstimateLayerCacheByteSize() +
+        raster_cache.EstimatePictureCacheByteSize();
+    resource_bytes -= std::min(resource_bytes, raster_cache_bytes);
+  }
+  resource_cache_allocation_.Update(resource_bytes);
+}
+
 flutter::TextureRegistry* Rasterizer::GetTextureRegistry() {
   return &compositor_context_->texture_registry();
 }
@@ -535,6 +570,8 @@ RasterStatus Rasterizer::DrawToSurface(
       TRACE_EVENT0("flutter", "PerformDeferredSkiaCleanup");
       surface_->GetContext()->performDeferredCleanup(kSkiaCleanupExpiration);
     }
+    UpdateResourceCacheAllocation();
+    ImageMemoryLedger::GetInstance().TraceCountersToTimeline();
 
     return raster_status;
   }
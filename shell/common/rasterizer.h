@@ -13,6 +13,7 @@
 #include "flutter/flow/compositor_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/frame_timings.h"
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/flow/layers/layer_tree.h"
 #include "flutter/flow/surface.h"
 #include "flutter/fml/closure.h"
@@ -158,6 +159,15 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   void NotifyLowMemoryWarning() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Releases image memory held by the rasterizer because the
+  ///             `ImageMemoryLedger` is over its budget. Raster cache entries
+  ///             are released first since they can be regenerated from the
+  ///             layer tree. If the ledger is still over its budget, the
+  ///             unlocked resources in the Skia resource cache are purged.
+  ///
+  void PurgeImageMemory();
+
   //----------------------------------------------------------------------------
   /// @brief      Gets a weak pointer to the rasterizer. The rasterizer may only
   ///             be accessed on the raster task runner.
@@ -463,6 +473,9 @@ class Rasterizer final : public SnapshotDelegate {
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
   std::shared_ptr<ExternalViewEmbedder> external_view_embedder_;
   bool shared_engine_block_thread_merging_ = false;
+  ImageMemoryLedger::Allocation resource_cache_allocation_ =
+      ImageMemoryLedger::GetInstance().Track(
+          ImageMemoryCategory::kResourceCache, 0);
 
   // |SnapshotDelegate|
   sk_sp<SkImage> MakeRasterSnapshot(sk_sp<SkPicture> picture,
@@ -471,6 +484,8 @@ class Rasterizer final : public SnapshotDelegate {
   // |SnapshotDelegate|
   sk_sp<SkImage> ConvertToRasterImage(sk_sp<SkImage> image) override;
 
+  void UpdateResourceCacheAllocation();
+
   sk_sp<SkData> ScreenshotLayerTreeAsImage(
       flutter::LayerTree* tree,
       flutter::CompositorContext& compositor_context,
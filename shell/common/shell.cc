@@ -5,12 +5,17 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <climits>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <vector>
 
 #include "flutter/assets/directory_asset_bundle.h"
 #include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/icu_util.h"
 #include "flutter/fml/log_settings.h"
@@ -25,6 +30,10 @@
 #include "flutter/shell/common/skia_event_tracer_impl.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/common/vsync_waiter.h"
+#include "minikin/Layout.h"
+#include "rapidjson/encodedstream.h"
+#include "rapidjson/memorystream.h"
+#include "rapidjson/reader.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
@@ -38,6 +47,12 @@ constexpr char kSkiaChannel[] = "flutter/skia";
 constexpr char kSystemChannel[] = "flutter/system";
 constexpr char kTypeKey[] = "type";
 constexpr char kFontChange[] = "fontsChange";
+constexpr char kChannelBuffersChannel[] = "dev.flutter/channel-buffers";
+
+// The longest time that messages on the background lane wait for the UI
+// thread to become idle.
+constexpr fml::TimeDelta kMaxBackgroundMessageDelay =
+    fml::TimeDelta::FromMilliseconds(100);
 
 namespace {
 
@@ -120,6 +135,93 @@ void PerformInitializationTasks(Settings& settings) {
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
 }
 
+// A rapidjson SAX handler that reads the method name and integer argument of
+// a message on the Skia channel, without building a document for the message.
+class SkiaMessageHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          SkiaMessageHandler> {
+ public:
+  const std::string& method() const { return method_; }
+
+  const std::optional<int>& args() const { return args_; }
+
+  bool StartObject() {
+    if (depth_ > 0 && !Default()) {
+      return false;
+    }
+    depth_++;
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType member_count) {
+    depth_--;
+    return true;
+  }
+
+  bool StartArray() {
+    // The message must be an object.
+    if (!Default()) {
+      return false;
+    }
+    depth_++;
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType element_count) {
+    depth_--;
+    return true;
+  }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    if (depth_ == 1) {
+      key_.assign(str, length);
+    }
+    return true;
+  }
+
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+    if (depth_ == 1 && key_ == "method") {
+      method_.assign(str, length);
+      return true;
+    }
+    return Default();
+  }
+
+  bool Int(int i) {
+    if (depth_ == 1 && key_ == "args") {
+      args_ = i;
+      return true;
+    }
+    return Default();
+  }
+
+  bool Uint(unsigned u) {
+    return u <= INT_MAX ? Int(static_cast<int>(u)) : Default();
+  }
+
+  // Called for every other value.
+  bool Default() {
+    if (depth_ == 0) {
+      return false;
+    }
+    if (depth_ == 1) {
+      if (key_ == "method") {
+        method_.clear();
+      } else if (key_ == "args") {
+        args_.reset();
+      }
+    }
+    return true;
+  }
+
+ private:
+  int depth_ = 0;
+  // The key of the current member of the message.
+  std::string key_;
+  std::string method_;
+  std::optional<int> args_;
+};
+
 }  // namespace
 
 std::unique_ptr<Shell> Shell::Create(
@@ -350,6 +452,85 @@ std::unique_ptr<Shell> Shell::CreateWithSnapshot(
   return shell;
 }
 
+// Counts the platform messages that are being handled on background task
+// runners. Those runners may outlive the shell, so the shell closes this
+// before it is torn down: messages that are still queued are then dropped
+// instead of reaching a handler whose embedder state may be gone.
+class Shell::PlatformMessageDispatches {
+ public:
+  PlatformMessageDispatches() = default;
+
+  // Returns false if the shell is shutting down and the message must be
+  // dropped. Otherwise |End| must be called once the message is handled.
+  bool Begin() {
+    std::scoped_lock lock(mutex_);
+    if (closed_) {
+      return false;
+    }
+    in_flight_++;
+    return true;
+  }
+
+  void End() {
+    std::scoped_lock lock(mutex_);
+    FML_DCHECK(in_flight_ > 0);
+    if (--in_flight_ == 0) {
+      drained_.notify_all();
+    }
+  }
+
+  // Stops further messages from being handled and waits for the messages
+  // that are being handled.
+  void CloseAndWait() {
+    std::unique_lock lock(mutex_);
+    closed_ = true;
+    drained_.wait(lock, [this] { return in_flight_ == 0; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable drained_;
+  size_t in_flight_ = 0;
+  bool closed_ = false;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PlatformMessageDispatches);
+};
+
+// The rings that answer the messages from the framework on their channels.
+// Shared with the callbacks that remove the rings, which embedders may call
+// after the shell is gone.
+class Shell::PlatformMessageRings {
+ public:
+  PlatformMessageRings() = default;
+
+  void Add(const std::string& channel, fml::RefPtr<PlatformMessageRing> ring) {
+    std::scoped_lock lock(mutex_);
+    rings_[channel] = std::move(ring);
+  }
+
+  fml::RefPtr<PlatformMessageRing> Find(const std::string& channel) {
+    std::scoped_lock lock(mutex_);
+    auto found = rings_.find(channel);
+    return found != rings_.end() ? found->second : nullptr;
+  }
+
+  // Removes |ring| unless another ring has replaced it on |channel|.
+  void Remove(const std::string& channel,
+              const fml::RefPtr<PlatformMessageRing>& ring) {
+    std::scoped_lock lock(mutex_);
+    auto found = rings_.find(channel);
+    if (found != rings_.end() && found->second == ring) {
+      rings_.erase(found);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, fml::RefPtr<PlatformMessageRing>> rings_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PlatformMessageRings);
+};
+
 Shell::Shell(DartVMRef vm,
              TaskRunners task_runners,
              Settings settings,
@@ -360,6 +541,9 @@ Shell::Shell(DartVMRef vm,
       vm_(std::move(vm)),
       is_gpu_disabled_sync_switch_(new fml::SyncSwitch(is_gpu_disabled)),
       volatile_path_tracker_(std::move(volatile_path_tracker)),
+      platform_message_rings_(std::make_shared<PlatformMessageRings>()),
+      platform_message_dispatches_(
+          std::make_shared<PlatformMessageDispatches>()),
       weak_factory_gpu_(nullptr),
       weak_factory_(this) {
   FML_CHECK(vm_) << "Must have access to VM to create a shell.";
@@ -368,6 +552,8 @@ Shell::Shell(DartVMRef vm,
 
   display_manager_ = std::make_unique<DisplayManager>();
 
+  platform_message_stats_->SetEnabled(settings_.enable_platform_message_stats);
+
   // Generate a WeakPtrFactory for use with the raster thread. This does not
   // need to wait on a latch because it can only ever be used from the raster
   // thread from this class, so we have ordering guarantees.
@@ -415,12 +601,33 @@ Shell::Shell(DartVMRef vm,
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetPlatformMessageStatsExtensionName] = {
+          task_runners_.GetUITaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetPlatformMessageStats, this,
+                    std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kSetPlatformMessageStatsEnabledExtensionName] = {
+          task_runners_.GetUITaskRunner(),
+          std::bind(&Shell::OnServiceProtocolSetPlatformMessageStatsEnabled,
+                    this, std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
+  // The handler of background channels calls into the embedder, which may
+  // free its state as soon as the shell is gone.
+  platform_message_dispatches_->CloseAndWait();
+
   PersistentCache::GetCacheForProcess()->RemoveWorkerTaskRunner(
       task_runners_.GetIOTaskRunner());
 
+  ImageMemoryLedger::GetInstance().RemovePressureListener(
+      image_memory_pressure_listener_);
+  ImageMemoryLedger::GetInstance().RemoveBudget(image_memory_budget_);
+  if (shaping_cache_budget_ != 0) {
+    minikin::Layout::removeCacheBudget(shaping_cache_budget_);
+  }
+
   vm_->GetServiceProtocol()->RemoveHandler(this);
 
   fml::AutoResetWaitableEvent ui_latch, gpu_latch, platform_latch, io_latch;
@@ -640,6 +847,20 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
   weak_engine_ = engine_->GetWeakPtr();
   weak_rasterizer_ = rasterizer_->GetWeakPtr();
   weak_platform_view_ = platform_view_->GetWeakPtr();
+  platform_message_handler_ = platform_view_->GetPlatformMessageHandler();
+  platform_message_batcher_ = std::make_shared<PlatformMessageBatcher>(
+      task_runners_.GetUITaskRunner().get(),
+      [engine = weak_engine_, stats = platform_message_stats_](
+          std::unique_ptr<PlatformMessage> message) {
+        if (engine) {
+          PlatformMessageStats::HandlerScope scope(
+              *stats, PlatformMessageStats::Direction::kToFramework, *message);
+          engine->DispatchPlatformMessage(std::move(message));
+        }
+      },
+      [ui_task_runner = task_runners_.GetUITaskRunner()](fml::closure deliver) {
+        ui_task_runner->PostDelayedTask(deliver, kMaxBackgroundMessageDelay);
+      });
 
   // Setup the time-consuming default font manager right after engine created.
   fml::TaskRunner::RunNowOrPostTask(task_runners_.GetUITaskRunner(),
@@ -661,6 +882,38 @@ bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
     PersistentCache::GetCacheForProcess()->Purge();
   }
 
+  // When image memory goes over budget, evict in order of how cheap the
+  // memory is to get back: raster cache entries, then the GPU resource cache,
+  // and finally unreachable `ui.Image`s by asking the VM to collect garbage.
+  image_memory_pressure_listener_ =
+      ImageMemoryLedger::GetInstance().AddPressureListener(
+          [raster_task_runner = task_runners_.GetRasterTaskRunner(),
+           ui_task_runner = task_runners_.GetUITaskRunner(),
+           rasterizer = weak_rasterizer_](size_t bytes_over_budget) {
+            raster_task_runner->PostTask([ui_task_runner, rasterizer]() {
+              if (!rasterizer) {
+                return;
+              }
+              rasterizer->PurgeImageMemory();
+              if (ImageMemoryLedger::GetInstance().IsOverBudget()) {
+                // Like `NotifyLowMemoryWarning`, ask the VM from the UI
+                // thread so that the raster thread isn't held up by it.
+                ui_task_runner->PostTask([]() { ::Dart_NotifyLowMemory(); });
+              }
+            });
+          });
+  // Budgets too large to count in bytes are no budget at all.
+  const size_t max_budget_mb = std::numeric_limits<size_t>::max() >> 20;
+  if (settings_.image_memory_budget_mb <= max_budget_mb) {
+    image_memory_budget_ = ImageMemoryLedger::GetInstance().AddBudget(
+        settings_.image_memory_budget_mb << 20);
+  }
+  if (settings_.shaping_cache_budget_mb > 0 &&
+      settings_.shaping_cache_budget_mb <= max_budget_mb) {
+    shaping_cache_budget_ = minikin::Layout::addCacheBudget(
+        settings_.shaping_cache_budget_mb << 20);
+  }
+
   return true;
 }
 
@@ -941,12 +1194,9 @@ void Shell::OnPlatformViewDispatchPlatformMessage(
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(fml::MakeCopyable(
-      [engine = engine_->GetWeakPtr(), message = std::move(message)]() mutable {
-        if (engine) {
-          engine->DispatchPlatformMessage(std::move(message));
-        }
-      }));
+  platform_message_stats_->RecordSend(
+      PlatformMessageStats::Direction::kToFramework, *message);
+  platform_message_batcher_->DispatchPlatformMessage(std::move(message));
 }
 
 // |PlatformView::Delegate|
@@ -1111,6 +1361,7 @@ void Shell::OnAnimatorBeginFrame(fml::TimePoint frame_target_time) {
     latest_frame_target_time_.emplace(frame_target_time);
   }
   if (engine_) {
+    platform_message_batcher_->DeliverUrgentMessages();
     engine_->BeginFrame(frame_target_time);
   }
 }
@@ -1121,6 +1372,11 @@ void Shell::OnAnimatorNotifyIdle(int64_t deadline) {
   FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
   if (engine_) {
+    // The messages on the background lane get the idle time before the engine
+    // does.
+    platform_message_batcher_->DeliverBackgroundMessages(
+        fml::TimePoint::Now() +
+        fml::TimeDelta::FromMicroseconds(deadline - Dart_TimelineGetMicros()));
     engine_->NotifyIdle(deadline);
     volatile_path_tracker_->OnFrame();
   }
@@ -1214,10 +1470,58 @@ void Shell::OnEngineHandlePlatformMessage(
     return;
   }
 
+  fml::RefPtr<PlatformMessageRing> ring =
+      platform_message_rings_->Find(message->channel());
+  if (ring) {
+    // The framework asks for the buffer of the ring by sending any message
+    // on its channel.
+    if (message->response()) {
+      message->response()->Complete(ring->CreateMapping());
+    }
+    return;
+  }
+
+  platform_message_stats_->RecordSend(
+      PlatformMessageStats::Direction::kToPlatform, *message);
+
+  if (platform_message_handler_) {
+    std::shared_ptr<fml::BasicTaskRunner> task_runner;
+    {
+      std::scoped_lock lock(platform_message_task_runners_mutex_);
+      auto found = platform_message_task_runners_.find(message->channel());
+      if (found != platform_message_task_runners_.end()) {
+        task_runner = found->second;
+      }
+    }
+    if (task_runner) {
+      task_runner->PostTask(
+          fml::MakeCopyable([handler = platform_message_handler_,
+                             dispatches = platform_message_dispatches_,
+                             stats = platform_message_stats_,
+                             message = std::move(message)]() mutable {
+            if (!dispatches->Begin()) {
+              // The shell is being torn down, so the message is dropped.
+              return;
+            }
+            {
+              PlatformMessageStats::HandlerScope scope(
+                  *stats, PlatformMessageStats::Direction::kToPlatform,
+                  *message);
+              handler->HandlePlatformMessage(std::move(message));
+            }
+            dispatches->End();
+          }));
+      return;
+    }
+  }
+
   task_runners_.GetPlatformTaskRunner()->PostTask(
       fml::MakeCopyable([view = platform_view_->GetWeakPtr(),
+                         stats = platform_message_stats_,
                          message = std::move(message)]() mutable {
         if (view) {
+          PlatformMessageStats::HandlerScope scope(
+              *stats, PlatformMessageStats::Direction::kToPlatform, *message);
           view->HandlePlatformMessage(std::move(message));
         }
       }));
@@ -1226,21 +1530,23 @@ void Shell::OnEngineHandlePlatformMessage(
 void Shell::HandleEngineSkiaMessage(std::unique_ptr<PlatformMessage> message) {
   const auto& data = message->data();
 
-  rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
-                 data.GetSize());
-  if (document.HasParseError() || !document.IsObject())
+  // The message is read with a SAX handler, since it only has two fields that
+  // are needed.
+  SkiaMessageHandler handler;
+  rapidjson::MemoryStream memory_stream(
+      reinterpret_cast<const char*>(data.GetMapping()), data.GetSize());
+  rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
+      stream(memory_stream);
+  rapidjson::Reader reader;
+  if (reader.Parse(stream, handler).IsError())
     return;
-  auto root = document.GetObject();
-  auto method = root.FindMember("method");
-  if (method->value != "Skia.setResourceCacheMaxBytes")
+  if (handler.method() != "Skia.setResourceCacheMaxBytes")
     return;
-  auto args = root.FindMember("args");
-  if (args == root.MemberEnd() || !args->value.IsInt())
+  if (!handler.args())
     return;
 
   task_runners_.GetRasterTaskRunner()->PostTask(
-      [rasterizer = rasterizer_->GetWeakPtr(), max_bytes = args->value.GetInt(),
+      [rasterizer = rasterizer_->GetWeakPtr(), max_bytes = *handler.args(),
        response = std::move(message->response())] {
         if (rasterizer) {
           rasterizer->SetResourceCacheMaxBytes(static_cast<size_t>(max_bytes),
@@ -1692,6 +1998,83 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+bool Shell::OnServiceProtocolGetPlatformMessageStats(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "PlatformMessageStats", allocator);
+  response->AddMember("enabled", platform_message_stats_->IsEnabled(),
+                      allocator);
+
+  // Times are in microseconds.
+  rapidjson::Value channels(rapidjson::kArrayType);
+  for (const auto& stats : platform_message_stats_->GetChannelStats()) {
+    rapidjson::Value channel(rapidjson::kObjectType);
+    rapidjson::Value name(stats.channel, allocator);
+    channel.AddMember("channel", name, allocator);
+    channel.AddMember(
+        "direction",
+        rapidjson::StringRef(
+            stats.direction == PlatformMessageStats::Direction::kToFramework
+                ? "toFramework"
+                : "toPlatform"),
+        allocator);
+    channel.AddMember<uint64_t>("messages", stats.message_count, allocator);
+    channel.AddMember<uint64_t>("bytes", stats.byte_count, allocator);
+    channel.AddMember<uint64_t>("handled", stats.handled_count, allocator);
+    channel.AddMember<int64_t>("totalQueueingDelay",
+                               stats.total_queueing_delay.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("maxQueueingDelay",
+                               stats.max_queueing_delay.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("totalHandlerTime",
+                               stats.total_handler_time.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("maxHandlerTime",
+                               stats.max_handler_time.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<uint64_t>("responses", stats.response_count, allocator);
+    channel.AddMember<int64_t>("responseLatencyP50",
+                               stats.response_latency_p50.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("responseLatencyP90",
+                               stats.response_latency_p90.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("responseLatencyP99",
+                               stats.response_latency_p99.ToMicroseconds(),
+                               allocator);
+    channel.AddMember<int64_t>("maxResponseLatency",
+                               stats.max_response_latency.ToMicroseconds(),
+                               allocator);
+    channels.PushBack(channel, allocator);
+  }
+  response->AddMember("channels", channels, allocator);
+  return true;
+}
+
+// Service protocol handler
+bool Shell::OnServiceProtocolSetPlatformMessageStatsEnabled(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  auto found = params.find("enabled");
+  if (found == params.end() ||
+      (found->second != "true" && found->second != "false")) {
+    ServiceProtocolParameterError(
+        response, "'enabled' parameter must be 'true' or 'false'.");
+    return false;
+  }
+
+  platform_message_stats_->SetEnabled(found->second == "true");
+  response->SetObject();
+  response->AddMember("type", "Success", response->GetAllocator());
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -1853,6 +2236,99 @@ void Shell::SetGpuAvailability(GpuAvailability availability) {
   }
 }
 
+void Shell::SetPlatformMessageTaskRunner(
+    const std::string& channel,
+    std::shared_ptr<fml::BasicTaskRunner> task_runner) {
+  std::scoped_lock lock(platform_message_task_runners_mutex_);
+  if (task_runner) {
+    platform_message_task_runners_[channel] = std::move(task_runner);
+  } else {
+    platform_message_task_runners_.erase(channel);
+  }
+}
+
+void Shell::SetPlatformMessageBatching(const std::string& channel,
+                                       PlatformMessageBatcher::Mode mode) {
+  platform_message_batcher_->SetMode(channel, mode);
+}
+
+void Shell::SetPlatformMessageLane(const std::string& channel,
+                                   PlatformMessageBatcher::Lane lane) {
+  platform_message_batcher_->SetLane(channel, lane);
+
+  // The channel buffers of the framework are told about the lane with a
+  // `lane` method call in the standard method codec, which they decode by
+  // hand. They only accept channel names that fit in a one byte size.
+  if (channel.size() >= 254) {
+    FML_LOG(ERROR) << "The channel buffers of the framework do not support "
+                      "lanes on channels with long names: "
+                   << channel;
+    return;
+  }
+  constexpr uint8_t kStringType = 7;
+  constexpr uint8_t kInt32Type = 3;
+  constexpr uint8_t kListType = 12;
+  constexpr char kLaneMethod[] = "lane";
+  std::vector<uint8_t> data;
+  data.push_back(kStringType);
+  data.push_back(sizeof(kLaneMethod) - 1);
+  data.insert(data.end(), kLaneMethod, kLaneMethod + sizeof(kLaneMethod) - 1);
+  data.push_back(kListType);
+  data.push_back(2);
+  data.push_back(kStringType);
+  data.push_back(static_cast<uint8_t>(channel.size()));
+  data.insert(data.end(), channel.begin(), channel.end());
+  data.push_back(kInt32Type);
+  const int32_t lane_index = static_cast<int32_t>(lane);
+  const uint8_t* lane_bytes = reinterpret_cast<const uint8_t*>(&lane_index);
+  data.insert(data.end(), lane_bytes, lane_bytes + sizeof(lane_index));
+
+  auto message = std::make_unique<PlatformMessage>(
+      kChannelBuffersChannel,
+      fml::MallocMapping::Copy(data.data(), data.size()), nullptr);
+  platform_message_stats_->RecordSend(
+      PlatformMessageStats::Direction::kToFramework, *message);
+  platform_message_batcher_->DispatchPlatformMessage(std::move(message));
+}
+
+fml::RefPtr<PlatformMessageRing> Shell::CreatePlatformMessageRing(
+    const std::string& channel,
+    size_t capacity) {
+  auto ring = PlatformMessageRing::Create(
+      capacity, [ui_task_runner = task_runners_.GetUITaskRunner(),
+                 engine = weak_engine_,
+                 channel](fml::RefPtr<PlatformMessageRing> ring) {
+        // The doorbell is created on the UI thread, so that it covers all the
+        // records that were written until the framework gets to it.
+        ui_task_runner->PostTask([engine, channel, ring]() {
+          if (engine) {
+            engine->DispatchPlatformMessage(
+                ring->CreateDoorbellMessage(channel));
+          }
+        });
+      });
+  if (ring) {
+    platform_message_rings_->Add(channel, ring);
+  }
+  return ring;
+}
+
+fml::closure Shell::GetPlatformMessageRingRemover(
+    const std::string& channel,
+    fml::RefPtr<PlatformMessageRing> ring) {
+  return [rings = std::weak_ptr<PlatformMessageRings>(platform_message_rings_),
+          channel, ring = std::move(ring)]() {
+    if (auto shared_rings = rings.lock()) {
+      shared_rings->Remove(channel, ring);
+    }
+  };
+}
+
+std::vector<PlatformMessageStats::ChannelStats> Shell::GetPlatformMessageStats()
+    const {
+  return platform_message_stats_->GetChannelStats();
+}
+
 void Shell::OnDisplayUpdates(DisplayUpdateType update_type,
                              std::vector<Display> displays) {
   display_manager_->HandleDisplayUpdates(update_type, displays);
@@ -35,6 +35,9 @@
 #include "flutter/shell/common/animator.h"
 #include "flutter/shell/common/display_manager.h"
 #include "flutter/shell/common/engine.h"
+#include "flutter/shell/common/platform_message_batcher.h"
+#include "flutter/shell/common/platform_message_ring.h"
+#include "flutter/shell/common/platform_message_stats.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/shell_io_manager.h"
@@ -357,6 +360,113 @@ class Shell final : public PlatformView::Delegate,
   ///
   DartVM* GetDartVM();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Dispatches the platform messages that the framework sends on
+  ///             a channel to a task runner instead of the platform thread.
+  ///             The messages go straight from the UI thread to the
+  ///             `PlatformMessageHandler` of the platform view, so that
+  ///             handlers that do not need the platform thread do not wait
+  ///             behind other work on it. Responses are still delivered to the
+  ///             framework on the UI thread.
+  ///
+  ///             Messages stay on the platform thread if the platform view
+  ///             has no `PlatformMessageHandler`. This may be called on any
+  ///             thread.
+  ///
+  ///             The task runner may outlive the shell. Messages that are
+  ///             still queued on it when the shell is destroyed are dropped
+  ///             without reaching the handler, and the destructor waits for
+  ///             the messages that are being handled. Handlers must therefore
+  ///             not block on the platform thread.
+  ///
+  /// @param[in]  channel      The channel.
+  /// @param[in]  task_runner  The task runner on which to handle the messages
+  ///                          on the channel, or null to handle them on the
+  ///                          platform thread again.
+  ///
+  void SetPlatformMessageTaskRunner(
+      const std::string& channel,
+      std::shared_ptr<fml::BasicTaskRunner> task_runner);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets whether the platform messages that the platform view
+  ///             sends on a channel are batched on their way to the UI
+  ///             thread. Batching channels that send many messages per frame
+  ///             saves a UI thread task per message, and channels that carry
+  ///             state can also drop the messages that a newer one replaces
+  ///             before the framework sees them. This may be called on any
+  ///             thread.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  mode     How the messages on the channel are delivered.
+  ///
+  /// @see        PlatformMessageBatcher
+  ///
+  void SetPlatformMessageBatching(const std::string& channel,
+                                  PlatformMessageBatcher::Mode mode);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the lane of the platform messages that the platform view
+  ///             sends on a channel. Messages on the input and frame-critical
+  ///             lanes reach the framework ahead of the other messages and of
+  ///             the next frame, and messages on the background lane wait for
+  ///             the UI thread to be idle. The channel buffers of the
+  ///             framework are told about the lane too. This may be called on
+  ///             any thread.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  lane     The lane.
+  ///
+  /// @see        PlatformMessageBatcher
+  ///
+  void SetPlatformMessageLane(const std::string& channel,
+                              PlatformMessageBatcher::Lane lane);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a ring buffer that native code writes records to, and
+  ///             that the framework reads on a channel. The ring replaces any
+  ///             ring that was created on the channel before. This may be
+  ///             called on any thread.
+  ///
+  /// @param[in]  channel   The channel.
+  /// @param[in]  capacity  The size of the buffer in bytes. Must be a power
+  ///                       of two that is at least
+  ///                       `PlatformMessageRing::kMinCapacity`.
+  ///
+  /// @return     The ring, or null if the capacity is invalid.
+  ///
+  /// @see        PlatformMessageRing
+  ///
+  fml::RefPtr<PlatformMessageRing> CreatePlatformMessageRing(
+      const std::string& channel,
+      size_t capacity);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Gets a callback that stops answering the framework on a
+  ///             channel with a ring, unless another ring has replaced it on
+  ///             the channel. The ring stays valid for as long as it is
+  ///             referenced. The callback may be called on any thread, and
+  ///             does nothing once the shell has been destroyed.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  ring     The ring.
+  ///
+  fml::closure GetPlatformMessageRingRemover(
+      const std::string& channel,
+      fml::RefPtr<PlatformMessageRing> ring);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Gets the counters and timings of the platform messages on
+  ///             each channel, in both directions, since the shell was
+  ///             created. This may be called on any thread.
+  ///
+  /// @return     The stats of every channel that carried a message.
+  ///
+  /// @see        PlatformMessageStats
+  ///
+  std::vector<PlatformMessageStats::ChannelStats> GetPlatformMessageStats()
+      const;
+
   //----------------------------------------------------------------------------
   /// @brief      Notifies the display manager of the updates.
   ///
@@ -390,6 +500,26 @@ class Shell final : public PlatformView::Delegate,
       weak_rasterizer_;  // to be shared across threads
   fml::WeakPtr<PlatformView>
       weak_platform_view_;  // to be shared across threads
+  // Handles the messages on the channels in platform_message_task_runners_.
+  std::shared_ptr<PlatformMessageHandler> platform_message_handler_;
+  // Hands the messages from the platform view over to the UI thread.
+  std::shared_ptr<PlatformMessageBatcher> platform_message_batcher_;
+  // The rings that answer the messages from the framework on their channels.
+  class PlatformMessageRings;
+  const std::shared_ptr<PlatformMessageRings> platform_message_rings_;
+  // The task runners of the channels whose messages are not handled on the
+  // platform thread. Written on any thread and read on the UI thread.
+  std::mutex platform_message_task_runners_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<fml::BasicTaskRunner>>
+      platform_message_task_runners_;
+  // Tracks the messages handed to platform_message_handler_ so that the
+  // destructor can drop the queued ones and wait for the rest.
+  class PlatformMessageDispatches;
+  const std::shared_ptr<PlatformMessageDispatches>
+      platform_message_dispatches_;
+  // Counts and times the platform messages in both directions.
+  const std::shared_ptr<PlatformMessageStats> platform_message_stats_ =
+      std::make_shared<PlatformMessageStats>();
 
   std::unordered_map<std::string_view,  // method
                      std::pair<fml::RefPtr<fml::TaskRunner>,
@@ -397,6 +527,12 @@ class Shell final : public PlatformView::Delegate,
                                                         // pair
                      >
       service_protocol_handlers_;
+  // The identifiers of the listener and of the budget registered with the
+  // `ImageMemoryLedger`.
+  size_t image_memory_pressure_listener_ = 0;
+  size_t image_memory_budget_ = 0;
+  // The identifier of the budget registered with the shaping cache, or 0.
+  size_t shaping_cache_budget_ = 0;
   bool is_setup_ = false;
   bool is_added_to_service_protocol_ = false;
   uint64_t next_pointer_flow_id_ = 0;
@@ -645,6 +781,16 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  bool OnServiceProtocolGetPlatformMessageStats(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  bool OnServiceProtocolSetPlatformMessageStatsEnabled(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // Creates an asset bundle from the original settings asset path or
   // directory.
   std::unique_ptr<DirectoryAssetBundle> RestoreOriginalAssetResolver();
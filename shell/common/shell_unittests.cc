@@ -1507,6 +1507,63 @@ TEST_F(ShellTest, SetResourceCacheSize) {
   DestroyShell(std::move(shell), std::move(task_runners));
 }
 
+TEST_F(ShellTest, SetResourceCacheSizeIgnoresMalformedMessages) {
+  Settings settings = CreateSettingsForFixture();
+  auto task_runner = CreateNewThread();
+  TaskRunners task_runners("test", task_runner, task_runner, task_runner,
+                           task_runner);
+  std::unique_ptr<Shell> shell =
+      CreateShell(std::move(settings), std::move(task_runners));
+
+  // Create the surface needed by rasterizer
+  PlatformViewNotifyCreated(shell.get());
+
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  configuration.SetEntrypoint("emptyMain");
+
+  RunEngine(shell.get(), std::move(configuration));
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetPlatformTaskRunner(), [&shell]() {
+        shell->GetPlatformView()->SetViewportMetrics({1.0, 400, 200});
+      });
+  PumpOneFrame(shell.get());
+  EXPECT_EQ(GetRasterizerResourceCacheBytesSync(*shell), 3840000U);
+
+  std::vector<std::string> requests = {
+      R"json({"args": 10000})json",
+      R"json({"method": "Skia.setResourceCacheMaxBytes"})json",
+      R"json({"method": "Skia.setResourceCacheMaxBytes", "args": "10000"})json",
+      R"json({"method": "Skia.setResourceCacheMaxBytes", "args": [10000]})json",
+      R"json({"method": "Skia.setResourceCacheMaxBytes", "args": 10000)json",
+      R"json(["Skia.setResourceCacheMaxBytes", 10000])json",
+  };
+  for (const auto& request_json : requests) {
+    auto data =
+        fml::MallocMapping::Copy(request_json.c_str(), request_json.length());
+    auto platform_message = std::make_unique<PlatformMessage>(
+        "flutter/skia", std::move(data), nullptr);
+    SendEnginePlatformMessage(shell.get(), std::move(platform_message));
+  }
+  PumpOneFrame(shell.get());
+  EXPECT_EQ(GetRasterizerResourceCacheBytesSync(*shell), 3840000U);
+
+  // Members other than the method and arguments are ignored.
+  std::string request_json = R"json({
+                                "method": "Skia.setResourceCacheMaxBytes",
+                                "extra": {"method": "Skia.other", "args": 1},
+                                "args": 10000
+                              })json";
+  auto data =
+      fml::MallocMapping::Copy(request_json.c_str(), request_json.length());
+  auto platform_message = std::make_unique<PlatformMessage>(
+      "flutter/skia", std::move(data), nullptr);
+  SendEnginePlatformMessage(shell.get(), std::move(platform_message));
+  PumpOneFrame(shell.get());
+  EXPECT_EQ(GetRasterizerResourceCacheBytesSync(*shell), 10000U);
+
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+
 TEST_F(ShellTest, SetResourceCacheSizeEarly) {
   Settings settings = CreateSettingsForFixture();
   auto task_runner = CreateNewThread();
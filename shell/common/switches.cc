@@ -394,6 +394,9 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.enable_skparagraph =
       command_line.HasOption(FlagForSwitch(Switch::EnableSkParagraph));
 
+  settings.enable_parallel_text_layout =
+      command_line.HasOption(FlagForSwitch(Switch::EnableParallelTextLayout));
+
   std::string all_dart_flags;
   if (command_line.GetOptionValue(FlagForSwitch(Switch::DartFlags),
                                   &all_dart_flags)) {
@@ -426,6 +429,30 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
                                 &old_gen_heap_size);
     settings.old_gen_heap_size = std::stoi(old_gen_heap_size);
   }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::ImageMemoryBudget))) {
+    if (!GetSwitchValue(command_line, Switch::ImageMemoryBudget,
+                        &settings.image_memory_budget_mb)) {
+      FML_LOG(INFO) << "Image memory budget specified was malformed. Will "
+                       "default to no budget.";
+    }
+  }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::ShapingCacheBudget))) {
+    if (!GetSwitchValue(command_line, Switch::ShapingCacheBudget,
+                        &settings.shaping_cache_budget_mb)) {
+      FML_LOG(INFO) << "Shaping cache budget specified was malformed. Will "
+                       "keep the default budget.";
+    }
+  }
+
+  settings.enable_platform_message_stats =
+      command_line.HasOption(FlagForSwitch(Switch::EnablePlatformMessageStats));
+
+  command_line.GetOptionValue(FlagForSwitch(Switch::FallbackFontIndexPath),
+                              &settings.fallback_font_index_path);
+  command_line.GetOptionValue(FlagForSwitch(Switch::HyphenationPatternsPath),
+                              &settings.hyphenation_patterns_path);
   return settings;
 }
 
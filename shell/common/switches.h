@@ -203,9 +203,36 @@ DEF_SWITCH(
 DEF_SWITCH(OldGenHeapSize,
            "old-gen-heap-size",
            "The size limit in megabytes for the Dart VM old gen heap space.")
+DEF_SWITCH(ImageMemoryBudget,
+           "image-memory-budget-mb",
+           "The budget in megabytes for decoded images, raster cache entries "
+           "and GPU resources. When exceeded, the engine evicts cached "
+           "rasterizations and GPU resources.")
+DEF_SWITCH(ShapingCacheBudget,
+           "shaping-cache-budget-mb",
+           "The budget in megabytes for the cache of shaped words used by "
+           "text layout.")
+DEF_SWITCH(EnablePlatformMessageStats,
+           "enable-platform-message-stats",
+           "Records the counts and timings of the platform messages on each "
+           "channel from launch.")
+DEF_SWITCH(FallbackFontIndexPath,
+           "fallback-font-index-path",
+           "The directory in which to save the index of the code points "
+           "covered by the installed fonts. The index speeds up finding "
+           "fallback fonts for characters the app's fonts do not cover.")
+DEF_SWITCH(HyphenationPatternsPath,
+           "hyphenation-patterns-path",
+           "The directory holding the hyphenation patterns, as a "
+           "hyph-<language>.hyb file per language. Paragraphs with a locale "
+           "are hyphenated with the patterns of their language.")
 DEF_SWITCH(EnableSkParagraph,
            "enable-skparagraph",
            "Selects the SkParagraph implementation of the text layout engine.")
+DEF_SWITCH(EnableParallelTextLayout,
+           "enable-parallel-text-layout",
+           "Lays out very long paragraphs on the concurrent worker pool. Has "
+           "no effect when the SkParagraph text layout engine is selected.")
 
 DEF_SWITCHES_END
 
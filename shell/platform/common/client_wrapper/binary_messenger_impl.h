@@ -36,6 +36,11 @@ class BinaryMessengerImpl : public BinaryMessenger {
   void SetMessageHandler(const std::string& channel,
                          BinaryMessageHandler handler) override;
 
+  // |flutter::BinaryMessenger|
+  void SetMessageHandlerOnQueue(const std::string& channel,
+                                BinaryMessageHandler handler,
+                                BinaryMessageQueue queue) override;
+
  private:
   // Handle for interacting with the C API.
   FlutterDesktopMessengerRef messenger_;
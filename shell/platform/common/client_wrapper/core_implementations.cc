@@ -97,6 +97,29 @@ void BinaryMessengerImpl::Send(const std::string& channel,
 
 void BinaryMessengerImpl::SetMessageHandler(const std::string& channel,
                                             BinaryMessageHandler handler) {
+  SetMessageHandlerOnQueue(channel, std::move(handler),
+                           BinaryMessageQueue::kPlatform);
+}
+
+void BinaryMessengerImpl::SetMessageHandlerOnQueue(
+    const std::string& channel,
+    BinaryMessageHandler handler,
+    BinaryMessageQueue queue) {
+  FlutterDesktopMessageQueue core_queue = kFlutterDesktopMessageQueuePlatform;
+  if (handler) {
+    switch (queue) {
+      case BinaryMessageQueue::kPlatform:
+        break;
+      case BinaryMessageQueue::kSerial:
+        core_queue = kFlutterDesktopMessageQueueSerial;
+        break;
+      case BinaryMessageQueue::kConcurrent:
+        core_queue = kFlutterDesktopMessageQueueConcurrent;
+        break;
+    }
+  }
+  FlutterDesktopMessengerSetQueue(messenger_, channel.c_str(), core_queue);
+
   if (!handler) {
     handlers_.erase(channel);
     FlutterDesktopMessengerSetCallback(messenger_, channel.c_str(), nullptr,
@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <string>
+#include <utility>
 
 namespace flutter {
 
@@ -23,6 +24,18 @@ typedef std::function<
     void(const uint8_t* message, size_t message_size, BinaryReply reply)>
     BinaryMessageHandler;
 
+// The task queue on which a message handler is called.
+enum class BinaryMessageQueue {
+  // The platform thread. This is the default.
+  kPlatform,
+  // A background thread shared by all serial channels, which delivers
+  // messages one at a time, in the order they were sent.
+  kSerial,
+  // The worker threads of the engine, which may deliver messages on the same
+  // channel concurrently and out of order.
+  kConcurrent,
+};
+
 // A protocol for a class that handles communication of binary data on named
 // channels to and from the Flutter engine.
 class BinaryMessenger {
@@ -45,6 +58,22 @@ class BinaryMessenger {
   // existing handler.
   virtual void SetMessageHandler(const std::string& channel,
                                  BinaryMessageHandler handler) = 0;
+
+  // Registers a message handler that is called on |queue| instead of the
+  // platform thread.
+  //
+  // Handlers that do not need the platform thread, such as those doing
+  // database or file work, can use a background queue so that they do not
+  // wait behind other work on the platform thread. The handler and the reply
+  // it is given may be called on that thread. The handler must not be
+  // replaced or unregistered while a message is being handled.
+  //
+  // The default implementation calls the handler on the platform thread.
+  virtual void SetMessageHandlerOnQueue(const std::string& channel,
+                                        BinaryMessageHandler handler,
+                                        BinaryMessageQueue queue) {
+    SetMessageHandler(channel, std::move(handler));
+  }
 };
 
 }  // namespace flutter
@@ -0,0 +1,153 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace flutter {
+
+// A read-only view of a value encoded by StandardMessageCodec, which reads the
+// value in place instead of decoding it into an EncodableValue.
+//
+// Creating and walking views never allocates: strings and typed lists are
+// returned as views into the message, and lists and maps are walked one
+// element at a time. This makes reading a few fields of a large message much
+// cheaper than decoding the whole message with DecodeMessage.
+//
+// The message must outlive every view into it. Typed lists can only be read
+// if the message is 8-byte aligned, as messages received from the engine are.
+//
+// Types added by StandardCodecSerializer subclasses cannot be read. Views of
+// such values, and of malformed messages, are invalid.
+//
+// Example:
+//   EncodableValueView message(data, size);
+//   EncodableValueView width = message.Find("width");
+//   if (width.type() == EncodableValueView::Type::kInt32) { ... }
+class EncodableValueView {
+ public:
+  // The types of value, which mirror the types of EncodableValue.
+  enum class Type {
+    kInvalid,
+    kNull,
+    kBool,
+    kInt32,
+    kInt64,
+    kDouble,
+    kString,
+    kUInt8List,
+    kInt32List,
+    kInt64List,
+    kFloat32List,
+    kFloat64List,
+    kList,
+    kMap,
+  };
+
+  // A typed list in the message.
+  template <typename T>
+  class TypedList {
+   public:
+    TypedList() = default;
+    TypedList(const T* data, size_t size) : data_(data), size_(size) {}
+
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+   private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  // Creates an invalid view.
+  EncodableValueView() = default;
+
+  // Creates a view of the value encoded in |message|, which has length
+  // |message_size|.
+  EncodableValueView(const uint8_t* message, size_t message_size);
+
+  // Creates a view of the value encoded in |message|.
+  explicit EncodableValueView(const std::vector<uint8_t>& message)
+      : EncodableValueView(message.data(), message.size()) {}
+
+  Type type() const { return type_; }
+
+  bool IsValid() const { return type_ != Type::kInvalid; }
+
+  bool IsNull() const { return type_ == Type::kNull; }
+
+  // Returns the value of a bool, or false for other types.
+  bool BoolValue() const;
+
+  // Returns the value of an int32 or int64, or 0 for other types. Like
+  // EncodableValue::LongValue, this hides whether Dart sent an int that fits
+  // in 32 bits.
+  int64_t LongValue() const;
+
+  // Returns the value of a double, or 0 for other types.
+  double DoubleValue() const;
+
+  // Returns a view of the UTF-8 bytes of a string, or an empty view for other
+  // types.
+  std::string_view StringValue() const;
+
+  // Returns the elements of a typed list of |T|, which must be one of
+  // uint8_t, int32_t, int64_t, float or double. Returns an empty list if the
+  // value is a different type, or if the message is not aligned.
+  template <typename T>
+  TypedList<T> TypedListValue() const;
+
+  // Returns the number of elements of a list, entries of a map or bytes of a
+  // string, or 0 for other types.
+  size_t size() const { return count_; }
+
+  // Returns the first element of a list, or the key of the first entry of a
+  // map. The view is invalid if the list or map is empty.
+  EncodableValueView First() const;
+
+  // Returns the value that follows this one in its list or map, or an invalid
+  // view if this is the last value. In a map, keys and values alternate, so
+  // the value of a key is the key's Next().
+  EncodableValueView Next() const;
+
+  // Returns the value of the entry with the string key |key| in a map, or an
+  // invalid view if there is no such entry.
+  EncodableValueView Find(std::string_view key) const;
+
+ private:
+  // Creates a view of the value at |offset| in the message, which is followed
+  // by |remaining| values in its list or map.
+  EncodableValueView(const uint8_t* message,
+                     size_t message_size,
+                     size_t offset,
+                     size_t remaining);
+
+  // Returns the offset just past the end of this value, or 0 if it could not
+  // be found.
+  size_t EndOffset() const;
+
+  const uint8_t* message_ = nullptr;
+  size_t message_size_ = 0;
+  // The offset of the type byte of the value.
+  size_t offset_ = 0;
+  // The offset of the value's payload, after its type, size and alignment.
+  size_t payload_offset_ = 0;
+  // The number of values that follow this one in its list or map.
+  size_t remaining_ = 0;
+  size_t count_ = 0;
+  Type type_ = Type::kInvalid;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_VIEW_H_
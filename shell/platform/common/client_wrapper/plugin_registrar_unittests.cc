@@ -40,6 +40,11 @@ class TestApi : public testing::StubFlutterApi {
     last_message_callback_set_ = callback;
   }
 
+  void MessengerSetQueue(const char* channel,
+                         FlutterDesktopMessageQueue queue) override {
+    last_queue_set_ = queue;
+  }
+
   void PluginRegistrarSetDestructionHandler(
       FlutterDesktopOnPluginRegistrarDestroyed callback) override {
     last_destruction_callback_set_ = callback;
@@ -52,10 +57,13 @@ class TestApi : public testing::StubFlutterApi {
   FlutterDesktopOnPluginRegistrarDestroyed last_destruction_callback_set() {
     return last_destruction_callback_set_;
   }
+  FlutterDesktopMessageQueue last_queue_set() { return last_queue_set_; }
 
  private:
   const uint8_t* last_data_sent_ = nullptr;
   FlutterDesktopMessageCallback last_message_callback_set_ = nullptr;
+  FlutterDesktopMessageQueue last_queue_set_ =
+      kFlutterDesktopMessageQueuePlatform;
   FlutterDesktopOnPluginRegistrarDestroyed last_destruction_callback_set_ =
       nullptr;
 };
@@ -155,6 +163,35 @@ TEST(PluginRegistrarTest, MessengerSetMessageHandler) {
   EXPECT_EQ(test_api->last_message_callback_set(), nullptr);
 }
 
+// Tests that the registrar returns a messenger that passes the queue of a
+// handler through to the C API, and resets it when the handler is replaced.
+TEST(PluginRegistrarTest, MessengerSetMessageHandlerOnQueue) {
+  testing::ScopedStubFlutterApi scoped_api_stub(std::make_unique<TestApi>());
+  auto test_api = static_cast<TestApi*>(scoped_api_stub.stub());
+
+  auto dummy_registrar_handle =
+      reinterpret_cast<FlutterDesktopPluginRegistrarRef>(1);
+  PluginRegistrar registrar(dummy_registrar_handle);
+  BinaryMessenger* messenger = registrar.messenger();
+  const std::string channel_name("foo");
+
+  BinaryMessageHandler binary_handler = [](const uint8_t* message,
+                                           const size_t message_size,
+                                           BinaryReply reply) {};
+  messenger->SetMessageHandlerOnQueue(channel_name, binary_handler,
+                                      BinaryMessageQueue::kSerial);
+  EXPECT_NE(test_api->last_message_callback_set(), nullptr);
+  EXPECT_EQ(test_api->last_queue_set(), kFlutterDesktopMessageQueueSerial);
+
+  messenger->SetMessageHandler(channel_name, binary_handler);
+  EXPECT_EQ(test_api->last_queue_set(), kFlutterDesktopMessageQueuePlatform);
+
+  messenger->SetMessageHandlerOnQueue(channel_name, nullptr,
+                                      BinaryMessageQueue::kConcurrent);
+  EXPECT_EQ(test_api->last_message_callback_set(), nullptr);
+  EXPECT_EQ(test_api->last_queue_set(), kFlutterDesktopMessageQueuePlatform);
+}
+
 // Tests that the registrar manager returns the same instance when getting
 // the wrapper for the same reference.
 TEST(PluginRegistrarTest, ManagerSameInstance) {
@@ -3,18 +3,22 @@
 // found in the LICENSE file.
 
 // This file contains what would normally be standard_codec_serializer.cc,
-// standard_message_codec.cc, and standard_method_codec.cc. They are grouped
-// together to simplify use of the client wrapper, since the common case is
-// that any client that needs one of these files needs all three.
+// encodable_value_view.cc, standard_message_codec.cc, and
+// standard_method_codec.cc. They are grouped together to simplify use of the
+// client wrapper, since the common case is that any client that needs one of
+// these files needs all of them.
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "byte_buffer_streams.h"
+#include "include/flutter/encodable_value_view.h"
 #include "include/flutter/standard_codec_serializer.h"
 #include "include/flutter/standard_message_codec.h"
 #include "include/flutter/standard_method_codec.h"
@@ -78,6 +82,69 @@ EncodedType EncodedTypeForValue(const EncodableValue& value) {
   return EncodedType::kNull;
 }
 
+// Returns the number of bytes used to encode the variable-length |size|.
+size_t SizeOfSize(size_t size) {
+  if (size < 254) {
+    return 1;
+  }
+  return size <= 0xffff ? 3 : 5;
+}
+
+// Returns an upper bound for the size of a fixed-type list of |count| values
+// of type T, excluding the type byte.
+template <typename T>
+size_t VectorSizeUpperBound(size_t count) {
+  // Up to sizeof(T) - 1 bytes of padding may be needed for alignment.
+  return SizeOfSize(count) + sizeof(T) - 1 + count * sizeof(T);
+}
+
+// Returns the number of bytes to reserve for the encoding of |value| before
+// writing it, so that large strings and typed lists are written into a buffer
+// of the right size instead of one that grows while writing.
+//
+// This is exact or an upper bound for everything but lists and maps, which
+// are not walked because walking them costs as much as writing them. Those
+// count a byte per element, and the buffer grows as usual while they are
+// written.
+size_t EncodedSizeHint(const EncodableValue& value) {
+  switch (value.index()) {
+    case 2:
+      return 1 + sizeof(int32_t);
+    case 3:
+      return 1 + sizeof(int64_t);
+    case 4:
+      return 1 + 7 + sizeof(double);
+    case 5: {
+      size_t size = std::get<std::string>(value).size();
+      return 1 + SizeOfSize(size) + size;
+    }
+    case 6:
+      return 1 + VectorSizeUpperBound<uint8_t>(
+                     std::get<std::vector<uint8_t>>(value).size());
+    case 7:
+      return 1 + VectorSizeUpperBound<int32_t>(
+                     std::get<std::vector<int32_t>>(value).size());
+    case 8:
+      return 1 + VectorSizeUpperBound<int64_t>(
+                     std::get<std::vector<int64_t>>(value).size());
+    case 9:
+      return 1 + VectorSizeUpperBound<double>(
+                     std::get<std::vector<double>>(value).size());
+    case 10: {
+      size_t size = std::get<EncodableList>(value).size();
+      return 1 + SizeOfSize(size) + size;
+    }
+    case 11: {
+      size_t size = std::get<EncodableMap>(value).size();
+      return 1 + SizeOfSize(size) + 2 * size;
+    }
+    case 13:
+      return 1 + VectorSizeUpperBound<float>(
+                     std::get<std::vector<float>>(value).size());
+  }
+  return 1;
+}
+
 }  // namespace
 
 StandardCodecSerializer::StandardCodecSerializer() = default;
@@ -188,7 +255,7 @@ EncodableValue StandardCodecSerializer::ReadValueOfType(
       std::string string_value;
       string_value.resize(size);
       stream->ReadBytes(reinterpret_cast<uint8_t*>(&string_value[0]), size);
-      return EncodableValue(string_value);
+      return EncodableValue(std::move(string_value));
     }
     case EncodedType::kUInt8List:
       return ReadVector<uint8_t>(stream);
@@ -205,7 +272,7 @@ EncodableValue StandardCodecSerializer::ReadValueOfType(
       for (size_t i = 0; i < length; ++i) {
         list_value.push_back(ReadValue(stream));
       }
-      return EncodableValue(list_value);
+      return EncodableValue(std::move(list_value));
     }
     case EncodedType::kMap: {
       size_t length = ReadSize(stream);
@@ -215,7 +282,7 @@ EncodableValue StandardCodecSerializer::ReadValueOfType(
         EncodableValue value = ReadValue(stream);
         map_value.emplace(std::move(key), std::move(value));
       }
-      return EncodableValue(map_value);
+      return EncodableValue(std::move(map_value));
     }
     case EncodedType::kFloat32List: {
       return ReadVector<float>(stream);
@@ -268,11 +335,11 @@ EncodableValue StandardCodecSerializer::ReadVector(
   }
   stream->ReadBytes(reinterpret_cast<uint8_t*>(vector.data()),
                     count * type_size);
-  return EncodableValue(vector);
+  return EncodableValue(std::move(vector));
 }
 
 template <typename T>
-void StandardCodecSerializer::WriteVector(const std::vector<T> vector,
+void StandardCodecSerializer::WriteVector(const std::vector<T>& vector,
                                           ByteStreamWriter* stream) const {
   size_t count = vector.size();
   WriteSize(count, stream);
@@ -287,6 +354,327 @@ void StandardCodecSerializer::WriteVector(const std::vector<T> vector,
                      count * type_size);
 }
 
+// ===== encodable_value_view.h =====
+
+namespace {
+
+// Used as the number of values following a top-level value, which may be
+// followed by any number of values, like the arguments of a method call.
+constexpr size_t kUnknownRemaining = static_cast<size_t>(-1);
+
+// Reads the variable-length size at |*offset| in |message|, and advances
+// |*offset| past it. Returns false if the message is too short.
+bool ReadSizeAt(const uint8_t* message,
+                size_t message_size,
+                size_t* offset,
+                size_t* size) {
+  if (*offset >= message_size) {
+    return false;
+  }
+  uint8_t byte = message[(*offset)++];
+  if (byte < 254) {
+    *size = byte;
+    return true;
+  }
+  if (byte == 254) {
+    uint16_t value;
+    if (message_size - *offset < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, &message[*offset], sizeof(value));
+    *offset += sizeof(value);
+    *size = value;
+    return true;
+  }
+  uint32_t value;
+  if (message_size - *offset < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, &message[*offset], sizeof(value));
+  *offset += sizeof(value);
+  *size = value;
+  return true;
+}
+
+// Returns the size of the scalar values, characters or elements of values of
+// |type|, or 0 for values without a payload of their own.
+size_t ElementSize(EncodableValueView::Type type) {
+  switch (type) {
+    case EncodableValueView::Type::kString:
+    case EncodableValueView::Type::kUInt8List:
+      return 1;
+    case EncodableValueView::Type::kInt32:
+    case EncodableValueView::Type::kInt32List:
+    case EncodableValueView::Type::kFloat32List:
+      return 4;
+    case EncodableValueView::Type::kInt64:
+    case EncodableValueView::Type::kDouble:
+    case EncodableValueView::Type::kInt64List:
+    case EncodableValueView::Type::kFloat64List:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Maps the element types of typed lists to the types of the lists.
+template <typename T>
+struct TypedListType;
+template <>
+struct TypedListType<uint8_t> {
+  static constexpr auto kType = EncodableValueView::Type::kUInt8List;
+};
+template <>
+struct TypedListType<int32_t> {
+  static constexpr auto kType = EncodableValueView::Type::kInt32List;
+};
+template <>
+struct TypedListType<int64_t> {
+  static constexpr auto kType = EncodableValueView::Type::kInt64List;
+};
+template <>
+struct TypedListType<float> {
+  static constexpr auto kType = EncodableValueView::Type::kFloat32List;
+};
+template <>
+struct TypedListType<double> {
+  static constexpr auto kType = EncodableValueView::Type::kFloat64List;
+};
+
+}  // namespace
+
+EncodableValueView::EncodableValueView(const uint8_t* message,
+                                       size_t message_size)
+    : EncodableValueView(message, message_size, 0, kUnknownRemaining) {}
+
+EncodableValueView::EncodableValueView(const uint8_t* message,
+                                       size_t message_size,
+                                       size_t offset,
+                                       size_t remaining)
+    : message_(message),
+      message_size_(message_size),
+      offset_(offset),
+      remaining_(remaining) {
+  if (!message || offset >= message_size) {
+    return;
+  }
+  size_t position = offset + 1;
+  size_t count = 0;
+  Type type = Type::kInvalid;
+  switch (static_cast<EncodedType>(message[offset])) {
+    case EncodedType::kNull:
+      type = Type::kNull;
+      break;
+    case EncodedType::kTrue:
+    case EncodedType::kFalse:
+      type = Type::kBool;
+      break;
+    case EncodedType::kInt32:
+      type = Type::kInt32;
+      break;
+    case EncodedType::kInt64:
+      type = Type::kInt64;
+      break;
+    case EncodedType::kFloat64:
+      type = Type::kDouble;
+      break;
+    case EncodedType::kLargeInt:
+    case EncodedType::kString:
+      type = Type::kString;
+      break;
+    case EncodedType::kUInt8List:
+      type = Type::kUInt8List;
+      break;
+    case EncodedType::kInt32List:
+      type = Type::kInt32List;
+      break;
+    case EncodedType::kInt64List:
+      type = Type::kInt64List;
+      break;
+    case EncodedType::kFloat32List:
+      type = Type::kFloat32List;
+      break;
+    case EncodedType::kFloat64List:
+      type = Type::kFloat64List;
+      break;
+    case EncodedType::kList:
+      type = Type::kList;
+      break;
+    case EncodedType::kMap:
+      type = Type::kMap;
+      break;
+  }
+  if (type == Type::kInvalid) {
+    return;
+  }
+
+  size_t payload_size = 0;
+  const size_t element_size = ElementSize(type);
+  switch (type) {
+    case Type::kInt32:
+    case Type::kInt64:
+      payload_size = element_size;
+      break;
+    case Type::kDouble:
+      position += (8 - position % 8) % 8;
+      payload_size = element_size;
+      break;
+    case Type::kString:
+    case Type::kUInt8List:
+    case Type::kInt32List:
+    case Type::kInt64List:
+    case Type::kFloat32List:
+    case Type::kFloat64List:
+      if (!ReadSizeAt(message, message_size, &position, &count)) {
+        return;
+      }
+      if (element_size > 1) {
+        position += (element_size - position % element_size) % element_size;
+      }
+      if (position > message_size ||
+          count > (message_size - position) / element_size) {
+        return;
+      }
+      payload_size = count * element_size;
+      break;
+    case Type::kList:
+    case Type::kMap:
+      if (!ReadSizeAt(message, message_size, &position, &count)) {
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  if (position > message_size || payload_size > message_size - position) {
+    return;
+  }
+  payload_offset_ = position;
+  count_ = count;
+  type_ = type;
+}
+
+bool EncodableValueView::BoolValue() const {
+  return type_ == Type::kBool &&
+         static_cast<EncodedType>(message_[offset_]) == EncodedType::kTrue;
+}
+
+int64_t EncodableValueView::LongValue() const {
+  if (type_ == Type::kInt32) {
+    int32_t value;
+    std::memcpy(&value, &message_[payload_offset_], sizeof(value));
+    return value;
+  }
+  if (type_ == Type::kInt64) {
+    int64_t value;
+    std::memcpy(&value, &message_[payload_offset_], sizeof(value));
+    return value;
+  }
+  return 0;
+}
+
+double EncodableValueView::DoubleValue() const {
+  if (type_ != Type::kDouble) {
+    return 0;
+  }
+  double value;
+  std::memcpy(&value, &message_[payload_offset_], sizeof(value));
+  return value;
+}
+
+std::string_view EncodableValueView::StringValue() const {
+  if (type_ != Type::kString) {
+    return std::string_view();
+  }
+  return std::string_view(
+      reinterpret_cast<const char*>(&message_[payload_offset_]), count_);
+}
+
+template <typename T>
+EncodableValueView::TypedList<T> EncodableValueView::TypedListValue() const {
+  if (type_ != TypedListType<T>::kType) {
+    return TypedList<T>();
+  }
+  const uint8_t* data = message_ + payload_offset_;
+  if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+    return TypedList<T>();
+  }
+  return TypedList<T>(reinterpret_cast<const T*>(data), count_);
+}
+
+template EncodableValueView::TypedList<uint8_t>
+EncodableValueView::TypedListValue<uint8_t>() const;
+template EncodableValueView::TypedList<int32_t>
+EncodableValueView::TypedListValue<int32_t>() const;
+template EncodableValueView::TypedList<int64_t>
+EncodableValueView::TypedListValue<int64_t>() const;
+template EncodableValueView::TypedList<float>
+EncodableValueView::TypedListValue<float>() const;
+template EncodableValueView::TypedList<double>
+EncodableValueView::TypedListValue<double>() const;
+
+EncodableValueView EncodableValueView::First() const {
+  if ((type_ != Type::kList && type_ != Type::kMap) || count_ == 0) {
+    return EncodableValueView();
+  }
+  size_t values = type_ == Type::kMap ? count_ * 2 : count_;
+  return EncodableValueView(message_, message_size_, payload_offset_,
+                            values - 1);
+}
+
+EncodableValueView EncodableValueView::Next() const {
+  if (!IsValid() || remaining_ == 0) {
+    return EncodableValueView();
+  }
+  size_t end = EndOffset();
+  if (end == 0 || end >= message_size_) {
+    return EncodableValueView();
+  }
+  return EncodableValueView(
+      message_, message_size_, end,
+      remaining_ == kUnknownRemaining ? kUnknownRemaining : remaining_ - 1);
+}
+
+EncodableValueView EncodableValueView::Find(std::string_view key) const {
+  if (type_ != Type::kMap) {
+    return EncodableValueView();
+  }
+  for (EncodableValueView entry_key = First(); entry_key.IsValid();) {
+    EncodableValueView entry_value = entry_key.Next();
+    if (entry_key.type_ == Type::kString && entry_key.StringValue() == key) {
+      return entry_value;
+    }
+    entry_key = entry_value.Next();
+  }
+  return EncodableValueView();
+}
+
+size_t EncodableValueView::EndOffset() const {
+  switch (type_) {
+    case Type::kInvalid:
+      return 0;
+    case Type::kList:
+    case Type::kMap: {
+      size_t values = type_ == Type::kMap ? count_ * 2 : count_;
+      size_t position = payload_offset_;
+      for (size_t i = 0; i < values; ++i) {
+        EncodableValueView value(message_, message_size_, position, 0);
+        position = value.EndOffset();
+        if (position == 0) {
+          return 0;
+        }
+      }
+      return position;
+    }
+    case Type::kInt32:
+    case Type::kInt64:
+    case Type::kDouble:
+      return payload_offset_ + ElementSize(type_);
+    default:
+      return payload_offset_ + count_ * ElementSize(type_);
+  }
+}
+
 // ===== standard_message_codec.h =====
 
 // static
@@ -295,8 +683,11 @@ const StandardMessageCodec& StandardMessageCodec::GetInstance(
   if (!serializer) {
     serializer = &StandardCodecSerializer::GetInstance();
   }
-  auto* sInstances = new std::map<const StandardCodecSerializer*,
-                                  std::unique_ptr<StandardMessageCodec>>;
+  static auto* sInstances = new std::map<const StandardCodecSerializer*,
+                                         std::unique_ptr<StandardMessageCodec>>;
+  // Codecs may be looked up from background message handlers.
+  static std::mutex sMutex;
+  std::scoped_lock lock(sMutex);
   auto it = sInstances->find(serializer);
   if (it == sInstances->end()) {
     // Uses new due to private constructor (to prevent API clients from
@@ -326,6 +717,7 @@ std::unique_ptr<std::vector<uint8_t>>
 StandardMessageCodec::EncodeMessageInternal(
     const EncodableValue& message) const {
   auto encoded = std::make_unique<std::vector<uint8_t>>();
+  encoded->reserve(EncodedSizeHint(message));
   ByteBufferStreamWriter stream(encoded.get());
   serializer_->WriteValue(message, &stream);
   return encoded;
@@ -339,8 +731,10 @@ const StandardMethodCodec& StandardMethodCodec::GetInstance(
   if (!serializer) {
     serializer = &StandardCodecSerializer::GetInstance();
   }
-  auto* sInstances = new std::map<const StandardCodecSerializer*,
-                                  std::unique_ptr<StandardMethodCodec>>;
+  static auto* sInstances = new std::map<const StandardCodecSerializer*,
+                                         std::unique_ptr<StandardMethodCodec>>;
+  static std::mutex sMutex;
+  std::scoped_lock lock(sMutex);
   auto it = sInstances->find(serializer);
   if (it == sInstances->end()) {
     // Uses new due to private constructor (to prevent API clients from
@@ -380,6 +774,11 @@ std::unique_ptr<std::vector<uint8_t>>
 StandardMethodCodec::EncodeMethodCallInternal(
     const MethodCall<EncodableValue>& method_call) const {
   auto encoded = std::make_unique<std::vector<uint8_t>>();
+  encoded->reserve(
+      1 + SizeOfSize(method_call.method_name().size()) +
+      method_call.method_name().size() +
+      (method_call.arguments() ? EncodedSizeHint(*method_call.arguments())
+                               : 1));
   ByteBufferStreamWriter stream(encoded.get());
   serializer_->WriteValue(EncodableValue(method_call.method_name()), &stream);
   if (method_call.arguments()) {
@@ -394,6 +793,7 @@ std::unique_ptr<std::vector<uint8_t>>
 StandardMethodCodec::EncodeSuccessEnvelopeInternal(
     const EncodableValue* result) const {
   auto encoded = std::make_unique<std::vector<uint8_t>>();
+  encoded->reserve(1 + (result ? EncodedSizeHint(*result) : 1));
   ByteBufferStreamWriter stream(encoded.get());
   stream.WriteByte(0);
   if (result) {
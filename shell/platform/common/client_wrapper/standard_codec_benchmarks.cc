@@ -0,0 +1,132 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/encodable_value_view.h"
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/standard_message_codec.h"
+
+namespace flutter {
+
+// The list from the StandardMessageCodec unittests.
+static EncodableValue MakeList() {
+  return EncodableValue(EncodableList{
+      EncodableValue(),
+      EncodableValue("hello"),
+      EncodableValue(3.14),
+      EncodableValue(47),
+      EncodableValue(EncodableList{
+          EncodableValue(42),
+          EncodableValue("nested"),
+      }),
+  });
+}
+
+// A map with |count| entries like the ones in the StandardMessageCodec
+// unittests, which is the shape of the maps plugins send many times a second.
+static EncodableValue MakeMap(int count) {
+  EncodableMap map;
+  for (int i = 0; i < count; ++i) {
+    map[EncodableValue("key" + std::to_string(i))] = EncodableValue(
+        EncodableMap{{EncodableValue("a"), EncodableValue(3.14)},
+                     {EncodableValue("b"), EncodableValue(i)},
+                     {EncodableValue("c"), MakeList()},
+                     {EncodableValue("d"),
+                      EncodableValue(std::vector<int32_t>(16, i))}});
+  }
+  return EncodableValue(std::move(map));
+}
+
+static EncodableValue MakeFloat64List(int count) {
+  return EncodableValue(std::vector<double>(count, 3.14));
+}
+
+static void Encode(benchmark::State& state, const EncodableValue& source) {
+  // A copy is laid out in memory the same way however |source| was built.
+  const EncodableValue value = source;
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  size_t size = 0;
+  for (auto _ : state) {
+    auto encoded = codec.EncodeMessage(value);
+    size = encoded->size();
+    benchmark::DoNotOptimize(encoded->data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+static void Decode(benchmark::State& state, const EncodableValue& value) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  auto encoded = codec.EncodeMessage(value);
+  for (auto _ : state) {
+    auto decoded = codec.DecodeMessage(*encoded);
+    benchmark::DoNotOptimize(decoded.get());
+  }
+  state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * encoded->size()));
+}
+
+static void BM_StandardMessageCodecEncodeList(benchmark::State& state) {
+  Encode(state, MakeList());
+}
+
+static void BM_StandardMessageCodecDecodeList(benchmark::State& state) {
+  Decode(state, MakeList());
+}
+
+static void BM_StandardMessageCodecEncodeMap(benchmark::State& state) {
+  Encode(state, MakeMap(state.range(0)));
+}
+
+static void BM_StandardMessageCodecDecodeMap(benchmark::State& state) {
+  Decode(state, MakeMap(state.range(0)));
+}
+
+static void BM_StandardMessageCodecEncodeFloat64List(benchmark::State& state) {
+  Encode(state, MakeFloat64List(state.range(0)));
+}
+
+static void BM_StandardMessageCodecDecodeFloat64List(benchmark::State& state) {
+  Decode(state, MakeFloat64List(state.range(0)));
+}
+
+// Reads one field of a large map, which is what most handlers of large
+// messages do, by decoding the whole message.
+static void BM_StandardMessageCodecDecodeMapField(benchmark::State& state) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  const int count = state.range(0);
+  auto encoded = codec.EncodeMessage(MakeMap(count));
+  const EncodableValue key("key" + std::to_string(count - 1));
+  for (auto _ : state) {
+    auto decoded = codec.DecodeMessage(*encoded);
+    const auto& map = std::get<EncodableMap>(*decoded);
+    const auto& entry = std::get<EncodableMap>(map.at(key));
+    benchmark::DoNotOptimize(
+        std::get<int32_t>(entry.at(EncodableValue("b"))));
+  }
+}
+
+// Reads the same field as BM_StandardMessageCodecDecodeMapField in place.
+static void BM_EncodableValueViewFindMapField(benchmark::State& state) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  const int count = state.range(0);
+  auto encoded = codec.EncodeMessage(MakeMap(count));
+  const std::string key = "key" + std::to_string(count - 1);
+  for (auto _ : state) {
+    EncodableValueView message(*encoded);
+    benchmark::DoNotOptimize(message.Find(key).Find("b").LongValue());
+  }
+}
+
+BENCHMARK(BM_StandardMessageCodecEncodeList);
+BENCHMARK(BM_StandardMessageCodecDecodeList);
+BENCHMARK(BM_StandardMessageCodecEncodeMap)->Range(8, 4096);
+BENCHMARK(BM_StandardMessageCodecDecodeMap)->Range(8, 4096);
+BENCHMARK(BM_StandardMessageCodecEncodeFloat64List)->Range(64, 1 << 20);
+BENCHMARK(BM_StandardMessageCodecDecodeFloat64List)->Range(64, 1 << 20);
+BENCHMARK(BM_StandardMessageCodecDecodeMapField)->Range(8, 4096);
+BENCHMARK(BM_EncodableValueViewFindMapField)->Range(8, 4096);
+
+}  // namespace flutter
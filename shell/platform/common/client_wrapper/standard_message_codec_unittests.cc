@@ -7,6 +7,7 @@
 #include <map>
 #include <vector>
 
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/encodable_value_view.h"
 #include "flutter/shell/platform/common/client_wrapper/testing/test_codec_extensions.h"
 #include "gtest/gtest.h"
 
@@ -226,4 +227,73 @@ TEST(StandardMessageCodec, CanEncodeAndDecodeVariableLengthCustomType) {
                     some_data_comparator);
 }
 
+TEST(StandardMessageCodec, GetInstanceReturnsSharedInstance) {
+  EXPECT_EQ(&StandardMessageCodec::GetInstance(),
+            &StandardMessageCodec::GetInstance());
+}
+
+TEST(EncodableValueView, CanReadList) {
+  const std::vector<uint8_t> bytes = {
+      0x0c, 0x05, 0x00, 0x07, 0x05, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x06,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x85, 0xeb, 0x51, 0xb8, 0x1e,
+      0x09, 0x40, 0x03, 0x2f, 0x00, 0x00, 0x00, 0x0c, 0x02, 0x03, 0x2a,
+      0x00, 0x00, 0x00, 0x07, 0x06, 0x6e, 0x65, 0x73, 0x74, 0x65, 0x64,
+  };
+  EncodableValueView list(bytes);
+  ASSERT_EQ(list.type(), EncodableValueView::Type::kList);
+  EXPECT_EQ(list.size(), 5u);
+
+  EncodableValueView value = list.First();
+  EXPECT_TRUE(value.IsNull());
+  value = value.Next();
+  EXPECT_EQ(value.StringValue(), "hello");
+  value = value.Next();
+  EXPECT_EQ(value.DoubleValue(), 3.14);
+  value = value.Next();
+  EXPECT_EQ(value.LongValue(), 47);
+  value = value.Next();
+  ASSERT_EQ(value.type(), EncodableValueView::Type::kList);
+  EXPECT_EQ(value.First().LongValue(), 42);
+  EXPECT_EQ(value.First().Next().StringValue(), "nested");
+  EXPECT_FALSE(value.First().Next().Next().IsValid());
+  EXPECT_FALSE(value.Next().IsValid());
+}
+
+TEST(EncodableValueView, CanFindMapEntries) {
+  EncodableValue value(EncodableMap{
+      {EncodableValue("a"), EncodableValue(3.14)},
+      {EncodableValue("b"), EncodableValue(std::vector<int32_t>{1, 2, 3})},
+      {EncodableValue(), EncodableValue()},
+      {EncodableValue("c"), EncodableValue(EncodableList{
+                                EncodableValue(true),
+                            })},
+  });
+  auto encoded = StandardMessageCodec::GetInstance().EncodeMessage(value);
+  ASSERT_TRUE(encoded);
+
+  EncodableValueView map(*encoded);
+  ASSERT_EQ(map.type(), EncodableValueView::Type::kMap);
+  EXPECT_EQ(map.size(), 4u);
+  EXPECT_EQ(map.Find("a").DoubleValue(), 3.14);
+  auto list = map.Find("b").TypedListValue<int32_t>();
+  EXPECT_EQ(std::vector<int32_t>(list.begin(), list.end()),
+            (std::vector<int32_t>{1, 2, 3}));
+  EXPECT_TRUE(map.Find("b").TypedListValue<int64_t>().empty());
+  EXPECT_TRUE(map.Find("c").First().BoolValue());
+  EXPECT_FALSE(map.Find("d").IsValid());
+}
+
+TEST(EncodableValueView, RejectsTruncatedMessages) {
+  const std::vector<uint8_t> bytes = {0x07, 0x05, 0x68, 0x65};
+  EncodableValueView string(bytes);
+  EXPECT_FALSE(string.IsValid());
+  EXPECT_EQ(string.StringValue(), "");
+
+  const std::vector<uint8_t> list_bytes = {0x0c, 0x02, 0x03, 0x2a};
+  EncodableValueView list(list_bytes);
+  ASSERT_TRUE(list.IsValid());
+  EXPECT_FALSE(list.First().IsValid());
+  EXPECT_FALSE(list.Next().IsValid());
+}
+
 }  // namespace flutter
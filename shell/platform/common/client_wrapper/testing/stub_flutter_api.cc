@@ -93,6 +93,14 @@ void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
   }
 }
 
+void FlutterDesktopMessengerSetQueue(FlutterDesktopMessengerRef messenger,
+                                     const char* channel,
+                                     FlutterDesktopMessageQueue queue) {
+  if (s_stub_implementation) {
+    s_stub_implementation->MessengerSetQueue(channel, queue);
+  }
+}
+
 FlutterDesktopTextureRegistrarRef FlutterDesktopRegistrarGetTextureRegistrar(
     FlutterDesktopPluginRegistrarRef registrar) {
   return reinterpret_cast<FlutterDesktopTextureRegistrarRef>(1);
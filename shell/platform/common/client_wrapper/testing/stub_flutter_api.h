@@ -65,6 +65,10 @@ class StubFlutterApi {
                                     FlutterDesktopMessageCallback callback,
                                     void* user_data) {}
 
+  // Called for FlutterDesktopMessengerSetQueue.
+  virtual void MessengerSetQueue(const char* channel,
+                                 FlutterDesktopMessageQueue queue) {}
+
   // Called for FlutterDesktopRegisterExternalTexture.
   virtual int64_t TextureRegistrarRegisterExternalTexture(
       const FlutterDesktopTextureInfo* info) {
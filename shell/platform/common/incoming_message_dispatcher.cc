@@ -20,16 +20,27 @@ void IncomingMessageDispatcher::HandleMessage(
   std::string channel(message.channel);
 
   // Find the handler for the channel; if there isn't one, report the failure.
-  if (callbacks_.find(channel) == callbacks_.end()) {
+  // The callback is called without holding the lock, so that it may register
+  // callbacks itself.
+  std::pair<FlutterDesktopMessageCallback, void*> callback_info = {nullptr,
+                                                                   nullptr};
+  bool block_input;
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = callbacks_.find(channel);
+    if (found != callbacks_.end()) {
+      callback_info = found->second;
+    }
+    block_input = input_blocking_channels_.count(channel) > 0;
+  }
+  if (callback_info.first == nullptr) {
     FlutterDesktopMessengerSendResponse(messenger_, message.response_handle,
                                         nullptr, 0);
     return;
   }
-  auto& callback_info = callbacks_[channel];
   FlutterDesktopMessageCallback message_callback = callback_info.first;
 
   // Process the call, handling input blocking if requested.
-  bool block_input = input_blocking_channels_.count(channel) > 0;
   if (block_input) {
     input_block_cb();
   }
@@ -43,6 +54,7 @@ void IncomingMessageDispatcher::SetMessageCallback(
     const std::string& channel,
     FlutterDesktopMessageCallback callback,
     void* user_data) {
+  std::scoped_lock lock(mutex_);
   if (!callback) {
     callbacks_.erase(channel);
     return;
@@ -52,6 +64,7 @@ void IncomingMessageDispatcher::SetMessageCallback(
 
 void IncomingMessageDispatcher::EnableInputBlockingForChannel(
     const std::string& channel) {
+  std::scoped_lock lock(mutex_);
   input_blocking_channels_.insert(channel);
 }
 
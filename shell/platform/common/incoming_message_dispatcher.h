@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -37,6 +38,10 @@ class IncomingMessageDispatcher {
   //
   // If no handler is registered for the message's channel, sends a
   // NotImplemented response to the engine.
+  //
+  // May be called on a background thread for channels that the engine
+  // delivers on a background queue. Input blocking should not be enabled for
+  // such channels.
   void HandleMessage(
       const FlutterDesktopMessage& message,
       const std::function<void(void)>& input_block_cb = [] {},
@@ -62,6 +67,10 @@ class IncomingMessageDispatcher {
   // Handle for interacting with the C messaging API.
   FlutterDesktopMessengerRef messenger_;
 
+  // Guards the members below, as messages on background queues are handled
+  // while callbacks may be registered on the platform thread.
+  std::mutex mutex_;
+
   // A map from channel names to the FlutterDesktopMessageCallback that should
   // be called for incoming messages on that channel, along with the void* user
   // data to pass to it.
@@ -0,0 +1,202 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/shell/platform/common/client_wrapper/include/flutter/method_result_functions.h"
+#include "flutter/shell/platform/common/json_message_codec.h"
+#include "flutter/shell/platform/common/json_method_codec.h"
+
+namespace {
+
+// The number of calls to operator new, which is how the codecs allocate
+// vectors, strings, documents and rapidjson allocators.
+//
+// rapidjson allocates the memory for values and its parse stack with malloc,
+// which is not counted, so these counts are a lower bound.
+std::atomic<int64_t> allocation_count{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (!pointer) {
+    std::abort();
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t size) noexcept {
+  std::free(pointer);
+}
+
+namespace flutter {
+
+namespace {
+
+// A key event message like the ones the GLFW embedding sends for every key
+// press.
+constexpr char kKeyEventMessage[] =
+    R"json({"toolkit":"glfw","keyCode":65,"scanCode":38,"modifiers":0,)json"
+    R"json("unicodeScalarValues":97,"keymap":"linux","type":"keydown"})json";
+
+// The response to a key event message.
+constexpr char kKeyEventResponse[] = R"json({"handled":true})json";
+
+// A method call like the ones the text input plugin receives for every edit.
+constexpr char kEditingStateCall[] =
+    R"json({"method":"TextInput.setEditingState","args":{"text":"hello",)json"
+    R"json("selectionBase":5,"selectionExtent":5,"composingBase":-1,)json"
+    R"json("composingExtent":-1}})json";
+
+const uint8_t* Bytes(const char* message) {
+  return reinterpret_cast<const uint8_t*>(message);
+}
+
+// Reports the allocations per iteration of the benchmark, which must be
+// started after the setup of the benchmark.
+class AllocationCounter {
+ public:
+  explicit AllocationCounter(benchmark::State& state)
+      : state_(state), start_(allocation_count.load()) {}
+
+  ~AllocationCounter() {
+    state_.counters["allocs_per_message"] = benchmark::Counter(
+        static_cast<double>(allocation_count.load() - start_),
+        benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  benchmark::State& state_;
+  int64_t start_;
+};
+
+// A SAX handler that reads the "handled" field of a key event response.
+class HandledReader
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, HandledReader> {
+ public:
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    is_handled_key_ = std::string_view(str, length) == "handled";
+    return true;
+  }
+
+  bool Bool(bool value) {
+    if (is_handled_key_) {
+      handled = value;
+    }
+    return true;
+  }
+
+  bool handled = false;
+
+ private:
+  bool is_handled_key_ = false;
+};
+
+}  // namespace
+
+static void BM_JsonMessageCodecEncode(benchmark::State& state) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  auto message = codec.DecodeMessage(Bytes(kKeyEventMessage),
+                                     sizeof(kKeyEventMessage) - 1);
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    auto encoded = codec.EncodeMessage(*message);
+    benchmark::DoNotOptimize(encoded->data());
+  }
+}
+
+// Reads the key event response the way KeyEventHandler does, by decoding it
+// into a document.
+static void BM_JsonMessageCodecDecodeField(benchmark::State& state) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    auto decoded = codec.DecodeMessage(Bytes(kKeyEventResponse),
+                                       sizeof(kKeyEventResponse) - 1);
+    benchmark::DoNotOptimize((*decoded)["handled"].GetBool());
+  }
+}
+
+// Reads the same field as BM_JsonMessageCodecDecodeField with a SAX handler.
+static void BM_JsonMessageCodecParseField(benchmark::State& state) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    HandledReader reader;
+    codec.ParseMessage(Bytes(kKeyEventResponse), sizeof(kKeyEventResponse) - 1,
+                       reader);
+    benchmark::DoNotOptimize(reader.handled);
+  }
+}
+
+static void BM_JsonMethodCodecDecodeMethodCall(benchmark::State& state) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    auto call = codec.DecodeMethodCall(Bytes(kEditingStateCall),
+                                       sizeof(kEditingStateCall) - 1);
+    benchmark::DoNotOptimize(call.get());
+  }
+}
+
+static void BM_JsonMethodCodecEncodeMethodCall(benchmark::State& state) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  auto call = codec.DecodeMethodCall(Bytes(kEditingStateCall),
+                                     sizeof(kEditingStateCall) - 1);
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    auto encoded = codec.EncodeMethodCall(*call);
+    benchmark::DoNotOptimize(encoded->data());
+  }
+}
+
+static void BM_JsonMethodCodecEncodeSuccessEnvelope(benchmark::State& state) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  auto result = JsonMessageCodec::GetInstance().DecodeMessage(
+      Bytes(kKeyEventResponse), sizeof(kKeyEventResponse) - 1);
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    auto encoded = codec.EncodeSuccessEnvelope(result.get());
+    benchmark::DoNotOptimize(encoded->data());
+  }
+}
+
+static void BM_JsonMethodCodecDecodeSuccessEnvelope(benchmark::State& state) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  auto result = JsonMessageCodec::GetInstance().DecodeMessage(
+      Bytes(kKeyEventResponse), sizeof(kKeyEventResponse) - 1);
+  auto envelope = codec.EncodeSuccessEnvelope(result.get());
+  bool handled = false;
+  MethodResultFunctions<rapidjson::Document> result_handler(
+      [&handled](const rapidjson::Document* result) {
+        handled = (*result)["handled"].GetBool();
+      },
+      nullptr, nullptr);
+  AllocationCounter counter(state);
+  for (auto _ : state) {
+    codec.DecodeAndProcessResponseEnvelope(envelope->data(), envelope->size(),
+                                           &result_handler);
+    benchmark::DoNotOptimize(handled);
+  }
+}
+
+BENCHMARK(BM_JsonMessageCodecEncode);
+BENCHMARK(BM_JsonMessageCodecDecodeField);
+BENCHMARK(BM_JsonMessageCodecParseField);
+BENCHMARK(BM_JsonMethodCodecDecodeMethodCall);
+BENCHMARK(BM_JsonMethodCodecEncodeMethodCall);
+BENCHMARK(BM_JsonMethodCodecEncodeSuccessEnvelope);
+BENCHMARK(BM_JsonMethodCodecDecodeSuccessEnvelope);
+
+}  // namespace flutter
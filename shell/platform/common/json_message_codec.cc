@@ -8,8 +8,6 @@
 #include <string>
 
 #include "rapidjson/error/en.h"
-#include "rapidjson/stringbuffer.h"
-#include "rapidjson/writer.h"
 
 namespace flutter {
 
@@ -21,27 +19,32 @@ const JsonMessageCodec& JsonMessageCodec::GetInstance() {
 
 std::unique_ptr<std::vector<uint8_t>> JsonMessageCodec::EncodeMessageInternal(
     const rapidjson::Document& message) const {
-  // TODO: Look into alternate writers that would avoid the buffer copy.
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  auto encoded = std::make_unique<std::vector<uint8_t>>();
+  JsonByteVectorStream stream(encoded.get());
+  JsonMessageWriter writer(stream);
   message.Accept(writer);
-  const char* buffer_start = buffer.GetString();
-  return std::make_unique<std::vector<uint8_t>>(
-      buffer_start, buffer_start + buffer.GetSize());
+  return encoded;
 }
 
-std::unique_ptr<rapidjson::Document> JsonMessageCodec::DecodeMessageInternal(
-    const uint8_t* binary_message,
-    const size_t message_size) const {
+bool JsonMessageCodec::DecodeMessageInto(const uint8_t* binary_message,
+                                         const size_t message_size,
+                                         rapidjson::Document* document) const {
   auto raw_message = reinterpret_cast<const char*>(binary_message);
-  auto json_message = std::make_unique<rapidjson::Document>();
-  rapidjson::ParseResult result =
-      json_message->Parse(raw_message, message_size);
+  rapidjson::ParseResult result = document->Parse(raw_message, message_size);
   bool parsing_successful =
       result == rapidjson::ParseErrorCode::kParseErrorNone;
   if (!parsing_successful) {
     std::cerr << "Unable to parse JSON message:" << std::endl
               << rapidjson::GetParseError_En(result.Code()) << std::endl;
+  }
+  return parsing_successful;
+}
+
+std::unique_ptr<rapidjson::Document> JsonMessageCodec::DecodeMessageInternal(
+    const uint8_t* binary_message,
+    const size_t message_size) const {
+  auto json_message = std::make_unique<rapidjson::Document>();
+  if (!DecodeMessageInto(binary_message, message_size, json_message.get())) {
     return nullptr;
   }
   return json_message;
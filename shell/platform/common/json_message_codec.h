@@ -6,11 +6,39 @@
 #define FLUTTER_SHELL_PLATFORM_COMMON_JSON_MESSAGE_CODEC_H_
 
 #include <rapidjson/document.h>
+#include <rapidjson/encodedstream.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+
+#include <cstdint>
+#include <vector>
 
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/message_codec.h"
 
 namespace flutter {
 
+// A rapidjson output stream that appends to a byte vector, so that messages
+// can be written directly into the buffer that is sent to the engine.
+class JsonByteVectorStream {
+ public:
+  typedef char Ch;
+
+  explicit JsonByteVectorStream(std::vector<uint8_t>* buffer)
+      : buffer_(buffer) {}
+
+  void Put(Ch c) { buffer_->push_back(static_cast<uint8_t>(c)); }
+
+  void Flush() {}
+
+ private:
+  std::vector<uint8_t>* buffer_;
+};
+
+// A writer that encodes JSON messages, for callers that stream a message
+// instead of building a rapidjson::Document to pass to EncodeMessage.
+using JsonMessageWriter = rapidjson::Writer<JsonByteVectorStream>;
+
 // A message encoding/decoding mechanism for communications to/from the
 // Flutter engine via JSON channels.
 class JsonMessageCodec : public MessageCodec<rapidjson::Document> {
@@ -24,6 +52,36 @@ class JsonMessageCodec : public MessageCodec<rapidjson::Document> {
   JsonMessageCodec(JsonMessageCodec const&) = delete;
   JsonMessageCodec& operator=(JsonMessageCodec const&) = delete;
 
+  // Decodes |binary_message| into |document|, which may use an allocator
+  // owned by the caller, such as one backed by a stack buffer for documents
+  // that don't outlive the call that decodes them. Returns false if the
+  // message is not valid JSON.
+  bool DecodeMessageInto(const uint8_t* binary_message,
+                         const size_t message_size,
+                         rapidjson::Document* document) const;
+
+  // Parses |binary_message| by calling the rapidjson SAX handler methods of
+  // |handler| (Null, Bool, Int, String, StartObject, Key, ...) for each value,
+  // instead of building a document.
+  //
+  // This is much cheaper than DecodeMessage for handlers that only read a few
+  // values. Strings are passed to |handler| as views that are only valid for
+  // the duration of the call.
+  //
+  // Returns false if the message is not valid JSON, or if |handler| stopped
+  // parsing by returning false.
+  template <typename Handler>
+  bool ParseMessage(const uint8_t* binary_message,
+                    const size_t message_size,
+                    Handler& handler) const {
+    rapidjson::MemoryStream memory_stream(
+        reinterpret_cast<const char*>(binary_message), message_size);
+    rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream>
+        stream(memory_stream);
+    rapidjson::Reader reader;
+    return !reader.Parse(stream, handler).IsError();
+  }
+
  protected:
   // Instances should be obtained via GetInstance.
   JsonMessageCodec() = default;
@@ -6,6 +6,7 @@
 
 #include <limits>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -23,6 +24,28 @@ static void CheckEncodeDecode(const rapidjson::Document& value) {
   EXPECT_EQ(value, *decoded);
 }
 
+// A SAX handler that records the string values and the sum of the integer
+// values of a message.
+class RecordingHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          RecordingHandler> {
+ public:
+  bool String(const char* str, rapidjson::SizeType length, bool copy) {
+    strings.emplace_back(str, length);
+    return true;
+  }
+
+  bool Int(int i) {
+    sum += i;
+    return true;
+  }
+
+  bool Uint(unsigned u) { return Int(static_cast<int>(u)); }
+
+  std::vector<std::string> strings;
+  int sum = 0;
+};
+
 }  // namespace
 
 // Tests that a JSON document with various data types round-trips correctly.
@@ -43,4 +66,50 @@ TEST(JsonMessageCodec, EncodeDecode) {
   CheckEncodeDecode(array);
 }
 
+// Tests that messages can be parsed with a SAX handler.
+TEST(JsonMessageCodec, ParseMessageCallsHandler) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  std::string message = R"json({"a": "x", "b": [1, -2, 3], "c": "y"})json";
+  RecordingHandler handler;
+  EXPECT_TRUE(codec.ParseMessage(
+      reinterpret_cast<const uint8_t*>(message.data()), message.size(),
+      handler));
+  EXPECT_EQ(handler.strings, std::vector<std::string>({"x", "y"}));
+  EXPECT_EQ(handler.sum, 2);
+}
+
+// Tests that ParseMessage fails for invalid JSON, which need not be null
+// terminated.
+TEST(JsonMessageCodec, ParseMessageRejectsInvalidJson) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  std::string message = R"json({"a": "x"}})json";
+  RecordingHandler handler;
+  EXPECT_FALSE(codec.ParseMessage(
+      reinterpret_cast<const uint8_t*>(message.data()), message.size(),
+      handler));
+  EXPECT_TRUE(codec.ParseMessage(
+      reinterpret_cast<const uint8_t*>(message.data()), message.size() - 1,
+      handler));
+}
+
+// Tests that messages can be decoded into a document that uses an allocator
+// owned by the caller.
+TEST(JsonMessageCodec, DecodeMessageIntoUsesDocumentAllocator) {
+  const JsonMessageCodec& codec = JsonMessageCodec::GetInstance();
+  rapidjson::Document value(rapidjson::kArrayType);
+  value.PushBack("string", value.GetAllocator());
+  value.PushBack(42, value.GetAllocator());
+  auto encoded = codec.EncodeMessage(value);
+  ASSERT_TRUE(encoded);
+
+  char buffer[256];
+  rapidjson::MemoryPoolAllocator<> allocator(buffer, sizeof(buffer));
+  rapidjson::Document decoded(&allocator);
+  ASSERT_TRUE(
+      codec.DecodeMessageInto(encoded->data(), encoded->size(), &decoded));
+  EXPECT_EQ(value, decoded);
+  EXPECT_EQ(&decoded.GetAllocator(), &allocator);
+  EXPECT_GT(allocator.Size(), 0u);
+}
+
 }  // namespace flutter
@@ -14,6 +14,30 @@ namespace {
 constexpr char kMessageMethodKey[] = "method";
 constexpr char kMessageArgumentsKey[] = "args";
 
+// The size of the stack buffer that backs the documents used to decode
+// response envelopes, which are only used for the duration of the decoding
+// call. Most responses fit, so decoding them doesn't allocate their values on
+// the heap.
+constexpr size_t kResponseBufferSize = 1024;
+
+// The initial capacity of the parser's stack, which is rapidjson's default.
+constexpr size_t kParseStackCapacity = 1024;
+
+// Writes |string| with |writer|.
+void WriteString(JsonMessageWriter& writer, const std::string& string) {
+  writer.String(string.c_str(),
+                static_cast<rapidjson::SizeType>(string.size()));
+}
+
+// Writes |value| with |writer|, or null if there is no value.
+void WriteValue(JsonMessageWriter& writer, const rapidjson::Document* value) {
+  if (value) {
+    value->Accept(writer);
+  } else {
+    writer.Null();
+  }
+}
+
 // Returns a new document containing only |element|, which must be an element
 // in |document|. This is a move rather than a copy, so it is efficient but
 // destructive to the data in |document|.
@@ -66,34 +90,30 @@ JsonMethodCodec::DecodeMethodCallInternal(const uint8_t* message,
 
 std::unique_ptr<std::vector<uint8_t>> JsonMethodCodec::EncodeMethodCallInternal(
     const MethodCall<rapidjson::Document>& method_call) const {
-  // TODO: Consider revisiting the codec APIs to avoid the need to copy
-  // everything when doing encoding (e.g., by having a version that takes
-  // owership of the object to encode, so that it can be moved instead).
-  rapidjson::Document message(rapidjson::kObjectType);
-  auto& allocator = message.GetAllocator();
-  rapidjson::Value name(method_call.method_name(), allocator);
-  rapidjson::Value arguments;
-  if (method_call.arguments()) {
-    arguments.CopyFrom(*method_call.arguments(), allocator);
-  }
-  message.AddMember(kMessageMethodKey, name, allocator);
-  message.AddMember(kMessageArgumentsKey, arguments, allocator);
-
-  return JsonMessageCodec::GetInstance().EncodeMessage(message);
+  // The call is streamed rather than built as a document, which would require
+  // copying the arguments.
+  auto encoded = std::make_unique<std::vector<uint8_t>>();
+  JsonByteVectorStream stream(encoded.get());
+  JsonMessageWriter writer(stream);
+  writer.StartObject();
+  writer.Key(kMessageMethodKey);
+  WriteString(writer, method_call.method_name());
+  writer.Key(kMessageArgumentsKey);
+  WriteValue(writer, method_call.arguments());
+  writer.EndObject();
+  return encoded;
 }
 
 std::unique_ptr<std::vector<uint8_t>>
 JsonMethodCodec::EncodeSuccessEnvelopeInternal(
     const rapidjson::Document* result) const {
-  rapidjson::Document envelope;
-  envelope.SetArray();
-  rapidjson::Value result_value;
-  if (result) {
-    result_value.CopyFrom(*result, envelope.GetAllocator());
-  }
-  envelope.PushBack(result_value, envelope.GetAllocator());
-
-  return JsonMessageCodec::GetInstance().EncodeMessage(envelope);
+  auto encoded = std::make_unique<std::vector<uint8_t>>();
+  JsonByteVectorStream stream(encoded.get());
+  JsonMessageWriter writer(stream);
+  writer.StartArray();
+  WriteValue(writer, result);
+  writer.EndArray();
+  return encoded;
 }
 
 std::unique_ptr<std::vector<uint8_t>>
@@ -101,51 +121,61 @@ JsonMethodCodec::EncodeErrorEnvelopeInternal(
     const std::string& error_code,
     const std::string& error_message,
     const rapidjson::Document* error_details) const {
-  rapidjson::Document envelope(rapidjson::kArrayType);
-  auto& allocator = envelope.GetAllocator();
-  envelope.PushBack(rapidjson::Value(error_code, allocator), allocator);
-  envelope.PushBack(rapidjson::Value(error_message, allocator), allocator);
-  rapidjson::Value details_value;
-  if (error_details) {
-    details_value.CopyFrom(*error_details, allocator);
-  }
-  envelope.PushBack(details_value, allocator);
-
-  return JsonMessageCodec::GetInstance().EncodeMessage(envelope);
+  auto encoded = std::make_unique<std::vector<uint8_t>>();
+  JsonByteVectorStream stream(encoded.get());
+  JsonMessageWriter writer(stream);
+  writer.StartArray();
+  WriteString(writer, error_code);
+  WriteString(writer, error_message);
+  WriteValue(writer, error_details);
+  writer.EndArray();
+  return encoded;
 }
 
 bool JsonMethodCodec::DecodeAndProcessResponseEnvelopeInternal(
     const uint8_t* response,
     size_t response_size,
     MethodResult<rapidjson::Document>* result) const {
-  std::unique_ptr<rapidjson::Document> json_response =
-      JsonMessageCodec::GetInstance().DecodeMessage(response, response_size);
-  if (!json_response) {
+  // The decoded values are only passed to |result| by reference, so they can
+  // be allocated from a buffer on the stack.
+  char buffer[kResponseBufferSize];
+  rapidjson::MemoryPoolAllocator<> allocator(buffer, sizeof(buffer));
+  rapidjson::CrtAllocator stack_allocator;
+  rapidjson::Document json_response(&allocator, kParseStackCapacity,
+                                    &stack_allocator);
+  if (!JsonMessageCodec::GetInstance().DecodeMessageInto(
+          response, response_size, &json_response)) {
     return false;
   }
-  if (!json_response->IsArray()) {
+  if (!json_response.IsArray()) {
     return false;
   }
-  switch (json_response->Size()) {
+  switch (json_response.Size()) {
     case 1: {
-      std::unique_ptr<rapidjson::Document> value =
-          ExtractElement(json_response.get(), &((*json_response)[0]));
-      if (value->IsNull()) {
+      rapidjson::Document value(&allocator);
+      value.Swap(json_response[0]);
+      if (value.IsNull()) {
         result->Success();
       } else {
-        result->Success(*value);
+        result->Success(value);
       }
       return true;
     }
     case 3: {
-      std::string code = (*json_response)[0].GetString();
-      std::string message = (*json_response)[1].GetString();
-      std::unique_ptr<rapidjson::Document> details =
-          ExtractElement(json_response.get(), &((*json_response)[2]));
-      if (details->IsNull()) {
+      // The framework sends a null message if none was given.
+      if (!json_response[0].IsString() ||
+          !(json_response[1].IsString() || json_response[1].IsNull())) {
+        return false;
+      }
+      std::string code = json_response[0].GetString();
+      std::string message =
+          json_response[1].IsString() ? json_response[1].GetString() : "";
+      rapidjson::Document details(&allocator);
+      details.Swap(json_response[2]);
+      if (details.IsNull()) {
         result->Error(code, message);
       } else {
-        result->Error(code, message, *details);
+        result->Error(code, message, details);
       }
       return true;
     }
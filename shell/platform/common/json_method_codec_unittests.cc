@@ -4,6 +4,8 @@
 
 #include "flutter/shell/platform/common/json_method_codec.h"
 
+#include <string>
+
 #include "flutter/shell/platform/common/client_wrapper/include/flutter/method_result_functions.h"
 #include "gtest/gtest.h"
 
@@ -157,4 +159,66 @@ TEST(JsonMethodCodec, HandlesErrorEnvelopesWithDetails) {
   EXPECT_TRUE(decoded_successfully);
 }
 
+TEST(JsonMethodCodec, HandlesErrorEnvelopesWithNullMessage) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  // The framework encodes a missing message as null.
+  std::string response = R"json(["errorCode",null,null])json";
+
+  bool decoded_successfully = false;
+  MethodResultFunctions<rapidjson::Document> result_handler(
+      nullptr,
+      [&decoded_successfully](const std::string& code,
+                              const std::string& message,
+                              const rapidjson::Document* details) {
+        decoded_successfully = true;
+        EXPECT_EQ(code, "errorCode");
+        EXPECT_EQ(message, "");
+        EXPECT_EQ(details, nullptr);
+      },
+      nullptr);
+  EXPECT_TRUE(codec.DecodeAndProcessResponseEnvelope(
+      reinterpret_cast<const uint8_t*>(response.data()), response.size(),
+      &result_handler));
+  EXPECT_TRUE(decoded_successfully);
+}
+
+TEST(JsonMethodCodec, RejectsMalformedResponseEnvelopes) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  MethodResultFunctions<rapidjson::Document> result_handler(nullptr, nullptr,
+                                                            nullptr);
+  for (std::string response : {R"json({"result":42})json", R"json([1,2])json",
+                               R"json([42,"message",null])json"}) {
+    EXPECT_FALSE(codec.DecodeAndProcessResponseEnvelope(
+        reinterpret_cast<const uint8_t*>(response.data()), response.size(),
+        &result_handler))
+        << response;
+  }
+}
+
+// Tests that results larger than the buffer used to decode response
+// envelopes are decoded correctly.
+TEST(JsonMethodCodec, HandlesLargeSuccessEnvelopes) {
+  const JsonMethodCodec& codec = JsonMethodCodec::GetInstance();
+  rapidjson::Document result(rapidjson::kArrayType);
+  for (int i = 0; i < 1000; ++i) {
+    std::string element = std::to_string(i);
+    result.PushBack(rapidjson::Value(element.c_str(), result.GetAllocator()),
+                    result.GetAllocator());
+  }
+  auto encoded = codec.EncodeSuccessEnvelope(&result);
+  ASSERT_TRUE(encoded);
+
+  bool decoded_successfully = false;
+  MethodResultFunctions<rapidjson::Document> result_handler(
+      [&decoded_successfully, &result](const rapidjson::Document* decoded) {
+        decoded_successfully = true;
+        ASSERT_NE(decoded, nullptr);
+        EXPECT_EQ(*decoded, result);
+      },
+      nullptr, nullptr);
+  codec.DecodeAndProcessResponseEnvelope(encoded->data(), encoded->size(),
+                                         &result_handler);
+  EXPECT_TRUE(decoded_successfully);
+}
+
 }  // namespace flutter
@@ -41,6 +41,18 @@ typedef struct {
   const FlutterDesktopMessageResponseHandle* response_handle;
 } FlutterDesktopMessage;
 
+// The queues on which the callback for a channel can be called.
+typedef enum {
+  // The platform thread. This is the default.
+  kFlutterDesktopMessageQueuePlatform,
+  // A background thread shared by all serial channels of the engine, which
+  // delivers messages one at a time, in the order they were sent.
+  kFlutterDesktopMessageQueueSerial,
+  // The worker threads of the engine, which may deliver messages on the same
+  // channel concurrently and out of order.
+  kFlutterDesktopMessageQueueConcurrent,
+} FlutterDesktopMessageQueue;
+
 // Function pointer type for message handler callback registration.
 //
 // The user data will be whatever was passed to FlutterDesktopSetMessageHandler
@@ -87,6 +99,17 @@ FLUTTER_EXPORT void FlutterDesktopMessengerSetCallback(
     FlutterDesktopMessageCallback callback,
     void* user_data);
 
+// Sets the queue on which the callback for |channel| is called.
+//
+// Messages on a background queue skip the platform thread, so handlers that
+// do not need it do not wait behind other work there. Their callback must be
+// safe to call on any thread, and may call FlutterDesktopMessengerSendResponse
+// on that thread.
+FLUTTER_EXPORT void FlutterDesktopMessengerSetQueue(
+    FlutterDesktopMessengerRef messenger,
+    const char* channel,
+    FlutterDesktopMessageQueue queue);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -38,12 +38,15 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/assets/directory_asset_bundle.h"
 #include "flutter/common/graphics/persistent_cache.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/image_memory_ledger.h"
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
+#include "flutter/shell/common/platform_message_ring.h"
+#include "flutter/shell/common/platform_message_stats.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/platform/embedder/embedder.h"
@@ -727,6 +730,12 @@ struct _FlutterPlatformMessageResponseHandle {
   std::unique_ptr<flutter::PlatformMessage> message;
 };
 
+struct _FlutterPlatformMessageRing {
+  fml::RefPtr<flutter::PlatformMessageRing> ring;
+  // Removes the ring from the shell, if the shell is still alive.
+  fml::closure remove;
+};
+
 struct LoadedElfDeleter {
   void operator()(Dart_LoadedElf* elf) {
     if (elf) {
@@ -970,6 +979,10 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   settings.assets_path = args->assets_path;
   settings.leak_vm = !SAFE_ACCESS(args, shutdown_dart_vm_when_done, false);
   settings.old_gen_heap_size = SAFE_ACCESS(args, dart_old_gen_heap_size, -1);
+  // Software renderers have no GPU context to rasterize pictures with, which
+  // lets picture snapshots be rasterized on the worker pool instead. Other
+  // shells set this from the --enable-software-rendering switch.
+  settings.enable_software_rendering = config->type == kSoftware;
 
   if (!flutter::DartVM::IsRunningPrecompiledCode()) {
     // Verify the assets path contains Dart 2 kernel assets.
@@ -1623,9 +1636,21 @@ FlutterEngineResult FlutterEngineSendKeyEvent(FLUTTER_API_SYMBOL(FlutterEngine)
                                   "running Flutter application.");
 }
 
-FlutterEngineResult FlutterEngineSendPlatformMessage(
+// Sends a platform message to the framework. If |owns_data| is set, the engine
+// takes ownership of the malloc allocated message data instead of copying it,
+// and frees it on every path including errors.
+static FlutterEngineResult SendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
-    const FlutterPlatformMessage* flutter_message) {
+    const FlutterPlatformMessage* flutter_message,
+    bool owns_data) {
+  fml::MallocMapping owned_data =
+      owns_data && flutter_message != nullptr
+          ? fml::MallocMapping(
+                const_cast<uint8_t*>(
+                    SAFE_ACCESS(flutter_message, message, nullptr)),
+                SAFE_ACCESS(flutter_message, message_size, 0))
+          : fml::MallocMapping();
+
   if (engine == nullptr) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
   }
@@ -1663,7 +1688,9 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
   } else {
     message = std::make_unique<flutter::PlatformMessage>(
         flutter_message->channel,
-        fml::MallocMapping::Copy(message_data, message_size), response);
+        owns_data ? std::move(owned_data)
+                  : fml::MallocMapping::Copy(message_data, message_size),
+        response);
   }
 
   return reinterpret_cast<flutter::EmbedderEngine*>(engine)
@@ -1674,6 +1701,18 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
                                   "Flutter application.");
 }
 
+FlutterEngineResult FlutterEngineSendPlatformMessage(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* flutter_message) {
+  return SendPlatformMessage(engine, flutter_message, false);
+}
+
+FlutterEngineResult FlutterEngineSendPlatformMessageNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* flutter_message) {
+  return SendPlatformMessage(engine, flutter_message, true);
+}
+
 FlutterEngineResult FlutterPlatformMessageCreateResponseHandle(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     FlutterDataCallback data_callback,
@@ -1750,6 +1789,214 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineSetPlatformMessageQueue(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageQueue queue) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (channel == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Channel was invalid.");
+  }
+
+  if (queue != kFlutterPlatformMessageQueuePlatform &&
+      queue != kFlutterPlatformMessageQueueSerial &&
+      queue != kFlutterPlatformMessageQueueConcurrent) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Queue was invalid.");
+  }
+
+  if (!reinterpret_cast<flutter::EmbedderEngine*>(engine)
+           ->SetPlatformMessageQueue(channel, queue)) {
+    return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                              "Could not set the platform message queue.");
+  }
+
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineSetPlatformMessageBatching(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageBatching batching) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (channel == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Channel was invalid.");
+  }
+
+  if (batching != kFlutterPlatformMessageBatchingNone &&
+      batching != kFlutterPlatformMessageBatchingBatch &&
+      batching != kFlutterPlatformMessageBatchingLatestOnly) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Batching was invalid.");
+  }
+
+  if (!reinterpret_cast<flutter::EmbedderEngine*>(engine)
+           ->SetPlatformMessageBatching(channel, batching)) {
+    return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                              "Could not set the platform message batching.");
+  }
+
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineSetPlatformMessageLane(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageLane lane) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (channel == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Channel was invalid.");
+  }
+
+  if (lane != kFlutterPlatformMessageLaneInput &&
+      lane != kFlutterPlatformMessageLaneFrameCritical &&
+      lane != kFlutterPlatformMessageLaneNormal &&
+      lane != kFlutterPlatformMessageLaneBackground) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Lane was invalid.");
+  }
+
+  if (!reinterpret_cast<flutter::EmbedderEngine*>(engine)
+           ->SetPlatformMessageLane(channel, lane)) {
+    return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                              "Could not set the platform message lane.");
+  }
+
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineCreatePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    size_t capacity,
+    FlutterPlatformMessageRing* out_ring) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (channel == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Channel was invalid.");
+  }
+
+  if (out_ring == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Ring out parameter was invalid.");
+  }
+
+  auto embedder_engine = reinterpret_cast<flutter::EmbedderEngine*>(engine);
+  auto ring = embedder_engine->CreatePlatformMessageRing(channel, capacity);
+  if (!ring) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Could not create a ring with the capacity.");
+  }
+
+  auto remove = embedder_engine->GetPlatformMessageRingRemover(channel, ring);
+  *out_ring = new _FlutterPlatformMessageRing{std::move(ring), remove};
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineWritePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring,
+    const uint8_t* data,
+    size_t size,
+    bool* out_written) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (ring == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Ring was invalid.");
+  }
+
+  if (size > 0 && data == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Data was null but the size was not zero.");
+  }
+
+  if (out_written == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Written out parameter was invalid.");
+  }
+
+  // The write is the hot path of the ring, so it does not go through the
+  // engine.
+  *out_written = ring->ring->Write(data, size);
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineReleasePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring) {
+  // The engine is not used, because rings may be released after the engine
+  // has been shut down.
+  if (ring == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Ring was invalid.");
+  }
+
+  if (ring->remove) {
+    ring->remove();
+  }
+  delete ring;
+  return kSuccess;
+}
+
+FlutterEngineResult FlutterEngineGetPlatformMessageStats(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageChannelStatsCallback callback,
+    void* user_data) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine handle was invalid.");
+  }
+
+  if (callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Callback was invalid.");
+  }
+
+  std::vector<flutter::PlatformMessageStats::ChannelStats> all_stats;
+  if (!reinterpret_cast<flutter::EmbedderEngine*>(engine)
+           ->GetPlatformMessageStats(&all_stats)) {
+    return LOG_EMBEDDER_ERROR(kInternalInconsistency,
+                              "Could not get the platform message stats.");
+  }
+
+  for (const auto& stats : all_stats) {
+    FlutterPlatformMessageChannelStats channel_stats = {};
+    channel_stats.struct_size = sizeof(channel_stats);
+    channel_stats.channel = stats.channel.c_str();
+    channel_stats.direction =
+        stats.direction ==
+                flutter::PlatformMessageStats::Direction::kToFramework
+            ? kFlutterPlatformMessageDirectionToFramework
+            : kFlutterPlatformMessageDirectionToPlatform;
+    channel_stats.message_count = stats.message_count;
+    channel_stats.byte_count = stats.byte_count;
+    channel_stats.handled_count = stats.handled_count;
+    channel_stats.total_queueing_delay =
+        stats.total_queueing_delay.ToNanoseconds();
+    channel_stats.max_queueing_delay = stats.max_queueing_delay.ToNanoseconds();
+    channel_stats.total_handler_time = stats.total_handler_time.ToNanoseconds();
+    channel_stats.max_handler_time = stats.max_handler_time.ToNanoseconds();
+    channel_stats.response_count = stats.response_count;
+    channel_stats.response_latency_p50 =
+        stats.response_latency_p50.ToNanoseconds();
+    channel_stats.response_latency_p90 =
+        stats.response_latency_p90.ToNanoseconds();
+    channel_stats.response_latency_p99 =
+        stats.response_latency_p99.ToNanoseconds();
+    channel_stats.max_response_latency =
+        stats.max_response_latency.ToNanoseconds();
+    callback(&channel_stats, user_data);
+  }
+  return kSuccess;
+}
+
 FlutterEngineResult __FlutterEngineFlushPendingTasksNow() {
   fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
   return kSuccess;
@@ -2199,6 +2446,43 @@ FlutterEngineResult FlutterEngineNotifyLowMemoryWarning(
                    "Could not dispatch the low memory notification message.");
 }
 
+FlutterEngineResult FlutterEngineGetImageMemoryUsage(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterEngineImageMemoryUsage* usage) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (usage == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Image memory usage was invalid.");
+  }
+
+  using flutter::ImageMemoryCategory;
+  const auto ledger_usage =
+      flutter::ImageMemoryLedger::GetInstance().GetUsage();
+  // Embedders built against an older header pass a smaller struct. Only the
+  // fields it has are written.
+#define SET_USAGE(member, value)          \
+  if (STRUCT_HAS_MEMBER(usage, member)) { \
+    usage->member = (value);              \
+  }
+
+  SET_USAGE(pending_decode_bytes,
+            ledger_usage.GetBytes(ImageMemoryCategory::kPendingDecodes));
+  SET_USAGE(dart_image_bytes,
+            ledger_usage.GetBytes(ImageMemoryCategory::kDartImages));
+  SET_USAGE(raster_cache_bytes,
+            ledger_usage.GetBytes(ImageMemoryCategory::kRasterCache));
+  SET_USAGE(resource_cache_bytes,
+            ledger_usage.GetBytes(ImageMemoryCategory::kResourceCache));
+  SET_USAGE(total_bytes, ledger_usage.total_bytes);
+  SET_USAGE(budget_bytes, ledger_usage.budget_bytes);
+#undef SET_USAGE
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEnginePostCallbackOnAllNativeThreads(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     FlutterNativeThreadCallback callback,
@@ -2328,6 +2612,15 @@ FlutterEngineResult FlutterEngineGetProcAddresses(
   SET_PROC(PostCallbackOnAllNativeThreads,
            FlutterEnginePostCallbackOnAllNativeThreads);
   SET_PROC(NotifyDisplayUpdate, FlutterEngineNotifyDisplayUpdate);
+  SET_PROC(GetImageMemoryUsage, FlutterEngineGetImageMemoryUsage);
+  SET_PROC(SetPlatformMessageQueue, FlutterEngineSetPlatformMessageQueue);
+  SET_PROC(SendPlatformMessageNoCopy, FlutterEngineSendPlatformMessageNoCopy);
+  SET_PROC(SetPlatformMessageBatching, FlutterEngineSetPlatformMessageBatching);
+  SET_PROC(CreatePlatformMessageRing, FlutterEngineCreatePlatformMessageRing);
+  SET_PROC(WritePlatformMessageRing, FlutterEngineWritePlatformMessageRing);
+  SET_PROC(ReleasePlatformMessageRing, FlutterEngineReleasePlatformMessageRing);
+  SET_PROC(GetPlatformMessageStats, FlutterEngineGetPlatformMessageStats);
+  SET_PROC(SetPlatformMessageLane, FlutterEngineSetPlatformMessageLane);
 #undef SET_PROC
 
   return kSuccess;
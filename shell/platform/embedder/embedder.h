@@ -756,6 +756,102 @@ typedef void (*FlutterPlatformMessageCallback)(
     const FlutterPlatformMessage* /* message*/,
     void* /* user data */);
 
+/// Where the platform messages on a channel are delivered to the
+/// `platform_message_callback`. See `FlutterEngineSetPlatformMessageQueue`.
+typedef enum {
+  /// Messages are delivered on the platform thread. This is the default.
+  kFlutterPlatformMessageQueuePlatform,
+  /// Messages are delivered one at a time, in the order they were sent, on a
+  /// background thread shared by all serial channels of the engine.
+  kFlutterPlatformMessageQueueSerial,
+  /// Messages are delivered on the worker threads of the engine. Messages on
+  /// the same channel may be delivered concurrently and out of order.
+  kFlutterPlatformMessageQueueConcurrent,
+} FlutterPlatformMessageQueue;
+
+/// How the platform messages that the embedder sends on a channel are
+/// delivered to the Flutter application. See
+/// `FlutterEngineSetPlatformMessageBatching`.
+typedef enum {
+  /// Each message is handed to the UI thread in a task of its own. This is the
+  /// default.
+  kFlutterPlatformMessageBatchingNone,
+  /// Messages sent before the UI thread picks up the pending batch are handed
+  /// to it together, in a single task.
+  kFlutterPlatformMessageBatchingBatch,
+  /// Like `kFlutterPlatformMessageBatchingBatch`, but a new message replaces
+  /// the message on the same channel that is still pending. The response
+  /// callback of the replaced message is invoked with no data.
+  kFlutterPlatformMessageBatchingLatestOnly,
+} FlutterPlatformMessageBatching;
+
+/// How urgently the platform messages that the embedder sends on a channel are
+/// delivered to the Flutter application. See
+/// `FlutterEngineSetPlatformMessageLane`.
+typedef enum {
+  /// Messages that carry user input. They are delivered ahead of the messages
+  /// on the other lanes and of the next frame.
+  kFlutterPlatformMessageLaneInput,
+  /// Messages that the next frame depends on. They are delivered ahead of the
+  /// messages on the normal and background lanes and of the next frame.
+  kFlutterPlatformMessageLaneFrameCritical,
+  /// Messages that are delivered in the order they were sent. This is the
+  /// default.
+  kFlutterPlatformMessageLaneNormal,
+  /// Messages that wait until the UI thread is idle after a frame, or for at
+  /// most 100 milliseconds.
+  kFlutterPlatformMessageLaneBackground,
+} FlutterPlatformMessageLane;
+
+/// A ring buffer that the embedder writes records to, and that the Flutter
+/// application reads on a channel. See
+/// `FlutterEngineCreatePlatformMessageRing`.
+typedef struct _FlutterPlatformMessageRing* FlutterPlatformMessageRing;
+
+/// Which way the platform messages on a channel go.
+typedef enum {
+  /// From the embedder to the Flutter application.
+  kFlutterPlatformMessageDirectionToFramework,
+  /// From the Flutter application to the embedder.
+  kFlutterPlatformMessageDirectionToPlatform,
+} FlutterPlatformMessageDirection;
+
+/// The counters and timings of the platform messages in one direction on one
+/// channel. All times are in nanoseconds.
+typedef struct {
+  /// The size of this struct. Must be
+  /// sizeof(FlutterPlatformMessageChannelStats).
+  size_t struct_size;
+  /// The channel. Only valid for the duration of the callback.
+  const char* channel;
+  FlutterPlatformMessageDirection direction;
+  /// The number of messages sent.
+  uint64_t message_count;
+  /// The number of bytes in the messages sent.
+  uint64_t byte_count;
+  /// The number of messages whose handler has returned.
+  uint64_t handled_count;
+  /// The time from sending the handled messages to calling their handler.
+  uint64_t total_queueing_delay;
+  uint64_t max_queueing_delay;
+  /// The time the handlers of the messages took.
+  uint64_t total_handler_time;
+  uint64_t max_handler_time;
+  /// The number of responses.
+  uint64_t response_count;
+  /// The percentiles of the time from sending a message to its response, over
+  /// the latest responses.
+  uint64_t response_latency_p50;
+  uint64_t response_latency_p90;
+  uint64_t response_latency_p99;
+  /// The longest time from sending a message to its response.
+  uint64_t max_response_latency;
+} FlutterPlatformMessageChannelStats;
+
+typedef void (*FlutterPlatformMessageChannelStatsCallback)(
+    const FlutterPlatformMessageChannelStats* /* stats */,
+    void* /* user data */);
+
 typedef void (*FlutterDataCallback)(const uint8_t* /* data */,
                                     size_t /* size */,
                                     void* /* user data */);
@@ -1202,6 +1298,28 @@ typedef enum {
   kFlutterEngineDisplaysUpdateTypeCount,
 } FlutterEngineDisplaysUpdateType;
 
+/// The image memory held by the engine, as reported by
+/// `FlutterEngineGetImageMemoryUsage`. All values are in bytes.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterEngineImageMemoryUsage).
+  /// The engine only writes the fields that fit in `struct_size`, so a
+  /// struct from an older version of this header is filled in as far as it
+  /// goes.
+  size_t struct_size;
+  /// Images that have been decoded but not yet handed to Dart.
+  size_t pending_decode_bytes;
+  /// Images referenced by `ui.Image` objects.
+  size_t dart_image_bytes;
+  /// Layers and pictures cached by the raster cache.
+  size_t raster_cache_bytes;
+  /// The GPU resource cache of the raster thread.
+  size_t resource_cache_bytes;
+  /// The sum of all of the above.
+  size_t total_bytes;
+  /// The image memory budget, or zero if there is none.
+  size_t budget_bytes;
+} FlutterEngineImageMemoryUsage;
+
 typedef int64_t FlutterEngineDartPort;
 
 typedef enum {
@@ -1750,6 +1868,33 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterPlatformMessage* message);
 
+//------------------------------------------------------------------------------
+/// @brief      Sends a platform message to the Flutter application like
+///             `FlutterEngineSendPlatformMessage`, but transfers ownership of
+///             the message data to the engine instead of copying it. The data
+///             of large messages is handed to the Flutter application as is,
+///             which avoids copying payloads like camera frames or file
+///             chunks.
+///
+///             The `message` field of the platform message must have been
+///             allocated with `malloc`, from the same C runtime as the engine,
+///             or be null. The engine frees it with `free` once the Flutter
+///             application is done with it.
+///
+/// @param[in]  engine   A running engine instance.
+/// @param[in]  message  The platform message to send. Ownership of its data
+///                      is transferred to the engine in every case, including
+///                      when the call fails, and the embedder must not access
+///                      the data after the call. The rest of the message is
+///                      not accessed after returning.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSendPlatformMessageNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* message);
+
 //------------------------------------------------------------------------------
 /// @brief     Creates a platform message response handle that allows the
 ///            embedder to set a native callback for a response to a message.
@@ -1823,6 +1968,198 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
     const uint8_t* data,
     size_t data_length);
 
+//------------------------------------------------------------------------------
+/// @brief      Sets where the platform messages that the Flutter application
+///             sends on a channel are delivered to the
+///             `platform_message_callback`.
+///
+///             By default messages are delivered on the platform thread, so
+///             handlers of data heavy channels wait behind other work there.
+///             Messages on a channel with a serial or concurrent queue are
+///             handed straight to a background thread instead. The callback
+///             must then be safe to call on that thread, and concurrently with
+///             itself. Responses may be sent with
+///             `FlutterEngineSendPlatformMessageResponse` on any thread, and
+///             are delivered to the Flutter application on its UI thread.
+///
+///             `FlutterEngineShutdown` drops the messages that are still
+///             queued and waits for the callbacks that are in progress on
+///             background threads, so those callbacks must not wait for the
+///             platform thread.
+///
+///             This may be called on any thread.
+///
+/// @param[in]  engine   A running engine instance.
+/// @param[in]  channel  The channel.
+/// @param[in]  queue    The queue to deliver the messages on the channel on.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSetPlatformMessageQueue(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageQueue queue);
+
+//------------------------------------------------------------------------------
+/// @brief      Sets whether the platform messages that the embedder sends on a
+///             channel are batched on their way to the Flutter application.
+///
+///             Every message is otherwise a task of its own on the UI thread.
+///             Batching saves those tasks for channels that send many small
+///             messages per frame, like sensor streams. Channels that carry
+///             state, where only the latest message matters, can also drop
+///             the messages that a newer one replaces before the Flutter
+///             application sees them. Messages on a channel are always
+///             delivered in the order they were sent.
+///
+///             This may be called on any thread.
+///
+/// @param[in]  engine    A running engine instance.
+/// @param[in]  channel   The channel.
+/// @param[in]  batching  How the messages on the channel are delivered.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSetPlatformMessageBatching(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageBatching batching);
+
+//------------------------------------------------------------------------------
+/// @brief      Sets the lane of the platform messages that the embedder sends
+///             on a channel, so that a burst of plugin traffic does not delay
+///             input or the next frame. The messages on a channel are
+///             delivered in the order they were sent, unless the channel
+///             leaves the background lane while messages wait in it. The
+///             Flutter application buffers the messages on the channel in the
+///             same lane until it has a listener for them.
+///
+///             This may be called on any thread.
+///
+/// @param[in]  engine   A running engine instance.
+/// @param[in]  channel  The channel.
+/// @param[in]  lane     How urgently the messages on the channel are
+///                      delivered.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSetPlatformMessageLane(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageLane lane);
+
+//------------------------------------------------------------------------------
+/// @brief      Creates a ring buffer that the embedder writes records to, and
+///             that the Flutter application reads on a channel, for streams of
+///             small messages like sensor samples. Writing a record neither
+///             allocates a platform message nor copies the record again: the
+///             Flutter application reads the records in place, from a
+///             `ByteData` that wraps the buffer of the ring.
+///
+///             The Flutter application gets the `ByteData` as the reply to
+///             any message it sends on the channel. When records are written
+///             to an empty ring, the Flutter application receives a message
+///             on the channel with two host-endian uint64 positions, `start`
+///             and `end`. It reads the records between those positions, and
+///             then replies to the message, which frees their space. The
+///             offset of a position in the buffer is the position modulo the
+///             capacity. A record is a host-endian uint32 length, followed by
+///             that many bytes, padded to 4 bytes. A length of `0xFFFFFFFF`
+///             means that the next record starts at the beginning of the
+///             buffer.
+///
+///             The ring replaces any ring that was created on the channel
+///             before. This may be called on any thread.
+///
+/// @param[in]  engine    A running engine instance.
+/// @param[in]  channel   The channel.
+/// @param[in]  capacity  The size of the buffer in bytes. Must be a power of
+///                       two that is at least 1024.
+/// @param[out] out_ring  The ring. Must be released with
+///                       `FlutterEngineReleasePlatformMessageRing`.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineCreatePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    size_t capacity,
+    FlutterPlatformMessageRing* out_ring);
+
+//------------------------------------------------------------------------------
+/// @brief      Writes a record to a ring. Must only be called by one thread at
+///             a time. The write fails instead of blocking when the Flutter
+///             application has not freed enough space yet, which lets the
+///             embedder drop or merge records.
+///
+/// @param[in]  engine       A running engine instance.
+/// @param[in]  ring         The ring.
+/// @param[in]  data         The bytes of the record.
+/// @param[in]  size         The number of bytes.
+/// @param[out] out_written  Whether the record was written.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineWritePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring,
+    const uint8_t* data,
+    size_t size,
+    bool* out_written);
+
+//------------------------------------------------------------------------------
+/// @brief      Releases a ring. The Flutter application no longer gets the
+///             buffer of the ring on its channel, but may keep reading the
+///             buffer it already has.
+///
+///             Every ring must be released, whether before or after
+///             `FlutterEngineShutdown` is called on the engine that created
+///             it. A ring must not be written to after shutdown, and releasing
+///             it then only frees it. This may be called on any thread.
+///
+/// @param[in]  engine  The engine instance that created the ring. It is not
+///                     used, and may be null or already shut down.
+/// @param[in]  ring    The ring.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineReleasePlatformMessageRing(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring);
+
+//------------------------------------------------------------------------------
+/// @brief      Gets the counters and timings of the platform messages on each
+///             channel since the engine was launched, for finding the
+///             channels that keep the threads of the engine busy. The
+///             callback is invoked on the calling thread, once for each
+///             channel and direction that carried a message, before this call
+///             returns. This may be called on any thread.
+///
+///             Recording the stats costs a lock and an allocation per
+///             message, so messages are only recorded if the engine was
+///             launched with the `--enable-platform-message-stats` switch in
+///             `FlutterProjectArgs.command_line_argv`, or while recording is
+///             turned on with the `_flutter.setPlatformMessageStatsEnabled`
+///             service extension.
+///
+/// @param[in]  engine     A running engine instance.
+/// @param[in]  callback   The callback invoked with the stats of a channel.
+/// @param[in]  user_data  The user data baton passed to the callback.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetPlatformMessageStats(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageChannelStatsCallback callback,
+    void* user_data);
+
 //------------------------------------------------------------------------------
 /// @brief      This API is only meant to be used by platforms that need to
 ///             flush tasks on a message loop not controlled by the Flutter
@@ -2169,6 +2506,29 @@ FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineNotifyLowMemoryWarning(
     FLUTTER_API_SYMBOL(FlutterEngine) engine);
 
+//------------------------------------------------------------------------------
+/// @brief      Gets the image memory currently held by the engine. Image
+///             memory is accounted for across all engines in the process, so
+///             the usage includes that of other running engines.
+///
+///             The budget can be set with the `--image-memory-budget-mb`
+///             command line switch. When the budget is exceeded, the engine
+///             evicts raster cache entries, then purges the GPU resource
+///             cache, and finally asks the Dart VM to collect unreachable
+///             images. `FlutterEngineNotifyLowMemoryWarning` evicts in the same
+///             order regardless of the budget.
+///
+/// @param[in]  engine     A running engine instance.
+/// @param[out] usage      The usage to fill in. The `struct_size` must be set
+///                        by the caller.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetImageMemoryUsage(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterEngineImageMemoryUsage* usage);
+
 //------------------------------------------------------------------------------
 /// @brief      Schedule a callback to be run on all engine managed threads.
 ///             The engine will attempt to service this callback the next time
@@ -2341,6 +2701,42 @@ typedef FlutterEngineResult (*FlutterEngineNotifyDisplayUpdateFnPtr)(
     FlutterEngineDisplaysUpdateType update_type,
     const FlutterEngineDisplay* displays,
     size_t display_count);
+typedef FlutterEngineResult (*FlutterEngineGetImageMemoryUsageFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterEngineImageMemoryUsage* usage);
+typedef FlutterEngineResult (*FlutterEngineSetPlatformMessageQueueFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageQueue queue);
+typedef FlutterEngineResult (*FlutterEngineSendPlatformMessageNoCopyFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessage* message);
+typedef FlutterEngineResult (*FlutterEngineSetPlatformMessageBatchingFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageBatching batching);
+typedef FlutterEngineResult (*FlutterEngineCreatePlatformMessageRingFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    size_t capacity,
+    FlutterPlatformMessageRing* out_ring);
+typedef FlutterEngineResult (*FlutterEngineWritePlatformMessageRingFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring,
+    const uint8_t* data,
+    size_t size,
+    bool* out_written);
+typedef FlutterEngineResult (*FlutterEngineReleasePlatformMessageRingFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageRing ring);
+typedef FlutterEngineResult (*FlutterEngineGetPlatformMessageStatsFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterPlatformMessageChannelStatsCallback callback,
+    void* user_data);
+typedef FlutterEngineResult (*FlutterEngineSetPlatformMessageLaneFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const char* channel,
+    FlutterPlatformMessageLane lane);
 
 /// Function-pointer-based versions of the APIs above.
 typedef struct {
@@ -2385,6 +2781,15 @@ typedef struct {
   FlutterEnginePostCallbackOnAllNativeThreadsFnPtr
       PostCallbackOnAllNativeThreads;
   FlutterEngineNotifyDisplayUpdateFnPtr NotifyDisplayUpdate;
+  FlutterEngineGetImageMemoryUsageFnPtr GetImageMemoryUsage;
+  FlutterEngineSetPlatformMessageQueueFnPtr SetPlatformMessageQueue;
+  FlutterEngineSendPlatformMessageNoCopyFnPtr SendPlatformMessageNoCopy;
+  FlutterEngineSetPlatformMessageBatchingFnPtr SetPlatformMessageBatching;
+  FlutterEngineCreatePlatformMessageRingFnPtr CreatePlatformMessageRing;
+  FlutterEngineWritePlatformMessageRingFnPtr WritePlatformMessageRing;
+  FlutterEngineReleasePlatformMessageRingFnPtr ReleasePlatformMessageRing;
+  FlutterEngineGetPlatformMessageStatsFnPtr GetPlatformMessageStats;
+  FlutterEngineSetPlatformMessageLaneFnPtr SetPlatformMessageLane;
 } FlutterEngineProcTable;
 
 //------------------------------------------------------------------------------
@@ -289,6 +289,122 @@ bool EmbedderEngine::PostTaskOnEngineManagedNativeThreads(
   return true;
 }
 
+bool EmbedderEngine::SetPlatformMessageQueue(
+    const std::string& channel,
+    FlutterPlatformMessageQueue queue) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  std::shared_ptr<fml::BasicTaskRunner> task_runner;
+  {
+    std::scoped_lock lock(platform_message_queues_mutex_);
+    switch (queue) {
+      case kFlutterPlatformMessageQueuePlatform:
+        break;
+      case kFlutterPlatformMessageQueueSerial:
+        // A single worker runs the tasks in the order they were posted.
+        if (!platform_message_serial_loop_) {
+          platform_message_serial_loop_ = fml::ConcurrentMessageLoop::Create(1);
+        }
+        task_runner = platform_message_serial_loop_->GetTaskRunner();
+        break;
+      case kFlutterPlatformMessageQueueConcurrent:
+        task_runner = shell_->GetDartVM()->GetConcurrentWorkerTaskRunner();
+        break;
+      default:
+        return false;
+    }
+  }
+
+  shell_->SetPlatformMessageTaskRunner(channel, std::move(task_runner));
+  return true;
+}
+
+bool EmbedderEngine::SetPlatformMessageBatching(
+    const std::string& channel,
+    FlutterPlatformMessageBatching batching) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  PlatformMessageBatcher::Mode mode;
+  switch (batching) {
+    case kFlutterPlatformMessageBatchingNone:
+      mode = PlatformMessageBatcher::Mode::kNone;
+      break;
+    case kFlutterPlatformMessageBatchingBatch:
+      mode = PlatformMessageBatcher::Mode::kBatch;
+      break;
+    case kFlutterPlatformMessageBatchingLatestOnly:
+      mode = PlatformMessageBatcher::Mode::kLatestOnly;
+      break;
+    default:
+      return false;
+  }
+
+  shell_->SetPlatformMessageBatching(channel, mode);
+  return true;
+}
+
+bool EmbedderEngine::SetPlatformMessageLane(const std::string& channel,
+                                            FlutterPlatformMessageLane lane) {
+  if (!IsValid()) {
+    return false;
+  }
+
+  PlatformMessageBatcher::Lane batcher_lane;
+  switch (lane) {
+    case kFlutterPlatformMessageLaneInput:
+      batcher_lane = PlatformMessageBatcher::Lane::kInput;
+      break;
+    case kFlutterPlatformMessageLaneFrameCritical:
+      batcher_lane = PlatformMessageBatcher::Lane::kFrameCritical;
+      break;
+    case kFlutterPlatformMessageLaneNormal:
+      batcher_lane = PlatformMessageBatcher::Lane::kNormal;
+      break;
+    case kFlutterPlatformMessageLaneBackground:
+      batcher_lane = PlatformMessageBatcher::Lane::kBackground;
+      break;
+    default:
+      return false;
+  }
+
+  shell_->SetPlatformMessageLane(channel, batcher_lane);
+  return true;
+}
+
+fml::RefPtr<PlatformMessageRing> EmbedderEngine::CreatePlatformMessageRing(
+    const std::string& channel,
+    size_t capacity) {
+  if (!IsValid()) {
+    return nullptr;
+  }
+
+  return shell_->CreatePlatformMessageRing(channel, capacity);
+}
+
+fml::closure EmbedderEngine::GetPlatformMessageRingRemover(
+    const std::string& channel,
+    fml::RefPtr<PlatformMessageRing> ring) {
+  if (!IsValid()) {
+    return nullptr;
+  }
+
+  return shell_->GetPlatformMessageRingRemover(channel, std::move(ring));
+}
+
+bool EmbedderEngine::GetPlatformMessageStats(
+    std::vector<PlatformMessageStats::ChannelStats>* stats) const {
+  if (!IsValid()) {
+    return false;
+  }
+
+  *stats = shell_->GetPlatformMessageStats();
+  return true;
+}
+
 Shell& EmbedderEngine::GetShell() {
   FML_DCHECK(shell_);
   return *shell_.get();
@@ -6,8 +6,10 @@
 #define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_ENGINE_H_
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/thread_host.h"
@@ -70,6 +72,85 @@ class EmbedderEngine {
 
   bool SendPlatformMessage(std::unique_ptr<PlatformMessage> message);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Sets the queue on which the platform messages that the
+  ///             framework sends on channel are handed to the embedder. The
+  ///             serial queue is a single worker thread created the first time
+  ///             it is used. This may be called on any thread.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  queue    The queue.
+  ///
+  /// @return     If the queue was set.
+  ///
+  bool SetPlatformMessageQueue(const std::string& channel,
+                               FlutterPlatformMessageQueue queue);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets how the platform messages that the embedder sends on a
+  ///             channel are batched on their way to the framework. This may
+  ///             be called on any thread.
+  ///
+  /// @param[in]  channel   The channel.
+  /// @param[in]  batching  The batching.
+  ///
+  /// @return     If the batching was set.
+  ///
+  bool SetPlatformMessageBatching(const std::string& channel,
+                                  FlutterPlatformMessageBatching batching);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Sets how urgently the platform messages that the embedder
+  ///             sends on a channel are delivered to the framework. This may
+  ///             be called on any thread.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  lane     The lane.
+  ///
+  /// @return     If the lane was set.
+  ///
+  bool SetPlatformMessageLane(const std::string& channel,
+                              FlutterPlatformMessageLane lane);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a ring buffer that the embedder writes records to, and
+  ///             that the framework reads on a channel. This may be called on
+  ///             any thread.
+  ///
+  /// @param[in]  channel   The channel.
+  /// @param[in]  capacity  The size of the buffer in bytes.
+  ///
+  /// @return     The ring, or null if the capacity is invalid.
+  ///
+  fml::RefPtr<PlatformMessageRing> CreatePlatformMessageRing(
+      const std::string& channel,
+      size_t capacity);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Gets a callback that stops answering the framework on a
+  ///             channel with a ring. The callback may be called on any
+  ///             thread, including after the engine has been destroyed.
+  ///
+  /// @param[in]  channel  The channel.
+  /// @param[in]  ring     The ring.
+  ///
+  /// @return     The callback, or null if the engine is not valid.
+  ///
+  fml::closure GetPlatformMessageRingRemover(
+      const std::string& channel,
+      fml::RefPtr<PlatformMessageRing> ring);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Gets the stats of the platform messages on each channel. This
+  ///             may be called on any thread.
+  ///
+  /// @param[out] stats  The stats of every channel that carried a message.
+  ///
+  /// @return     Whether the engine is valid.
+  ///
+  bool GetPlatformMessageStats(
+      std::vector<PlatformMessageStats::ChannelStats>* stats) const;
+
   bool RegisterTexture(int64_t texture);
 
   bool UnregisterTexture(int64_t texture);
@@ -104,6 +185,11 @@ class EmbedderEngine {
   TaskRunners task_runners_;
   RunConfiguration run_configuration_;
   std::unique_ptr<ShellArgs> shell_args_;
+  // The loop of the serial platform message queue. The shell drops the
+  // messages still queued on it when it is destroyed, so it is declared before
+  // the shell to outlive it.
+  std::mutex platform_message_queues_mutex_;
+  std::shared_ptr<fml::ConcurrentMessageLoop> platform_message_serial_loop_;
   std::unique_ptr<Shell> shell_;
   std::unique_ptr<EmbedderExternalTextureResolver> external_texture_resolver_;
 
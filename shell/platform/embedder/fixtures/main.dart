@@ -243,6 +243,28 @@ void platform_messages_response() {
   signalNativeTest();
 }
 
+@pragma('vm:entry-point')
+void platform_messages_background_queue() {
+  PlatformDispatcher.instance.onPlatformMessage = (String name, ByteData? data, PlatformMessageResponseCallback? callback) {
+    // Forward the message to a channel the embedder handles in the background
+    // and pass its response back.
+    PlatformDispatcher.instance.sendPlatformMessage('test/background', data, (ByteData? reply) {
+      callback!(reply);
+    });
+  };
+  signalNativeTest();
+}
+
+@pragma('vm:entry-point')
+void platform_messages_background_queue_flood() {
+  PlatformDispatcher.instance.onPlatformMessage = (String name, ByteData? data, PlatformMessageResponseCallback? callback) {
+    for (int i = 0; i < 1000; i++) {
+      PlatformDispatcher.instance.sendPlatformMessage('test/background', null, null);
+    }
+  };
+  signalNativeTest();
+}
+
 @pragma('vm:entry-point')
 void platform_messages_no_response() {
   PlatformDispatcher.instance.onPlatformMessage = (String name, ByteData? data, PlatformMessageResponseCallback? callback) {
@@ -64,23 +64,62 @@ void PlatformViewEmbedder::UpdateSemantics(
   }
 }
 
-void PlatformViewEmbedder::HandlePlatformMessage(
-    std::unique_ptr<flutter::PlatformMessage> message) {
-  if (!message) {
-    return;
+namespace {
+
+// Hands the messages on background channels to the platform message callback
+// of the embedder. The callback only refers to state owned by the embedder, so
+// it may be called on any thread.
+class EmbedderPlatformMessageHandler final : public PlatformMessageHandler {
+ public:
+  explicit EmbedderPlatformMessageHandler(
+      PlatformViewEmbedder::PlatformMessageResponseCallback callback)
+      : callback_(std::move(callback)) {}
+
+  // |PlatformMessageHandler|
+  void HandlePlatformMessage(
+      std::unique_ptr<PlatformMessage> message) override {
+    DispatchPlatformMessage(callback_, std::move(message));
   }
 
-  if (platform_dispatch_table_.platform_message_response_callback == nullptr) {
-    if (message->response()) {
-      message->response()->CompleteEmpty();
+  static void DispatchPlatformMessage(
+      const PlatformViewEmbedder::PlatformMessageResponseCallback& callback,
+      std::unique_ptr<PlatformMessage> message) {
+    if (!message) {
+      return;
+    }
+
+    if (callback == nullptr) {
+      if (message->response()) {
+        message->response()->CompleteEmpty();
+      }
+      return;
     }
-    return;
+
+    callback(std::move(message));
   }
 
-  platform_dispatch_table_.platform_message_response_callback(
+ private:
+  const PlatformViewEmbedder::PlatformMessageResponseCallback callback_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EmbedderPlatformMessageHandler);
+};
+
+}  // namespace
+
+void PlatformViewEmbedder::HandlePlatformMessage(
+    std::unique_ptr<flutter::PlatformMessage> message) {
+  EmbedderPlatformMessageHandler::DispatchPlatformMessage(
+      platform_dispatch_table_.platform_message_response_callback,
       std::move(message));
 }
 
+// |PlatformView|
+std::shared_ptr<PlatformMessageHandler>
+PlatformViewEmbedder::GetPlatformMessageHandler() const {
+  return std::make_shared<EmbedderPlatformMessageHandler>(
+      platform_dispatch_table_.platform_message_response_callback);
+}
+
 // |PlatformView|
 std::unique_ptr<Surface> PlatformViewEmbedder::CreateRenderingSurface() {
   if (embedder_surface_ == nullptr) {
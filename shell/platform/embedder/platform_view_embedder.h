@@ -87,6 +87,10 @@ class PlatformViewEmbedder final : public PlatformView {
   // |PlatformView|
   void HandlePlatformMessage(std::unique_ptr<PlatformMessage> message) override;
 
+  // |PlatformView|
+  std::shared_ptr<PlatformMessageHandler> GetPlatformMessageHandler()
+      const override;
+
  private:
   std::shared_ptr<EmbedderExternalViewEmbedder> external_view_embedder_;
   std::unique_ptr<EmbedderSurface> embedder_surface_;
@@ -4,7 +4,10 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "embedder.h"
@@ -340,6 +343,241 @@ TEST_F(EmbedderTest, PlatformMessagesCanReceiveResponse) {
   captures.latch.Wait();
 }
 
+//------------------------------------------------------------------------------
+/// Tests that a platform message whose data is transferred to the engine is
+/// delivered intact, including when it is large enough to be handed to Dart
+/// without a copy.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanTransferData) {
+  constexpr size_t kMessageSize = 1 << 20;
+  struct Captures {
+    fml::AutoResetWaitableEvent latch;
+    bool matched = false;
+  };
+  Captures captures;
+
+  CreateNewThread()->PostTask([&]() {
+    auto& context =
+        GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetDartEntrypoint("platform_messages_response");
+
+    fml::AutoResetWaitableEvent ready;
+    context.AddNativeCallback(
+        "SignalNativeTest",
+        CREATE_NATIVE_ENTRY(
+            [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+
+    auto engine = builder.LaunchEngine();
+    ASSERT_TRUE(engine.is_valid());
+
+    FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+    auto callback = [](const uint8_t* data, size_t size,
+                       void* user_data) -> void {
+      auto captures = reinterpret_cast<Captures*>(user_data);
+      captures->matched = size == kMessageSize;
+      for (size_t i = 0; captures->matched && i < size; i++) {
+        captures->matched = data[i] == static_cast<uint8_t>(i);
+      }
+      captures->latch.Signal();
+    };
+    auto result = FlutterPlatformMessageCreateResponseHandle(
+        engine.get(), callback, &captures, &response_handle);
+    ASSERT_EQ(result, kSuccess);
+
+    auto data = reinterpret_cast<uint8_t*>(malloc(kMessageSize));
+    for (size_t i = 0; i < kMessageSize; i++) {
+      data[i] = static_cast<uint8_t>(i);
+    }
+
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(FlutterPlatformMessage);
+    message.channel = "test_channel";
+    message.message = data;
+    message.message_size = kMessageSize;
+    message.response_handle = response_handle;
+
+    ready.Wait();
+    result = FlutterEngineSendPlatformMessageNoCopy(engine.get(), &message);
+    ASSERT_EQ(result, kSuccess);
+
+    result = FlutterPlatformMessageReleaseResponseHandle(engine.get(),
+                                                         response_handle);
+    ASSERT_EQ(result, kSuccess);
+  });
+
+  captures.latch.Wait();
+  ASSERT_TRUE(captures.matched);
+}
+
+//------------------------------------------------------------------------------
+/// Moves a channel to the serial background queue and checks that messages on
+/// it are delivered off the platform thread, and that responses sent from that
+/// thread get back to Dart.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanBeHandledOnBackgroundQueue) {
+  struct Captures {
+    fml::AutoResetWaitableEvent latch;
+    std::thread::id platform_thread_id;
+    std::thread::id handler_thread_id;
+    std::string reply;
+  };
+  Captures captures;
+  UniqueEngine engine;
+
+  auto platform_task_runner = CreateNewThread();
+  platform_task_runner->PostTask([&]() {
+    captures.platform_thread_id = std::this_thread::get_id();
+    auto& context =
+        GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetDartEntrypoint("platform_messages_background_queue");
+
+    fml::AutoResetWaitableEvent ready;
+    context.AddNativeCallback(
+        "SignalNativeTest",
+        CREATE_NATIVE_ENTRY(
+            [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+    builder.SetPlatformMessageCallback(
+        [&](const FlutterPlatformMessage* message) {
+          if (strcmp(message->channel, "test/background") != 0) {
+            return;
+          }
+          captures.handler_thread_id = std::this_thread::get_id();
+          FlutterEngineSendPlatformMessageResponse(
+              engine.get(), message->response_handle, message->message,
+              message->message_size);
+        });
+
+    engine = builder.LaunchEngine();
+    ASSERT_TRUE(engine.is_valid());
+    ASSERT_EQ(FlutterEngineSetPlatformMessageQueue(
+                  engine.get(), "test/background",
+                  kFlutterPlatformMessageQueueSerial),
+              kSuccess);
+
+    static std::string kMessageData = "Hello from the background.";
+    FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+    auto callback = [](const uint8_t* data, size_t size,
+                       void* user_data) -> void {
+      auto captures = reinterpret_cast<Captures*>(user_data);
+      captures->reply.assign(reinterpret_cast<const char*>(data), size);
+      captures->latch.Signal();
+    };
+    auto result = FlutterPlatformMessageCreateResponseHandle(
+        engine.get(), callback, &captures, &response_handle);
+    ASSERT_EQ(result, kSuccess);
+
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(FlutterPlatformMessage);
+    message.channel = "test_channel";
+    message.message = reinterpret_cast<const uint8_t*>(kMessageData.data());
+    message.message_size = kMessageData.size();
+    message.response_handle = response_handle;
+
+    ready.Wait();
+    result = FlutterEngineSendPlatformMessage(engine.get(), &message);
+    ASSERT_EQ(result, kSuccess);
+
+    result = FlutterPlatformMessageReleaseResponseHandle(engine.get(),
+                                                         response_handle);
+    ASSERT_EQ(result, kSuccess);
+  });
+
+  captures.latch.Wait();
+  EXPECT_EQ(captures.reply, "Hello from the background.");
+  EXPECT_NE(captures.handler_thread_id, std::thread::id());
+  EXPECT_NE(captures.handler_thread_id, captures.platform_thread_id);
+
+  // The engine was started on its own thread, so it must be collected there.
+  fml::AutoResetWaitableEvent kill_latch;
+  platform_task_runner->PostTask([&]() {
+    engine.reset();
+    kill_latch.Signal();
+  });
+  kill_latch.Wait();
+}
+
+//------------------------------------------------------------------------------
+/// Shuts the engine down while messages on a concurrent background channel
+/// are still queued on the worker pool, which outlives the engine, and checks
+/// that none of them reach the callback after the shutdown.
+///
+TEST_F(EmbedderTest, QueuedBackgroundPlatformMessagesAreDroppedAtShutdown) {
+  static constexpr size_t kMessageCount = 1000;
+  struct Captures {
+    fml::AutoResetWaitableEvent first_message;
+    std::atomic<bool> shut_down = false;
+    std::atomic<size_t> handled = 0;
+    std::atomic<size_t> handled_after_shutdown = 0;
+  };
+  Captures captures;
+  UniqueEngine engine;
+
+  auto platform_task_runner = CreateNewThread();
+  fml::AutoResetWaitableEvent launched;
+  platform_task_runner->PostTask([&]() {
+    auto& context =
+        GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetDartEntrypoint("platform_messages_background_queue_flood");
+
+    fml::AutoResetWaitableEvent ready;
+    context.AddNativeCallback(
+        "SignalNativeTest",
+        CREATE_NATIVE_ENTRY(
+            [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+    builder.SetPlatformMessageCallback(
+        [&captures](const FlutterPlatformMessage* message) {
+          if (strcmp(message->channel, "test/background") != 0) {
+            return;
+          }
+          if (captures.shut_down) {
+            captures.handled_after_shutdown++;
+          }
+          if (captures.handled++ == 0) {
+            captures.first_message.Signal();
+          }
+          // Keep the rest of the messages queued.
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+
+    engine = builder.LaunchEngine();
+    ASSERT_TRUE(engine.is_valid());
+    ASSERT_EQ(FlutterEngineSetPlatformMessageQueue(
+                  engine.get(), "test/background",
+                  kFlutterPlatformMessageQueueConcurrent),
+              kSuccess);
+
+    ready.Wait();
+    // Any message makes the application flood the background channel.
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(FlutterPlatformMessage);
+    message.channel = "test_channel";
+    ASSERT_EQ(FlutterEngineSendPlatformMessage(engine.get(), &message),
+              kSuccess);
+    launched.Signal();
+  });
+  launched.Wait();
+  captures.first_message.Wait();
+
+  fml::AutoResetWaitableEvent kill_latch;
+  platform_task_runner->PostTask([&]() {
+    engine.reset();
+    captures.shut_down = true;
+    kill_latch.Signal();
+  });
+  kill_latch.Wait();
+
+  // Give the worker pool time to run whatever is still queued on it.
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(captures.handled_after_shutdown, 0u);
+  EXPECT_LT(captures.handled, kMessageCount);
+}
+
 //------------------------------------------------------------------------------
 /// Tests that a platform message can be sent with no response handle. Instead
 /// of the platform message integrity checked via a response handle, a native
@@ -858,6 +1096,21 @@ TEST_F(EmbedderTest, CanUpdateLocales) {
   check_latch.Wait();
 }
 
+//------------------------------------------------------------------------------
+/// Engines with a software renderer config render pictures without a GPU, and
+/// their settings say so.
+///
+TEST_F(EmbedderTest, SoftwareRendererConfigEnablesSoftwareRendering) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  const flutter::Shell& shell = ToEmbedderEngine(engine.get())->GetShell();
+  ASSERT_TRUE(shell.GetSettings().enable_software_rendering);
+}
+
 TEST_F(EmbedderTest, LocalizationCallbacksCalled) {
   auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
   fml::AutoResetWaitableEvent latch;
@@ -1031,6 +1284,55 @@ TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   ASSERT_EQ(FlutterEngineNotifyLowMemoryWarning(engine.get()), kSuccess);
 }
 
+TEST_F(EmbedderTest, PlatformMessageRingsCanBeReleasedAfterShutdown) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterPlatformMessageRing released_before = nullptr;
+  FlutterPlatformMessageRing released_after = nullptr;
+  ASSERT_EQ(FlutterEngineCreatePlatformMessageRing(
+                engine.get(), "test/before", 1024, &released_before),
+            kSuccess);
+  ASSERT_EQ(FlutterEngineCreatePlatformMessageRing(
+                engine.get(), "test/after", 1024, &released_after),
+            kSuccess);
+
+  ASSERT_EQ(FlutterEngineReleasePlatformMessageRing(engine.get(),
+                                                    released_before),
+            kSuccess);
+  engine.reset();
+  ASSERT_EQ(FlutterEngineReleasePlatformMessageRing(nullptr, released_after),
+            kSuccess);
+}
+
+TEST_F(EmbedderTest, ImageMemoryUsageFillsOnlyTheFieldsOfOlderStructs) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  // A struct from a version of the header that ended at `total_bytes`.
+  FlutterEngineImageMemoryUsage usage = {};
+  usage.struct_size = offsetof(FlutterEngineImageMemoryUsage, budget_bytes);
+  usage.budget_bytes = 42;
+  ASSERT_EQ(FlutterEngineGetImageMemoryUsage(engine.get(), &usage), kSuccess);
+  ASSERT_EQ(usage.budget_bytes, 42u);
+
+  usage.struct_size = sizeof(FlutterEngineImageMemoryUsage);
+  ASSERT_EQ(FlutterEngineGetImageMemoryUsage(engine.get(), &usage), kSuccess);
+  ASSERT_EQ(usage.budget_bytes, 0u);
+}
+
 TEST_F(EmbedderTest, CanPostTaskToAllNativeThreads) {
   UniqueEngine engine;
   size_t worker_count = 0;
@@ -45,6 +45,17 @@ TEST_F(EmbedderTest, CanCreateOpenGLRenderingEngine) {
   ASSERT_TRUE(engine.is_valid());
 }
 
+TEST_F(EmbedderTest, OpenGLRendererConfigDoesNotEnableSoftwareRendering) {
+  EmbedderConfigBuilder builder(
+      GetEmbedderContext(EmbedderTestContextType::kOpenGLContext));
+  builder.SetOpenGLRendererConfig(SkISize::Make(1, 1));
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  const flutter::Shell& shell = ToEmbedderEngine(engine.get())->GetShell();
+  ASSERT_FALSE(shell.GetSettings().enable_software_rendering);
+}
+
 //------------------------------------------------------------------------------
 /// If an incorrectly configured compositor is set on the engine, the engine
 /// must fail to launch instead of failing to render a frame at a later point in
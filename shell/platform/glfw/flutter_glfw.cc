@@ -1101,6 +1101,25 @@ void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
                                                             user_data);
 }
 
+void FlutterDesktopMessengerSetQueue(FlutterDesktopMessengerRef messenger,
+                                     const char* channel,
+                                     FlutterDesktopMessageQueue queue) {
+  FlutterPlatformMessageQueue engine_queue;
+  switch (queue) {
+    case kFlutterDesktopMessageQueueSerial:
+      engine_queue = kFlutterPlatformMessageQueueSerial;
+      break;
+    case kFlutterDesktopMessageQueueConcurrent:
+      engine_queue = kFlutterPlatformMessageQueueConcurrent;
+      break;
+    default:
+      engine_queue = kFlutterPlatformMessageQueuePlatform;
+      break;
+  }
+  FlutterEngineSetPlatformMessageQueue(messenger->engine->flutter_engine,
+                                       channel, engine_queue);
+}
+
 FlutterDesktopTextureRegistrarRef FlutterDesktopRegistrarGetTextureRegistrar(
     FlutterDesktopPluginRegistrarRef registrar) {
   std::cerr << "GLFW Texture support is not implemented yet." << std::endl;
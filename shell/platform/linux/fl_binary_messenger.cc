@@ -74,6 +74,40 @@ static FlBinaryMessengerResponseHandle* fl_binary_messenger_response_handle_new(
   return self;
 }
 
+struct _FlBinaryMessengerRing {
+  GObject parent_instance;
+
+  // Messenger the ring was created on.
+  FlBinaryMessenger* messenger;
+
+  FlutterPlatformMessageRing ring;
+
+  // Function that releases the ring. It is kept from the engine the ring was
+  // created on, as the engine may be gone by the time the ring is released.
+  FlutterEngineReleasePlatformMessageRingFnPtr release;
+};
+
+G_DEFINE_TYPE(FlBinaryMessengerRing, fl_binary_messenger_ring, G_TYPE_OBJECT)
+
+static void fl_binary_messenger_ring_dispose(GObject* object) {
+  FlBinaryMessengerRing* self = FL_BINARY_MESSENGER_RING(object);
+
+  if (self->ring != nullptr) {
+    self->release(nullptr, self->ring);
+  }
+  self->ring = nullptr;
+  g_clear_object(&self->messenger);
+
+  G_OBJECT_CLASS(fl_binary_messenger_ring_parent_class)->dispose(object);
+}
+
+static void fl_binary_messenger_ring_class_init(
+    FlBinaryMessengerRingClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = fl_binary_messenger_ring_dispose;
+}
+
+static void fl_binary_messenger_ring_init(FlBinaryMessengerRing* self) {}
+
 typedef struct {
   FlBinaryMessengerMessageHandler message_handler;
   gpointer message_handler_data;
@@ -276,3 +310,48 @@ G_MODULE_EXPORT GBytes* fl_binary_messenger_send_on_channel_finish(
 
   return fl_engine_send_platform_message_finish(self->engine, r, error);
 }
+
+G_MODULE_EXPORT FlBinaryMessengerRing* fl_binary_messenger_create_ring(
+    FlBinaryMessenger* self,
+    const gchar* channel,
+    size_t capacity,
+    GError** error) {
+  g_return_val_if_fail(FL_IS_BINARY_MESSENGER(self), nullptr);
+  g_return_val_if_fail(channel != nullptr, nullptr);
+
+  if (self->engine == nullptr) {
+    g_set_error(error, fl_engine_error_quark(), FL_ENGINE_ERROR_FAILED,
+                "No engine to create ring on");
+    return nullptr;
+  }
+
+  FlutterPlatformMessageRing ring = fl_engine_create_platform_message_ring(
+      self->engine, channel, capacity, error);
+  if (ring == nullptr) {
+    return nullptr;
+  }
+
+  FlBinaryMessengerRing* result = FL_BINARY_MESSENGER_RING(
+      g_object_new(fl_binary_messenger_ring_get_type(), nullptr));
+  result->messenger = FL_BINARY_MESSENGER(g_object_ref(self));
+  result->ring = ring;
+  result->release =
+      fl_engine_get_embedder_api(self->engine)->ReleasePlatformMessageRing;
+
+  return result;
+}
+
+G_MODULE_EXPORT gboolean fl_binary_messenger_ring_write(
+    FlBinaryMessengerRing* self,
+    const uint8_t* data,
+    size_t size) {
+  g_return_val_if_fail(FL_IS_BINARY_MESSENGER_RING(self), FALSE);
+  g_return_val_if_fail(data != nullptr || size == 0, FALSE);
+
+  if (self->messenger->engine == nullptr) {
+    return FALSE;
+  }
+
+  return fl_engine_write_platform_message_ring(self->messenger->engine,
+                                               self->ring, data, size);
+}
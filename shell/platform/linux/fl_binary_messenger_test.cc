@@ -6,7 +6,9 @@
 #include "gtest/gtest.h"
 
 #include <cstring>
+#include <string>
 
+#include "flutter/shell/platform/embedder/test_utils/proc_table_replacement.h"
 #include "flutter/shell/platform/linux/fl_binary_messenger_private.h"
 #include "flutter/shell/platform/linux/fl_engine_private.h"
 #include "flutter/shell/platform/linux/public/flutter_linux/fl_binary_messenger.h"
@@ -184,3 +186,112 @@ TEST(FlBinaryMessengerTest, ReceiveMessage) {
   // Blocks here until response_cb is called.
   g_main_loop_run(loop);
 }
+
+// Checks rings are created, written to and released through the engine.
+TEST(FlBinaryMessengerTest, Ring) {
+  g_autoptr(FlEngine) engine = make_mock_engine();
+  FlutterEngineProcTable* embedder_api = fl_engine_get_embedder_api(engine);
+
+  FlutterPlatformMessageRing engine_ring =
+      reinterpret_cast<FlutterPlatformMessageRing>(42);
+  embedder_api->CreatePlatformMessageRing = MOCK_ENGINE_PROC(
+      CreatePlatformMessageRing,
+      ([engine_ring](auto engine, const char* channel, size_t capacity,
+                     FlutterPlatformMessageRing* out_ring) {
+        EXPECT_STREQ(channel, "test/ring");
+        EXPECT_EQ(capacity, static_cast<size_t>(4096));
+        *out_ring = engine_ring;
+        return kSuccess;
+      }));
+  std::string written;
+  embedder_api->WritePlatformMessageRing = MOCK_ENGINE_PROC(
+      WritePlatformMessageRing,
+      ([engine_ring, &written](auto engine, FlutterPlatformMessageRing ring,
+                               const uint8_t* data, size_t size,
+                               bool* out_written) {
+        EXPECT_EQ(ring, engine_ring);
+        written.append(reinterpret_cast<const char*>(data), size);
+        // Pretend the ring is full after the first record.
+        *out_written = written.size() == size;
+        return kSuccess;
+      }));
+  bool released = false;
+  embedder_api->ReleasePlatformMessageRing = MOCK_ENGINE_PROC(
+      ReleasePlatformMessageRing,
+      ([engine_ring, &released](auto engine, FlutterPlatformMessageRing ring) {
+        EXPECT_EQ(ring, engine_ring);
+        released = true;
+        return kSuccess;
+      }));
+
+  g_autoptr(FlBinaryMessenger) messenger = fl_binary_messenger_new(engine);
+  g_autoptr(GError) error = nullptr;
+  FlBinaryMessengerRing* ring =
+      fl_binary_messenger_create_ring(messenger, "test/ring", 4096, &error);
+  ASSERT_NE(ring, nullptr);
+  EXPECT_EQ(error, nullptr);
+
+  const uint8_t sample[] = {1, 2, 3};
+  EXPECT_TRUE(fl_binary_messenger_ring_write(ring, sample, sizeof(sample)));
+  EXPECT_FALSE(fl_binary_messenger_ring_write(ring, sample, sizeof(sample)));
+  EXPECT_EQ(written.size(), 2 * sizeof(sample));
+
+  EXPECT_FALSE(released);
+  g_object_unref(ring);
+  EXPECT_TRUE(released);
+}
+
+// Checks rings are released when they outlive the engine.
+TEST(FlBinaryMessengerTest, RingOutlivesEngine) {
+  FlEngine* engine = make_mock_engine();
+  FlutterEngineProcTable* embedder_api = fl_engine_get_embedder_api(engine);
+
+  FlutterPlatformMessageRing engine_ring =
+      reinterpret_cast<FlutterPlatformMessageRing>(42);
+  embedder_api->CreatePlatformMessageRing = MOCK_ENGINE_PROC(
+      CreatePlatformMessageRing,
+      ([engine_ring](auto engine, const char* channel, size_t capacity,
+                     FlutterPlatformMessageRing* out_ring) {
+        *out_ring = engine_ring;
+        return kSuccess;
+      }));
+  bool released = false;
+  embedder_api->ReleasePlatformMessageRing = MOCK_ENGINE_PROC(
+      ReleasePlatformMessageRing,
+      ([engine_ring, &released](auto engine, FlutterPlatformMessageRing ring) {
+        EXPECT_EQ(ring, engine_ring);
+        released = true;
+        return kSuccess;
+      }));
+
+  g_autoptr(FlBinaryMessenger) messenger = fl_binary_messenger_new(engine);
+  FlBinaryMessengerRing* ring =
+      fl_binary_messenger_create_ring(messenger, "test/ring", 4096, nullptr);
+  ASSERT_NE(ring, nullptr);
+
+  g_object_unref(engine);
+  const uint8_t sample[] = {1, 2, 3};
+  EXPECT_FALSE(fl_binary_messenger_ring_write(ring, sample, sizeof(sample)));
+
+  EXPECT_FALSE(released);
+  g_object_unref(ring);
+  EXPECT_TRUE(released);
+}
+
+// Checks errors creating rings are reported.
+TEST(FlBinaryMessengerTest, RingCreateFailure) {
+  g_autoptr(FlEngine) engine = make_mock_engine();
+  FlutterEngineProcTable* embedder_api = fl_engine_get_embedder_api(engine);
+
+  embedder_api->CreatePlatformMessageRing = MOCK_ENGINE_PROC(
+      CreatePlatformMessageRing,
+      ([](auto engine, const char* channel, size_t capacity,
+          FlutterPlatformMessageRing* out_ring) { return kInvalidArguments; }));
+
+  g_autoptr(FlBinaryMessenger) messenger = fl_binary_messenger_new(engine);
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlBinaryMessengerRing) ring =
+      fl_binary_messenger_create_ring(messenger, "test/ring", 1000, &error);
+  EXPECT_EQ(ring, nullptr);
+  EXPECT_NE(error, nullptr);
+}
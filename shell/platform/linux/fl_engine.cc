@@ -591,6 +591,52 @@ GBytes* fl_engine_send_platform_message_finish(FlEngine* self,
   return static_cast<GBytes*>(g_task_propagate_pointer(G_TASK(result), error));
 }
 
+FlutterPlatformMessageRing fl_engine_create_platform_message_ring(
+    FlEngine* self,
+    const gchar* channel,
+    size_t capacity,
+    GError** error) {
+  g_return_val_if_fail(FL_IS_ENGINE(self), nullptr);
+  g_return_val_if_fail(channel != nullptr, nullptr);
+
+  if (self->engine == nullptr) {
+    g_set_error(error, fl_engine_error_quark(), FL_ENGINE_ERROR_FAILED,
+                "No engine to create ring on");
+    return nullptr;
+  }
+
+  FlutterPlatformMessageRing ring = nullptr;
+  FlutterEngineResult result = self->embedder_api.CreatePlatformMessageRing(
+      self->engine, channel, capacity, &ring);
+  if (result != kSuccess) {
+    g_set_error(error, fl_engine_error_quark(), FL_ENGINE_ERROR_FAILED,
+                "Failed to create platform message ring");
+    return nullptr;
+  }
+
+  return ring;
+}
+
+gboolean fl_engine_write_platform_message_ring(FlEngine* self,
+                                               FlutterPlatformMessageRing ring,
+                                               const uint8_t* data,
+                                               size_t size) {
+  g_return_val_if_fail(FL_IS_ENGINE(self), FALSE);
+  g_return_val_if_fail(ring != nullptr, FALSE);
+
+  if (self->engine == nullptr) {
+    return FALSE;
+  }
+
+  bool written = false;
+  if (self->embedder_api.WritePlatformMessageRing(self->engine, ring, data,
+                                                  size, &written) != kSuccess) {
+    return FALSE;
+  }
+
+  return written;
+}
+
 void fl_engine_send_window_metrics_event(FlEngine* self,
                                          size_t width,
                                          size_t height,
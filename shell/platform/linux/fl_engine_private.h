@@ -235,6 +235,43 @@ GBytes* fl_engine_send_platform_message_finish(FlEngine* engine,
                                                GAsyncResult* result,
                                                GError** error);
 
+/**
+ * fl_engine_create_platform_message_ring:
+ * @engine: an #FlEngine.
+ * @channel: channel the Flutter application reads the ring on.
+ * @capacity: size of the buffer of the ring in bytes.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL
+ * to ignore.
+ *
+ * Creates a ring buffer that records are written to with
+ * fl_engine_write_platform_message_ring().
+ *
+ * Returns: the ring on success or %NULL on error. Release it with the
+ * ReleasePlatformMessageRing function of the embedder API, which does not need
+ * the engine.
+ */
+FlutterPlatformMessageRing fl_engine_create_platform_message_ring(
+    FlEngine* engine,
+    const gchar* channel,
+    size_t capacity,
+    GError** error);
+
+/**
+ * fl_engine_write_platform_message_ring:
+ * @engine: an #FlEngine.
+ * @ring: a ring created with fl_engine_create_platform_message_ring().
+ * @data: bytes of the record.
+ * @size: number of bytes.
+ *
+ * Writes a record to a ring.
+ *
+ * Returns: %TRUE if the record was written, %FALSE if the ring is full.
+ */
+gboolean fl_engine_write_platform_message_ring(FlEngine* engine,
+                                               FlutterPlatformMessageRing ring,
+                                               const uint8_t* data,
+                                               size_t size);
+
 /**
  * fl_engine_get_task_runner:
  * @engine: an #FlEngine.
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/platform/linux/public/flutter_linux/fl_standard_message_codec.h"
 #include "flutter/shell/platform/linux/fl_standard_message_codec_private.h"
+#include "flutter/shell/platform/linux/fl_value_private.h"
 
 #include <gmodule.h>
 
@@ -36,41 +37,77 @@ G_DEFINE_TYPE(FlStandardMessageCodec,
               fl_standard_message_codec,
               fl_message_codec_get_type())
 
-// Functions to write standard C number types.
+// Functions to write standard C number types. The buffer has been sized with
+// fl_standard_message_codec_get_value_end(), so the writes don't check it.
 
-static void write_uint8(GByteArray* buffer, uint8_t value) {
-  g_byte_array_append(buffer, &value, sizeof(uint8_t));
+static void write_data(uint8_t* buffer,
+                       size_t* offset,
+                       const void* data,
+                       size_t length) {
+  if (length > 0) {
+    memcpy(buffer + *offset, data, length);
+  }
+  *offset += length;
+}
+
+static void write_uint8(uint8_t* buffer, size_t* offset, uint8_t value) {
+  buffer[*offset] = value;
+  (*offset)++;
 }
 
-static void write_uint16(GByteArray* buffer, uint16_t value) {
-  g_byte_array_append(buffer, reinterpret_cast<uint8_t*>(&value),
-                      sizeof(uint16_t));
+static void write_uint16(uint8_t* buffer, size_t* offset, uint16_t value) {
+  write_data(buffer, offset, &value, sizeof(uint16_t));
 }
 
-static void write_uint32(GByteArray* buffer, uint32_t value) {
-  g_byte_array_append(buffer, reinterpret_cast<uint8_t*>(&value),
-                      sizeof(uint32_t));
+static void write_uint32(uint8_t* buffer, size_t* offset, uint32_t value) {
+  write_data(buffer, offset, &value, sizeof(uint32_t));
 }
 
-static void write_int32(GByteArray* buffer, int32_t value) {
-  g_byte_array_append(buffer, reinterpret_cast<uint8_t*>(&value),
-                      sizeof(int32_t));
+static void write_int32(uint8_t* buffer, size_t* offset, int32_t value) {
+  write_data(buffer, offset, &value, sizeof(int32_t));
 }
 
-static void write_int64(GByteArray* buffer, int64_t value) {
-  g_byte_array_append(buffer, reinterpret_cast<uint8_t*>(&value),
-                      sizeof(int64_t));
+static void write_int64(uint8_t* buffer, size_t* offset, int64_t value) {
+  write_data(buffer, offset, &value, sizeof(int64_t));
 }
 
-static void write_float64(GByteArray* buffer, double value) {
-  g_byte_array_append(buffer, reinterpret_cast<uint8_t*>(&value),
-                      sizeof(double));
+static void write_float64(uint8_t* buffer, size_t* offset, double value) {
+  write_data(buffer, offset, &value, sizeof(double));
 }
 
 // Write padding bytes to align to @align multiple of bytes.
-static void write_align(GByteArray* buffer, guint align) {
-  while (buffer->len % align != 0) {
-    write_uint8(buffer, 0);
+static void write_align(uint8_t* buffer, size_t* offset, size_t align) {
+  while (*offset % align != 0) {
+    write_uint8(buffer, offset, 0);
+  }
+}
+
+// Writes a size in standard codec format.
+static void write_size(uint8_t* buffer, size_t* offset, uint32_t size) {
+  if (size < 254) {
+    write_uint8(buffer, offset, size);
+  } else if (size <= 0xffff) {
+    write_uint8(buffer, offset, 254);
+    write_uint16(buffer, offset, size);
+  } else {
+    write_uint8(buffer, offset, 255);
+    write_uint32(buffer, offset, size);
+  }
+}
+
+// Gets the position after padding @offset to @align multiple of bytes.
+static size_t get_align_end(size_t offset, size_t align) {
+  return (offset + align - 1) / align * align;
+}
+
+// Gets the position after a size written at @offset.
+static size_t get_size_end(size_t offset, size_t size) {
+  if (size < 254) {
+    return offset + sizeof(uint8_t);
+  } else if (size <= 0xffff) {
+    return offset + sizeof(uint8_t) + sizeof(uint16_t);
+  } else {
+    return offset + sizeof(uint8_t) + sizeof(uint32_t);
   }
 }
 
@@ -243,7 +280,8 @@ static FlValue* read_uint8_list_value(FlStandardMessageCodec* self,
   if (!check_size(buffer, *offset, sizeof(uint8_t) * length, error)) {
     return nullptr;
   }
-  FlValue* value = fl_value_new_uint8_list(get_data(buffer, offset), length);
+  FlValue* value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_UINT8_LIST, buffer, *offset, length);
   *offset += length;
   return value;
 }
@@ -266,8 +304,8 @@ static FlValue* read_int32_list_value(FlStandardMessageCodec* self,
   if (!check_size(buffer, *offset, sizeof(int32_t) * length, error)) {
     return nullptr;
   }
-  FlValue* value = fl_value_new_int32_list(
-      reinterpret_cast<const int32_t*>(get_data(buffer, offset)), length);
+  FlValue* value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_INT32_LIST, buffer, *offset, length);
   *offset += sizeof(int32_t) * length;
   return value;
 }
@@ -290,8 +328,8 @@ static FlValue* read_int64_list_value(FlStandardMessageCodec* self,
   if (!check_size(buffer, *offset, sizeof(int64_t) * length, error)) {
     return nullptr;
   }
-  FlValue* value = fl_value_new_int64_list(
-      reinterpret_cast<const int64_t*>(get_data(buffer, offset)), length);
+  FlValue* value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_INT64_LIST, buffer, *offset, length);
   *offset += sizeof(int64_t) * length;
   return value;
 }
@@ -314,8 +352,8 @@ static FlValue* read_float32_list_value(FlStandardMessageCodec* self,
   if (!check_size(buffer, *offset, sizeof(float) * length, error)) {
     return nullptr;
   }
-  FlValue* value = fl_value_new_float32_list(
-      reinterpret_cast<const float*>(get_data(buffer, offset)), length);
+  FlValue* value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_FLOAT32_LIST, buffer, *offset, length);
   *offset += sizeof(float) * length;
   return value;
 }
@@ -338,8 +376,8 @@ static FlValue* read_float64_list_value(FlStandardMessageCodec* self,
   if (!check_size(buffer, *offset, sizeof(double) * length, error)) {
     return nullptr;
   }
-  FlValue* value = fl_value_new_float_list(
-      reinterpret_cast<const double*>(get_data(buffer, offset)), length);
+  FlValue* value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_FLOAT_LIST, buffer, *offset, length);
   *offset += sizeof(double) * length;
   return value;
 }
@@ -364,7 +402,7 @@ static FlValue* read_list_value(FlStandardMessageCodec* self,
     if (child == nullptr) {
       return nullptr;
     }
-    fl_value_append(list, child);
+    fl_value_append_take(list, static_cast<FlValue*>(g_steal_pointer(&child)));
   }
 
   return fl_value_ref(list);
@@ -395,12 +433,135 @@ static FlValue* read_map_value(FlStandardMessageCodec* self,
     if (value == nullptr) {
       return nullptr;
     }
-    fl_value_set(map, key, value);
+    // Keys in a message are unique, so the map does not need to be searched.
+    fl_value_map_append_take(map, static_cast<FlValue*>(g_steal_pointer(&key)),
+                             static_cast<FlValue*>(g_steal_pointer(&value)));
   }
 
   return fl_value_ref(map);
 }
 
+// Writes an #FlValue in standard codec format into @buffer at @offset.
+// Returns TRUE if successful, otherwise sets an error.
+static gboolean write_value(FlStandardMessageCodec* self,
+                            uint8_t* buffer,
+                            size_t* offset,
+                            FlValue* value,
+                            GError** error) {
+  if (value == nullptr) {
+    write_uint8(buffer, offset, kValueNull);
+    return TRUE;
+  }
+
+  switch (fl_value_get_type(value)) {
+    case FL_VALUE_TYPE_NULL:
+      write_uint8(buffer, offset, kValueNull);
+      return TRUE;
+    case FL_VALUE_TYPE_BOOL:
+      if (fl_value_get_bool(value)) {
+        write_uint8(buffer, offset, kValueTrue);
+      } else {
+        write_uint8(buffer, offset, kValueFalse);
+      }
+      return TRUE;
+    case FL_VALUE_TYPE_INT: {
+      int64_t v = fl_value_get_int(value);
+      if (v >= INT32_MIN && v <= INT32_MAX) {
+        write_uint8(buffer, offset, kValueInt32);
+        write_int32(buffer, offset, v);
+      } else {
+        write_uint8(buffer, offset, kValueInt64);
+        write_int64(buffer, offset, v);
+      }
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_FLOAT:
+      write_uint8(buffer, offset, kValueFloat64);
+      write_align(buffer, offset, 8);
+      write_float64(buffer, offset, fl_value_get_float(value));
+      return TRUE;
+    case FL_VALUE_TYPE_STRING: {
+      write_uint8(buffer, offset, kValueString);
+      const char* text = fl_value_get_string(value);
+      size_t length = strlen(text);
+      write_size(buffer, offset, length);
+      write_data(buffer, offset, text, length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_UINT8_LIST: {
+      write_uint8(buffer, offset, kValueUint8List);
+      size_t length = fl_value_get_length(value);
+      write_size(buffer, offset, length);
+      write_data(buffer, offset, fl_value_get_uint8_list(value),
+                 sizeof(uint8_t) * length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_INT32_LIST: {
+      write_uint8(buffer, offset, kValueInt32List);
+      size_t length = fl_value_get_length(value);
+      write_size(buffer, offset, length);
+      write_align(buffer, offset, 4);
+      write_data(buffer, offset, fl_value_get_int32_list(value),
+                 sizeof(int32_t) * length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_INT64_LIST: {
+      write_uint8(buffer, offset, kValueInt64List);
+      size_t length = fl_value_get_length(value);
+      write_size(buffer, offset, length);
+      write_align(buffer, offset, 8);
+      write_data(buffer, offset, fl_value_get_int64_list(value),
+                 sizeof(int64_t) * length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_FLOAT32_LIST: {
+      write_uint8(buffer, offset, kValueFloat32List);
+      size_t length = fl_value_get_length(value);
+      write_size(buffer, offset, length);
+      write_align(buffer, offset, 4);
+      write_data(buffer, offset, fl_value_get_float32_list(value),
+                 sizeof(float) * length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_FLOAT_LIST: {
+      write_uint8(buffer, offset, kValueFloat64List);
+      size_t length = fl_value_get_length(value);
+      write_size(buffer, offset, length);
+      write_align(buffer, offset, 8);
+      write_data(buffer, offset, fl_value_get_float_list(value),
+                 sizeof(double) * length);
+      return TRUE;
+    }
+    case FL_VALUE_TYPE_LIST:
+      write_uint8(buffer, offset, kValueList);
+      write_size(buffer, offset, fl_value_get_length(value));
+      for (size_t i = 0; i < fl_value_get_length(value); i++) {
+        if (!write_value(self, buffer, offset,
+                         fl_value_get_list_value(value, i), error)) {
+          return FALSE;
+        }
+      }
+      return TRUE;
+    case FL_VALUE_TYPE_MAP:
+      write_uint8(buffer, offset, kValueMap);
+      write_size(buffer, offset, fl_value_get_length(value));
+      for (size_t i = 0; i < fl_value_get_length(value); i++) {
+        if (!write_value(self, buffer, offset, fl_value_get_map_key(value, i),
+                         error) ||
+            !write_value(self, buffer, offset, fl_value_get_map_value(value, i),
+                         error)) {
+          return FALSE;
+        }
+      }
+      return TRUE;
+  }
+
+  g_set_error(error, FL_MESSAGE_CODEC_ERROR,
+              FL_MESSAGE_CODEC_ERROR_UNSUPPORTED_TYPE,
+              "Unexpected FlValue type %d", fl_value_get_type(value));
+  return FALSE;
+}
+
 // Implements FlMessageCodec::encode_message.
 static GBytes* fl_standard_message_codec_encode_message(FlMessageCodec* codec,
                                                         FlValue* message,
@@ -408,12 +569,13 @@ static GBytes* fl_standard_message_codec_encode_message(FlMessageCodec* codec,
   FlStandardMessageCodec* self =
       reinterpret_cast<FlStandardMessageCodec*>(codec);
 
-  g_autoptr(GByteArray) buffer = g_byte_array_new();
-  if (!fl_standard_message_codec_write_value(self, buffer, message, error)) {
+  size_t size = fl_standard_message_codec_get_value_end(self, 0, message);
+  g_autofree uint8_t* buffer = static_cast<uint8_t*>(g_malloc(size));
+  size_t offset = 0;
+  if (!write_value(self, buffer, &offset, message, error)) {
     return nullptr;
   }
-  return g_byte_array_free_to_bytes(
-      static_cast<GByteArray*>(g_steal_pointer(&buffer)));
+  return g_bytes_new_take(g_steal_pointer(&buffer), size);
 }
 
 // Implements FlMessageCodec::decode_message.
@@ -459,15 +621,9 @@ G_MODULE_EXPORT FlStandardMessageCodec* fl_standard_message_codec_new() {
 void fl_standard_message_codec_write_size(FlStandardMessageCodec* codec,
                                           GByteArray* buffer,
                                           uint32_t size) {
-  if (size < 254) {
-    write_uint8(buffer, size);
-  } else if (size <= 0xffff) {
-    write_uint8(buffer, 254);
-    write_uint16(buffer, size);
-  } else {
-    write_uint8(buffer, 255);
-    write_uint32(buffer, size);
-  }
+  size_t offset = buffer->len;
+  g_byte_array_set_size(buffer, get_size_end(offset, size));
+  write_size(buffer->data, &offset, size);
 }
 
 gboolean fl_standard_message_codec_read_size(FlStandardMessageCodec* codec,
@@ -501,129 +657,89 @@ gboolean fl_standard_message_codec_write_value(FlStandardMessageCodec* self,
                                                GByteArray* buffer,
                                                FlValue* value,
                                                GError** error) {
+  size_t start = buffer->len;
+  g_byte_array_set_size(
+      buffer, fl_standard_message_codec_get_value_end(self, start, value));
+  size_t offset = start;
+  if (!write_value(self, buffer->data, &offset, value, error)) {
+    g_byte_array_set_size(buffer, start);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+size_t fl_standard_message_codec_get_value_end(FlStandardMessageCodec* self,
+                                               size_t offset,
+                                               FlValue* value) {
+  // The type.
+  offset += sizeof(uint8_t);
   if (value == nullptr) {
-    write_uint8(buffer, kValueNull);
-    return TRUE;
+    return offset;
   }
 
   switch (fl_value_get_type(value)) {
     case FL_VALUE_TYPE_NULL:
-      write_uint8(buffer, kValueNull);
-      return TRUE;
     case FL_VALUE_TYPE_BOOL:
-      if (fl_value_get_bool(value)) {
-        write_uint8(buffer, kValueTrue);
-      } else {
-        write_uint8(buffer, kValueFalse);
-      }
-      return TRUE;
+      return offset;
     case FL_VALUE_TYPE_INT: {
       int64_t v = fl_value_get_int(value);
-      if (v >= INT32_MIN && v <= INT32_MAX) {
-        write_uint8(buffer, kValueInt32);
-        write_int32(buffer, v);
-      } else {
-        write_uint8(buffer, kValueInt64);
-        write_int64(buffer, v);
-      }
-      return TRUE;
+      return offset + (v >= INT32_MIN && v <= INT32_MAX ? sizeof(int32_t)
+                                                        : sizeof(int64_t));
     }
     case FL_VALUE_TYPE_FLOAT:
-      write_uint8(buffer, kValueFloat64);
-      write_align(buffer, 8);
-      write_float64(buffer, fl_value_get_float(value));
-      return TRUE;
+      return get_align_end(offset, 8) + sizeof(double);
     case FL_VALUE_TYPE_STRING: {
-      write_uint8(buffer, kValueString);
-      const char* text = fl_value_get_string(value);
-      size_t length = strlen(text);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      g_byte_array_append(buffer, reinterpret_cast<const uint8_t*>(text),
-                          length);
-      return TRUE;
+      size_t length = strlen(fl_value_get_string(value));
+      return get_size_end(offset, length) + length;
     }
     case FL_VALUE_TYPE_UINT8_LIST: {
-      write_uint8(buffer, kValueUint8List);
       size_t length = fl_value_get_length(value);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      g_byte_array_append(buffer, fl_value_get_uint8_list(value),
-                          sizeof(uint8_t) * length);
-      return TRUE;
+      return get_size_end(offset, length) + sizeof(uint8_t) * length;
     }
     case FL_VALUE_TYPE_INT32_LIST: {
-      write_uint8(buffer, kValueInt32List);
       size_t length = fl_value_get_length(value);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      write_align(buffer, 4);
-      g_byte_array_append(
-          buffer,
-          reinterpret_cast<const uint8_t*>(fl_value_get_int32_list(value)),
-          sizeof(int32_t) * length);
-      return TRUE;
+      return get_align_end(get_size_end(offset, length), 4) +
+             sizeof(int32_t) * length;
     }
     case FL_VALUE_TYPE_INT64_LIST: {
-      write_uint8(buffer, kValueInt64List);
       size_t length = fl_value_get_length(value);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      write_align(buffer, 8);
-      g_byte_array_append(
-          buffer,
-          reinterpret_cast<const uint8_t*>(fl_value_get_int64_list(value)),
-          sizeof(int64_t) * length);
-      return TRUE;
+      return get_align_end(get_size_end(offset, length), 8) +
+             sizeof(int64_t) * length;
     }
     case FL_VALUE_TYPE_FLOAT32_LIST: {
-      write_uint8(buffer, kValueFloat32List);
       size_t length = fl_value_get_length(value);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      write_align(buffer, 4);
-      g_byte_array_append(
-          buffer,
-          reinterpret_cast<const uint8_t*>(fl_value_get_float32_list(value)),
-          sizeof(float) * length);
-      return TRUE;
+      return get_align_end(get_size_end(offset, length), 4) +
+             sizeof(float) * length;
     }
     case FL_VALUE_TYPE_FLOAT_LIST: {
-      write_uint8(buffer, kValueFloat64List);
       size_t length = fl_value_get_length(value);
-      fl_standard_message_codec_write_size(self, buffer, length);
-      write_align(buffer, 8);
-      g_byte_array_append(
-          buffer,
-          reinterpret_cast<const uint8_t*>(fl_value_get_float_list(value)),
-          sizeof(double) * length);
-      return TRUE;
+      return get_align_end(get_size_end(offset, length), 8) +
+             sizeof(double) * length;
     }
-    case FL_VALUE_TYPE_LIST:
-      write_uint8(buffer, kValueList);
-      fl_standard_message_codec_write_size(self, buffer,
-                                           fl_value_get_length(value));
-      for (size_t i = 0; i < fl_value_get_length(value); i++) {
-        if (!fl_standard_message_codec_write_value(
-                self, buffer, fl_value_get_list_value(value, i), error)) {
-          return FALSE;
-        }
+    case FL_VALUE_TYPE_LIST: {
+      size_t length = fl_value_get_length(value);
+      offset = get_size_end(offset, length);
+      for (size_t i = 0; i < length; i++) {
+        offset = fl_standard_message_codec_get_value_end(
+            self, offset, fl_value_get_list_value(value, i));
       }
-      return TRUE;
-    case FL_VALUE_TYPE_MAP:
-      write_uint8(buffer, kValueMap);
-      fl_standard_message_codec_write_size(self, buffer,
-                                           fl_value_get_length(value));
-      for (size_t i = 0; i < fl_value_get_length(value); i++) {
-        if (!fl_standard_message_codec_write_value(
-                self, buffer, fl_value_get_map_key(value, i), error) ||
-            !fl_standard_message_codec_write_value(
-                self, buffer, fl_value_get_map_value(value, i), error)) {
-          return FALSE;
-        }
+      return offset;
+    }
+    case FL_VALUE_TYPE_MAP: {
+      size_t length = fl_value_get_length(value);
+      offset = get_size_end(offset, length);
+      for (size_t i = 0; i < length; i++) {
+        offset = fl_standard_message_codec_get_value_end(
+            self, offset, fl_value_get_map_key(value, i));
+        offset = fl_standard_message_codec_get_value_end(
+            self, offset, fl_value_get_map_value(value, i));
       }
-      return TRUE;
+      return offset;
+    }
   }
 
-  g_set_error(error, FL_MESSAGE_CODEC_ERROR,
-              FL_MESSAGE_CODEC_ERROR_UNSUPPORTED_TYPE,
-              "Unexpected FlValue type %d", fl_value_get_type(value));
-  return FALSE;
+  // fl_standard_message_codec_write_value() reports the unknown type.
+  return offset;
 }
 
 FlValue* fl_standard_message_codec_read_value(FlStandardMessageCodec* self,
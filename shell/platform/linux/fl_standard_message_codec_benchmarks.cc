@@ -0,0 +1,102 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/shell/platform/linux/public/flutter_linux/fl_standard_message_codec.h"
+
+// Makes a payload like the ones a plugin sends with a batch of records: a list
+// of maps, each with a few scalars, a string and a list of samples.
+static FlValue* make_nested_payload(int64_t record_count,
+                                    size_t sample_count) {
+  g_autofree double* samples = g_new0(double, sample_count);
+  for (size_t i = 0; i < sample_count; i++) {
+    samples[i] = i * 0.5;
+  }
+
+  FlValue* payload = fl_value_new_list();
+  for (int64_t i = 0; i < record_count; i++) {
+    g_autoptr(FlValue) record = fl_value_new_map();
+    fl_value_set_string_take(record, "id", fl_value_new_int(i));
+    fl_value_set_string_take(record, "timestamp",
+                             fl_value_new_int(i * 1000000000));
+    fl_value_set_string_take(record, "valid", fl_value_new_bool(i % 2 == 0));
+    fl_value_set_string_take(record, "scale", fl_value_new_float(1.5));
+    fl_value_set_string_take(record, "name",
+                             fl_value_new_string("sensor record"));
+    fl_value_set_string_take(record, "samples",
+                             fl_value_new_float_list(samples, sample_count));
+    fl_value_append(payload, record);
+  }
+  return payload;
+}
+
+static GBytes* encode(FlStandardMessageCodec* codec, FlValue* value) {
+  g_autoptr(GError) error = nullptr;
+  GBytes* message =
+      fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec), value, &error);
+  g_assert(message != nullptr);
+  return message;
+}
+
+static void BM_FlStandardMessageCodecEncodeNested(benchmark::State& state) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  g_autoptr(FlValue) payload = make_nested_payload(state.range(0), 64);
+  size_t size = 0;
+  for (auto _ : state) {
+    g_autoptr(GBytes) message = encode(codec, payload);
+    size = g_bytes_get_size(message);
+    benchmark::DoNotOptimize(message);
+  }
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void BM_FlStandardMessageCodecDecodeNested(benchmark::State& state) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  g_autoptr(FlValue) payload = make_nested_payload(state.range(0), 64);
+  g_autoptr(GBytes) message = encode(codec, payload);
+  for (auto _ : state) {
+    g_autoptr(FlValue) value = fl_message_codec_decode_message(
+        FL_MESSAGE_CODEC(codec), message, nullptr);
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * g_bytes_get_size(message));
+}
+
+// Decodes a message that is mostly a Uint8List, like an image or a file.
+static void BM_FlStandardMessageCodecDecodeUint8List(benchmark::State& state) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  g_autofree uint8_t* data = g_new0(uint8_t, state.range(0));
+  g_autoptr(FlValue) payload = fl_value_new_uint8_list(data, state.range(0));
+  g_autoptr(GBytes) message = encode(codec, payload);
+  for (auto _ : state) {
+    g_autoptr(FlValue) value = fl_message_codec_decode_message(
+        FL_MESSAGE_CODEC(codec), message, nullptr);
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * g_bytes_get_size(message));
+}
+
+// Decodes a large map and looks up every key.
+static void BM_FlStandardMessageCodecDecodeMapLookup(benchmark::State& state) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  g_autoptr(FlValue) payload = fl_value_new_map();
+  for (int64_t i = 0; i < state.range(0); i++) {
+    g_autofree gchar* key = g_strdup_printf("key%" G_GINT64_FORMAT, i);
+    fl_value_set_string_take(payload, key, fl_value_new_int(i));
+  }
+  g_autoptr(GBytes) message = encode(codec, payload);
+  for (auto _ : state) {
+    g_autoptr(FlValue) value = fl_message_codec_decode_message(
+        FL_MESSAGE_CODEC(codec), message, nullptr);
+    for (size_t i = 0; i < fl_value_get_length(value); i++) {
+      benchmark::DoNotOptimize(
+          fl_value_lookup(value, fl_value_get_map_key(value, i)));
+    }
+  }
+}
+
+BENCHMARK(BM_FlStandardMessageCodecEncodeNested)->Range(8, 1024);
+BENCHMARK(BM_FlStandardMessageCodecDecodeNested)->Range(8, 1024);
+BENCHMARK(BM_FlStandardMessageCodecDecodeUint8List)->Range(1024, 1 << 22);
+BENCHMARK(BM_FlStandardMessageCodecDecodeMapLookup)->Range(8, 4096);
@@ -48,7 +48,8 @@ gboolean fl_standard_message_codec_read_size(FlStandardMessageCodec* codec,
  * @error: (allow-none): #GError location to store the error occurring, or
  * %NULL.
  *
- * Writes an #FlValue in Flutter Standard encoding.
+ * Writes an #FlValue in Flutter Standard encoding. @buffer is grown once to fit
+ * the value.
  *
  * Returns: %TRUE on success.
  */
@@ -57,6 +58,22 @@ gboolean fl_standard_message_codec_write_value(FlStandardMessageCodec* codec,
                                                FlValue* value,
                                                GError** error);
 
+/**
+ * fl_standard_message_codec_get_value_end:
+ * @codec: an #FlStandardMessageCodec.
+ * @offset: the position in a buffer that the value would be written at.
+ * @value: (allow-none): value to measure.
+ *
+ * Measures an #FlValue in Flutter Standard encoding. This is used to grow
+ * buffers once before values are written into them. The size depends on
+ * @offset because of the padding before aligned values.
+ *
+ * Returns: the position in the buffer after the value.
+ */
+size_t fl_standard_message_codec_get_value_end(FlStandardMessageCodec* codec,
+                                               size_t offset,
+                                               FlValue* value);
+
 /**
  * fl_standard_message_codec_read_value:
  * @codec: an #FlStandardMessageCodec.
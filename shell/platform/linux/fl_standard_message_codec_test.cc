@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "flutter/shell/platform/linux/public/flutter_linux/fl_standard_message_codec.h"
+#include "flutter/shell/platform/linux/fl_standard_message_codec_private.h"
 #include "flutter/shell/platform/linux/testing/fl_test.h"
 #include "gtest/gtest.h"
 
@@ -1057,6 +1058,113 @@ TEST(FlStandardMessageCodecTest, EncodeDecodeLargeMap) {
   ASSERT_TRUE(fl_value_equal(value, decoded_value));
 }
 
+TEST(FlStandardMessageCodecTest, DecodeTypedListsReferenceMessage) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+  g_autoptr(GBytes) data = hex_string_to_bytes(
+      "0c03"
+      "080201ff"
+      "090200000000ffffffff"
+      "0b01000000000000000000000000f03f");
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(FlValue) value =
+      fl_message_codec_decode_message(FL_MESSAGE_CODEC(codec), data, &error);
+  EXPECT_EQ(error, nullptr);
+  ASSERT_NE(value, nullptr);
+  ASSERT_EQ(fl_value_get_length(value), static_cast<size_t>(3));
+
+  const uint8_t* start =
+      static_cast<const uint8_t*>(g_bytes_get_data(data, nullptr));
+  FlValue* uint8_list = fl_value_get_list_value(value, 0);
+  ASSERT_EQ(fl_value_get_type(uint8_list), FL_VALUE_TYPE_UINT8_LIST);
+  EXPECT_EQ(fl_value_get_uint8_list(uint8_list), start + 4);
+  EXPECT_EQ(fl_value_get_uint8_list(uint8_list)[1], 0xff);
+  FlValue* int32_list = fl_value_get_list_value(value, 1);
+  ASSERT_EQ(fl_value_get_type(int32_list), FL_VALUE_TYPE_INT32_LIST);
+  EXPECT_EQ(fl_value_get_int32_list(int32_list),
+            reinterpret_cast<const int32_t*>(start + 8));
+  EXPECT_EQ(fl_value_get_int32_list(int32_list)[1], -1);
+  FlValue* float_list = fl_value_get_list_value(value, 2);
+  ASSERT_EQ(fl_value_get_type(float_list), FL_VALUE_TYPE_FLOAT_LIST);
+  EXPECT_EQ(fl_value_get_float_list(float_list),
+            reinterpret_cast<const double*>(start + 24));
+  EXPECT_EQ(fl_value_get_float_list(float_list)[0], 1.0);
+
+  // The lists keep the message alive.
+  g_clear_pointer(&data, g_bytes_unref);
+  EXPECT_EQ(fl_value_get_float_list(float_list)[0], 1.0);
+}
+
+TEST(FlStandardMessageCodecTest, DecodeLargeMapLookup) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+
+  g_autoptr(FlValue) value = fl_value_new_map();
+  for (int i = 0; i < 512; i++) {
+    g_autofree gchar* key = g_strdup_printf("key%d", i);
+    fl_value_set_string_take(value, key, fl_value_new_int(i));
+  }
+
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GBytes) message =
+      fl_message_codec_encode_message(FL_MESSAGE_CODEC(codec), value, &error);
+  EXPECT_NE(message, nullptr);
+  EXPECT_EQ(error, nullptr);
+
+  g_autoptr(FlValue) decoded_value =
+      fl_message_codec_decode_message(FL_MESSAGE_CODEC(codec), message, &error);
+  EXPECT_EQ(error, nullptr);
+  ASSERT_NE(decoded_value, nullptr);
+
+  FlValue* v = fl_value_lookup_string(decoded_value, "key300");
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(fl_value_get_int(v), 300);
+  EXPECT_EQ(fl_value_lookup_string(decoded_value, "key512"), nullptr);
+}
+
+TEST(FlStandardMessageCodecTest, ValueEndMatchesEncodedSize) {
+  g_autoptr(FlStandardMessageCodec) codec = fl_standard_message_codec_new();
+
+  g_autoptr(FlValue) value = fl_value_new_map();
+  fl_value_set_string_take(value, "null", fl_value_new_null());
+  fl_value_set_string_take(value, "int32", fl_value_new_int(42));
+  fl_value_set_string_take(value, "int64", fl_value_new_int(G_MAXINT64));
+  fl_value_set_string_take(value, "float", fl_value_new_float(M_PI));
+  g_autofree gchar* long_string = g_strnfill(300, 'a');
+  fl_value_set_string_take(value, "string", fl_value_new_string(long_string));
+  uint8_t uint8_data[] = {1, 2, 3};
+  fl_value_set_string_take(value, "uint8_list",
+                           fl_value_new_uint8_list(uint8_data, 3));
+  int32_t int32_data[] = {1, 2, 3};
+  fl_value_set_string_take(value, "int32_list",
+                           fl_value_new_int32_list(int32_data, 3));
+  int64_t int64_data[] = {1, 2, 3};
+  fl_value_set_string_take(value, "int64_list",
+                           fl_value_new_int64_list(int64_data, 3));
+  float float32_data[] = {1, 2, 3};
+  fl_value_set_string_take(value, "float32_list",
+                           fl_value_new_float32_list(float32_data, 3));
+  double float_data[] = {1, 2, 3};
+  fl_value_set_string_take(value, "float_list",
+                           fl_value_new_float_list(float_data, 3));
+  g_autoptr(FlValue) list = fl_value_new_list();
+  fl_value_append_take(list, fl_value_new_float(1.0));
+  fl_value_append_take(list, fl_value_new_map());
+  fl_value_set_string(value, "list", list);
+
+  // The size depends on the padding before aligned values.
+  for (size_t offset = 0; offset < 8; offset++) {
+    g_autoptr(GByteArray) buffer = g_byte_array_new();
+    for (size_t i = 0; i < offset; i++) {
+      guint8 padding = 0;
+      g_byte_array_append(buffer, &padding, 1);
+    }
+    g_autoptr(GError) error = nullptr;
+    EXPECT_TRUE(
+        fl_standard_message_codec_write_value(codec, buffer, value, &error));
+    EXPECT_EQ(fl_standard_message_codec_get_value_end(codec, offset, value),
+              buffer->len);
+  }
+}
+
 TEST(FlStandardMessageCodecTest, DecodeUnknownType) {
   decode_error_value("0f", FL_MESSAGE_CODEC_ERROR,
                      FL_MESSAGE_CODEC_ERROR_UNSUPPORTED_TYPE);
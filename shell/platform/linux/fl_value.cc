@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include "flutter/shell/platform/linux/public/flutter_linux/fl_value.h"
+#include "flutter/shell/platform/linux/fl_value_private.h"
 
 #include <gmodule.h>
 
@@ -33,35 +34,16 @@ typedef struct {
   gchar* value;
 } FlValueString;
 
+// The lists of numbers: FL_VALUE_TYPE_UINT8_LIST, FL_VALUE_TYPE_INT32_LIST,
+// FL_VALUE_TYPE_INT64_LIST, FL_VALUE_TYPE_FLOAT32_LIST and
+// FL_VALUE_TYPE_FLOAT_LIST.
 typedef struct {
   FlValue parent;
-  uint8_t* values;
+  // Owned by the list if @bytes is %NULL, otherwise points into @bytes.
+  gpointer values;
   size_t values_length;
-} FlValueUint8List;
-
-typedef struct {
-  FlValue parent;
-  int32_t* values;
-  size_t values_length;
-} FlValueInt32List;
-
-typedef struct {
-  FlValue parent;
-  int64_t* values;
-  size_t values_length;
-} FlValueInt64List;
-
-typedef struct {
-  FlValue parent;
-  float* values;
-  size_t values_length;
-} FlValueFloat32List;
-
-typedef struct {
-  FlValue parent;
-  double* values;
-  size_t values_length;
-} FlValueFloatList;
+  GBytes* bytes;
+} FlValueTypedList;
 
 typedef struct {
   FlValue parent;
@@ -72,8 +54,14 @@ typedef struct {
   FlValue parent;
   GPtrArray* keys;
   GPtrArray* values;
+  // Maps keys to their index, or %NULL if the map has not been looked up since
+  // it grew past kMapIndexThreshold entries.
+  GHashTable* index;
 } FlValueMap;
 
+// Maps with more entries than this build a hash table for lookups.
+static constexpr size_t kMapIndexThreshold = 8;
+
 static FlValue* fl_value_new(FlValueType type, size_t size) {
   FlValue* self = static_cast<FlValue*>(g_malloc0(size));
   self->type = type;
@@ -86,14 +74,118 @@ static void fl_value_destroy(gpointer value) {
   fl_value_unref(static_cast<FlValue*>(value));
 }
 
-// Finds the index of a key in a FlValueMap.
-// FIXME(robert-ancell) This is highly inefficient, and should be optimized if
-// necessary.
+// Gets the size of the elements of a list of numbers, or 0 if @type is not a
+// list of numbers.
+static size_t get_element_size(FlValueType type) {
+  switch (type) {
+    case FL_VALUE_TYPE_UINT8_LIST:
+      return sizeof(uint8_t);
+    case FL_VALUE_TYPE_INT32_LIST:
+      return sizeof(int32_t);
+    case FL_VALUE_TYPE_INT64_LIST:
+      return sizeof(int64_t);
+    case FL_VALUE_TYPE_FLOAT32_LIST:
+      return sizeof(float);
+    case FL_VALUE_TYPE_FLOAT_LIST:
+      return sizeof(double);
+    default:
+      return 0;
+  }
+}
+
+// Creates a list of numbers that holds a copy of @data.
+static FlValue* fl_value_new_typed_list(FlValueType type,
+                                        gconstpointer data,
+                                        size_t data_length) {
+  FlValueTypedList* self = reinterpret_cast<FlValueTypedList*>(
+      fl_value_new(type, sizeof(FlValueTypedList)));
+  size_t size = get_element_size(type) * data_length;
+  self->values_length = data_length;
+  self->values = g_malloc(size);
+  memcpy(self->values, data, size);
+  return reinterpret_cast<FlValue*>(self);
+}
+
+// Hashes a map key consistently with fl_value_equal().
+static guint fl_value_hash(gconstpointer value) {
+  FlValue* self = static_cast<FlValue*>(const_cast<gpointer>(value));
+  guint hash = 0;
+  switch (self->type) {
+    case FL_VALUE_TYPE_BOOL:
+      hash = fl_value_get_bool(self) ? 1 : 0;
+      break;
+    case FL_VALUE_TYPE_INT: {
+      int64_t v = fl_value_get_int(self);
+      hash = g_int64_hash(&v);
+      break;
+    }
+    case FL_VALUE_TYPE_FLOAT: {
+      // 0.0 and -0.0 are equal.
+      double v = fl_value_get_float(self);
+      if (v == 0.0) {
+        v = 0.0;
+      }
+      hash = g_double_hash(&v);
+      break;
+    }
+    case FL_VALUE_TYPE_STRING:
+      hash = g_str_hash(fl_value_get_string(self));
+      break;
+    case FL_VALUE_TYPE_UINT8_LIST:
+    case FL_VALUE_TYPE_INT32_LIST:
+    case FL_VALUE_TYPE_INT64_LIST:
+    case FL_VALUE_TYPE_FLOAT32_LIST:
+    case FL_VALUE_TYPE_FLOAT_LIST:
+      hash = fl_value_get_length(self);
+      break;
+    // Lists and maps can change after they are added as keys, so they are only
+    // hashed by type.
+    case FL_VALUE_TYPE_NULL:
+    case FL_VALUE_TYPE_LIST:
+    case FL_VALUE_TYPE_MAP:
+      break;
+  }
+  return hash * 31 + self->type;
+}
+
+// Helper function to match GEqualFunc type.
+static gboolean fl_value_key_equal(gconstpointer a, gconstpointer b) {
+  return fl_value_equal(static_cast<FlValue*>(const_cast<gpointer>(a)),
+                        static_cast<FlValue*>(const_cast<gpointer>(b)));
+}
+
+// Adds a key to the index of a FlValueMap. The first of two equal keys wins,
+// as it does in a linear search.
+static void fl_value_index_key(FlValueMap* self, size_t index) {
+  gpointer key = g_ptr_array_index(self->keys, index);
+  if (!g_hash_table_contains(self->index, key)) {
+    g_hash_table_insert(self->index, key, GSIZE_TO_POINTER(index));
+  }
+}
+
+// Finds the index of a key in a FlValueMap. Small maps are searched linearly,
+// larger ones build an index on the first lookup.
 static ssize_t fl_value_lookup_index(FlValue* self, FlValue* key) {
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_MAP, -1);
 
-  for (size_t i = 0; i < fl_value_get_length(self); i++) {
-    FlValue* k = fl_value_get_map_key(self, i);
+  FlValueMap* v = reinterpret_cast<FlValueMap*>(self);
+  if (v->index == nullptr && v->keys->len > kMapIndexThreshold) {
+    v->index = g_hash_table_new(fl_value_hash, fl_value_key_equal);
+    for (size_t i = 0; i < v->keys->len; i++) {
+      fl_value_index_key(v, i);
+    }
+  }
+
+  if (v->index != nullptr) {
+    gpointer index;
+    if (!g_hash_table_lookup_extended(v->index, key, nullptr, &index)) {
+      return -1;
+    }
+    return GPOINTER_TO_SIZE(index);
+  }
+
+  for (size_t i = 0; i < v->keys->len; i++) {
+    FlValue* k = static_cast<FlValue*>(g_ptr_array_index(v->keys, i));
     if (fl_value_equal(k, key)) {
       return i;
     }
@@ -280,59 +372,33 @@ G_MODULE_EXPORT FlValue* fl_value_new_string_sized(const gchar* value,
 
 G_MODULE_EXPORT FlValue* fl_value_new_uint8_list(const uint8_t* data,
                                                  size_t data_length) {
-  FlValueUint8List* self = reinterpret_cast<FlValueUint8List*>(
-      fl_value_new(FL_VALUE_TYPE_UINT8_LIST, sizeof(FlValueUint8List)));
-  self->values_length = data_length;
-  self->values = static_cast<uint8_t*>(g_malloc(sizeof(uint8_t) * data_length));
-  memcpy(self->values, data, sizeof(uint8_t) * data_length);
-  return reinterpret_cast<FlValue*>(self);
+  return fl_value_new_typed_list(FL_VALUE_TYPE_UINT8_LIST, data, data_length);
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_uint8_list_from_bytes(GBytes* data) {
-  gsize length;
-  const uint8_t* d =
-      static_cast<const uint8_t*>(g_bytes_get_data(data, &length));
-  return fl_value_new_uint8_list(d, length);
+  g_return_val_if_fail(data != nullptr, nullptr);
+  return fl_value_new_typed_list_from_bytes(FL_VALUE_TYPE_UINT8_LIST, data, 0,
+                                            g_bytes_get_size(data));
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_int32_list(const int32_t* data,
                                                  size_t data_length) {
-  FlValueInt32List* self = reinterpret_cast<FlValueInt32List*>(
-      fl_value_new(FL_VALUE_TYPE_INT32_LIST, sizeof(FlValueInt32List)));
-  self->values_length = data_length;
-  self->values = static_cast<int32_t*>(g_malloc(sizeof(int32_t) * data_length));
-  memcpy(self->values, data, sizeof(int32_t) * data_length);
-  return reinterpret_cast<FlValue*>(self);
+  return fl_value_new_typed_list(FL_VALUE_TYPE_INT32_LIST, data, data_length);
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_int64_list(const int64_t* data,
                                                  size_t data_length) {
-  FlValueInt64List* self = reinterpret_cast<FlValueInt64List*>(
-      fl_value_new(FL_VALUE_TYPE_INT64_LIST, sizeof(FlValueInt64List)));
-  self->values_length = data_length;
-  self->values = static_cast<int64_t*>(g_malloc(sizeof(int64_t) * data_length));
-  memcpy(self->values, data, sizeof(int64_t) * data_length);
-  return reinterpret_cast<FlValue*>(self);
+  return fl_value_new_typed_list(FL_VALUE_TYPE_INT64_LIST, data, data_length);
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_float32_list(const float* data,
                                                    size_t data_length) {
-  FlValueFloat32List* self = reinterpret_cast<FlValueFloat32List*>(
-      fl_value_new(FL_VALUE_TYPE_FLOAT32_LIST, sizeof(FlValueFloat32List)));
-  self->values_length = data_length;
-  self->values = static_cast<float*>(g_malloc(sizeof(float) * data_length));
-  memcpy(self->values, data, sizeof(float) * data_length);
-  return reinterpret_cast<FlValue*>(self);
+  return fl_value_new_typed_list(FL_VALUE_TYPE_FLOAT32_LIST, data, data_length);
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_float_list(const double* data,
                                                  size_t data_length) {
-  FlValueFloatList* self = reinterpret_cast<FlValueFloatList*>(
-      fl_value_new(FL_VALUE_TYPE_FLOAT_LIST, sizeof(FlValueFloatList)));
-  self->values_length = data_length;
-  self->values = static_cast<double*>(g_malloc(sizeof(double) * data_length));
-  memcpy(self->values, data, sizeof(double) * data_length);
-  return reinterpret_cast<FlValue*>(self);
+  return fl_value_new_typed_list(FL_VALUE_TYPE_FLOAT_LIST, data, data_length);
 }
 
 G_MODULE_EXPORT FlValue* fl_value_new_list() {
@@ -380,29 +446,17 @@ G_MODULE_EXPORT void fl_value_unref(FlValue* self) {
       g_free(v->value);
       break;
     }
-    case FL_VALUE_TYPE_UINT8_LIST: {
-      FlValueUint8List* v = reinterpret_cast<FlValueUint8List*>(self);
-      g_free(v->values);
-      break;
-    }
-    case FL_VALUE_TYPE_INT32_LIST: {
-      FlValueInt32List* v = reinterpret_cast<FlValueInt32List*>(self);
-      g_free(v->values);
-      break;
-    }
-    case FL_VALUE_TYPE_INT64_LIST: {
-      FlValueInt64List* v = reinterpret_cast<FlValueInt64List*>(self);
-      g_free(v->values);
-      break;
-    }
-    case FL_VALUE_TYPE_FLOAT32_LIST: {
-      FlValueFloat32List* v = reinterpret_cast<FlValueFloat32List*>(self);
-      g_free(v->values);
-      break;
-    }
+    case FL_VALUE_TYPE_UINT8_LIST:
+    case FL_VALUE_TYPE_INT32_LIST:
+    case FL_VALUE_TYPE_INT64_LIST:
+    case FL_VALUE_TYPE_FLOAT32_LIST:
     case FL_VALUE_TYPE_FLOAT_LIST: {
-      FlValueFloatList* v = reinterpret_cast<FlValueFloatList*>(self);
-      g_free(v->values);
+      FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+      if (v->bytes != nullptr) {
+        g_bytes_unref(v->bytes);
+      } else {
+        g_free(v->values);
+      }
       break;
     }
     case FL_VALUE_TYPE_LIST: {
@@ -414,6 +468,9 @@ G_MODULE_EXPORT void fl_value_unref(FlValue* self) {
       FlValueMap* v = reinterpret_cast<FlValueMap*>(self);
       g_ptr_array_unref(v->keys);
       g_ptr_array_unref(v->values);
+      if (v->index != nullptr) {
+        g_hash_table_unref(v->index);
+      }
       break;
     }
     case FL_VALUE_TYPE_NULL:
@@ -586,9 +643,12 @@ G_MODULE_EXPORT void fl_value_set_take(FlValue* self,
   FlValueMap* v = reinterpret_cast<FlValueMap*>(self);
   ssize_t index = fl_value_lookup_index(self, key);
   if (index < 0) {
-    g_ptr_array_add(v->keys, key);
-    g_ptr_array_add(v->values, value);
+    fl_value_map_append_take(self, key, value);
   } else {
+    // The index holds the old key, which must stay alive until it is replaced.
+    if (v->index != nullptr) {
+      g_hash_table_replace(v->index, key, GSIZE_TO_POINTER(index));
+    }
     fl_value_destroy(v->keys->pdata[index]);
     v->keys->pdata[index] = key;
     fl_value_destroy(v->values->pdata[index]);
@@ -649,36 +709,36 @@ G_MODULE_EXPORT const gchar* fl_value_get_string(FlValue* self) {
 G_MODULE_EXPORT const uint8_t* fl_value_get_uint8_list(FlValue* self) {
   g_return_val_if_fail(self != nullptr, nullptr);
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_UINT8_LIST, nullptr);
-  FlValueUint8List* v = reinterpret_cast<FlValueUint8List*>(self);
-  return v->values;
+  FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+  return static_cast<const uint8_t*>(v->values);
 }
 
 G_MODULE_EXPORT const int32_t* fl_value_get_int32_list(FlValue* self) {
   g_return_val_if_fail(self != nullptr, nullptr);
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_INT32_LIST, nullptr);
-  FlValueInt32List* v = reinterpret_cast<FlValueInt32List*>(self);
-  return v->values;
+  FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+  return static_cast<const int32_t*>(v->values);
 }
 
 G_MODULE_EXPORT const int64_t* fl_value_get_int64_list(FlValue* self) {
   g_return_val_if_fail(self != nullptr, nullptr);
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_INT64_LIST, nullptr);
-  FlValueInt64List* v = reinterpret_cast<FlValueInt64List*>(self);
-  return v->values;
+  FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+  return static_cast<const int64_t*>(v->values);
 }
 
 G_MODULE_EXPORT const float* fl_value_get_float32_list(FlValue* self) {
   g_return_val_if_fail(self != nullptr, nullptr);
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_FLOAT32_LIST, nullptr);
-  FlValueFloat32List* v = reinterpret_cast<FlValueFloat32List*>(self);
-  return v->values;
+  FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+  return static_cast<const float*>(v->values);
 }
 
 G_MODULE_EXPORT const double* fl_value_get_float_list(FlValue* self) {
   g_return_val_if_fail(self != nullptr, nullptr);
   g_return_val_if_fail(self->type == FL_VALUE_TYPE_FLOAT_LIST, nullptr);
-  FlValueFloatList* v = reinterpret_cast<FlValueFloatList*>(self);
-  return v->values;
+  FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
+  return static_cast<const double*>(v->values);
 }
 
 G_MODULE_EXPORT size_t fl_value_get_length(FlValue* self) {
@@ -693,24 +753,12 @@ G_MODULE_EXPORT size_t fl_value_get_length(FlValue* self) {
                        0);
 
   switch (self->type) {
-    case FL_VALUE_TYPE_UINT8_LIST: {
-      FlValueUint8List* v = reinterpret_cast<FlValueUint8List*>(self);
-      return v->values_length;
-    }
-    case FL_VALUE_TYPE_INT32_LIST: {
-      FlValueInt32List* v = reinterpret_cast<FlValueInt32List*>(self);
-      return v->values_length;
-    }
-    case FL_VALUE_TYPE_INT64_LIST: {
-      FlValueInt64List* v = reinterpret_cast<FlValueInt64List*>(self);
-      return v->values_length;
-    }
-    case FL_VALUE_TYPE_FLOAT32_LIST: {
-      FlValueFloat32List* v = reinterpret_cast<FlValueFloat32List*>(self);
-      return v->values_length;
-    }
+    case FL_VALUE_TYPE_UINT8_LIST:
+    case FL_VALUE_TYPE_INT32_LIST:
+    case FL_VALUE_TYPE_INT64_LIST:
+    case FL_VALUE_TYPE_FLOAT32_LIST:
     case FL_VALUE_TYPE_FLOAT_LIST: {
-      FlValueFloatList* v = reinterpret_cast<FlValueFloatList*>(self);
+      FlValueTypedList* v = reinterpret_cast<FlValueTypedList*>(self);
       return v->values_length;
     }
     case FL_VALUE_TYPE_LIST: {
@@ -783,3 +831,45 @@ G_MODULE_EXPORT gchar* fl_value_to_string(FlValue* value) {
   value_to_string(value, buffer);
   return g_string_free(buffer, FALSE);
 }
+
+FlValue* fl_value_new_typed_list_from_bytes(FlValueType type,
+                                            GBytes* bytes,
+                                            size_t offset,
+                                            size_t length) {
+  size_t element_size = get_element_size(type);
+  g_return_val_if_fail(element_size != 0, nullptr);
+  g_return_val_if_fail(bytes != nullptr, nullptr);
+  gsize bytes_size;
+  const uint8_t* data =
+      static_cast<const uint8_t*>(g_bytes_get_data(bytes, &bytes_size));
+  g_return_val_if_fail(offset <= bytes_size, nullptr);
+  g_return_val_if_fail(length <= (bytes_size - offset) / element_size,
+                       nullptr);
+
+  // Values that are not aligned for their type can't be referenced in place.
+  const uint8_t* values = data + offset;
+  if (length == 0 || reinterpret_cast<uintptr_t>(values) % element_size != 0) {
+    return fl_value_new_typed_list(type, values, length);
+  }
+
+  FlValueTypedList* self = reinterpret_cast<FlValueTypedList*>(
+      fl_value_new(type, sizeof(FlValueTypedList)));
+  self->values_length = length;
+  self->values = const_cast<uint8_t*>(values);
+  self->bytes = g_bytes_ref(bytes);
+  return reinterpret_cast<FlValue*>(self);
+}
+
+void fl_value_map_append_take(FlValue* self, FlValue* key, FlValue* value) {
+  g_return_if_fail(self != nullptr);
+  g_return_if_fail(self->type == FL_VALUE_TYPE_MAP);
+  g_return_if_fail(key != nullptr);
+  g_return_if_fail(value != nullptr);
+
+  FlValueMap* v = reinterpret_cast<FlValueMap*>(self);
+  g_ptr_array_add(v->keys, key);
+  g_ptr_array_add(v->values, value);
+  if (v->index != nullptr) {
+    fl_value_index_key(v, v->keys->len - 1);
+  }
+}
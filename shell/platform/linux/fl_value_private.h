@@ -0,0 +1,48 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_LINUX_FL_VALUE_PRIVATE_H_
+#define FLUTTER_SHELL_PLATFORM_LINUX_FL_VALUE_PRIVATE_H_
+
+#include "flutter/shell/platform/linux/public/flutter_linux/fl_value.h"
+
+G_BEGIN_DECLS
+
+/**
+ * fl_value_new_typed_list_from_bytes:
+ * @type: the type of list, one of #FL_VALUE_TYPE_UINT8_LIST,
+ * #FL_VALUE_TYPE_INT32_LIST, #FL_VALUE_TYPE_INT64_LIST,
+ * #FL_VALUE_TYPE_FLOAT32_LIST or #FL_VALUE_TYPE_FLOAT_LIST.
+ * @bytes: a #GBytes containing the values in host byte order.
+ * @offset: the offset of the first value in @bytes.
+ * @length: the number of values.
+ *
+ * Creates a list of numbers that references a slice of @bytes instead of
+ * copying it. The list keeps all of @bytes alive. Values that are not aligned
+ * for their type are copied.
+ *
+ * Returns: a new #FlValue, or %NULL if the values are outside @bytes.
+ */
+FlValue* fl_value_new_typed_list_from_bytes(FlValueType type,
+                                            GBytes* bytes,
+                                            size_t offset,
+                                            size_t length);
+
+/**
+ * fl_value_map_append_take:
+ * @value: an #FlValue of type #FL_VALUE_TYPE_MAP.
+ * @key: (transfer full): an #FlValue.
+ * @child_value: (transfer full): an #FlValue.
+ *
+ * Adds @key and @child_value to the end of @value without checking if @key is
+ * already in the map, which lets a map be built in linear time. If @key is
+ * already in the map, lookups find the earlier entry.
+ */
+void fl_value_map_append_take(FlValue* value,
+                              FlValue* key,
+                              FlValue* child_value);
+
+G_END_DECLS
+
+#endif  // FLUTTER_SHELL_PLATFORM_LINUX_FL_VALUE_PRIVATE_H_
@@ -3,9 +3,12 @@
 // found in the LICENSE file.
 
 #include "flutter/shell/platform/linux/public/flutter_linux/fl_value.h"
+#include "flutter/shell/platform/linux/fl_value_private.h"
 
 #include <gmodule.h>
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 TEST(FlDartProjectTest, Null) {
@@ -216,6 +219,50 @@ TEST(FlValueTest, Uint8ListNullptr) {
   ASSERT_EQ(fl_value_get_length(value), static_cast<size_t>(0));
 }
 
+TEST(FlValueTest, Uint8ListFromBytes) {
+  uint8_t data[] = {0x00, 0x01, 0xFE, 0xFF};
+  g_autoptr(GBytes) bytes = g_bytes_new(data, 4);
+  g_autoptr(FlValue) value = fl_value_new_uint8_list_from_bytes(bytes);
+  ASSERT_EQ(fl_value_get_type(value), FL_VALUE_TYPE_UINT8_LIST);
+  ASSERT_EQ(fl_value_get_length(value), static_cast<size_t>(4));
+  // The list references the bytes rather than copying them.
+  EXPECT_EQ(fl_value_get_uint8_list(value), g_bytes_get_data(bytes, nullptr));
+  g_clear_pointer(&bytes, g_bytes_unref);
+  EXPECT_EQ(fl_value_get_uint8_list(value)[0], 0x00);
+  EXPECT_EQ(fl_value_get_uint8_list(value)[3], 0xFF);
+}
+
+TEST(FlValueTest, TypedListFromBytes) {
+  int32_t data[] = {0, 1, -1, 42};
+  g_autoptr(GBytes) bytes = g_bytes_new(data, sizeof(data));
+  g_autoptr(FlValue) value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_INT32_LIST, bytes, sizeof(int32_t), 2);
+  ASSERT_EQ(fl_value_get_type(value), FL_VALUE_TYPE_INT32_LIST);
+  ASSERT_EQ(fl_value_get_length(value), static_cast<size_t>(2));
+  EXPECT_EQ(fl_value_get_int32_list(value),
+            static_cast<const int32_t*>(g_bytes_get_data(bytes, nullptr)) + 1);
+  EXPECT_EQ(fl_value_get_int32_list(value)[0], 1);
+  EXPECT_EQ(fl_value_get_int32_list(value)[1], -1);
+}
+
+TEST(FlValueTest, TypedListFromBytesUnaligned) {
+  double data[] = {0.0, 1.5, -2.25};
+  g_autofree uint8_t* buffer =
+      static_cast<uint8_t*>(g_malloc(sizeof(data) + 1));
+  memcpy(buffer + 1, data, sizeof(data));
+  g_autoptr(GBytes) bytes = g_bytes_new_static(buffer, sizeof(data) + 1);
+  g_autoptr(FlValue) value = fl_value_new_typed_list_from_bytes(
+      FL_VALUE_TYPE_FLOAT_LIST, bytes, 1, 3);
+  ASSERT_EQ(fl_value_get_type(value), FL_VALUE_TYPE_FLOAT_LIST);
+  ASSERT_EQ(fl_value_get_length(value), static_cast<size_t>(3));
+  // Unaligned values are copied.
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(fl_value_get_float_list(value)) %
+                sizeof(double),
+            0u);
+  EXPECT_EQ(fl_value_get_float_list(value)[1], 1.5);
+  EXPECT_EQ(fl_value_get_float_list(value)[2], -2.25);
+}
+
 TEST(FlValueTest, Uint8ListEqual) {
   uint8_t data1[] = {1, 2, 3};
   g_autoptr(FlValue) value1 = fl_value_new_uint8_list(data1, 3);
@@ -682,6 +729,65 @@ TEST(FlValueTest, MapLookupString) {
   ASSERT_EQ(v, nullptr);
 }
 
+TEST(FlValueTest, MapLookupLarge) {
+  g_autoptr(FlValue) value = fl_value_new_map();
+  for (int i = 0; i < 100; i++) {
+    fl_value_set_take(value, fl_value_new_int(i), fl_value_new_int(i * 2));
+  }
+  g_autoptr(FlValue) key = fl_value_new_int(42);
+  FlValue* v = fl_value_lookup(value, key);
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(fl_value_get_int(v), 84);
+
+  // Changes after the first lookup are seen by later lookups.
+  fl_value_set_take(value, fl_value_new_int(42), fl_value_new_int(-1));
+  fl_value_set_string_take(value, "extra", fl_value_new_bool(TRUE));
+  EXPECT_EQ(fl_value_get_length(value), static_cast<size_t>(101));
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup(value, key)), -1);
+  v = fl_value_lookup_string(value, "extra");
+  ASSERT_NE(v, nullptr);
+  EXPECT_TRUE(fl_value_get_bool(v));
+  g_autoptr(FlValue) missing_key = fl_value_new_int(100);
+  EXPECT_EQ(fl_value_lookup(value, missing_key), nullptr);
+}
+
+TEST(FlValueTest, MapLookupLargeKeyTypes) {
+  g_autoptr(FlValue) value = fl_value_new_map();
+  for (int i = 0; i < 10; i++) {
+    fl_value_set_take(value, fl_value_new_int(i), fl_value_new_null());
+  }
+  fl_value_set_take(value, fl_value_new_float(0.0), fl_value_new_int(1));
+  fl_value_set_take(value, fl_value_new_list(), fl_value_new_int(2));
+  int32_t data[] = {1, 2, 3};
+  fl_value_set_take(value, fl_value_new_int32_list(data, 3),
+                    fl_value_new_int(3));
+
+  g_autoptr(FlValue) float_key = fl_value_new_float(-0.0);
+  FlValue* v = fl_value_lookup(value, float_key);
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(fl_value_get_int(v), 1);
+  g_autoptr(FlValue) list_key = fl_value_new_list();
+  v = fl_value_lookup(value, list_key);
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(fl_value_get_int(v), 2);
+  g_autoptr(FlValue) int32_list_key = fl_value_new_int32_list(data, 3);
+  v = fl_value_lookup(value, int32_list_key);
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(fl_value_get_int(v), 3);
+}
+
+TEST(FlValueTest, MapAppend) {
+  g_autoptr(FlValue) value = fl_value_new_map();
+  for (int i = 0; i < 10; i++) {
+    fl_value_map_append_take(value, fl_value_new_int(i), fl_value_new_int(i));
+  }
+  fl_value_map_append_take(value, fl_value_new_int(5), fl_value_new_int(-1));
+  EXPECT_EQ(fl_value_get_length(value), static_cast<size_t>(11));
+  // The first entry with a key is found.
+  g_autoptr(FlValue) key = fl_value_new_int(5);
+  EXPECT_EQ(fl_value_get_int(fl_value_lookup(value, key)), 5);
+}
+
 TEST(FlValueTest, MapValueypes) {
   g_autoptr(FlValue) value = fl_value_new_map();
   fl_value_set_take(value, fl_value_new_string("null"), fl_value_new_null());
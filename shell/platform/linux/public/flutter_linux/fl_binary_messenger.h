@@ -11,6 +11,7 @@
 
 #include <gio/gio.h>
 #include <glib-object.h>
+#include <stdint.h>
 
 G_BEGIN_DECLS
 
@@ -41,6 +42,12 @@ G_DECLARE_FINAL_TYPE(FlBinaryMessengerResponseHandle,
                      BINARY_MESSENGER_RESPONSE_HANDLE,
                      GObject)
 
+G_DECLARE_FINAL_TYPE(FlBinaryMessengerRing,
+                     fl_binary_messenger_ring,
+                     FL,
+                     BINARY_MESSENGER_RING,
+                     GObject)
+
 /**
  * FlBinaryMessenger:
  *
@@ -54,6 +61,14 @@ G_DECLARE_FINAL_TYPE(FlBinaryMessengerResponseHandle,
  * #FlBinaryMessengerResponseHandle is an object used to send responses with.
  */
 
+/**
+ * FlBinaryMessengerRing:
+ *
+ * #FlBinaryMessengerRing is a ring buffer that records are written to, and
+ * that Dart reads in place on a channel, without a platform message being
+ * allocated or copied for each record. See fl_binary_messenger_create_ring().
+ */
+
 /**
  * FlBinaryMessengerMessageHandler:
  * @messenger: an #FlBinaryMessenger.
@@ -153,6 +168,57 @@ GBytes* fl_binary_messenger_send_on_channel_finish(FlBinaryMessenger* messenger,
                                                    GAsyncResult* result,
                                                    GError** error);
 
+/**
+ * fl_binary_messenger_create_ring:
+ * @binary_messenger: an #FlBinaryMessenger.
+ * @channel: channel Dart reads the ring on.
+ * @capacity: size of the buffer of the ring in bytes. Must be a power of two
+ * that is at least 1024.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL
+ * to ignore.
+ *
+ * Creates a ring buffer for streams of small records, like sensor samples.
+ * Write records to it with fl_binary_messenger_ring_write().
+ *
+ * Dart gets a `ByteData` that wraps the buffer of the ring as the response to
+ * any message it sends on @channel. When records are written to an empty ring,
+ * Dart receives a message on @channel with two host-endian 64 bit positions,
+ * `start` and `end`. It reads the records between those positions, and then
+ * responds to the message, which frees their space. The offset of a position
+ * in the buffer is the position modulo @capacity. A record is a host-endian 32
+ * bit length, followed by that many bytes, padded to 4 bytes. A length of
+ * `0xFFFFFFFF` means that the next record starts at the beginning of the
+ * buffer.
+ *
+ * The ring replaces any ring that was created on @channel before, and stops
+ * being used when the last reference to it is dropped. The ring may outlive
+ * the engine, after which writes to it fail.
+ *
+ * Returns: (transfer full): a new #FlBinaryMessengerRing or %NULL on error.
+ */
+FlBinaryMessengerRing* fl_binary_messenger_create_ring(
+    FlBinaryMessenger* messenger,
+    const gchar* channel,
+    size_t capacity,
+    GError** error);
+
+/**
+ * fl_binary_messenger_ring_write:
+ * @ring: an #FlBinaryMessengerRing.
+ * @data: (allow-none): bytes of the record.
+ * @size: number of bytes.
+ *
+ * Writes a record to the ring. This may be called on any thread, but only on
+ * one thread at a time. The write does not block when Dart has not freed
+ * enough space yet, so that the caller can drop or merge records instead.
+ *
+ * Returns: %TRUE if the record was written or %FALSE if there is no room for
+ * it.
+ */
+gboolean fl_binary_messenger_ring_write(FlBinaryMessengerRing* ring,
+                                        const uint8_t* data,
+                                        size_t size);
+
 G_END_DECLS
 
 #endif  // FLUTTER_SHELL_PLATFORM_LINUX_FL_BINARY_MESSENGER_H_
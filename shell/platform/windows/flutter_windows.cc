@@ -206,6 +206,12 @@ void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
                                                               user_data);
 }
 
+void FlutterDesktopMessengerSetQueue(FlutterDesktopMessengerRef messenger,
+                                     const char* channel,
+                                     FlutterDesktopMessageQueue queue) {
+  messenger->engine->SetPlatformMessageQueue(channel, queue);
+}
+
 FlutterDesktopTextureRegistrarRef FlutterDesktopRegistrarGetTextureRegistrar(
     FlutterDesktopPluginRegistrarRef registrar) {
   return HandleForTextureRegistrar(registrar->engine->texture_registrar());
@@ -369,6 +369,24 @@ void FlutterWindowsEngine::SendPlatformMessageResponse(
   embedder_api_.SendPlatformMessageResponse(engine_, handle, data, data_length);
 }
 
+void FlutterWindowsEngine::SetPlatformMessageQueue(
+    const char* channel,
+    FlutterDesktopMessageQueue queue) {
+  FlutterPlatformMessageQueue engine_queue;
+  switch (queue) {
+    case kFlutterDesktopMessageQueueSerial:
+      engine_queue = kFlutterPlatformMessageQueueSerial;
+      break;
+    case kFlutterDesktopMessageQueueConcurrent:
+      engine_queue = kFlutterPlatformMessageQueueConcurrent;
+      break;
+    default:
+      engine_queue = kFlutterPlatformMessageQueuePlatform;
+      break;
+  }
+  embedder_api_.SetPlatformMessageQueue(engine_, channel, engine_queue);
+}
+
 void FlutterWindowsEngine::HandlePlatformMessage(
     const FlutterPlatformMessage* engine_message) {
   if (engine_message->struct_size != sizeof(FlutterPlatformMessage)) {
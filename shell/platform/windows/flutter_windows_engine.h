@@ -124,8 +124,14 @@ class FlutterWindowsEngine {
       const uint8_t* data,
       size_t data_length);
 
+  // Sets the queue on which the messages on |channel| are handled. Messages
+  // on a background queue are handled off the platform thread.
+  void SetPlatformMessageQueue(const char* channel,
+                               FlutterDesktopMessageQueue queue);
+
   // Callback passed to Flutter engine for notifying window of platform
-  // messages.
+  // messages. May be called on a background thread for channels given a
+  // background queue.
   void HandlePlatformMessage(const FlutterPlatformMessage*);
 
   // Informs the engine that the system font list has changed.
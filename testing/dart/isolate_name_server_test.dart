@@ -4,6 +4,7 @@
 
 import 'dart:async';
 import 'dart:isolate';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:litetest/litetest.dart';
@@ -51,6 +52,18 @@ void isolateSpawnEntrypoint(IsolateSpawnInfo info) {
   }
 }
 
+void bufferSpawnEntrypoint(IsolateSpawnInfo info) {
+  final Uint8List bytes = Uint8List(1024);
+  for (int i = 0; i < bytes.length; i++) {
+    bytes[i] = i % 256;
+  }
+  final TransferableTypedData buffer =
+      TransferableTypedData.fromList(<Uint8List>[bytes]);
+  final bool sent =
+      IsolateNameServer.sendBufferToPortByName(info.portName, buffer);
+  info.sendPort.send(sent);
+}
+
 void main() {
   test('simple isolate name server', () {
     const String portName = 'foobar1';
@@ -139,4 +152,60 @@ void main() {
       IsolateNameServer.removePortNameMapping(portName);
     }
   });
+
+  test('send buffer to port by name', () async {
+    const String portName = 'buffer1';
+    final ReceivePort receivePort = ReceivePort();
+    try {
+      final TransferableTypedData buffer =
+          TransferableTypedData.fromList(<Uint8List>[
+        Uint8List.fromList(<int>[1, 2, 3, 4]),
+      ]);
+      expect(IsolateNameServer.sendBufferToPortByName(portName, buffer),
+          isFalse);
+
+      expect(IsolateNameServer.registerPortWithName(
+          receivePort.sendPort, portName), isTrue);
+      expect(IsolateNameServer.sendBufferToPortByName(portName, buffer),
+          isTrue);
+      // The bytes now belong to the receiver.
+      expectArgumentError(() => buffer.materialize());
+
+      final dynamic received = await receivePort.first;
+      expect(received, isInstanceOf<TransferableTypedData>());
+      final TransferableTypedData receivedBuffer =
+          received as TransferableTypedData;
+      expect(receivedBuffer.materialize().asUint8List(), <int>[1, 2, 3, 4]);
+    } finally {
+      IsolateNameServer.removePortNameMapping(portName);
+      receivePort.close();
+    }
+  });
+
+  test('send buffer to port by name multi-isolate', () async {
+    const String portName = 'buffer2';
+    final ReceivePort bufferPort = ReceivePort();
+    final ReceivePort resultPort = ReceivePort();
+    try {
+      expect(IsolateNameServer.registerPortWithName(
+          bufferPort.sendPort, portName), isTrue);
+      await Isolate.spawn(
+        bufferSpawnEntrypoint,
+        IsolateSpawnInfo(resultPort.sendPort, portName),
+      );
+      expect(await resultPort.first, isTrue);
+
+      final TransferableTypedData buffer =
+          await bufferPort.first as TransferableTypedData;
+      final Uint8List bytes = buffer.materialize().asUint8List();
+      expect(bytes.length, 1024);
+      for (int i = 0; i < bytes.length; i++) {
+        expect(bytes[i], i % 256);
+      }
+    } finally {
+      IsolateNameServer.removePortNameMapping(portName);
+      bufferPort.close();
+      resultPort.close();
+    }
+  });
 }
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:litetest/litetest.dart';
@@ -59,4 +60,48 @@ void main() {
       );
     }
   });
+
+  test('batch layout matches laying out each paragraph', () {
+    final ParagraphBatch batch = ParagraphBatch(
+      ParagraphStyle(fontFamily: 'Ahem', fontSize: 10.0),
+      <TextStyle>[
+        TextStyle(fontFamily: 'Ahem', fontSize: 10.0),
+        TextStyle(fontFamily: 'Ahem', fontSize: 20.0),
+      ],
+    );
+    final Float64List metrics = batch.layout(
+      'TestTest Ahem',
+      Int32List.fromList(<int>[
+        1, 4, 0, // 'Test' at 10px.
+        2, 5, 1, 4, 1, // 'Test ' and 'Ahem' at 20px.
+      ]),
+      Float64List.fromList(<double>[400.0, 100.0]),
+    );
+    expect(metrics.length, 2 * ParagraphBatch.metricsPerParagraph);
+
+    final List<double> first = metrics.sublist(0, ParagraphBatch.metricsPerParagraph);
+    expect(first[0], closeTo(10.0, 0.001)); // height
+    expect(first[2], closeTo(40.0, 0.001)); // minIntrinsicWidth
+    expect(first[3], closeTo(40.0, 0.001)); // maxIntrinsicWidth
+    expect(first[4], closeTo(8.0, 0.001)); // alphabeticBaseline
+    expect(first[6], 0.0); // didExceedMaxLines
+
+    final List<double> second = metrics.sublist(ParagraphBatch.metricsPerParagraph);
+    expect(second[0], closeTo(40.0, 0.001)); // because it wraps
+    expect(second[2], closeTo(80.0, 0.001));
+    expect(second[3], closeTo(180.0, 0.001));
+    expect(second[4], closeTo(16.0, 0.001));
+  });
+
+  test('batch layout rejects runs that do not match the text', () {
+    final ParagraphBatch batch = ParagraphBatch(
+      ParagraphStyle(fontFamily: 'Ahem', fontSize: 10.0),
+      <TextStyle>[TextStyle(fontFamily: 'Ahem')],
+    );
+    final Float64List widths = Float64List.fromList(<double>[100.0]);
+    expectArgumentError(() => batch.layout('Test', Int32List.fromList(<int>[1, 5, 0]), widths));
+    expectArgumentError(() => batch.layout('Test', Int32List.fromList(<int>[1, 3, 0]), widths));
+    expectArgumentError(() => batch.layout('Test', Int32List.fromList(<int>[1, 4, 1]), widths));
+    expectArgumentError(() => batch.layout('Test', Int32List.fromList(<int>[2, 4, 0]), widths));
+  });
 }
@@ -14,11 +14,15 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <vector>
+
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/logging.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
 #include "third_party/benchmark/include/benchmark/benchmark_api.h"
 #include "txt/paint_record.h"
+#include "txt/text_blob_cache.h"
 #include "txt/text_style.h"
 
 namespace txt {
@@ -42,4 +46,39 @@ static void BM_PaintRecordInit(benchmark::State& state) {
 }
 BENCHMARK(BM_PaintRecordInit);
 
+// Builds the blob for a run of 20 glyphs. Arg 0 builds a new blob every time,
+// as layout did before the blob cache, and arg 1 gets it from the cache.
+static void BM_TextBlobForRun(benchmark::State& state) {
+  SkFont font;
+  font.setEdging(SkFont::Edging::kAntiAlias);
+  font.setSize(14);
+
+  constexpr size_t kGlyphCount = 20;
+  std::vector<SkGlyphID> glyphs(kGlyphCount);
+  std::vector<SkScalar> positions(kGlyphCount * 2);
+  for (size_t i = 0; i < kGlyphCount; ++i) {
+    glyphs[i] = 40 + i;
+    positions[i * 2] = i * 8.5f;
+    positions[i * 2 + 1] = 0;
+  }
+
+  const bool cached = state.range(0);
+  TextBlobCache& cache = TextBlobCache::GetInstance();
+  while (state.KeepRunning()) {
+    sk_sp<SkTextBlob> blob;
+    if (cached) {
+      blob = cache.GetBlob(font, glyphs.data(), positions.data(), kGlyphCount);
+    } else {
+      SkTextBlobBuilder builder;
+      const SkTextBlobBuilder::RunBuffer& buffer =
+          builder.allocRunPos(font, kGlyphCount);
+      memcpy(buffer.glyphs, glyphs.data(), kGlyphCount * sizeof(SkGlyphID));
+      memcpy(buffer.pos, positions.data(), kGlyphCount * 2 * sizeof(SkScalar));
+      blob = builder.make();
+    }
+    benchmark::DoNotOptimize(blob);
+  }
+}
+BENCHMARK(BM_TextBlobForRun)->Arg(0)->Arg(1);
+
 }  // namespace txt
@@ -16,9 +16,11 @@
 
 #include <minikin/Layout.h>
 
+#include <cmath>
 #include <cstring>
 
 #include "flutter/fml/command_line.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
 #include "minikin/LayoutUtils.h"
@@ -119,6 +121,47 @@ BENCHMARK_F(ParagraphFixture, LongLayout)(benchmark::State& state) {
   }
 }
 
+// Lays out the same long text on several threads at once, each thread using
+// its own paragraph but sharing the font collection and minikin's caches, as
+// separate engines in one process do. With independent layouts scaling across
+// cores, the real time per iteration should stay flat as threads are added.
+static void ConcurrentLongLayout(benchmark::State& state) {
+  static std::shared_ptr<FontCollection> font_collection =
+      GetTestFontCollection();
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK(ConcurrentLongLayout)->ThreadRange(1, 8)->UseRealTime();
+
 BENCHMARK_F(ParagraphFixture, JustifyLayout)(benchmark::State& state) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
@@ -184,6 +227,158 @@ BENCHMARK_F(ParagraphFixture, ManyStylesLayout)(benchmark::State& state) {
   }
 }
 
+// Simulates dragging the edge of a window: the same paragraph is laid out at a
+// sweep of widths. Arg 0 lays out every width from scratch and arg 1 lets the
+// paragraph reuse its previous layout.
+BENCHMARK_DEFINE_F(ParagraphFixture, ResizeDragLayout)
+(benchmark::State& state) {
+  const char* text =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua.\n"
+      "Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris.\n"
+      "Short line.\nAnother short line.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::center;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  const bool incremental = state.range(0);
+  while (state.KeepRunning()) {
+    for (double width = 200; width < 1200; width += 8) {
+      if (!incremental) {
+        paragraph->SetDirty();
+      }
+      paragraph->Layout(width);
+    }
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ResizeDragLayout)->Arg(0)->Arg(1);
+
+// Simulates a log view that appends a message to its text and lays it out
+// again after every message. Arg 0 lays out every step from scratch and arg 1
+// lets the paragraph keep the lines before the new message.
+BENCHMARK_DEFINE_F(ParagraphFixture, AppendLayout)(benchmark::State& state) {
+  const std::u16string message =
+      u"\n[info] Received a message that is long enough to wrap once.";
+
+  txt::ParagraphStyle paragraph_style;
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+  const bool incremental = state.range(0);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+    builder.PushStyle(text_style);
+    builder.AddText(u"Log started.");
+    builder.Pop();
+    auto paragraph = BuildParagraph(builder);
+    paragraph->Layout(300);
+    state.ResumeTiming();
+
+    for (int i = 0; i < 100; ++i) {
+      paragraph->AppendText(message);
+      if (!incremental) {
+        paragraph->SetDirty();
+      }
+      paragraph->Layout(300);
+    }
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, AppendLayout)->Arg(0)->Arg(1);
+
+// Lays out a long document from scratch. Arg 0 lays it out on the calling
+// thread and arg 1 on a pool of workers.
+BENCHMARK_DEFINE_F(ParagraphFixture, ParallelLongLayout)
+(benchmark::State& state) {
+  std::u16string text;
+  while (text.size() < 256 * 1024) {
+    text +=
+        u"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+        u"eiusmod tempor incididunt ut labore et dolore magna aliqua.\n";
+  }
+
+  txt::ParagraphStyle paragraph_style;
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection_);
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  if (state.range(0)) {
+    paragraph->SetLayoutTaskRunner(loop->GetTaskRunner());
+  }
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, ParallelLongLayout)->Arg(0)->Arg(1);
+
+static std::unique_ptr<Paragraph> BuildLongDocument(
+    std::shared_ptr<FontCollection> font_collection) {
+  std::u16string text;
+  while (text.size() < 100 * 1000) {
+    text +=
+        u"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+        u"eiusmod tempor incididunt ut labore et dolore magna aliqua. ";
+  }
+
+  txt::ParagraphStyle paragraph_style;
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  return paragraph;
+}
+
+// Drags a selection through a long document, as a text field does while the
+// selection handle moves.
+BENCHMARK_F(ParagraphFixture, LongSelectionRects)(benchmark::State& state) {
+  auto paragraph = BuildLongDocument(font_collection_);
+  size_t offset = 0;
+  while (state.KeepRunning()) {
+    offset = (offset + 7919) % 99000;
+    benchmark::DoNotOptimize(paragraph->GetRectsForRange(
+        offset, offset + 500, Paragraph::RectHeightStyle::kMax,
+        Paragraph::RectWidthStyle::kTight));
+  }
+}
+
+// Moves the caret to points all over a long document.
+BENCHMARK_F(ParagraphFixture, LongHitTest)(benchmark::State& state) {
+  auto paragraph = BuildLongDocument(font_collection_);
+  double height = paragraph->GetHeight();
+  double y = 0;
+  double x = 0;
+  while (state.KeepRunning()) {
+    y = fmod(y + 977, height);
+    x = fmod(x + 37, 300);
+    benchmark::DoNotOptimize(paragraph->GetGlyphPositionAtCoordinate(x, y));
+  }
+}
+
 BENCHMARK_DEFINE_F(ParagraphFixture, TextBigO)(benchmark::State& state) {
   std::vector<uint16_t> text;
   for (uint16_t i = 0; i < state.range(0); ++i) {
@@ -389,6 +584,39 @@ BENCHMARK_REGISTER_F(ParagraphFixture, MinikinDoLayout)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+// Compares laying out text whose words are all in the shaping cache (arg 1)
+// against shaping every word from scratch (arg 0).
+BENCHMARK_DEFINE_F(ParagraphFixture, MinikinRelayout)(benchmark::State& state) {
+  const char* text =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::vector<uint16_t> u16_text(icu_text.getBuffer(),
+                                 icu_text.getBuffer() + icu_text.length());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  minikin::MinikinPaint paint;
+  paint.size = text_style.font_size;
+  auto collection = font_collection_->GetMinikinFontCollectionForFamilies(
+      text_style.font_families, "en-US");
+  const bool cached = state.range(0);
+
+  minikin::Layout::purgeCaches();
+  while (state.KeepRunning()) {
+    if (!cached) {
+      state.PauseTiming();
+      minikin::Layout::purgeCaches();
+      state.ResumeTiming();
+    }
+    minikin::Layout layout;
+    layout.doLayout(u16_text.data(), 0, u16_text.size(), u16_text.size(), 0,
+                    minikin::FontStyle(4, false), paint, collection);
+  }
+}
+BENCHMARK_REGISTER_F(ParagraphFixture, MinikinRelayout)->Arg(0)->Arg(1);
+
 BENCHMARK_DEFINE_F(ParagraphFixture, AddStyleRun)(benchmark::State& state) {
   std::vector<uint16_t> text;
   for (uint16_t i = 0; i < 16000 * 2; ++i) {
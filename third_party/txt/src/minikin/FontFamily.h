@@ -120,7 +120,7 @@ struct Font {
   std::shared_ptr<MinikinFont> typeface;
   FontStyle style;
 
-  std::unordered_set<AxisTag> getSupportedAxesLocked() const;
+  std::unordered_set<AxisTag> getSupportedAxes() const;
 };
 
 struct FontVariation {
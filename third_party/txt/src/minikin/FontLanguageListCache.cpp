@@ -123,19 +123,28 @@ static std::vector<FontLanguage> parseLanguageList(const std::string& input) {
 // static
 uint32_t FontLanguageListCache::getId(const std::string& languages) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
-  std::unordered_map<std::string, uint32_t>::const_iterator it =
-      inst->mLanguageListLookupTable.find(languages);
-  if (it != inst->mLanguageListLookupTable.end()) {
-    return it->second;
+  {
+    fml::SharedLock lock(*inst->mMutex);
+    std::unordered_map<std::string, uint32_t>::const_iterator it =
+        inst->mLanguageListLookupTable.find(languages);
+    if (it != inst->mLanguageListLookupTable.end()) {
+      return it->second;
+    }
   }
 
-  // Given language list is not in cache. Insert it and return newly assigned
-  // ID.
-  const uint32_t nextId = inst->mLanguageLists.size();
+  // Given language list is not in cache. Parse it outside of the lock, then
+  // insert it and return newly assigned ID unless another thread won the race.
   FontLanguages fontLanguages(parseLanguageList(languages));
   if (fontLanguages.empty()) {
     return kEmptyListId;
   }
+  fml::UniqueLock lock(*inst->mMutex);
+  std::unordered_map<std::string, uint32_t>::const_iterator it =
+      inst->mLanguageListLookupTable.find(languages);
+  if (it != inst->mLanguageListLookupTable.end()) {
+    return it->second;
+  }
+  const uint32_t nextId = inst->mLanguageLists.size();
   inst->mLanguageLists.push_back(std::move(fontLanguages));
   inst->mLanguageListLookupTable.insert(std::make_pair(languages, nextId));
   return nextId;
@@ -144,6 +153,7 @@ uint32_t FontLanguageListCache::getId(const std::string& languages) {
 // static
 const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
+  fml::SharedLock lock(*inst->mMutex);
   LOG_ALWAYS_FATAL_IF(id >= inst->mLanguageLists.size(),
                       "Lookup by unknown language list ID.");
   return inst->mLanguageLists[id];
@@ -151,17 +161,16 @@ const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
 
 // static
 FontLanguageListCache* FontLanguageListCache::getInstance() {
-  assertMinikinLocked();
-  static FontLanguageListCache* instance = nullptr;
-  if (instance == nullptr) {
-    instance = new FontLanguageListCache();
+  static FontLanguageListCache* instance = [] {
+    FontLanguageListCache* cache = new FontLanguageListCache();
 
     // Insert an empty language list for mapping default language list to
     // kEmptyListId. The default language list has only one FontLanguage and it
     // is the unsupported language.
-    instance->mLanguageLists.push_back(FontLanguages());
-    instance->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
-  }
+    cache->mLanguageLists.push_back(FontLanguages());
+    cache->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
+    return cache;
+  }();
   return instance;
 }
 
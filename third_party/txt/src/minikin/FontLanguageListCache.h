@@ -17,10 +17,13 @@
 #ifndef MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 #define MINIKIN_FONT_LANGUAGE_LIST_CACHE_H
 
+#include <deque>
+#include <memory>
 #include <unordered_map>
 
 #include <minikin/FontFamily.h>
 #include "FontLanguage.h"
+#include "flutter/fml/synchronization/shared_mutex.h"
 
 namespace minikin {
 
@@ -32,20 +35,25 @@ class FontLanguageListCache {
   const static uint32_t kEmptyListId = 0;
 
   // Returns language list ID for the given string representation of
-  // FontLanguages. Caller should acquire a lock before calling the method.
+  // FontLanguages. May be called from any thread.
   static uint32_t getId(const std::string& languages);
 
-  // Caller should acquire a lock before calling the method.
+  // May be called from any thread. The returned reference stays valid for the
+  // lifetime of the process.
   static const FontLanguages& getById(uint32_t id);
 
  private:
-  FontLanguageListCache() {}  // Singleton
+  // Singleton
+  FontLanguageListCache() : mMutex(fml::SharedMutex::Create()) {}
   ~FontLanguageListCache() {}
 
-  // Caller should acquire a lock before calling the method.
   static FontLanguageListCache* getInstance();
 
-  std::vector<FontLanguages> mLanguageLists;
+  // Lookups vastly outnumber insertions, so readers share the lock.
+  std::unique_ptr<fml::SharedMutex> mMutex;
+
+  // A deque so that references returned by getById survive insertions.
+  std::deque<FontLanguages> mLanguageLists;
 
   // A map from string representation of the font language list to the ID.
   std::unordered_map<std::string, uint32_t> mLanguageListLookupTable;
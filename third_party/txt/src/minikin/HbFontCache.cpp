@@ -18,6 +18,8 @@
 
 #include "HbFontCache.h"
 
+#include <mutex>
+
 #include <log/log.h>
 #include <utils/LruCache.h>
 
@@ -40,60 +42,75 @@ class HbFontCache : private android::OnEntryRemoved<int32_t, hb_font_t*> {
     hb_font_destroy(value);
   }
 
-  hb_font_t* get(int32_t fontId) { return mCache.get(fontId); }
+  // Returns a new reference to the cached font, or nullptr.
+  hb_font_t* get(int32_t fontId) {
+    std::scoped_lock lock(mMutex);
+    hb_font_t* font = mCache.get(fontId);
+    return font ? hb_font_reference(font) : nullptr;
+  }
 
-  void put(int32_t fontId, hb_font_t* font) { mCache.put(fontId, font); }
+  // Returns a new reference to the cached font for fontId, which is |font|
+  // unless another thread cached a font for the same id first.
+  hb_font_t* put(int32_t fontId, hb_font_t* font) {
+    std::scoped_lock lock(mMutex);
+    hb_font_t* cached = mCache.get(fontId);
+    if (cached != nullptr) {
+      hb_font_destroy(font);
+      return hb_font_reference(cached);
+    }
+    mCache.put(fontId, font);
+    return hb_font_reference(font);
+  }
 
-  void clear() { mCache.clear(); }
+  void clear() {
+    std::scoped_lock lock(mMutex);
+    mCache.clear();
+  }
 
-  void remove(int32_t fontId) { mCache.remove(fontId); }
+  void remove(int32_t fontId) {
+    std::scoped_lock lock(mMutex);
+    mCache.remove(fontId);
+  }
 
  private:
   static const size_t kMaxEntries = 100;
 
+  std::mutex mMutex;
   android::LruCache<int32_t, hb_font_t*> mCache;
 };
 
-HbFontCache* getFontCacheLocked() {
-  assertMinikinLocked();
-  static HbFontCache* cache = nullptr;
-  if (cache == nullptr) {
-    cache = new HbFontCache();
-  }
+HbFontCache* getFontCache() {
+  static HbFontCache* cache = new HbFontCache();
   return cache;
 }
 
-void purgeHbFontCacheLocked() {
-  assertMinikinLocked();
-  getFontCacheLocked()->clear();
+void purgeHbFontCache() {
+  getFontCache()->clear();
 }
 
-void purgeHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
+void purgeHbFont(const MinikinFont* minikinFont) {
   const int32_t fontId = minikinFont->GetUniqueId();
-  getFontCacheLocked()->remove(fontId);
+  getFontCache()->remove(fontId);
 }
 
 // Returns a new reference to a hb_font_t object, caller is
 // responsible for calling hb_font_destroy() on it.
-hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
-  assertMinikinLocked();
+hb_font_t* getHbFont(const MinikinFont* minikinFont) {
   // TODO: get rid of nullFaceFont
-  static hb_font_t* nullFaceFont = nullptr;
+  static hb_font_t* nullFaceFont = hb_font_create(nullptr);
   if (minikinFont == nullptr) {
-    if (nullFaceFont == nullptr) {
-      nullFaceFont = hb_font_create(nullptr);
-    }
     return hb_font_reference(nullFaceFont);
   }
 
-  HbFontCache* fontCache = getFontCacheLocked();
+  HbFontCache* fontCache = getFontCache();
   const int32_t fontId = minikinFont->GetUniqueId();
   hb_font_t* font = fontCache->get(fontId);
   if (font != nullptr) {
-    return hb_font_reference(font);
+    return font;
   }
 
+  // Fonts are created outside the cache's lock. If two threads race to create
+  // the same font, the cache keeps the first one.
   hb_face_t* face = minikinFont->CreateHarfBuzzFace();
 
   hb_font_t* parent_font = hb_font_create(face);
@@ -108,10 +125,10 @@ hb_font_t* getHbFontLocked(const MinikinFont* minikinFont) {
     variations.push_back({variation.axisTag, variation.value});
   }
   hb_font_set_variations(font, variations.data(), variations.size());
+  hb_font_make_immutable(font);
   hb_font_destroy(parent_font);
   hb_face_destroy(face);
-  fontCache->put(fontId, font);
-  return hb_font_reference(font);
+  return fontCache->put(fontId, font);
 }
 
 }  // namespace minikin
@@ -22,9 +22,12 @@ struct hb_font_t;
 namespace minikin {
 class MinikinFont;
 
-void purgeHbFontCacheLocked();
-void purgeHbFontLocked(const MinikinFont* minikinFont);
-hb_font_t* getHbFontLocked(const MinikinFont* minikinFont);
+// These functions may be called from any thread. The returned hb_font_t is
+// shared between threads and must not be modified; create a sub font to set
+// per-layout funcs or scales.
+void purgeHbFontCache();
+void purgeHbFont(const MinikinFont* minikinFont);
+hb_font_t* getHbFont(const MinikinFont* minikinFont);
 
 }  // namespace minikin
 #endif  // MINIKIN_HBFONT_CACHE_H
@@ -17,6 +17,7 @@
 #include <unicode/uchar.h>
 #include <unicode/uscript.h>
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -38,6 +39,9 @@ static const uint16_t CHAR_SOFT_HYPHEN = 0x00AD;
 static const uint16_t CHAR_MIDDLE_DOT = 0x00B7;
 static const uint16_t CHAR_HYPHEN = 0x2010;
 
+// libtxt: the magic number at the start of a hyb file.
+static const uint32_t HYPHENATION_MAGIC = 0x62ad7968;
+
 // The following are structs that correspond to tables inside the hyb file
 // format
 
@@ -122,10 +126,129 @@ Hyphenator* Hyphenator::loadBinary(const uint8_t* patternData,
   return result;
 }
 
+// libtxt: returns true if a table of fixed_size bytes followed by
+// entry_count entries of entry_size bytes fits between offset and file_size.
+// Tables are read as uint32_t, so they must also be aligned.
+static bool isValidTable(uint32_t offset,
+                         uint64_t fixed_size,
+                         uint64_t entry_count,
+                         uint64_t entry_size,
+                         uint32_t file_size) {
+  return offset % sizeof(uint32_t) == 0 && offset <= file_size &&
+         fixed_size + entry_count * entry_size <= file_size - offset;
+}
+
+bool Hyphenator::isValidBinary(const uint8_t* patternData, size_t size) {
+  if (patternData == nullptr || size < sizeof(Header) ||
+      reinterpret_cast<uintptr_t>(patternData) % sizeof(uint32_t) != 0) {
+    return false;
+  }
+  const Header* header = reinterpret_cast<const Header*>(patternData);
+  const uint32_t file_size = header->file_size;
+  if (header->magic != HYPHENATION_MAGIC || file_size > size ||
+      file_size < sizeof(Header)) {
+    return false;
+  }
+
+  // The fixed fields of each table, without its flexible array.
+  const size_t alphabet0_size = offsetof(AlphabetTable0, data);
+  const size_t alphabet1_size = offsetof(AlphabetTable1, data);
+  const size_t trie_size = offsetof(Trie, data);
+  const size_t pattern_size = offsetof(Pattern, data);
+
+  if (!isValidTable(header->alphabet_offset, sizeof(uint32_t), 0, 0,
+                    file_size)) {
+    return false;
+  }
+  switch (header->alphabetVersion()) {
+    case 0: {
+      if (!isValidTable(header->alphabet_offset, alphabet0_size, 0, 0,
+                        file_size)) {
+        return false;
+      }
+      const AlphabetTable0* alphabet = header->alphabetTable0();
+      if (alphabet->max_codepoint < alphabet->min_codepoint ||
+          !isValidTable(header->alphabet_offset, alphabet0_size,
+                        alphabet->max_codepoint - alphabet->min_codepoint,
+                        sizeof(uint8_t), file_size)) {
+        return false;
+      }
+      break;
+    }
+    case 1: {
+      if (!isValidTable(header->alphabet_offset, alphabet1_size, 0, 0,
+                        file_size) ||
+          !isValidTable(header->alphabet_offset, alphabet1_size,
+                        header->alphabetTable1()->n_entries, sizeof(uint32_t),
+                        file_size)) {
+        return false;
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+
+  if (!isValidTable(header->trie_offset, trie_size, 0, 0, file_size)) {
+    return false;
+  }
+  const Trie* trie = header->trieTable();
+  if (trie->link_shift >= 32 || trie->pattern_shift >= 32 ||
+      !isValidTable(header->trie_offset, trie_size, trie->n_entries,
+                    sizeof(uint32_t), file_size)) {
+    return false;
+  }
+
+  if (!isValidTable(header->pattern_offset, pattern_size, 0, 0, file_size)) {
+    return false;
+  }
+  const Pattern* pattern = header->patternTable();
+  // The pattern bytes are addressed from the start of the table.
+  const uint64_t pattern_end =
+      static_cast<uint64_t>(pattern->pattern_offset) + pattern->pattern_size;
+  return isValidTable(header->pattern_offset, pattern_size, pattern->n_entries,
+                      sizeof(uint32_t), file_size) &&
+         pattern_end <= file_size - header->pattern_offset;
+}
+
 void Hyphenator::hyphenate(vector<HyphenationType>* result,
                            const uint16_t* word,
                            size_t len,
                            const icu::Locale& locale) {
+  std::u16string key;
+  for (const char* c = locale.getLanguage(); *c != '\0'; c++) {
+    key.push_back(*c);
+  }
+  key.push_back(u'\0');
+  key.append(reinterpret_cast<const char16_t*>(word), len);
+  {
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    auto found = mWordCache.find(key);
+    if (found != mWordCache.end()) {
+      *result = found->second;
+      mCacheHits++;
+      return;
+    }
+  }
+
+  hyphenateUncached(result, word, len, locale);
+
+  std::lock_guard<std::mutex> lock(mCacheMutex);
+  if (mWordCache.size() >= MAX_CACHED_WORDS) {
+    mWordCache.clear();
+  }
+  mWordCache.emplace(std::move(key), *result);
+}
+
+size_t Hyphenator::getCacheHitCount() {
+  std::lock_guard<std::mutex> lock(mCacheMutex);
+  return mCacheHits;
+}
+
+void Hyphenator::hyphenateUncached(vector<HyphenationType>* result,
+                                   const uint16_t* word,
+                                   size_t len,
+                                   const icu::Locale& locale) {
   result->clear();
   result->resize(len);
   const size_t paddedLen = len + 2;  // start and stop code each count for 1
@@ -419,17 +542,31 @@ void Hyphenator::hyphenateFromCodes(HyphenationType* result,
   uint32_t link_mask = trie->link_mask;
   uint32_t pattern_shift = trie->pattern_shift;
   size_t maxOffset = len - minSuffix - 1;
+  // libtxt: the tables fit in the file, as checked by isValidBinary, but the
+  // links and pattern entries inside them are checked as they are followed.
+  const uint32_t trie_entries = trie->n_entries;
+  const uint32_t pattern_entries = pattern->n_entries;
+  const uint32_t pattern_bytes = pattern->pattern_size;
   for (size_t i = 0; i < len - 1; i++) {
     uint32_t node = 0;  // index into Trie table
     for (size_t j = i; j < len; j++) {
       uint16_t c = codes[j];
+      if (static_cast<uint64_t>(node) + c >= trie_entries) {
+        break;
+      }
       uint32_t entry = trie->data[node + c];
       if ((entry & char_mask) == c) {
         node = (entry & link_mask) >> link_shift;
       } else {
         break;
       }
+      if (node >= trie_entries) {
+        break;
+      }
       uint32_t pat_ix = trie->data[node] >> pattern_shift;
+      if (pat_ix >= pattern_entries) {
+        break;
+      }
       // pat_ix contains a 3-tuple of length, shift (number of trailing zeros),
       // and an offset into the buf pool. This is the pattern for the substring
       // (i..j) we just matched, which we combine (via point-wise max) into the
@@ -438,6 +575,9 @@ void Hyphenator::hyphenateFromCodes(HyphenationType* result,
         uint32_t pat_entry = pattern->data[pat_ix];
         int pat_len = Pattern::len(pat_entry);
         int pat_shift = Pattern::shift(pat_entry);
+        if ((pat_entry & 0xfffff) + pat_len > pattern_bytes) {
+          break;
+        }
         const uint8_t* pat_buf = pattern->buf(pat_entry);
         int offset = j + 1 - (pat_len + pat_shift);
         // offset is the index within buffer that lines up with the start of
@@ -23,6 +23,8 @@
 #endif  //  U_USING_ICU_NAMESPACE
 
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include "unicode/locid.h"
@@ -136,6 +138,9 @@ class Hyphenator {
   // Example: word is "hyphen", result is the following, corresponding to
   // "hy-phen": [DONT_BREAK, DONT_BREAK, BREAK_AND_INSERT_HYPHEN, DONT_BREAK,
   // DONT_BREAK, DONT_BREAK]
+  //
+  // libtxt: results are cached per word, and the method may be called from
+  // several threads at once.
   void hyphenate(std::vector<HyphenationType>* result,
                  const uint16_t* word,
                  size_t len,
@@ -156,7 +161,20 @@ class Hyphenator {
                                 size_t minPrefix,
                                 size_t minSuffix);
 
+  // libtxt: returns true if the size bytes at patternData hold a complete hyb
+  // file, so that data read from disk can be checked before it is loaded.
+  static bool isValidBinary(const uint8_t* patternData, size_t size);
+
+  // libtxt: the number of words whose hyphenation was found in the cache.
+  size_t getCacheHitCount();
+
  private:
+  // compute the hyphenation of a word without consulting the cache
+  void hyphenateUncached(std::vector<HyphenationType>* result,
+                         const uint16_t* word,
+                         size_t len,
+                         const icu::Locale& locale);
+
   // apply various hyphenation rules including hard and soft hyphens, ignoring
   // patterns
   void hyphenateWithNoPatterns(HyphenationType* result,
@@ -185,9 +203,20 @@ class Hyphenator {
   // is a slightly different use case. It measures UTF-16 code units.
   static const size_t MAX_HYPHENATED_SIZE = 64;
 
+  // libtxt: the number of words kept in the cache. The cache is emptied when
+  // it is full, as the words of a document tend to repeat within a few pages.
+  static const size_t MAX_CACHED_WORDS = 4096;
+
   const uint8_t* patternData;
   size_t minPrefix, minSuffix;
 
+  // libtxt: the hyphenation of recently seen words, keyed by the language of
+  // the locale and the word separated by a zero code unit. Line breaking asks
+  // for the same words every time a paragraph is laid out.
+  std::mutex mCacheMutex;
+  std::unordered_map<std::u16string, std::vector<HyphenationType>> mWordCache;
+  size_t mCacheHits = 0;
+
   // accessors for binary data
   const Header* getHeader() const {
     return reinterpret_cast<const Header*>(patternData);
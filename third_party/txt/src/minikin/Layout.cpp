@@ -20,19 +20,26 @@
 #include <unicode/ubidi.h>
 #include <unicode/utf16.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <log/log.h>
 #include <utils/JenkinsHash.h>
-#include <utils/LruCache.h>
 #include <utils/WindowsUtils.h>
 
 #include <hb-icu.h>
 #include <hb-ot.h>
 
+#include "flutter/fml/thread_local.h"
+
 #include <minikin/Emoji.h>
 #include <minikin/Layout.h>
 #include "FontLanguage.h"
@@ -89,15 +96,11 @@ class LayoutCacheKey {
 
   android::hash_t hash() const { return mHash; }
 
-  void copyText() {
-    uint16_t* charsCopy = new uint16_t[mNchars];
-    memcpy(charsCopy, mChars, mNchars * sizeof(uint16_t));
-    mChars = charsCopy;
-  }
-  void freeText() {
-    delete[] mChars;
-    mChars = NULL;
-  }
+  const uint16_t* text() const { return mChars; }
+  size_t textLength() const { return mNchars; }
+
+  // Points the key at a copy of its text that outlives the caller's buffer.
+  void setText(const uint16_t* chars) { mChars = chars; }
 
   void doLayout(Layout* layout,
                 LayoutContext* ctx,
@@ -129,56 +132,235 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// Shaped words are cached in an LRU cache bounded by the bytes its entries
+// use. The cache is split into shards by key hash so that threads laying out
+// different words rarely contend on the same lock. Words are shaped outside of
+// the lock, and cached layouts are handed out as shared pointers so that an
+// eviction on one thread can't free a layout another thread is still copying.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
-  }
+  static constexpr size_t kShardCount = 16;
+  static constexpr size_t kDefaultBudgetBytes = 8 << 20;
+
+  LayoutCache() { setBudget(kDefaultBudgetBytes); }
+
+  std::shared_ptr<Layout> get(
+      const LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    Shard& shard = shardFor(key);
+    {
+      std::scoped_lock lock(shard.mutex);
+      auto found = shard.index.find(&key);
+      if (found != shard.index.end()) {
+        shard.entries.splice(shard.entries.begin(), shard.entries,
+                             found->second);
+        mHits.fetch_add(1, std::memory_order_relaxed);
+        return found->second->layout;
+      }
+    }
+    mMisses.fetch_add(1, std::memory_order_relaxed);
 
-  void clear() { mCache.clear(); }
-
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
+    auto layout = std::make_shared<Layout>();
+    key.doLayout(layout.get(), ctx, collection);
+    const size_t bytes = entryBytes(key, *layout);
+
+    std::scoped_lock lock(shard.mutex);
+    // Another thread may have cached the same word while this one was shaping
+    // it. Either layout is equally valid, so keep the one already cached.
+    if (bytes > shard.budget || shard.index.count(&key) > 0) {
+      return layout;
     }
+    Entry& entry = shard.entries.emplace_front(key, layout, bytes);
+    shard.index.emplace(&entry.key, shard.entries.begin());
+    shard.bytes += bytes;
+    mEntries.fetch_add(1, std::memory_order_relaxed);
+    mBytes.fetch_add(bytes, std::memory_order_relaxed);
+    evictLocked(shard);
     return layout;
   }
 
+  void clear() {
+    for (Shard& shard : mShards) {
+      std::scoped_lock lock(shard.mutex);
+      mEntries.fetch_sub(shard.entries.size(), std::memory_order_relaxed);
+      mBytes.fetch_sub(shard.bytes, std::memory_order_relaxed);
+      shard.index.clear();
+      shard.entries.clear();
+      shard.bytes = 0;
+    }
+  }
+
+  size_t addBudget(size_t bytes) {
+    std::scoped_lock lock(mBudgetsMutex);
+    const size_t budgetId = mNextBudgetId++;
+    mBudgets[budgetId] = bytes;
+    updateBudgetLocked();
+    return budgetId;
+  }
+
+  void removeBudget(size_t budgetId) {
+    std::scoped_lock lock(mBudgetsMutex);
+    if (mBudgets.erase(budgetId) > 0) {
+      updateBudgetLocked();
+    }
+  }
+
+  Layout::CacheStats getStats() {
+    Layout::CacheStats stats;
+    stats.hits = mHits.load(std::memory_order_relaxed);
+    stats.misses = mMisses.load(std::memory_order_relaxed);
+    stats.evictions = mEvictions.load(std::memory_order_relaxed);
+    stats.entries = mEntries.load(std::memory_order_relaxed);
+    stats.bytes = mBytes.load(std::memory_order_relaxed);
+    stats.budgetBytes = mBudgetBytes.load(std::memory_order_relaxed);
+    return stats;
+  }
+
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
+  struct Entry {
+    Entry(const LayoutCacheKey& k, std::shared_ptr<Layout> l, size_t b)
+        : key(k),
+          text(new uint16_t[k.textLength()]),
+          layout(std::move(l)),
+          bytes(b) {
+      memcpy(text.get(), k.text(), k.textLength() * sizeof(uint16_t));
+      key.setText(text.get());
+    }
+
+    LayoutCacheKey key;
+    std::unique_ptr<uint16_t[]> text;
+    std::shared_ptr<Layout> layout;
+    size_t bytes;
+  };
+
+  struct KeyHash {
+    size_t operator()(const LayoutCacheKey* key) const { return key->hash(); }
+  };
+
+  struct KeyEqual {
+    bool operator()(const LayoutCacheKey* a, const LayoutCacheKey* b) const {
+      return *a == *b;
+    }
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // Most recently used first.
+    std::list<Entry> entries;
+    // Keyed by the keys of |entries|, which are stable because list nodes
+    // never move.
+    std::unordered_map<const LayoutCacheKey*,
+                       std::list<Entry>::iterator,
+                       KeyHash,
+                       KeyEqual>
+        index;
+    size_t bytes = 0;
+    size_t budget = 0;
+  };
+
+  std::array<Shard, kShardCount> mShards;
+  std::atomic<uint64_t> mHits = 0;
+  std::atomic<uint64_t> mMisses = 0;
+  std::atomic<uint64_t> mEvictions = 0;
+  // The totals of all shards, so that getStats does not lock them.
+  std::atomic<size_t> mEntries = 0;
+  std::atomic<size_t> mBytes = 0;
+  std::atomic<size_t> mBudgetBytes = 0;
+
+  // The budgets requested by engines, by id.
+  std::mutex mBudgetsMutex;
+  std::map<size_t, size_t> mBudgets;
+  size_t mNextBudgetId = 1;
+
+  Shard& shardFor(const LayoutCacheKey& key) {
+    // The low bits pick the bucket within the shard's index, so use the high
+    // bits to pick the shard.
+    return mShards[(static_cast<uint32_t>(key.hash()) >> 28) % kShardCount];
   }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+  // An estimate of the memory held by an entry, including the text copy and
+  // the bookkeeping of the list and index.
+  static size_t entryBytes(const LayoutCacheKey& key, const Layout& layout) {
+    return sizeof(Entry) + sizeof(Layout) + 4 * sizeof(void*) +
+           key.textLength() * sizeof(uint16_t) +
+           layout.mGlyphs.capacity() * sizeof(LayoutGlyph) +
+           layout.mAdvances.capacity() * sizeof(float) +
+           layout.mFaces.capacity() * sizeof(FakedFont);
+  }
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+  // Applies the smallest of mBudgets. Called with mBudgetsMutex held.
+  void updateBudgetLocked() {
+    size_t bytes =
+        mBudgets.empty() ? kDefaultBudgetBytes : mBudgets.begin()->second;
+    for (const auto& budget : mBudgets) {
+      bytes = std::min(bytes, budget.second);
+    }
+    setBudget(bytes);
+  }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+  void setBudget(size_t bytes) {
+    for (Shard& shard : mShards) {
+      std::scoped_lock lock(shard.mutex);
+      shard.budget = bytes / kShardCount;
+      evictLocked(shard);
+    }
+    mBudgetBytes.store(bytes / kShardCount * kShardCount,
+                       std::memory_order_relaxed);
+  }
+
+  void evictLocked(Shard& shard) {
+    while (shard.bytes > shard.budget && !shard.entries.empty()) {
+      Entry& oldest = shard.entries.back();
+      shard.bytes -= oldest.bytes;
+      mEntries.fetch_sub(1, std::memory_order_relaxed);
+      mBytes.fetch_sub(oldest.bytes, std::memory_order_relaxed);
+      shard.index.erase(&oldest.key);
+      shard.entries.pop_back();
+      mEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+};
+
+// A HarfBuzz buffer is mutated while shaping, so every thread shapes into
+// its own.
+class ThreadHbBuffer {
+ public:
+  explicit ThreadHbBuffer(hb_unicode_funcs_t* unicodeFunctions)
+      : mBuffer(hb_buffer_create()) {
+    hb_buffer_set_unicode_funcs(mBuffer, unicodeFunctions);
+  }
+
+  ~ThreadHbBuffer() { hb_buffer_destroy(mBuffer); }
+
+  hb_buffer_t* get() const { return mBuffer; }
+
+ private:
+  hb_buffer_t* mBuffer;
 };
 
+FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<ThreadHbBuffer> tlsHbBuffer;
+
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
+    hb_unicode_funcs_make_immutable(unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
+  // Returns the calling thread's shaping buffer.
+  hb_buffer_t* getBuffer() {
+    ThreadHbBuffer* buffer = tlsHbBuffer.get();
+    if (buffer == nullptr) {
+      buffer = new ThreadHbBuffer(unicodeFunctions);
+      tlsHbBuffer.reset(buffer);
+    }
+    return buffer->get();
+  }
+
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
@@ -186,7 +368,10 @@ class LayoutEngine {
 };
 
 bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
-  return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
+  // The precomputed hash rejects almost all mismatches before the text is
+  // compared.
+  return mHash == other.mHash && mId == other.mId &&
+         mStart == other.mStart && mCount == other.mCount &&
          mStyle == other.mStyle && mSize == other.mSize &&
          mScaleX == other.mScaleX && mSkewX == other.mSkewX &&
          mLetterSpacing == other.mLetterSpacing &&
@@ -254,34 +439,31 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(false);
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(true);
+  return forColorBitmapFont ? hbFuncsForColorBitmap : hbFuncs;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -316,7 +498,11 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    // The cached font is shared with other threads, so the funcs and scale
+    // for this layout are set on a sub font that only this layout uses.
+    hb_font_t* parent = getHbFont(face.font);
+    hb_font_t* font = hb_font_create_sub_font(parent);
+    hb_font_destroy(parent);
     hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
                       &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
@@ -325,10 +511,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +771,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -612,8 +793,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -720,9 +899,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<Layout> layoutForWord = cache.get(key, ctx, collection);
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -748,7 +927,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,7 +1098,7 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = LayoutEngine::getInstance().getBuffer();
   std::vector<FontCollection::Run> items;
   collection->itemize(buf + start, count, ctx->style, &items);
 
@@ -1193,10 +1372,21 @@ void Layout::getBounds(MinikinRect* bounds) const {
 }
 
 void Layout::purgeCaches() {
-  std::scoped_lock _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
   layoutCache.clear();
-  purgeHbFontCacheLocked();
+  purgeHbFontCache();
+}
+
+size_t Layout::addCacheBudget(size_t bytes) {
+  return LayoutEngine::getInstance().layoutCache.addBudget(bytes);
+}
+
+void Layout::removeCacheBudget(size_t budgetId) {
+  LayoutEngine::getInstance().layoutCache.removeBudget(budgetId);
+}
+
+Layout::CacheStats Layout::getCacheStats() {
+  return LayoutEngine::getInstance().layoutCache.getStats();
 }
 
 }  // namespace minikin
@@ -117,7 +117,31 @@ class Layout {
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // Counters for the cache of shaped words shared by all layouts.
+  struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t budgetBytes = 0;
+  };
+
+  // Reads counters that are kept up to date as the cache changes, so this
+  // does not lock the cache.
+  static CacheStats getCacheStats();
+
+  // Asks that the cache of shaped words use at most |bytes| until the budget
+  // is removed, evicting the least recently used words if it is already over
+  // it. The cache is shared by every engine in the process, so the smallest
+  // budget in effect applies, or a default if there is none. Returns the id
+  // to pass to removeCacheBudget.
+  static size_t addCacheBudget(size_t bytes);
+
+  static void removeCacheBudget(size_t budgetId);
+
  private:
+  friend class LayoutCache;
   friend class LayoutCacheKey;
 
   // Find a face in the mFaces vector, or create a new entry
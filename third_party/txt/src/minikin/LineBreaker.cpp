@@ -74,6 +74,12 @@ void LineBreaker::setLocale() {
   mHyphenator = nullptr;
 }
 
+void LineBreaker::setHyphenator(Hyphenator* hyphenator,
+                                const icu::Locale& locale) {
+  mLocale = locale;
+  mHyphenator = hyphenator;
+}
+
 void LineBreaker::setText() {
   mWordBreaker.setText(mTextBuf.data(), mTextBuf.size());
 
@@ -102,6 +102,12 @@ class LineBreaker {
   // of the ICU break iterator can be reused.
   void setLocale();
 
+  // libtxt extension: hyphenates words with hyphenator, following the rules of
+  // locale, or stops hyphenating if hyphenator is null. Unlike setLocale, the
+  // word breaker keeps the default locale.
+  // Note: caller is responsible for managing lifetime of hyphenator
+  void setHyphenator(Hyphenator* hyphenator, const icu::Locale& locale);
+
   void resize(size_t size) {
     mTextBuf.resize(size);
     mCharWidths.resize(size);
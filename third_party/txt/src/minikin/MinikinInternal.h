@@ -19,22 +19,16 @@
 #ifndef MINIKIN_INTERNAL_H
 #define MINIKIN_INTERNAL_H
 
-#include <mutex>
-
 #include <hb.h>
 
 #include <minikin/MinikinFont.h>
 
 namespace minikin {
 
-// All external Minikin interfaces are designed to be thread-safe.
-// Presently, that's implemented by through a global lock, and having
-// all external interfaces take that lock.
-
-extern std::recursive_mutex gMinikinLock;
-
-// Aborts if gMinikinLock is not acquired. Do nothing on the release build.
-void assertMinikinLocked();
+// All external Minikin interfaces are designed to be thread-safe. The caches
+// shared between layouts guard themselves with their own locks, and HarfBuzz
+// state that is mutated during a layout is owned by the thread doing it, so
+// independent layouts can run concurrently.
 
 hb_blob_t* getFontTable(const MinikinFont* minikinFont, uint32_t tag);
 
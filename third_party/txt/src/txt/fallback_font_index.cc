@@ -0,0 +1,262 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "fallback_font_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace txt {
+namespace {
+
+// Identifies a saved index. Bump the version when the layout changes.
+constexpr uint32_t kMagic = 0x58494646;  // "FFIX"
+constexpr uint32_t kVersion = 2;
+
+// The family lists store family indexes as uint16_t.
+constexpr size_t kMaxFamilies = std::numeric_limits<uint16_t>::max();
+
+// Reads the values of a saved index, failing once it runs out of data. The
+// index is only read back on the device that saved it, so values are stored
+// in native byte order.
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    return ReadBytes(value, sizeof(T));
+  }
+
+  bool ReadBytes(void* value, size_t size) {
+    if (size > size_ - offset_) {
+      return false;
+    }
+    memcpy(value, data_ + offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool AtEnd() const { return offset_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+template <typename T>
+void Write(std::vector<uint8_t>* data, const T& value) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  data->insert(data->end(), bytes, bytes + sizeof(T));
+}
+
+}  // namespace
+
+FallbackFontIndex::FallbackFontIndex(uint64_t fingerprint)
+    : fingerprint_(fingerprint) {}
+
+FallbackFontIndex::FallbackFontIndex(uint64_t fingerprint,
+                                     const std::vector<Family>& families)
+    : fingerprint_(fingerprint) {
+  // Turn the coverage of each family into the points where it starts and
+  // stops covering code points, then sweep them in order.
+  struct Edge {
+    uint32_t position;
+    uint16_t family;
+    bool starts;
+  };
+  std::vector<Edge> edges;
+  for (size_t i = 0; i < families.size() && i < kMaxFamilies; ++i) {
+    family_names_.push_back(families[i].name);
+    const minikin::SparseBitSet& coverage = *families[i].coverage;
+    uint32_t start = coverage.nextSetBit(0);
+    while (start != minikin::SparseBitSet::kNotFound) {
+      uint32_t end = start + 1;
+      while (coverage.get(end)) {
+        end++;
+      }
+      edges.push_back({start, static_cast<uint16_t>(i), true});
+      edges.push_back({end, static_cast<uint16_t>(i), false});
+      start = coverage.nextSetBit(end);
+    }
+  }
+  std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+    return a.position < b.position;
+  });
+
+  // Ranges covered by the same families share their list.
+  std::map<std::vector<uint16_t>, uint32_t> list_starts;
+  std::vector<uint16_t> covering;
+  size_t edge = 0;
+  while (edge < edges.size()) {
+    const uint32_t start = edges[edge].position;
+    for (; edge < edges.size() && edges[edge].position == start; ++edge) {
+      auto position = std::lower_bound(covering.begin(), covering.end(),
+                                       edges[edge].family);
+      if (edges[edge].starts) {
+        covering.insert(position, edges[edge].family);
+      } else {
+        covering.erase(position);
+      }
+    }
+    if (covering.empty() || edge == edges.size()) {
+      continue;
+    }
+
+    auto list = list_starts.find(covering);
+    if (list == list_starts.end()) {
+      list = list_starts.emplace(covering, family_lists_.size()).first;
+      family_lists_.insert(family_lists_.end(), covering.begin(),
+                           covering.end());
+    }
+    const uint32_t end = edges[edge].position;
+    if (!ranges_.empty() && ranges_.back().end == start &&
+        ranges_.back().list_start == list->second) {
+      ranges_.back().end = end;
+    } else {
+      ranges_.push_back({start, end, list->second,
+                         static_cast<uint32_t>(covering.size())});
+    }
+  }
+}
+
+FallbackFontIndex::~FallbackFontIndex() = default;
+
+uint64_t FallbackFontIndex::ComputeFingerprint(
+    const std::vector<FamilyVersion>& families) {
+  // FNV-1a, which is stable across runs unlike std::hash.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto mix = [&hash](uint8_t byte) {
+    hash ^= byte;
+    hash *= 0x100000001b3ull;
+  };
+  auto mix_value = [&mix](uint64_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+      mix(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  };
+  for (const FamilyVersion& family : families) {
+    for (char c : family.name) {
+      mix(static_cast<uint8_t>(c));
+    }
+    // Separates the names so that moving characters between them changes the
+    // fingerprint.
+    mix(0);
+    mix_value(family.typeface_versions.size());
+    for (uint64_t version : family.typeface_versions) {
+      mix_value(version);
+    }
+  }
+  return hash;
+}
+
+std::unique_ptr<FallbackFontIndex> FallbackFontIndex::Deserialize(
+    const uint8_t* data,
+    size_t size,
+    uint64_t fingerprint) {
+  Reader reader(data, size);
+  uint32_t magic, version;
+  uint64_t saved_fingerprint;
+  if (!reader.Read(&magic) || magic != kMagic || !reader.Read(&version) ||
+      version != kVersion || !reader.Read(&saved_fingerprint) ||
+      saved_fingerprint != fingerprint) {
+    return nullptr;
+  }
+
+  std::unique_ptr<FallbackFontIndex> index(new FallbackFontIndex(fingerprint));
+  uint32_t family_count;
+  if (!reader.Read(&family_count) || family_count > kMaxFamilies) {
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < family_count; ++i) {
+    uint32_t name_size;
+    if (!reader.Read(&name_size) || name_size > size) {
+      return nullptr;
+    }
+    std::string name(name_size, '\0');
+    if (!reader.ReadBytes(name.data(), name_size)) {
+      return nullptr;
+    }
+    index->family_names_.push_back(std::move(name));
+  }
+
+  uint32_t list_size;
+  if (!reader.Read(&list_size) || list_size > size) {
+    return nullptr;
+  }
+  index->family_lists_.resize(list_size);
+  for (uint16_t& family : index->family_lists_) {
+    if (!reader.Read(&family) || family >= family_count) {
+      return nullptr;
+    }
+  }
+
+  uint32_t range_count;
+  if (!reader.Read(&range_count) || range_count > size) {
+    return nullptr;
+  }
+  index->ranges_.resize(range_count);
+  uint32_t previous_end = 0;
+  for (Range& range : index->ranges_) {
+    if (!reader.Read(&range) || range.start < previous_end ||
+        range.end <= range.start || range.list_size == 0 ||
+        range.list_start > list_size ||
+        range.list_size > list_size - range.list_start) {
+      return nullptr;
+    }
+    previous_end = range.end;
+  }
+
+  if (!reader.AtEnd()) {
+    return nullptr;
+  }
+  return index;
+}
+
+std::vector<uint8_t> FallbackFontIndex::Serialize() const {
+  std::vector<uint8_t> data;
+  Write(&data, kMagic);
+  Write(&data, kVersion);
+  Write(&data, fingerprint_);
+  Write(&data, static_cast<uint32_t>(family_names_.size()));
+  for (const std::string& name : family_names_) {
+    Write(&data, static_cast<uint32_t>(name.size()));
+    data.insert(data.end(), name.begin(), name.end());
+  }
+  Write(&data, static_cast<uint32_t>(family_lists_.size()));
+  for (uint16_t family : family_lists_) {
+    Write(&data, family);
+  }
+  Write(&data, static_cast<uint32_t>(ranges_.size()));
+  for (const Range& range : ranges_) {
+    Write(&data, range);
+  }
+  return data;
+}
+
+bool FallbackFontIndex::Find(uint32_t code_point, Match* match) const {
+  auto range = std::upper_bound(
+      ranges_.begin(), ranges_.end(), code_point,
+      [](uint32_t value, const Range& range) { return value < range.start; });
+  if (range == ranges_.begin()) {
+    return false;
+  }
+  --range;
+  if (code_point >= range->end) {
+    return false;
+  }
+  match->range = range - ranges_.begin();
+  match->families = family_lists_.data() + range->list_start;
+  match->family_count = range->list_size;
+  return true;
+}
+
+const std::string& FallbackFontIndex::GetFamilyName(uint16_t family) const {
+  return family_names_[family];
+}
+
+}  // namespace txt
@@ -0,0 +1,97 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_TXT_SRC_FALLBACK_FONT_INDEX_H_
+#define LIB_TXT_SRC_FALLBACK_FONT_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "minikin/SparseBitSet.h"
+
+namespace txt {
+
+// Maps ranges of code points to the installed font families that cover them.
+//
+// Building the index reads the character map of every installed family,
+// which is slow, so the index can be saved and loaded again on the next run.
+// The fingerprint identifies the installed families the index was built from,
+// down to the versions of their fonts, and an index saved for other families
+// or fonts is not loaded.
+class FallbackFontIndex {
+ public:
+  struct Family {
+    std::string name;
+    const minikin::SparseBitSet* coverage;
+  };
+
+  // The result of a lookup. Code points in the same range are covered by the
+  // same families.
+  struct Match {
+    size_t range;
+    // The indexes of the covering families, in the order they were given.
+    const uint16_t* families;
+    size_t family_count;
+  };
+
+  FallbackFontIndex(uint64_t fingerprint, const std::vector<Family>& families);
+
+  ~FallbackFontIndex();
+
+  // What the fingerprint is computed from for each installed family.
+  struct FamilyVersion {
+    std::string name;
+    // One value per typeface of the family that changes when its font is
+    // updated, such as a hash of its revision and checksum. An update that
+    // keeps the family names may still change what they cover.
+    std::vector<uint64_t> typeface_versions;
+  };
+
+  // Computes the fingerprint of the installed families.
+  static uint64_t ComputeFingerprint(
+      const std::vector<FamilyVersion>& families);
+
+  // Returns the index saved by Serialize(), or nullptr if the data is corrupt
+  // or was built from families with another fingerprint.
+  static std::unique_ptr<FallbackFontIndex> Deserialize(const uint8_t* data,
+                                                        size_t size,
+                                                        uint64_t fingerprint);
+
+  std::vector<uint8_t> Serialize() const;
+
+  // Finds the families that cover code_point. Returns false if no family
+  // covers it.
+  bool Find(uint32_t code_point, Match* match) const;
+
+  const std::string& GetFamilyName(uint16_t family) const;
+
+  size_t GetRangeCount() const { return ranges_.size(); }
+
+ private:
+  struct Range {
+    uint32_t start;
+    // Exclusive.
+    uint32_t end;
+    // The families covering the range are
+    // family_lists_[list_start, list_start + list_size).
+    uint32_t list_start;
+    uint32_t list_size;
+  };
+
+  uint64_t fingerprint_;
+  std::vector<std::string> family_names_;
+  // Sorted by start and never overlapping.
+  std::vector<Range> ranges_;
+  std::vector<uint16_t> family_lists_;
+
+  FallbackFontIndex(uint64_t fingerprint);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(FallbackFontIndex);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_FALLBACK_FONT_INDEX_H_
@@ -17,6 +17,7 @@
 #include "font_collection.h"
 
 #include <algorithm>
+#include <cstring>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -24,10 +25,13 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "font_skia.h"
 #include "minikin/Layout.h"
+#include "txt/hyphenation_patterns.h"
 #include "txt/platform.h"
 #include "txt/text_style.h"
 
@@ -37,6 +41,22 @@ namespace {
 
 const std::shared_ptr<minikin::FontFamily> g_null_family;
 
+constexpr char kFallbackFontIndexFileName[] = "fallback_font_index";
+
+// Identifies the version of the font of a typeface by the revision and
+// checksum in its 'head' table and by its glyph count, which are cheap to read
+// compared to its character map.
+uint64_t GetTypefaceVersion(const SkTypeface& typeface) {
+  // fontRevision and checkSumAdjustment follow the 4 byte table version.
+  uint8_t head[8] = {};
+  typeface.getTableData(SkSetFourByteTag('h', 'e', 'a', 'd'), 4, sizeof(head),
+                        head);
+  uint64_t version;
+  memcpy(&version, head, sizeof(version));
+  return version ^ (static_cast<uint64_t>(typeface.countGlyphs()) *
+                    0x9e3779b97f4a7c15ull);
+}
+
 }  // anonymous namespace
 
 FontCollection::FamilyKey::FamilyKey(const std::vector<std::string>& families,
@@ -98,11 +118,22 @@ size_t FontCollection::GetFontManagersCount() const {
 }
 
 void FontCollection::SetupDefaultFontManager() {
-  default_font_manager_ = GetDefaultFontManager();
+  sk_sp<SkFontMgr> font_manager = GetDefaultFontManager();
+  {
+    std::scoped_lock lock(mutex_);
+    default_font_manager_ = std::move(font_manager);
+    ResetFallbackFontIndex();
+  }
+  RequestFallbackFontIndex();
 }
 
 void FontCollection::SetDefaultFontManager(sk_sp<SkFontMgr> font_manager) {
-  default_font_manager_ = font_manager;
+  {
+    std::scoped_lock lock(mutex_);
+    default_font_manager_ = font_manager;
+    ResetFallbackFontIndex();
+  }
+  RequestFallbackFontIndex();
 
 #if FLUTTER_ENABLE_SKSHAPER
   skt_collection_.reset();
@@ -157,10 +188,29 @@ void FontCollection::DisableFontFallback() {
 #endif
 }
 
+void FontCollection::SetFallbackFontIndexDirectory(
+    std::string directory,
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  {
+    std::scoped_lock lock(mutex_);
+    fallback_font_index_directory_ = std::move(directory);
+    fallback_font_index_task_runner_ = std::move(task_runner);
+    ResetFallbackFontIndex();
+  }
+  RequestFallbackFontIndex();
+}
+
+void FontCollection::ResetFallbackFontIndex() {
+  fallback_font_index_.reset();
+  fallback_font_index_generation_++;
+  fallback_range_matches_.clear();
+}
+
 std::shared_ptr<minikin::FontCollection>
 FontCollection::GetMinikinFontCollectionForFamilies(
     const std::vector<std::string>& font_families,
     const std::string& locale) {
+  std::scoped_lock lock(mutex_);
   // Look inside the font collections cache first.
   FamilyKey family_key(font_families, locale);
   auto cached = font_collections_cache_.find(family_key);
@@ -314,9 +364,24 @@ std::shared_ptr<minikin::FontFamily> FontCollection::CreateMinikinFontFamily(
   return std::make_shared<minikin::FontFamily>(std::move(minikin_fonts));
 }
 
+void FontCollection::SetHyphenationPatternsDirectory(std::string directory) {
+  std::scoped_lock lock(mutex_);
+  hyphenation_patterns_directory_ = std::move(directory);
+}
+
+minikin::Hyphenator* FontCollection::GetHyphenator(const std::string& locale) {
+  std::string directory;
+  {
+    std::scoped_lock lock(mutex_);
+    directory = hyphenation_patterns_directory_;
+  }
+  return HyphenationPatterns::GetInstance().GetHyphenator(directory, locale);
+}
+
 const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     uint32_t ch,
     std::string locale) {
+  std::unique_lock lock(mutex_);
   // Check if the ch's matched font has been cached. We cache the results of
   // this method as repeated matchFamilyStyleCharacter calls can become
   // extremely laggy when typing a large number of complex emojis.
@@ -325,27 +390,23 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::MatchFallbackFont(
     return *lookup->second;
   }
   const std::shared_ptr<minikin::FontFamily>* match =
-      &DoMatchFallbackFont(ch, locale);
-  fallback_match_cache_.insert(std::make_pair(ch, match));
-  return *match;
+      &DoMatchFallbackFont(ch, locale, lock);
+  // Another thread may have matched ch while the lock was released, in which
+  // case its match is kept.
+  auto inserted = fallback_match_cache_.insert(std::make_pair(ch, match));
+  return *inserted.first->second;
 }
 
 const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
     uint32_t ch,
-    std::string locale) {
+    std::string locale,
+    std::unique_lock<std::mutex>& lock) {
   for (const sk_sp<SkFontMgr>& manager : GetFontManagerOrder()) {
-    std::vector<const char*> bcp47;
-    if (!locale.empty())
-      bcp47.push_back(locale.c_str());
-    sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
-        0, SkFontStyle(), bcp47.data(), bcp47.size(), ch));
-    if (!typeface)
+    std::string family_name =
+        MatchFallbackFamilyName(manager, ch, locale, lock);
+    if (family_name.empty())
       continue;
 
-    SkString sk_family_name;
-    typeface->getFamilyName(&sk_family_name);
-    std::string family_name(sk_family_name.c_str());
-
     if (std::find(fallback_fonts_for_locale_[locale].begin(),
                   fallback_fonts_for_locale_[locale].end(),
                   family_name) == fallback_fonts_for_locale_[locale].end())
@@ -356,6 +417,155 @@ const std::shared_ptr<minikin::FontFamily>& FontCollection::DoMatchFallbackFont(
   return g_null_family;
 }
 
+std::string FontCollection::MatchFallbackFamilyName(
+    const sk_sp<SkFontMgr>& manager,
+    uint32_t ch,
+    const std::string& locale,
+    std::unique_lock<std::mutex>& lock) {
+  const FallbackFontIndex* index =
+      manager == default_font_manager_ ? fallback_font_index_.get() : nullptr;
+  FallbackFontIndex::Match match = {};
+  // The index only has the named families of the manager. A character it does
+  // not cover is looked up in the manager, whose unnamed fallback families
+  // may cover it.
+  const bool indexed = index && index->Find(ch, &match);
+  if (indexed) {
+    std::string family_name;
+    if (match.family_count == 1) {
+      family_name = index->GetFamilyName(match.families[0]);
+    } else {
+      // The font manager picks between the families by their coverage and the
+      // locale, so its pick holds for the whole range.
+      auto& range_matches = fallback_range_matches_[locale];
+      auto found = range_matches.find(match.range);
+      if (found != range_matches.end())
+        family_name = found->second;
+    }
+    // A saved index may predate an update of the installed fonts, so the
+    // family it names must still have a glyph for the character.
+    if (!family_name.empty()) {
+      const std::shared_ptr<minikin::FontFamily>& family =
+          GetFallbackFontFamily(manager, family_name);
+      if (family && family->hasGlyph(ch, 0))
+        return family_name;
+    }
+  }
+
+  // Font managers are thread safe, and asking one for a character can take
+  // long enough to stall the other threads laying out paragraphs, so the
+  // lock is released meanwhile. The index may be replaced in the meantime
+  // and is not used afterwards.
+  lock.unlock();
+  std::vector<const char*> bcp47;
+  if (!locale.empty())
+    bcp47.push_back(locale.c_str());
+  sk_sp<SkTypeface> typeface(manager->matchFamilyStyleCharacter(
+      0, SkFontStyle(), bcp47.data(), bcp47.size(), ch));
+  std::string family_name;
+  if (typeface) {
+    SkString sk_family_name;
+    typeface->getFamilyName(&sk_family_name);
+    family_name = sk_family_name.c_str();
+  }
+  lock.lock();
+  if (indexed && match.family_count > 1)
+    fallback_range_matches_[locale][match.range] = family_name;
+  return family_name;
+}
+
+void FontCollection::RequestFallbackFontIndex() {
+  std::shared_ptr<fml::ConcurrentTaskRunner> task_runner;
+  sk_sp<SkFontMgr> manager;
+  std::string directory;
+  uint64_t generation;
+  {
+    std::scoped_lock lock(mutex_);
+    if (fallback_font_index_directory_.empty() ||
+        !fallback_font_index_task_runner_ || !default_font_manager_) {
+      return;
+    }
+    task_runner = fallback_font_index_task_runner_;
+    manager = default_font_manager_;
+    directory = fallback_font_index_directory_;
+    generation = fallback_font_index_generation_;
+  }
+
+  // Reading the coverage of every installed family takes long enough to drop
+  // frames, so it is kept off the layouts that need a fallback font.
+  task_runner->PostTask([weak_collection = weak_from_this(), manager,
+                         directory, generation]() {
+    std::shared_ptr<FontCollection> collection = weak_collection.lock();
+    if (!collection)
+      return;
+    std::unique_ptr<FallbackFontIndex> index =
+        collection->LoadFallbackFontIndex(manager, directory);
+    std::scoped_lock lock(collection->mutex_);
+    if (generation == collection->fallback_font_index_generation_)
+      collection->fallback_font_index_ = std::move(index);
+  });
+}
+
+std::unique_ptr<FallbackFontIndex> FontCollection::LoadFallbackFontIndex(
+    const sk_sp<SkFontMgr>& manager,
+    const std::string& directory_path) {
+  TRACE_EVENT0("flutter", "FontCollection::LoadFallbackFontIndex");
+
+  // The fingerprint covers the versions of the fonts as well as the family
+  // names, since an update of the installed fonts may keep the names but
+  // change what the families cover.
+  std::vector<FallbackFontIndex::FamilyVersion> families;
+  for (int i = 0; i < manager->countFamilies(); i++) {
+    SkString family_name;
+    manager->getFamilyName(i, &family_name);
+    FallbackFontIndex::FamilyVersion family{family_name.c_str(), {}};
+    sk_sp<SkFontStyleSet> style_set(manager->createStyleSet(i));
+    for (int j = 0; style_set && j < style_set->count(); j++) {
+      sk_sp<SkTypeface> typeface(style_set->createTypeface(j));
+      family.typeface_versions.push_back(
+          typeface ? GetTypefaceVersion(*typeface) : 0);
+    }
+    families.push_back(std::move(family));
+  }
+  const uint64_t fingerprint = FallbackFontIndex::ComputeFingerprint(families);
+
+  fml::UniqueFD directory = fml::OpenDirectory(
+      directory_path.c_str(), true, fml::FilePermission::kReadWrite);
+  if (!directory.is_valid()) {
+    FML_LOG(ERROR) << "Could not open the fallback font index directory "
+                   << directory_path;
+    return nullptr;
+  }
+  std::unique_ptr<fml::FileMapping> saved_index =
+      fml::FileMapping::CreateReadOnly(directory, kFallbackFontIndexFileName);
+  if (saved_index && saved_index->GetMapping() != nullptr) {
+    std::unique_ptr<FallbackFontIndex> index = FallbackFontIndex::Deserialize(
+        saved_index->GetMapping(), saved_index->GetSize(), fingerprint);
+    if (index)
+      return index;
+  }
+
+  // Read the coverage of every installed family. The families are only kept
+  // until the index is built.
+  TRACE_EVENT0("flutter", "FontCollection::BuildFallbackFontIndex");
+  std::vector<std::shared_ptr<minikin::FontFamily>> minikin_families;
+  std::vector<FallbackFontIndex::Family> coverage;
+  for (const FallbackFontIndex::FamilyVersion& family_version : families) {
+    std::shared_ptr<minikin::FontFamily> family =
+        CreateMinikinFontFamily(manager, family_version.name);
+    if (!family)
+      continue;
+    coverage.push_back({family_version.name, &family->getCoverage()});
+    minikin_families.push_back(std::move(family));
+  }
+  auto index = std::make_unique<FallbackFontIndex>(fingerprint, coverage);
+
+  fml::DataMapping data(index->Serialize());
+  if (!fml::WriteAtomically(directory, kFallbackFontIndexFileName, data)) {
+    FML_LOG(ERROR) << "Could not save the fallback font index.";
+  }
+  return index;
+}
+
 const std::shared_ptr<minikin::FontFamily>&
 FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
                                       const std::string& family_name) {
@@ -381,6 +591,7 @@ FontCollection::GetFallbackFontFamily(const sk_sp<SkFontMgr>& manager,
 }
 
 void FontCollection::ClearFontFamilyCache() {
+  std::scoped_lock lock(mutex_);
   font_collections_cache_.clear();
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -18,17 +18,21 @@
 #define LIB_TXT_SRC_FONT_COLLECTION_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "minikin/FontCollection.h"
 #include "minikin/FontFamily.h"
+#include "minikin/Hyphenator.h"
 #include "third_party/googletest/googletest/include/gtest/gtest_prod.h"  // nogncheck
 #include "third_party/skia/include/core/SkFontMgr.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "txt/asset_font_manager.h"
+#include "txt/fallback_font_index.h"
 #include "txt/text_style.h"
 
 #if FLUTTER_ENABLE_SKSHAPER
@@ -65,6 +69,25 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   // missing from the requested font family.
   void DisableFontFallback();
 
+  // Finds fallback fonts of the default font manager through an index of the
+  // code points each installed family covers, so that a new character only
+  // asks the font manager when several families cover it. The index is built
+  // on task_runner and saved in directory, from which later runs load it as
+  // long as the installed fonts have not changed. Lookups ask the font
+  // manager until the index is ready, and whenever a family the index names
+  // has no glyph for the character.
+  void SetFallbackFontIndexDirectory(
+      std::string directory,
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
+  // Hyphenates the paragraphs laid out with this collection with the pattern
+  // files in directory, or disables hyphenation if it is empty.
+  void SetHyphenationPatternsDirectory(std::string directory);
+
+  // Returns the hyphenator for the language of locale, or null if there are no
+  // patterns for it. See HyphenationPatterns.
+  minikin::Hyphenator* GetHyphenator(const std::string& locale);
+
   // Remove all entries in the font family cache.
   void ClearFontFamilyCache();
 
@@ -94,6 +117,10 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   sk_sp<SkFontMgr> asset_font_manager_;
   sk_sp<SkFontMgr> dynamic_font_manager_;
   sk_sp<SkFontMgr> test_font_manager_;
+  // Guards the caches below. Paragraphs sharing this collection may be laid
+  // out on several threads at once. The fallback font families are never
+  // removed, so references to them remain valid after the lock is released.
+  std::mutex mutex_;
   std::unordered_map<FamilyKey,
                      std::shared_ptr<minikin::FontCollection>,
                      FamilyKey::Hasher>
@@ -107,6 +134,17 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
   std::unordered_map<std::string, std::vector<std::string>>
       fallback_fonts_for_locale_;
   bool enable_font_fallback_;
+  std::string fallback_font_index_directory_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> fallback_font_index_task_runner_;
+  std::unique_ptr<FallbackFontIndex> fallback_font_index_;
+  // Counts the resets of the index, so that an index built for an earlier
+  // default font manager or directory is dropped.
+  uint64_t fallback_font_index_generation_ = 0;
+  std::string hyphenation_patterns_directory_;
+  // The family the default font manager picked for each range of the index
+  // that several families cover, by locale.
+  std::unordered_map<std::string, std::unordered_map<size_t, std::string>>
+      fallback_range_matches_;
 
 #if FLUTTER_ENABLE_SKSHAPER
   // An equivalent font collection usable by the Skia text shaper library.
@@ -114,10 +152,35 @@ class FontCollection : public std::enable_shared_from_this<FontCollection> {
 #endif
 
   // Performs the actual work of MatchFallbackFont. The result is cached in
-  // fallback_match_cache_.
+  // fallback_match_cache_. Called with lock held on mutex_, which is released
+  // while font managers are queried.
   const std::shared_ptr<minikin::FontFamily>& DoMatchFallbackFont(
       uint32_t ch,
-      std::string locale);
+      std::string locale,
+      std::unique_lock<std::mutex>& lock);
+
+  // Returns the name of the family manager picks for ch, or an empty string
+  // if it has none. Called with lock held on mutex_, which is released while
+  // manager is queried.
+  std::string MatchFallbackFamilyName(const sk_sp<SkFontMgr>& manager,
+                                      uint32_t ch,
+                                      const std::string& locale,
+                                      std::unique_lock<std::mutex>& lock);
+
+  // Posts a task that loads or builds the fallback font index, if it is
+  // enabled. Must not be called under mutex_, since a task posted to a
+  // concurrent loop that is gone runs on the calling thread.
+  void RequestFallbackFontIndex();
+
+  // Loads the fallback font index of manager saved in directory_path, or builds
+  // and saves it if there is none. This reads the coverage of every family of
+  // manager, so it is slow and never runs under mutex_.
+  std::unique_ptr<FallbackFontIndex> LoadFallbackFontIndex(
+      const sk_sp<SkFontMgr>& manager,
+      const std::string& directory_path);
+
+  // Drops the fallback font index. Called under mutex_.
+  void ResetFallbackFontIndex();
 
   std::vector<sk_sp<SkFontMgr>> GetFontManagerOrder() const;
 
@@ -0,0 +1,93 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "hyphenation_patterns.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+namespace {
+
+// The shortest word fragments left on either side of a hyphen.
+constexpr size_t kMinPrefix = 2;
+constexpr size_t kMinSuffix = 3;
+
+// Returns the names of the pattern files that may serve locale, from the most
+// specific to the language alone. For example "de_CH_1901" gives
+// hyph-de-ch-1901.hyb, hyph-de-ch.hyb and hyph-de.hyb.
+std::vector<std::string> GetPatternFileNames(const std::string& locale) {
+  std::string tag = locale;
+  std::replace(tag.begin(), tag.end(), '_', '-');
+  std::transform(tag.begin(), tag.end(), tag.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  std::vector<std::string> names;
+  while (!tag.empty()) {
+    names.push_back("hyph-" + tag + ".hyb");
+    size_t separator = tag.rfind('-');
+    tag.resize(separator == std::string::npos ? 0 : separator);
+  }
+  return names;
+}
+
+}  // namespace
+
+HyphenationPatterns& HyphenationPatterns::GetInstance() {
+  static HyphenationPatterns* instance = new HyphenationPatterns();
+  return *instance;
+}
+
+HyphenationPatterns::HyphenationPatterns() = default;
+
+HyphenationPatterns::~HyphenationPatterns() = default;
+
+minikin::Hyphenator* HyphenationPatterns::GetHyphenator(
+    const std::string& directory,
+    const std::string& locale) {
+  if (directory.empty()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::string& name : GetPatternFileNames(locale)) {
+    Patterns* patterns = GetPatterns(directory, name);
+    if (patterns) {
+      return patterns->hyphenator.get();
+    }
+  }
+  return nullptr;
+}
+
+HyphenationPatterns::Patterns* HyphenationPatterns::GetPatterns(
+    const std::string& directory,
+    const std::string& name) {
+  auto key = std::make_pair(directory, name);
+  auto found = patterns_.find(key);
+  if (found != patterns_.end()) {
+    return found->second.get();
+  }
+
+  TRACE_EVENT0("flutter", "HyphenationPatterns::GetPatterns");
+  std::unique_ptr<Patterns>& patterns = patterns_[std::move(key)];
+  fml::UniqueFD directory_fd = fml::OpenDirectory(
+      directory.c_str(), false, fml::FilePermission::kRead);
+  if (!directory_fd.is_valid()) {
+    return nullptr;
+  }
+  std::unique_ptr<fml::FileMapping> mapping =
+      fml::FileMapping::CreateReadOnly(directory_fd, name);
+  if (!mapping || !minikin::Hyphenator::isValidBinary(mapping->GetMapping(),
+                                                      mapping->GetSize())) {
+    return nullptr;
+  }
+  patterns = std::make_unique<Patterns>();
+  patterns->hyphenator.reset(minikin::Hyphenator::loadBinary(
+      mapping->GetMapping(), kMinPrefix, kMinSuffix));
+  patterns->mapping = std::move(mapping);
+  return patterns.get();
+}
+
+}  // namespace txt
@@ -0,0 +1,68 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+#define LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "minikin/Hyphenator.h"
+
+namespace txt {
+
+// The hyphenation patterns of every language, shared by every paragraph in the
+// process.
+//
+// Patterns are read from directories holding a hyb file per language, named
+// like hyph-en-us.hyb or hyph-de.hyb, in the hyb format read by
+// minikin::Hyphenator. A file is memory mapped the first time a paragraph in
+// its language is broken into lines, and the hyphenator reads the mapping in
+// place. Languages that are never used cost nothing, so startup time
+// and resident memory do not grow with the number of languages shipped.
+//
+// Each engine names its own directory through its font collection, and the
+// patterns of every directory are shared by the engines that name it.
+class HyphenationPatterns {
+ public:
+  static HyphenationPatterns& GetInstance();
+
+  // Returns the hyphenator for locale, such as "en_US" or "en-US", from the
+  // pattern files in directory, or null if there are no patterns for its
+  // language or directory is empty. The most specific file is used, falling
+  // back to the language alone. The hyphenator lives as long as the process.
+  minikin::Hyphenator* GetHyphenator(const std::string& directory,
+                                     const std::string& locale);
+
+ private:
+  struct Patterns {
+    std::unique_ptr<fml::FileMapping> mapping;
+    std::unique_ptr<minikin::Hyphenator> hyphenator;
+  };
+
+  std::mutex mutex_;
+  // The patterns loaded by directory and file name. Files that are missing or
+  // invalid map to null so they are only looked for once.
+  std::map<std::pair<std::string, std::string>, std::unique_ptr<Patterns>>
+      patterns_;
+
+  HyphenationPatterns();
+
+  ~HyphenationPatterns();
+
+  // Returns the patterns in the file with name in directory, loading them if
+  // needed.
+  Patterns* GetPatterns(const std::string& directory, const std::string& name);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(HyphenationPatterns);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_HYPHENATION_PATTERNS_H_
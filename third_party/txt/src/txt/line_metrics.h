@@ -34,6 +34,9 @@ class LineMetrics {
   size_t end_excluding_whitespace = 0;
   size_t end_including_newline = 0;
   bool hard_break = false;
+  // The minikin::HyphenEdit applied to the start and end of the line when it
+  // starts or ends inside a hyphenated word.
+  uint32_t hyphen_edit = 0;
 
   // The following fields are tracked after or during layout to provide to
   // the user as well as for computing bounding boxes.
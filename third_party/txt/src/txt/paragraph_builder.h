@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "paragraph.h"
@@ -79,6 +80,11 @@ class ParagraphBuilder {
   // to a SkCanvas.
   virtual std::unique_ptr<Paragraph> Build() = 0;
 
+  // Lets the paragraphs built from now on lay out long text on the workers of
+  // task_runner. Builders that cannot lay out concurrently ignore this.
+  virtual void SetLayoutTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {}
+
  protected:
   ParagraphBuilder() = default;
 
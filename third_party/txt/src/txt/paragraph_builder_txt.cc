@@ -78,8 +78,14 @@ std::unique_ptr<Paragraph> ParagraphBuilderTxt::Build() {
                                    std::move(obj_replacement_char_indexes_));
   paragraph->SetParagraphStyle(paragraph_style_);
   paragraph->SetFontCollection(font_collection_);
+  paragraph->SetLayoutTaskRunner(layout_task_runner_);
   SetParagraphStyle(paragraph_style_);
   return paragraph;
 }
 
+void ParagraphBuilderTxt::SetLayoutTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  layout_task_runner_ = std::move(task_runner);
+}
+
 }  // namespace txt
@@ -38,6 +38,8 @@ class ParagraphBuilderTxt : public ParagraphBuilder {
   virtual void AddText(const std::u16string& text) override;
   virtual void AddPlaceholder(PlaceholderRun& span) override;
   virtual std::unique_ptr<Paragraph> Build() override;
+  virtual void SetLayoutTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) override;
 
  private:
   std::vector<uint16_t> text_;
@@ -55,6 +57,7 @@ class ParagraphBuilderTxt : public ParagraphBuilder {
   StyledRuns runs_;
   ParagraphStyle paragraph_style_;
   size_t paragraph_style_index_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> layout_task_runner_;
 
   void SetParagraphStyle(const ParagraphStyle& style);
 
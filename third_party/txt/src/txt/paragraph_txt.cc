@@ -20,10 +20,12 @@
 #include <minikin/Layout.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <limits>
 #include <map>
 #include <numeric>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,6 +38,7 @@
 #include "minikin/LayoutUtils.h"
 #include "minikin/LineBreaker.h"
 #include "minikin/MinikinFont.h"
+#include "text_blob_cache.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkFont.h"
 #include "third_party/skia/include/core/SkFontMetrics.h"
@@ -51,6 +54,13 @@
 namespace txt {
 namespace {
 
+// Paragraphs with less text than this are always laid out on the calling
+// thread, as handing them to the worker pool costs more than it saves.
+constexpr size_t kMinParallelLayoutTextSize = 16 * 1024;
+
+// The fewest lines, or blocks of text between hard breaks, given to a worker.
+constexpr size_t kMinItemsPerParallelSegment = 16;
+
 class GlyphTypeface {
  public:
   GlyphTypeface(sk_sp<SkTypeface> typeface, minikin::FontFakery fakery)
@@ -205,6 +215,11 @@ void ParagraphTxt::GlyphPosition::Shift(double delta) {
 ParagraphTxt::GlyphLine::GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu)
     : positions(std::move(p)), total_code_units(tcu) {}
 
+void ParagraphTxt::GlyphLine::Shift(double delta) {
+  for (GlyphPosition& position : positions)
+    position.Shift(delta);
+}
+
 ParagraphTxt::CodeUnitRun::CodeUnitRun(std::vector<GlyphPosition>&& p,
                                        Range<size_t> cu,
                                        Range<double> x,
@@ -242,14 +257,41 @@ void ParagraphTxt::SetText(std::vector<uint16_t> text, StyledRuns runs) {
   runs_ = std::move(runs);
 }
 
+void ParagraphTxt::AppendText(const std::u16string& text) {
+  if (text.empty() || runs_.size() == 0)
+    return;
+  text_.insert(text_.end(), text.begin(), text.end());
+  runs_.EndRunIfNeeded(text_.size());
+  needs_layout_ = true;
+}
+
 void ParagraphTxt::SetInlinePlaceholders(
     std::vector<PlaceholderRun> inline_placeholders,
     std::unordered_set<size_t> obj_replacement_char_indexes) {
   needs_layout_ = true;
+  lines_reusable_ = false;
   inline_placeholders_ = std::move(inline_placeholders);
   obj_replacement_char_indexes_ = std::move(obj_replacement_char_indexes);
 }
 
+void ParagraphTxt::SetLayoutTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  layout_task_runner_ = std::move(task_runner);
+}
+
+size_t ParagraphTxt::GetParallelSegmentCount(size_t item_count) const {
+  // Placeholders are numbered from the start of the paragraph and ellipsized
+  // lines depend on the lines before them, so those paragraphs are laid out
+  // in order.
+  if (!layout_task_runner_ || text_.size() < kMinParallelLayoutTextSize ||
+      !inline_placeholders_.empty() || paragraph_style_.ellipsized()) {
+    return 1;
+  }
+  size_t max_segments = std::max(std::thread::hardware_concurrency(), 1u);
+  return std::clamp<size_t>(item_count / kMinItemsPerParallelSegment, 1,
+                            max_segments);
+}
+
 bool ParagraphTxt::ComputeLineBreaks() {
   line_metrics_.clear();
   line_widths_.clear();
@@ -266,119 +308,205 @@ bool ParagraphTxt::ComputeLineBreaks() {
   // Break at the end of the paragraph.
   newline_positions.push_back(text_.size());
 
-  // Calculate and add any breaks due to a line being too long.
+  // Hyphenate words if there are patterns for the language of the paragraph.
+  minikin::Hyphenator* hyphenator = nullptr;
+  icu::Locale hyphenation_locale;
+  if (!paragraph_style_.locale.empty()) {
+    hyphenator = font_collection_->GetHyphenator(paragraph_style_.locale);
+    if (hyphenator != nullptr) {
+      hyphenation_locale = icu::Locale(paragraph_style_.locale.c_str());
+    }
+  }
+
+  // Calculate and add any breaks due to a line being too long. Blocks of text
+  // between hard breaks are broken independently, so ranges of blocks can be
+  // broken on the worker pool and concatenated in order.
+  size_t block_count = newline_positions.size();
+  size_t segment_count = GetParallelSegmentCount(block_count);
+  if (segment_count > 1) {
+    struct Segment {
+      std::vector<LineMetrics> lines;
+      std::vector<double> widths;
+      double max_width = 0;
+      bool succeeded = false;
+    };
+    std::vector<Segment> segments(segment_count);
+    fml::RunConcurrently(layout_task_runner_, segment_count, [&](size_t index) {
+      size_t begin = block_count * index / segment_count;
+      size_t end = block_count * (index + 1) / segment_count;
+      // Skip the runs that end before the first block, as breaking the
+      // earlier blocks in order would have.
+      size_t run_index = 0;
+      if (begin > 0) {
+        while (run_index < runs_.size() &&
+               runs_.GetRun(run_index).end <= newline_positions[begin - 1]) {
+          ++run_index;
+        }
+      }
+      size_t inline_placeholder_index = 0;
+      minikin::LineBreaker breaker;
+      breaker.setLocale();
+      breaker.setHyphenator(hyphenator, hyphenation_locale);
+      Segment& segment = segments[index];
+      for (size_t newline_index = begin; newline_index < end;
+           ++newline_index) {
+        size_t block_start =
+            (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
+        if (!ComputeBlockLineBreaks(breaker, block_start,
+                                    newline_positions[newline_index],
+                                    run_index, inline_placeholder_index,
+                                    &segment.lines, &segment.widths,
+                                    &segment.max_width)) {
+          return;
+        }
+      }
+      segment.succeeded = true;
+    });
+    for (Segment& segment : segments) {
+      if (!segment.succeeded)
+        return false;
+      line_metrics_.insert(line_metrics_.end(),
+                           std::make_move_iterator(segment.lines.begin()),
+                           std::make_move_iterator(segment.lines.end()));
+      line_widths_.insert(line_widths_.end(), segment.widths.begin(),
+                          segment.widths.end());
+      max_intrinsic_width_ = std::max(max_intrinsic_width_, segment.max_width);
+    }
+    return true;
+  }
+
+  breaker_.setHyphenator(hyphenator, hyphenation_locale);
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
-  for (size_t newline_index = 0; newline_index < newline_positions.size();
+  for (size_t newline_index = 0; newline_index < block_count;
        ++newline_index) {
     size_t block_start =
         (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
-    size_t block_end = newline_positions[newline_index];
-    size_t block_size = block_end - block_start;
-
-    if (block_size == 0) {
-      line_metrics_.emplace_back(block_start, block_end, block_end,
-                                 block_end + 1, true);
-      line_widths_.push_back(0);
-      continue;
+    if (!ComputeBlockLineBreaks(breaker_, block_start,
+                                newline_positions[newline_index], run_index,
+                                inline_placeholder_index, &line_metrics_,
+                                &line_widths_, &max_intrinsic_width_)) {
+      return false;
     }
+  }
 
-    // Setup breaker. We wait to set the line width in order to account for the
-    // widths of the inline placeholders, which are calculated in the loop over
-    // the runs.
-    breaker_.setLineWidths(0.0f, 0, width_);
-    breaker_.setJustified(paragraph_style_.text_align == TextAlign::justify);
-    breaker_.setStrategy(paragraph_style_.break_strategy);
-    breaker_.resize(block_size);
-    memcpy(breaker_.buffer(), text_.data() + block_start,
-           block_size * sizeof(text_[0]));
-    breaker_.setText();
-
-    // Add the runs that include this line to the LineBreaker.
-    double block_total_width = 0;
-    while (run_index < runs_.size()) {
-      StyledRuns::Run run = runs_.GetRun(run_index);
-      if (run.start >= block_end)
-        break;
-      if (run.end < block_start) {
-        run_index++;
-        continue;
-      }
+  return true;
+}
 
-      minikin::FontStyle font;
-      minikin::MinikinPaint paint;
-      GetFontAndMinikinPaint(run.style, &font, &paint);
-      std::shared_ptr<minikin::FontCollection> collection =
-          GetMinikinFontCollectionForStyle(run.style);
-      if (collection == nullptr) {
-        FML_LOG(INFO) << "Could not find font collection for families \""
-                      << (run.style.font_families.empty()
-                              ? ""
-                              : run.style.font_families[0])
-                      << "\".";
-        return false;
-      }
-      size_t run_start = std::max(run.start, block_start) - block_start;
-      size_t run_end = std::min(run.end, block_end) - block_start;
-      bool isRtl = (paragraph_style_.text_direction == TextDirection::rtl);
-
-      // Check if the run is an object replacement character-only run. We should
-      // leave space for inline placeholder and break around it if appropriate.
-      if (run.end - run.start == 1 &&
-          obj_replacement_char_indexes_.count(run.start) != 0 &&
-          text_[run.start] == objReplacementChar &&
-          inline_placeholder_index < inline_placeholders_.size()) {
-        // Is a inline placeholder run.
-        PlaceholderRun placeholder_run =
-            inline_placeholders_[inline_placeholder_index];
-        block_total_width += placeholder_run.width;
-
-        // Inject custom width into minikin breaker. (Uses LibTxt-minikin
-        // patch).
-        breaker_.setCustomCharWidth(run_start, placeholder_run.width);
-
-        // Called with nullptr as paint in order to use the custom widths passed
-        // above.
-        breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
-                             isRtl);
-        inline_placeholder_index++;
-      } else {
-        // Is a regular text run.
-        double run_width = breaker_.addStyleRun(&paint, collection, font,
-                                                run_start, run_end, isRtl);
-        block_total_width += run_width;
-      }
+bool ParagraphTxt::ComputeBlockLineBreaks(minikin::LineBreaker& breaker,
+                                          size_t block_start,
+                                          size_t block_end,
+                                          size_t& run_index,
+                                          size_t& inline_placeholder_index,
+                                          std::vector<LineMetrics>* lines,
+                                          std::vector<double>* widths,
+                                          double* max_width) {
+  size_t block_size = block_end - block_start;
+
+  if (block_size == 0) {
+    lines->emplace_back(block_start, block_end, block_end, block_end + 1,
+                        true);
+    widths->push_back(0);
+    return true;
+  }
 
-      if (run.end > block_end)
-        break;
-      run_index++;
+  // Setup breaker. We wait to set the line width in order to account for the
+  // widths of the inline placeholders, which are calculated in the loop over
+  // the runs.
+  breaker.setLineWidths(0.0f, 0, width_);
+  breaker.setJustified(paragraph_style_.text_align == TextAlign::justify);
+  breaker.setStrategy(paragraph_style_.break_strategy);
+  breaker.resize(block_size);
+  memcpy(breaker.buffer(), text_.data() + block_start,
+         block_size * sizeof(text_[0]));
+  breaker.setText();
+
+  // Add the runs that include this line to the LineBreaker.
+  double block_total_width = 0;
+  while (run_index < runs_.size()) {
+    StyledRuns::Run run = runs_.GetRun(run_index);
+    if (run.start >= block_end)
+      break;
+    if (run.end < block_start) {
+      ++run_index;
+      continue;
     }
-    max_intrinsic_width_ = std::max(max_intrinsic_width_, block_total_width);
-
-    size_t breaks_count = breaker_.computeBreaks();
-    const int* breaks = breaker_.getBreaks();
-    for (size_t i = 0; i < breaks_count; ++i) {
-      size_t break_start = (i > 0) ? breaks[i - 1] : 0;
-      size_t line_start = break_start + block_start;
-      size_t line_end = breaks[i] + block_start;
-      bool hard_break = i == breaks_count - 1;
-      size_t line_end_including_newline =
-          (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
-      size_t line_end_excluding_whitespace = line_end;
-      while (
-          line_end_excluding_whitespace > line_start &&
-          minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
-        line_end_excluding_whitespace--;
-      }
-      line_metrics_.emplace_back(line_start, line_end,
-                                 line_end_excluding_whitespace,
-                                 line_end_including_newline, hard_break);
-      line_widths_.push_back(breaker_.getWidths()[i]);
+
+    minikin::FontStyle font;
+    minikin::MinikinPaint paint;
+    GetFontAndMinikinPaint(run.style, &font, &paint);
+    std::shared_ptr<minikin::FontCollection> collection =
+        GetMinikinFontCollectionForStyle(run.style);
+    if (collection == nullptr) {
+      FML_LOG(INFO) << "Could not find font collection for families \""
+                    << (run.style.font_families.empty()
+                            ? ""
+                            : run.style.font_families[0])
+                    << "\".";
+      return false;
+    }
+    size_t run_start = std::max(run.start, block_start) - block_start;
+    size_t run_end = std::min(run.end, block_end) - block_start;
+    bool isRtl = (paragraph_style_.text_direction == TextDirection::rtl);
+
+    // Check if the run is an object replacement character-only run. We should
+    // leave space for inline placeholder and break around it if appropriate.
+    if (run.end - run.start == 1 &&
+        obj_replacement_char_indexes_.count(run.start) != 0 &&
+        text_[run.start] == objReplacementChar &&
+        inline_placeholder_index < inline_placeholders_.size()) {
+      // Is a inline placeholder run.
+      PlaceholderRun placeholder_run =
+          inline_placeholders_[inline_placeholder_index];
+      block_total_width += placeholder_run.width;
+
+      // Inject custom width into minikin breaker. (Uses LibTxt-minikin
+      // patch).
+      breaker.setCustomCharWidth(run_start, placeholder_run.width);
+
+      // Called with nullptr as paint in order to use the custom widths passed
+      // above.
+      breaker.addStyleRun(nullptr, collection, font, run_start, run_end,
+                           isRtl);
+      ++inline_placeholder_index;
+    } else {
+      // Is a regular text run.
+      double run_width = breaker.addStyleRun(&paint, collection, font,
+                                              run_start, run_end, isRtl);
+      block_total_width += run_width;
     }
 
-    breaker_.finish();
+    if (run.end > block_end)
+      break;
+    ++run_index;
+  }
+  *max_width = std::max(*max_width, block_total_width);
+
+  size_t breaks_count = breaker.computeBreaks();
+  const int* breaks = breaker.getBreaks();
+  for (size_t i = 0; i < breaks_count; ++i) {
+    size_t break_start = (i > 0) ? breaks[i - 1] : 0;
+    size_t line_start = break_start + block_start;
+    size_t line_end = breaks[i] + block_start;
+    bool hard_break = i == breaks_count - 1;
+    size_t line_end_including_newline =
+        (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
+    size_t line_end_excluding_whitespace = line_end;
+    while (
+        line_end_excluding_whitespace > line_start &&
+        minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
+      line_end_excluding_whitespace--;
+    }
+    lines->emplace_back(line_start, line_end, line_end_excluding_whitespace,
+                        line_end_including_newline, hard_break);
+    lines->back().hyphen_edit =
+        breaker.getFlags()[i] & (minikin::HyphenEdit::MASK_START_OF_LINE |
+                                 minikin::HyphenEdit::MASK_END_OF_LINE);
+    widths->push_back(breaker.getWidths()[i]);
   }
 
+  breaker.finish();
+
   return true;
 }
 
@@ -670,33 +798,48 @@ void ParagraphTxt::Layout(double width) {
   if (!needs_layout_ && rounded_width == width_) {
     return;
   }
+  position_index_.reset();
+
+  // Justified lines are stretched to the width, so they can only be reused at
+  // the same width.
+  bool can_reuse_lines =
+      lines_reusable_ && (rounded_width == width_ ||
+                          paragraph_style_.text_align != TextAlign::justify);
+
+  // If every block of text fit on one line at the old width and still does at
+  // the new one, the breaks are unchanged and the lines only need aligning.
+  if (can_reuse_lines && !needs_layout_ &&
+      max_intrinsic_width_ <= std::min(width_, rounded_width)) {
+    width_ = rounded_width;
+    AlignLines(final_line_count_);
+    return;
+  }
 
+  bool width_changed = rounded_width != width_;
   width_ = rounded_width;
 
   needs_layout_ = false;
+  lines_reusable_ = false;
+
+  std::vector<LineMetrics> previous_line_metrics;
+  std::vector<BidiRun> previous_bidi_runs;
+  size_t previous_line_count = final_line_count_;
+  if (can_reuse_lines) {
+    previous_line_metrics.swap(line_metrics_);
+    previous_bidi_runs.swap(bidi_runs_);
+  }
+  bidi_runs_.clear();
 
-  records_.clear();
-  glyph_lines_.clear();
-  code_unit_runs_.clear();
-  inline_placeholder_code_unit_runs_.clear();
-  max_right_ = std::numeric_limits<double>::lowest();
-  min_left_ = std::numeric_limits<double>::max();
-  final_line_count_ = 0;
-
-  if (!ComputeLineBreaks())
-    return;
-
-  std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
+  if (!ComputeLineBreaks() || !ComputeBidiRuns(&bidi_runs_)) {
+    TruncateLines(0);
     return;
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
   font.setSubpixel(true);
   font.setHinting(SkFontHinting::kSlight);
 
-  minikin::Layout layout;
-  SkTextBlobBuilder builder;
   double y_offset = 0;
   double prev_max_descent = 0;
   double max_word_width = 0;
@@ -709,484 +852,757 @@ void ParagraphTxt::Layout(double width) {
       std::min(paragraph_style_.max_lines, line_metrics_.size());
   did_exceed_max_lines_ = (line_metrics_.size() > paragraph_style_.max_lines);
 
-  size_t placeholder_run_index = 0;
-  for (size_t line_number = 0; line_number < line_limit; ++line_number) {
-    LineMetrics& line_metrics = line_metrics_[line_number];
+  // Keep the lines of the previous layout that did not change and continue
+  // from the first one that did.
+  size_t reused_line_count = 0;
+  if (can_reuse_lines) {
+    reused_line_count =
+        CountReusableLines(previous_line_metrics, previous_line_count,
+                           line_limit, previous_bidi_runs);
+    for (size_t i = 0; i < reused_line_count; ++i) {
+      line_metrics_[i] = std::move(previous_line_metrics[i]);
+    }
+  }
+  TruncateLines(reused_line_count);
+  if (width_changed) {
+    AlignLines(reused_line_count);
+  }
+  if (reused_line_count > 0) {
+    const LineState& state = line_states_[reused_line_count - 1];
+    y_offset = state.y_offset;
+    prev_max_descent = line_metrics_[reused_line_count - 1].descent;
+    max_word_width = state.max_word_width;
+  }
 
-    // Break the line into words if justification should be applied.
-    std::vector<Range<size_t>> words;
-    double word_gap_width = 0;
-    size_t word_index = 0;
-    bool justify_line =
-        (paragraph_style_.text_align == TextAlign::justify &&
-         line_number != line_limit - 1 && !line_metrics.hard_break);
-    FindWords(text_, line_metrics.start_index, line_metrics.end_index, &words);
-    if (justify_line) {
-      if (words.size() > 1) {
-        word_gap_width =
-            (width_ - line_widths_[line_number]) / (words.size() - 1);
+  size_t line_count = line_limit - reused_line_count;
+  size_t segment_count = GetParallelSegmentCount(line_count);
+  if (segment_count > 1) {
+    // Lay out ranges of lines on the worker pool, then place them one below
+    // the other in order.
+    std::vector<LineLayout> lines(line_count);
+    std::unique_ptr<bool[]> laid_out(new bool[line_count]());
+    fml::RunConcurrently(
+        layout_task_runner_, segment_count, [&](size_t segment) {
+          size_t begin = line_count * segment / segment_count;
+          size_t end = line_count * (segment + 1) / segment_count;
+          SkFont segment_font = font;
+          minikin::Layout segment_layout;
+          size_t segment_line_limit = line_limit;
+          size_t segment_placeholder_run_index = 0;
+          for (size_t i = begin; i < end; ++i) {
+            if (!LayoutLine(reused_line_count + i, segment_line_limit,
+                            segment_placeholder_run_index, segment_font,
+                            segment_layout, &lines[i])) {
+              return;
+            }
+            laid_out[i] = true;
+          }
+        });
+    for (size_t i = 0; i < line_count; ++i) {
+      if (!laid_out[i])
+        return;
+      AddLine(reused_line_count + i, lines[i], y_offset, prev_max_descent,
+              max_word_width);
+    }
+  } else {
+    minikin::Layout layout;
+    size_t placeholder_run_index = 0;
+    for (size_t line_number = reused_line_count; line_number < line_limit;
+         ++line_number) {
+      LineLayout line;
+      if (!LayoutLine(line_number, line_limit, placeholder_run_index, font,
+                      layout, &line)) {
+        return;
       }
+      AddLine(line_number, line, y_offset, prev_max_descent, max_word_width);
     }
+  }
 
-    // Exclude trailing whitespace from justified lines so the last visible
-    // character in the line will be flush with the right margin.
-    size_t line_end_index =
-        (paragraph_style_.effective_align() == TextAlign::right ||
-         paragraph_style_.effective_align() == TextAlign::center ||
-         paragraph_style_.effective_align() == TextAlign::justify)
-            ? line_metrics.end_excluding_whitespace
-            : line_metrics.end_index;
-
-    // Find the runs comprising this line.
-    std::vector<BidiRun> line_runs;
-    for (const BidiRun& bidi_run : bidi_runs) {
-      // A "ghost" run is a run that does not impact the layout, breaking,
-      // alignment, width, etc but is still "visible" through getRectsForRange.
-      // For example, trailing whitespace on centered text can be scrolled
-      // through with the caret but will not wrap the line.
-      //
-      // Here, we add an additional run for the whitespace, but dont
-      // let it impact metrics. After layout of the whitespace run, we do not
-      // add its width into the x-offset adjustment, effectively nullifying its
-      // impact on the layout.
-      std::unique_ptr<BidiRun> ghost_run = nullptr;
-      if (paragraph_style_.ellipsis.empty() &&
-          line_metrics.end_excluding_whitespace < line_metrics.end_index &&
-          bidi_run.start() <= line_metrics.end_index &&
-          bidi_run.end() > line_end_index) {
-        ghost_run = std::make_unique<BidiRun>(
-            std::max(bidi_run.start(), line_end_index),
-            std::min(bidi_run.end(), line_metrics.end_index),
-            bidi_run.direction(), bidi_run.style(), true);
-      }
-      // Include the ghost run before normal run if RTL
-      if (bidi_run.direction() == TextDirection::rtl && ghost_run != nullptr) {
-        line_runs.push_back(*ghost_run);
-      }
-      // Emplace a normal line run.
-      if (bidi_run.start() < line_end_index &&
-          bidi_run.end() > line_metrics.start_index) {
-        // The run is a placeholder run.
-        if (bidi_run.size() == 1 &&
-            text_[bidi_run.start()] == objReplacementChar &&
-            obj_replacement_char_indexes_.count(bidi_run.start()) != 0 &&
-            placeholder_run_index < inline_placeholders_.size()) {
-          line_runs.emplace_back(
-              std::max(bidi_run.start(), line_metrics.start_index),
-              std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
-              bidi_run.style(), inline_placeholders_[placeholder_run_index]);
-          placeholder_run_index++;
-        } else {
-          line_runs.emplace_back(
-              std::max(bidi_run.start(), line_metrics.start_index),
-              std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
-              bidi_run.style());
-        }
-      }
-      // Include the ghost run after normal run if LTR
-      if (bidi_run.direction() == TextDirection::ltr && ghost_run != nullptr) {
-        line_runs.push_back(*ghost_run);
+  if (paragraph_style_.max_lines == 1 ||
+      (paragraph_style_.unlimited_lines() && paragraph_style_.ellipsized())) {
+    min_intrinsic_width_ = max_intrinsic_width_;
+  } else {
+    min_intrinsic_width_ = std::min(max_word_width, max_intrinsic_width_);
+  }
+
+  std::sort(code_unit_runs_.begin(), code_unit_runs_.end(),
+            [](const CodeUnitRun& a, const CodeUnitRun& b) {
+              return a.code_units.start < b.code_units.start;
+            });
+
+  longest_line_ = max_right_ - min_left_;
+
+  // Placeholders are counted from the start of the paragraph and ellipsized
+  // lines depend on the lines after them, so neither can be reused.
+  lines_reusable_ =
+      inline_placeholders_.empty() && !paragraph_style_.ellipsized();
+}
+
+size_t ParagraphTxt::CountReusableLines(
+    const std::vector<LineMetrics>& previous_lines,
+    size_t previous_line_count,
+    size_t line_limit,
+    const std::vector<BidiRun>& previous_bidi_runs) {
+  size_t count = 0;
+  size_t max_count =
+      std::min({previous_line_count, line_limit, previous_lines.size()});
+  while (count < max_count) {
+    const LineMetrics& previous = previous_lines[count];
+    const LineMetrics& current = line_metrics_[count];
+    if (previous.start_index != current.start_index ||
+        previous.end_index != current.end_index ||
+        previous.end_excluding_whitespace !=
+            current.end_excluding_whitespace ||
+        previous.end_including_newline != current.end_including_newline ||
+        previous.hard_break != current.hard_break ||
+        previous.hyphen_edit != current.hyphen_edit) {
+      break;
+    }
+    count++;
+  }
+
+  // The metrics of the last line depend on it being last.
+  if (count > 0 && (count == previous_line_count) != (count == line_limit)) {
+    count--;
+  }
+
+  // Appended text can change the direction of neutral characters before it,
+  // so the runs covering the reused lines must be unchanged too. Runs may
+  // only grow past the end of the reused lines.
+  size_t reused_end = count < line_metrics_.size()
+                          ? line_metrics_[count].start_index
+                          : text_.size();
+  size_t run_index = 0;
+  for (; run_index < previous_bidi_runs.size() &&
+         previous_bidi_runs[run_index].start() < reused_end;
+       ++run_index) {
+    if (run_index >= bidi_runs_.size())
+      return 0;
+    const BidiRun& previous = previous_bidi_runs[run_index];
+    const BidiRun& current = bidi_runs_[run_index];
+    if (previous.start() != current.start() ||
+        std::min(previous.end(), reused_end + 1) !=
+            std::min(current.end(), reused_end + 1) ||
+        previous.direction() != current.direction() ||
+        &previous.style() != &current.style()) {
+      return 0;
+    }
+  }
+  if (run_index < bidi_runs_.size() &&
+      bidi_runs_[run_index].start() < reused_end) {
+    return 0;
+  }
+
+  return count;
+}
+
+void ParagraphTxt::TruncateLines(size_t line_count) {
+  auto past_line = [line_count](size_t line_number) {
+    return line_number >= line_count;
+  };
+  records_.erase(std::remove_if(records_.begin(), records_.end(),
+                                [&](const PaintRecord& record) {
+                                  return past_line(record.line());
+                                }),
+                 records_.end());
+  auto past_run = [&](const CodeUnitRun& run) {
+    return past_line(run.line_number);
+  };
+  code_unit_runs_.erase(std::remove_if(code_unit_runs_.begin(),
+                                       code_unit_runs_.end(), past_run),
+                        code_unit_runs_.end());
+  inline_placeholder_code_unit_runs_.erase(
+      std::remove_if(inline_placeholder_code_unit_runs_.begin(),
+                     inline_placeholder_code_unit_runs_.end(), past_run),
+      inline_placeholder_code_unit_runs_.end());
+  glyph_lines_.erase(glyph_lines_.begin() + line_count, glyph_lines_.end());
+  line_states_.erase(line_states_.begin() + line_count, line_states_.end());
+
+  if (line_count == 0) {
+    max_right_ = std::numeric_limits<double>::lowest();
+    min_left_ = std::numeric_limits<double>::max();
+  } else {
+    max_right_ = line_states_.back().max_right;
+    min_left_ = line_states_.back().min_left;
+  }
+  final_line_count_ = line_count;
+}
+
+const ParagraphTxt::PositionIndex& ParagraphTxt::GetPositionIndex() {
+  if (position_index_) {
+    return *position_index_;
+  }
+  position_index_ = std::make_unique<PositionIndex>();
+  PositionIndex& index = *position_index_;
+
+  index.run_end_prefix_max.reserve(code_unit_runs_.size());
+  index.line_runs.resize(final_line_count_);
+  size_t max_end = 0;
+  for (size_t i = 0; i < code_unit_runs_.size(); ++i) {
+    const CodeUnitRun& run = code_unit_runs_[i];
+    max_end = std::max(max_end, run.code_units.end);
+    index.run_end_prefix_max.push_back(max_end);
+    if (run.line_number < index.line_runs.size()) {
+      index.line_runs[run.line_number].push_back(i);
+    }
+  }
+
+  index.glyph_line_starts.reserve(glyph_lines_.size());
+  size_t line_start = 0;
+  for (const GlyphLine& line : glyph_lines_) {
+    index.glyph_line_starts.push_back(line_start);
+    line_start += line.total_code_units;
+  }
+  return index;
+}
+
+size_t ParagraphTxt::FindFirstRunReaching(const PositionIndex& index,
+                                          size_t code_unit) {
+  return std::lower_bound(index.run_end_prefix_max.begin(),
+                          index.run_end_prefix_max.end(), code_unit) -
+         index.run_end_prefix_max.begin();
+}
+
+void ParagraphTxt::AlignLines(size_t line_count) {
+  std::vector<double> deltas(line_count);
+  for (size_t line_number = 0; line_number < line_count; ++line_number) {
+    LineMetrics& line_metrics = line_metrics_[line_number];
+    double left = GetLineXOffset(line_states_[line_number].advance, false);
+    deltas[line_number] = left - line_metrics.left;
+    line_metrics.left = left;
+    glyph_lines_[line_number].Shift(deltas[line_number]);
+  }
+
+  for (PaintRecord& record : records_) {
+    if (record.line() < line_count) {
+      record.SetOffset(SkPoint::Make(
+          record.offset().x() + deltas[record.line()], record.offset().y()));
+    }
+  }
+  for (CodeUnitRun& run : code_unit_runs_) {
+    if (run.line_number < line_count) {
+      run.Shift(deltas[run.line_number]);
+    }
+  }
+  for (CodeUnitRun& run : inline_placeholder_code_unit_runs_) {
+    if (run.line_number < line_count) {
+      run.Shift(deltas[run.line_number]);
+    }
+  }
+}
+
+bool ParagraphTxt::LayoutLine(size_t line_number,
+                              size_t& line_limit,
+                              size_t& placeholder_run_index,
+                              SkFont& font,
+                              minikin::Layout& layout,
+                              LineLayout* result) {
+  LineMetrics& line_metrics = line_metrics_[line_number];
+
+  // The glyphs of the text blob being built and their x and y positions.
+  std::vector<SkGlyphID> blob_glyphs;
+  std::vector<SkScalar> blob_positions;
+
+  // Break the line into words if justification should be applied.
+  std::vector<Range<size_t>> words;
+  double word_gap_width = 0;
+  size_t word_index = 0;
+  bool justify_line =
+      (paragraph_style_.text_align == TextAlign::justify &&
+       line_number != line_limit - 1 && !line_metrics.hard_break);
+  FindWords(text_, line_metrics.start_index, line_metrics.end_index, &words);
+  if (justify_line) {
+    if (words.size() > 1) {
+      word_gap_width =
+          (width_ - line_widths_[line_number]) / (words.size() - 1);
+    }
+  }
+
+  // Exclude trailing whitespace from justified lines so the last visible
+  // character in the line will be flush with the right margin.
+  size_t line_end_index =
+      (paragraph_style_.effective_align() == TextAlign::right ||
+       paragraph_style_.effective_align() == TextAlign::center ||
+       paragraph_style_.effective_align() == TextAlign::justify)
+          ? line_metrics.end_excluding_whitespace
+          : line_metrics.end_index;
+
+  // Find the runs comprising this line.
+  std::vector<BidiRun> line_runs;
+  for (const BidiRun& bidi_run : bidi_runs_) {
+    // A "ghost" run is a run that does not impact the layout, breaking,
+    // alignment, width, etc but is still "visible" through getRectsForRange.
+    // For example, trailing whitespace on centered text can be scrolled
+    // through with the caret but will not wrap the line.
+    //
+    // Here, we add an additional run for the whitespace, but dont
+    // let it impact metrics. After layout of the whitespace run, we do not
+    // add its width into the x-offset adjustment, effectively nullifying its
+    // impact on the layout.
+    std::unique_ptr<BidiRun> ghost_run = nullptr;
+    if (paragraph_style_.ellipsis.empty() &&
+        line_metrics.end_excluding_whitespace < line_metrics.end_index &&
+        bidi_run.start() <= line_metrics.end_index &&
+        bidi_run.end() > line_end_index) {
+      ghost_run = std::make_unique<BidiRun>(
+          std::max(bidi_run.start(), line_end_index),
+          std::min(bidi_run.end(), line_metrics.end_index),
+          bidi_run.direction(), bidi_run.style(), true);
+    }
+    // Include the ghost run before normal run if RTL
+    if (bidi_run.direction() == TextDirection::rtl && ghost_run != nullptr) {
+      line_runs.push_back(*ghost_run);
+    }
+    // Emplace a normal line run.
+    if (bidi_run.start() < line_end_index &&
+        bidi_run.end() > line_metrics.start_index) {
+      // The run is a placeholder run.
+      if (bidi_run.size() == 1 &&
+          text_[bidi_run.start()] == objReplacementChar &&
+          obj_replacement_char_indexes_.count(bidi_run.start()) != 0 &&
+          placeholder_run_index < inline_placeholders_.size()) {
+        line_runs.emplace_back(
+            std::max(bidi_run.start(), line_metrics.start_index),
+            std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
+            bidi_run.style(), inline_placeholders_[placeholder_run_index]);
+        placeholder_run_index++;
+      } else {
+        line_runs.emplace_back(
+            std::max(bidi_run.start(), line_metrics.start_index),
+            std::min(bidi_run.end(), line_end_index), bidi_run.direction(),
+            bidi_run.style());
       }
     }
-    bool line_runs_all_rtl =
-        line_runs.size() &&
-        std::accumulate(
-            line_runs.begin(), line_runs.end(), true,
-            [](const bool a, const BidiRun& b) { return a && b.is_rtl(); });
-    if (line_runs_all_rtl) {
-      std::reverse(words.begin(), words.end());
+    // Include the ghost run after normal run if LTR
+    if (bidi_run.direction() == TextDirection::ltr && ghost_run != nullptr) {
+      line_runs.push_back(*ghost_run);
     }
+  }
+  bool line_runs_all_rtl =
+      line_runs.size() &&
+      std::accumulate(
+          line_runs.begin(), line_runs.end(), true,
+          [](const bool a, const BidiRun& b) { return a && b.is_rtl(); });
+  if (line_runs_all_rtl) {
+    std::reverse(words.begin(), words.end());
+  }
 
-    std::vector<GlyphPosition> line_glyph_positions;
-    std::vector<CodeUnitRun> line_code_unit_runs;
-    std::vector<CodeUnitRun> line_inline_placeholder_code_unit_runs;
-
-    double run_x_offset = 0;
-    double justify_x_offset = 0;
-    std::vector<PaintRecord> paint_records;
-
-    for (auto line_run_it = line_runs.begin(); line_run_it != line_runs.end();
-         ++line_run_it) {
-      const BidiRun& run = *line_run_it;
-      minikin::FontStyle minikin_font;
-      minikin::MinikinPaint minikin_paint;
-      GetFontAndMinikinPaint(run.style(), &minikin_font, &minikin_paint);
-      font.setSize(run.style().font_size);
-
-      std::shared_ptr<minikin::FontCollection> minikin_font_collection =
-          GetMinikinFontCollectionForStyle(run.style());
-      if (!minikin_font_collection) {
-        return;
+  std::vector<GlyphPosition>& line_glyph_positions = result->glyph_positions;
+  std::vector<CodeUnitRun>& line_code_unit_runs = result->code_unit_runs;
+  std::vector<CodeUnitRun>& line_inline_placeholder_code_unit_runs =
+      result->inline_placeholder_code_unit_runs;
+
+  double run_x_offset = 0;
+  double justify_x_offset = 0;
+  std::vector<PaintRecord>& paint_records = result->paint_records;
+
+  for (auto line_run_it = line_runs.begin(); line_run_it != line_runs.end();
+       ++line_run_it) {
+    const BidiRun& run = *line_run_it;
+    minikin::FontStyle minikin_font;
+    minikin::MinikinPaint minikin_paint;
+    GetFontAndMinikinPaint(run.style(), &minikin_font, &minikin_paint);
+    font.setSize(run.style().font_size);
+
+    std::shared_ptr<minikin::FontCollection> minikin_font_collection =
+        GetMinikinFontCollectionForStyle(run.style());
+    if (!minikin_font_collection) {
+      return false;
+    }
+
+    // Lay out this run.
+    uint16_t* text_ptr = text_.data();
+    size_t text_start = run.start();
+    size_t text_count = run.end() - run.start();
+    size_t text_size = text_.size();
+
+    // Apply ellipsizing if the run was not completely laid out and this
+    // is the last line (or lines are unlimited).
+    const std::u16string& ellipsis = paragraph_style_.ellipsis;
+    std::vector<uint16_t> ellipsized_text;
+    if (ellipsis.length() && !isinf(width_) && !line_metrics.hard_break &&
+        line_run_it == line_runs.end() - 1 &&
+        (line_number == line_limit - 1 || paragraph_style_.unlimited_lines())) {
+      float ellipsis_width = layout.measureText(
+          reinterpret_cast<const uint16_t*>(ellipsis.data()), 0,
+          ellipsis.length(), ellipsis.length(), run.is_rtl(), minikin_font,
+          minikin_paint, minikin_font_collection, nullptr);
+
+      std::vector<float> text_advances(text_count);
+      float text_width =
+          layout.measureText(text_ptr, text_start, text_count, text_.size(),
+                             run.is_rtl(), minikin_font, minikin_paint,
+                             minikin_font_collection, text_advances.data());
+
+      // Truncate characters from the text until the ellipsis fits.
+      size_t truncate_count = 0;
+      while (truncate_count < text_count &&
+             run_x_offset + text_width + ellipsis_width > width_) {
+        text_width -= text_advances[text_count - truncate_count - 1];
+        truncate_count++;
       }
 
-      // Lay out this run.
-      uint16_t* text_ptr = text_.data();
-      size_t text_start = run.start();
-      size_t text_count = run.end() - run.start();
-      size_t text_size = text_.size();
-
-      // Apply ellipsizing if the run was not completely laid out and this
-      // is the last line (or lines are unlimited).
-      const std::u16string& ellipsis = paragraph_style_.ellipsis;
-      std::vector<uint16_t> ellipsized_text;
-      if (ellipsis.length() && !isinf(width_) && !line_metrics.hard_break &&
-          line_run_it == line_runs.end() - 1 &&
-          (line_number == line_limit - 1 ||
-           paragraph_style_.unlimited_lines())) {
-        float ellipsis_width = layout.measureText(
-            reinterpret_cast<const uint16_t*>(ellipsis.data()), 0,
-            ellipsis.length(), ellipsis.length(), run.is_rtl(), minikin_font,
-            minikin_paint, minikin_font_collection, nullptr);
-
-        std::vector<float> text_advances(text_count);
-        float text_width =
-            layout.measureText(text_ptr, text_start, text_count, text_.size(),
-                               run.is_rtl(), minikin_font, minikin_paint,
-                               minikin_font_collection, text_advances.data());
-
-        // Truncate characters from the text until the ellipsis fits.
-        size_t truncate_count = 0;
-        while (truncate_count < text_count &&
-               run_x_offset + text_width + ellipsis_width > width_) {
-          text_width -= text_advances[text_count - truncate_count - 1];
-          truncate_count++;
-        }
+      ellipsized_text.reserve(text_count - truncate_count + ellipsis.length());
+      ellipsized_text.insert(ellipsized_text.begin(),
+                             text_.begin() + run.start(),
+                             text_.begin() + run.end() - truncate_count);
+      ellipsized_text.insert(ellipsized_text.end(), ellipsis.begin(),
+                             ellipsis.end());
+      text_ptr = ellipsized_text.data();
+      text_start = 0;
+      text_count = ellipsized_text.size();
+      text_size = text_count;
+
+      // If there is no line limit, then skip all lines after the ellipsized
+      // line.
+      if (paragraph_style_.unlimited_lines()) {
+        line_limit = line_number + 1;
+        did_exceed_max_lines_ = true;
+      }
+    }
 
-        ellipsized_text.reserve(text_count - truncate_count +
-                                ellipsis.length());
-        ellipsized_text.insert(ellipsized_text.begin(),
-                               text_.begin() + run.start(),
-                               text_.begin() + run.end() - truncate_count);
-        ellipsized_text.insert(ellipsized_text.end(), ellipsis.begin(),
-                               ellipsis.end());
-        text_ptr = ellipsized_text.data();
-        text_start = 0;
-        text_count = ellipsized_text.size();
-        text_size = text_count;
-
-        // If there is no line limit, then skip all lines after the ellipsized
-        // line.
-        if (paragraph_style_.unlimited_lines()) {
-          line_limit = line_number + 1;
-          did_exceed_max_lines_ = true;
-        }
+    // Draw the hyphens of a line broken inside a word with the runs at the
+    // ends of the line.
+    if (line_metrics.hyphen_edit != minikin::HyphenEdit::NO_EDIT &&
+        !run.is_ghost() && ellipsized_text.empty()) {
+      uint32_t hyphen_edit = minikin::HyphenEdit::NO_EDIT;
+      if (run.start() == line_metrics.start_index) {
+        hyphen_edit |= line_metrics.hyphen_edit &
+                       minikin::HyphenEdit::MASK_START_OF_LINE;
+      }
+      if (run.end() == line_end_index) {
+        hyphen_edit |=
+            line_metrics.hyphen_edit & minikin::HyphenEdit::MASK_END_OF_LINE;
       }
+      minikin_paint.hyphenEdit = hyphen_edit;
+    }
 
-      layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
-                      minikin_font, minikin_paint, minikin_font_collection);
+    layout.doLayout(text_ptr, text_start, text_count, text_size, run.is_rtl(),
+                    minikin_font, minikin_paint, minikin_font_collection);
 
-      if (layout.nGlyphs() == 0)
-        continue;
+    if (layout.nGlyphs() == 0)
+      continue;
 
-      // When laying out RTL ghost runs, shift the run_x_offset here by the
-      // advance so that the ghost run is positioned to the left of the first
-      // real run of text in the line. However, since we do not want it to
-      // impact the layout of real text, this advance is subsequently added
-      // back into the run_x_offset after the ghost run positions have been
-      // calcuated and before the next real run of text is laid out, ensuring
-      // later runs are laid out in the same position as if there were no ghost
-      // run.
-      if (run.is_ghost() && run.is_rtl())
-        run_x_offset -= layout.getAdvance();
-
-      std::vector<float> layout_advances(text_count);
-      layout.getAdvances(layout_advances.data());
-
-      // Break the layout into blobs that share the same SkPaint parameters.
-      std::vector<Range<size_t>> glyph_blobs = GetLayoutTypefaceRuns(layout);
-
-      double word_start_position = std::numeric_limits<double>::quiet_NaN();
-
-      // Build a Skia text blob from each group of glyphs.
-      for (const Range<size_t>& glyph_blob : glyph_blobs) {
-        std::vector<GlyphPosition> glyph_positions;
-
-        GetGlyphTypeface(layout, glyph_blob.start).apply(font);
-        const SkTextBlobBuilder::RunBuffer& blob_buffer =
-            builder.allocRunPos(font, glyph_blob.end - glyph_blob.start);
-
-        double justify_x_offset_delta = 0;
-        for (size_t glyph_index = glyph_blob.start;
-             glyph_index < glyph_blob.end;) {
-          size_t cluster_start_glyph_index = glyph_index;
-          uint32_t cluster = layout.getGlyphCluster(cluster_start_glyph_index);
-          double glyph_x_offset;
-          // Add all the glyphs in this cluster to the text blob.
-          do {
-            size_t blob_index = glyph_index - glyph_blob.start;
-            blob_buffer.glyphs[blob_index] = layout.getGlyphId(glyph_index);
-
-            size_t pos_index = blob_index * 2;
-            blob_buffer.pos[pos_index] = layout.getX(glyph_index) +
-                                         justify_x_offset +
-                                         justify_x_offset_delta;
-            blob_buffer.pos[pos_index + 1] = layout.getY(glyph_index);
-
-            if (glyph_index == cluster_start_glyph_index)
-              glyph_x_offset = blob_buffer.pos[pos_index];
-
-            glyph_index++;
-          } while (glyph_index < glyph_blob.end &&
-                   layout.getGlyphCluster(glyph_index) == cluster);
-
-          Range<int32_t> glyph_code_units(cluster, 0);
-          std::vector<size_t> grapheme_code_unit_counts;
-          if (run.is_rtl()) {
-            if (cluster_start_glyph_index > 0) {
-              glyph_code_units.end =
-                  layout.getGlyphCluster(cluster_start_glyph_index - 1);
-            } else {
-              glyph_code_units.end = text_count;
-            }
-            grapheme_code_unit_counts.push_back(glyph_code_units.width());
+    // When laying out RTL ghost runs, shift the run_x_offset here by the
+    // advance so that the ghost run is positioned to the left of the first
+    // real run of text in the line. However, since we do not want it to
+    // impact the layout of real text, this advance is subsequently added
+    // back into the run_x_offset after the ghost run positions have been
+    // calcuated and before the next real run of text is laid out, ensuring
+    // later runs are laid out in the same position as if there were no ghost
+    // run.
+    if (run.is_ghost() && run.is_rtl())
+      run_x_offset -= layout.getAdvance();
+
+    std::vector<float> layout_advances(text_count);
+    layout.getAdvances(layout_advances.data());
+
+    // Break the layout into blobs that share the same SkPaint parameters.
+    std::vector<Range<size_t>> glyph_blobs = GetLayoutTypefaceRuns(layout);
+
+    double word_start_position = std::numeric_limits<double>::quiet_NaN();
+
+    // Build a Skia text blob from each group of glyphs.
+    for (const Range<size_t>& glyph_blob : glyph_blobs) {
+      std::vector<GlyphPosition> glyph_positions;
+
+      GetGlyphTypeface(layout, glyph_blob.start).apply(font);
+      size_t blob_glyph_count = glyph_blob.end - glyph_blob.start;
+      blob_glyphs.resize(blob_glyph_count);
+      blob_positions.resize(blob_glyph_count * 2);
+
+      double justify_x_offset_delta = 0;
+      for (size_t glyph_index = glyph_blob.start;
+           glyph_index < glyph_blob.end;) {
+        size_t cluster_start_glyph_index = glyph_index;
+        uint32_t cluster = layout.getGlyphCluster(cluster_start_glyph_index);
+        double glyph_x_offset;
+        // Add all the glyphs in this cluster to the text blob.
+        do {
+          size_t blob_index = glyph_index - glyph_blob.start;
+          blob_glyphs[blob_index] = layout.getGlyphId(glyph_index);
+
+          size_t pos_index = blob_index * 2;
+          blob_positions[pos_index] = layout.getX(glyph_index) +
+                                      justify_x_offset + justify_x_offset_delta;
+          blob_positions[pos_index + 1] = layout.getY(glyph_index);
+
+          if (glyph_index == cluster_start_glyph_index)
+            glyph_x_offset = blob_positions[pos_index];
+
+          glyph_index++;
+        } while (glyph_index < glyph_blob.end &&
+                 layout.getGlyphCluster(glyph_index) == cluster);
+
+        Range<int32_t> glyph_code_units(cluster, 0);
+        std::vector<size_t> grapheme_code_unit_counts;
+        if (run.is_rtl()) {
+          if (cluster_start_glyph_index > 0) {
+            glyph_code_units.end =
+                layout.getGlyphCluster(cluster_start_glyph_index - 1);
           } else {
-            if (glyph_index < layout.nGlyphs()) {
-              glyph_code_units.end = layout.getGlyphCluster(glyph_index);
-            } else {
-              glyph_code_units.end = text_count;
-            }
-
-            // The glyph may be a ligature.  Determine how many graphemes are
-            // joined into this glyph and how many input code units map to
-            // each grapheme.
-            size_t code_unit_count = 1;
-            for (int32_t offset = glyph_code_units.start + 1;
-                 offset < glyph_code_units.end; ++offset) {
-              if (minikin::GraphemeBreak::isGraphemeBreak(
-                      layout_advances.data(), text_ptr, text_start, text_count,
-                      text_start + offset)) {
-                grapheme_code_unit_counts.push_back(code_unit_count);
-                code_unit_count = 1;
-              } else {
-                code_unit_count++;
-              }
-            }
-            grapheme_code_unit_counts.push_back(code_unit_count);
+            glyph_code_units.end = text_count;
           }
-          float glyph_advance;
-          if (run.is_placeholder_run()) {
-            // The placeholder run's layout should yield one glyph representing
-            // the object replacement character.  Replace its width with the
-            // placeholder's width.
-            FML_DCHECK(layout.nGlyphs() == 1);
-            glyph_advance = run.placeholder_run()->width;
+          grapheme_code_unit_counts.push_back(glyph_code_units.width());
+        } else {
+          if (glyph_index < layout.nGlyphs()) {
+            glyph_code_units.end = layout.getGlyphCluster(glyph_index);
           } else {
-            glyph_advance = layout.getCharAdvance(glyph_code_units.start);
-          }
-          float grapheme_advance =
-              glyph_advance / grapheme_code_unit_counts.size();
-
-          glyph_positions.emplace_back(run_x_offset + glyph_x_offset,
-                                       grapheme_advance,
-                                       run.start() + glyph_code_units.start,
-                                       grapheme_code_unit_counts[0]);
-
-          // Compute positions for the additional graphemes in the ligature.
-          for (size_t i = 1; i < grapheme_code_unit_counts.size(); ++i) {
-            glyph_positions.emplace_back(
-                glyph_positions.back().x_pos.end, grapheme_advance,
-                glyph_positions.back().code_units.start +
-                    grapheme_code_unit_counts[i - 1],
-                grapheme_code_unit_counts[i]);
+            glyph_code_units.end = text_count;
           }
 
-          bool at_word_start = false;
-          bool at_word_end = false;
-          if (word_index < words.size()) {
-            at_word_start =
-                words[word_index].start == run.start() + glyph_code_units.start;
-            at_word_end =
-                words[word_index].end == run.start() + glyph_code_units.end;
-            if (line_runs_all_rtl) {
-              std::swap(at_word_start, at_word_end);
+          // The glyph may be a ligature.  Determine how many graphemes are
+          // joined into this glyph and how many input code units map to
+          // each grapheme.
+          size_t code_unit_count = 1;
+          for (int32_t offset = glyph_code_units.start + 1;
+               offset < glyph_code_units.end; ++offset) {
+            if (minikin::GraphemeBreak::isGraphemeBreak(
+                    layout_advances.data(), text_ptr, text_start, text_count,
+                    text_start + offset)) {
+              grapheme_code_unit_counts.push_back(code_unit_count);
+              code_unit_count = 1;
+            } else {
+              code_unit_count++;
             }
           }
+          grapheme_code_unit_counts.push_back(code_unit_count);
+        }
+        float glyph_advance;
+        if (run.is_placeholder_run()) {
+          // The placeholder run's layout should yield one glyph representing
+          // the object replacement character.  Replace its width with the
+          // placeholder's width.
+          FML_DCHECK(layout.nGlyphs() == 1);
+          glyph_advance = run.placeholder_run()->width;
+        } else {
+          glyph_advance = layout.getCharAdvance(glyph_code_units.start);
+        }
+        float grapheme_advance =
+            glyph_advance / grapheme_code_unit_counts.size();
+
+        glyph_positions.emplace_back(run_x_offset + glyph_x_offset,
+                                     grapheme_advance,
+                                     run.start() + glyph_code_units.start,
+                                     grapheme_code_unit_counts[0]);
+
+        // Compute positions for the additional graphemes in the ligature.
+        for (size_t i = 1; i < grapheme_code_unit_counts.size(); ++i) {
+          glyph_positions.emplace_back(
+              glyph_positions.back().x_pos.end, grapheme_advance,
+              glyph_positions.back().code_units.start +
+                  grapheme_code_unit_counts[i - 1],
+              grapheme_code_unit_counts[i]);
+        }
 
-          if (at_word_start) {
-            word_start_position = run_x_offset + glyph_x_offset;
+        bool at_word_start = false;
+        bool at_word_end = false;
+        if (word_index < words.size()) {
+          at_word_start =
+              words[word_index].start == run.start() + glyph_code_units.start;
+          at_word_end =
+              words[word_index].end == run.start() + glyph_code_units.end;
+          if (line_runs_all_rtl) {
+            std::swap(at_word_start, at_word_end);
           }
+        }
 
-          if (at_word_end) {
-            if (justify_line) {
-              justify_x_offset_delta += word_gap_width;
-            }
-            word_index++;
+        if (at_word_start) {
+          word_start_position = run_x_offset + glyph_x_offset;
+        }
 
-            if (!isnan(word_start_position)) {
-              double word_width =
-                  glyph_positions.back().x_pos.end - word_start_position;
-              max_word_width = std::max(word_width, max_word_width);
-              word_start_position = std::numeric_limits<double>::quiet_NaN();
-            }
+        if (at_word_end) {
+          if (justify_line) {
+            justify_x_offset_delta += word_gap_width;
+          }
+          word_index++;
+
+          if (!isnan(word_start_position)) {
+            double word_width =
+                glyph_positions.back().x_pos.end - word_start_position;
+            result->max_word_width =
+                std::max(word_width, result->max_word_width);
+            word_start_position = std::numeric_limits<double>::quiet_NaN();
           }
-        }  // for each in glyph_blob
-
-        if (glyph_positions.empty())
-          continue;
-
-        // Store the font metrics and TextStyle in the LineMetrics for this line
-        // to provide metrics upon user request. We index this RunMetrics
-        // instance at `run.end() - 1` to allow map::lower_bound to access the
-        // correct RunMetrics at any text index.
-        size_t run_key = run.end() - 1;
-        line_metrics.run_metrics.emplace(run_key, &run.style());
-        SkFontMetrics* metrics =
-            &line_metrics.run_metrics.at(run_key).font_metrics;
-        font.getMetrics(metrics);
-
-        Range<double> record_x_pos(
-            glyph_positions.front().x_pos.start - run_x_offset,
-            glyph_positions.back().x_pos.end - run_x_offset);
-        paint_records.emplace_back(run.style(), SkPoint::Make(run_x_offset, 0),
-                                   builder.make(), *metrics, line_number,
-                                   record_x_pos.start, record_x_pos.end,
-                                   run.is_ghost(), run.placeholder_run());
-
-        justify_x_offset += justify_x_offset_delta;
-
-        line_glyph_positions.insert(line_glyph_positions.end(),
-                                    glyph_positions.begin(),
-                                    glyph_positions.end());
-
-        // Add a record of glyph positions sorted by code unit index.
-        std::vector<GlyphPosition> code_unit_positions(glyph_positions);
-        std::sort(code_unit_positions.begin(), code_unit_positions.end(),
-                  [](const GlyphPosition& a, const GlyphPosition& b) {
-                    return a.code_units.start < b.code_units.start;
-                  });
-
-        double blob_x_pos_start = glyph_positions.front().x_pos.start;
-        double blob_x_pos_end = glyph_positions.back().x_pos.end;
-        line_code_unit_runs.emplace_back(
-            std::move(code_unit_positions),
-            Range<size_t>(run.start(), run.end()),
-            Range<double>(blob_x_pos_start, blob_x_pos_end), line_number,
-            *metrics, run.style(), run.direction(), run.placeholder_run());
-
-        if (run.is_placeholder_run()) {
-          line_inline_placeholder_code_unit_runs.push_back(
-              line_code_unit_runs.back());
         }
+      }  // for each in glyph_blob
 
-        if (!run.is_ghost()) {
-          min_left_ = std::min(min_left_, blob_x_pos_start);
-          max_right_ = std::max(max_right_, blob_x_pos_end);
-        }
-      }  // for each in glyph_blobs
+      if (glyph_positions.empty())
+        continue;
+
+      // Store the font metrics and TextStyle in the LineMetrics for this line
+      // to provide metrics upon user request. We index this RunMetrics
+      // instance at `run.end() - 1` to allow map::lower_bound to access the
+      // correct RunMetrics at any text index.
+      size_t run_key = run.end() - 1;
+      line_metrics.run_metrics.emplace(run_key, &run.style());
+      SkFontMetrics* metrics =
+          &line_metrics.run_metrics.at(run_key).font_metrics;
+      font.getMetrics(metrics);
+
+      Range<double> record_x_pos(
+          glyph_positions.front().x_pos.start - run_x_offset,
+          glyph_positions.back().x_pos.end - run_x_offset);
+      // Runs with the same glyphs share a blob across paragraphs.
+      sk_sp<SkTextBlob> blob = TextBlobCache::GetInstance().GetBlob(
+          font, blob_glyphs.data(), blob_positions.data(), blob_glyph_count);
+      paint_records.emplace_back(run.style(), SkPoint::Make(run_x_offset, 0),
+                                 std::move(blob), *metrics, line_number,
+                                 record_x_pos.start, record_x_pos.end,
+                                 run.is_ghost(), run.placeholder_run());
+
+      justify_x_offset += justify_x_offset_delta;
+
+      line_glyph_positions.insert(line_glyph_positions.end(),
+                                  glyph_positions.begin(),
+                                  glyph_positions.end());
+
+      // Add a record of glyph positions sorted by code unit index.
+      std::vector<GlyphPosition> code_unit_positions(glyph_positions);
+      std::sort(code_unit_positions.begin(), code_unit_positions.end(),
+                [](const GlyphPosition& a, const GlyphPosition& b) {
+                  return a.code_units.start < b.code_units.start;
+                });
+
+      double blob_x_pos_start = glyph_positions.front().x_pos.start;
+      double blob_x_pos_end = glyph_positions.back().x_pos.end;
+      line_code_unit_runs.emplace_back(
+          std::move(code_unit_positions), Range<size_t>(run.start(), run.end()),
+          Range<double>(blob_x_pos_start, blob_x_pos_end), line_number,
+          *metrics, run.style(), run.direction(), run.placeholder_run());
 
       if (run.is_placeholder_run()) {
-        run_x_offset += run.placeholder_run()->width;
-      } else {
-        // Do not increase x offset for LTR trailing ghost runs as it should not
-        // impact the layout of visible glyphs. RTL tailing ghost runs have the
-        // advance subtracted, so we do add the advance here to reset the
-        // run_x_offset. We do keep the record though so GetRectsForRange() can
-        // find metrics for trailing spaces.
-        if (!run.is_ghost() || run.is_rtl()) {
-          run_x_offset += layout.getAdvance();
-        }
+        line_inline_placeholder_code_unit_runs.push_back(
+            line_code_unit_runs.back());
       }
-    }  // for each in line_runs
 
-    // Adjust the glyph positions based on the alignment of the line.
-    double line_x_offset = GetLineXOffset(run_x_offset, justify_line);
-    if (line_x_offset) {
-      for (CodeUnitRun& code_unit_run : line_code_unit_runs) {
-        code_unit_run.Shift(line_x_offset);
-      }
-      for (CodeUnitRun& code_unit_run :
-           line_inline_placeholder_code_unit_runs) {
-        code_unit_run.Shift(line_x_offset);
+      if (!run.is_ghost()) {
+        result->min_left = std::min(result->min_left, blob_x_pos_start);
+        result->max_right = std::max(result->max_right, blob_x_pos_end);
       }
-      for (GlyphPosition& position : line_glyph_positions) {
-        position.Shift(line_x_offset);
+    }  // for each in glyph_blobs
+
+    if (run.is_placeholder_run()) {
+      run_x_offset += run.placeholder_run()->width;
+    } else {
+      // Do not increase x offset for LTR trailing ghost runs as it should not
+      // impact the layout of visible glyphs. RTL tailing ghost runs have the
+      // advance subtracted, so we do add the advance here to reset the
+      // run_x_offset. We do keep the record though so GetRectsForRange() can
+      // find metrics for trailing spaces.
+      if (!run.is_ghost() || run.is_rtl()) {
+        run_x_offset += layout.getAdvance();
       }
     }
+  }  // for each in line_runs
 
-    size_t next_line_start = (line_number < line_metrics_.size() - 1)
-                                 ? line_metrics_[line_number + 1].start_index
-                                 : text_.size();
-    glyph_lines_.emplace_back(std::move(line_glyph_positions),
-                              next_line_start - line_metrics.start_index);
-    code_unit_runs_.insert(code_unit_runs_.end(), line_code_unit_runs.begin(),
-                           line_code_unit_runs.end());
-    inline_placeholder_code_unit_runs_.insert(
-        inline_placeholder_code_unit_runs_.end(),
-        line_inline_placeholder_code_unit_runs.begin(),
-        line_inline_placeholder_code_unit_runs.end());
-
-    // Calculate the amount to advance in the y direction. This is done by
-    // computing the maximum ascent and descent with respect to the strut.
-    double max_ascent = IsStrutValid() ? strut_.ascent + strut_.half_leading
-                                       : std::numeric_limits<double>::lowest();
-    double max_descent = IsStrutValid() ? strut_.descent + strut_.half_leading
-                                        : std::numeric_limits<double>::lowest();
-    double max_unscaled_ascent = 0;
-    for (const PaintRecord& paint_record : paint_records) {
-      UpdateLineMetrics(paint_record.metrics(), paint_record.style(),
-                        max_ascent, max_descent, max_unscaled_ascent,
-                        paint_record.GetPlaceholderRun(), line_number,
-                        line_limit);
+  // Adjust the glyph positions based on the alignment of the line.
+  double line_x_offset = GetLineXOffset(run_x_offset, justify_line);
+  if (line_x_offset) {
+    for (CodeUnitRun& code_unit_run : line_code_unit_runs) {
+      code_unit_run.Shift(line_x_offset);
     }
-
-    // If no fonts were actually rendered, then compute a baseline based on the
-    // font of the paragraph style.
-    if (paint_records.empty()) {
-      SkFontMetrics metrics;
-      TextStyle style(paragraph_style_.GetTextStyle());
-      font.setTypeface(GetDefaultSkiaTypeface(style));
-      font.setSize(style.font_size);
-      font.getMetrics(&metrics);
-      UpdateLineMetrics(metrics, style, max_ascent, max_descent,
-                        max_unscaled_ascent, nullptr, line_number, line_limit);
+    for (CodeUnitRun& code_unit_run : line_inline_placeholder_code_unit_runs) {
+      code_unit_run.Shift(line_x_offset);
     }
-
-    // Calculate the baselines. This is only done on the first line.
-    if (line_number == 0) {
-      alphabetic_baseline_ = max_ascent;
-      // TODO(garyq): Ideographic baseline is currently bottom of EM
-      // box, which is not correct. This should be obtained from metrics.
-      // Skia currently does not support various baselines.
-      ideographic_baseline_ = (max_ascent + max_descent);
+    for (GlyphPosition& position : line_glyph_positions) {
+      position.Shift(line_x_offset);
     }
+  }
 
-    line_metrics.height =
-        (line_number == 0 ? 0 : line_metrics_[line_number - 1].height) +
-        round(max_ascent + max_descent);
-    line_metrics.baseline = line_metrics.height - max_descent;
-
-    y_offset += round(max_ascent + prev_max_descent);
-    prev_max_descent = max_descent;
-
-    line_metrics.line_number = line_number;
-    line_metrics.ascent = max_ascent;
-    line_metrics.descent = max_descent;
-    line_metrics.unscaled_ascent = max_unscaled_ascent;
-    line_metrics.width = line_widths_[line_number];
-    line_metrics.left = line_x_offset;
-
-    final_line_count_++;
-
-    for (PaintRecord& paint_record : paint_records) {
-      paint_record.SetOffset(
-          SkPoint::Make(paint_record.offset().x() + line_x_offset, y_offset));
-      records_.emplace_back(std::move(paint_record));
-    }
-  }  // for each line_number
+  result->advance = run_x_offset;
+  result->x_offset = line_x_offset;
+
+  // Calculate the amount to advance in the y direction. This is done by
+  // computing the maximum ascent and descent with respect to the strut.
+  double& max_ascent = result->max_ascent;
+  double& max_descent = result->max_descent;
+  double& max_unscaled_ascent = result->max_unscaled_ascent;
+  max_ascent = IsStrutValid() ? strut_.ascent + strut_.half_leading
+                               : std::numeric_limits<double>::lowest();
+  max_descent = IsStrutValid() ? strut_.descent + strut_.half_leading
+                                : std::numeric_limits<double>::lowest();
+  for (const PaintRecord& paint_record : paint_records) {
+    UpdateLineMetrics(paint_record.metrics(), paint_record.style(), max_ascent,
+                      max_descent, max_unscaled_ascent,
+                      paint_record.GetPlaceholderRun(), line_number,
+                      line_limit);
+  }
 
-  if (paragraph_style_.max_lines == 1 ||
-      (paragraph_style_.unlimited_lines() && paragraph_style_.ellipsized())) {
-    min_intrinsic_width_ = max_intrinsic_width_;
-  } else {
-    min_intrinsic_width_ = std::min(max_word_width, max_intrinsic_width_);
+  // If no fonts were actually rendered, then compute a baseline based on the
+  // font of the paragraph style.
+  if (paint_records.empty()) {
+    SkFontMetrics metrics;
+    TextStyle style(paragraph_style_.GetTextStyle());
+    font.setTypeface(GetDefaultSkiaTypeface(style));
+    font.setEmbolden(false);
+    font.setSkewX(0);
+    font.setSize(style.font_size);
+    font.getMetrics(&metrics);
+    UpdateLineMetrics(metrics, style, max_ascent, max_descent,
+                      max_unscaled_ascent, nullptr, line_number, line_limit);
   }
+  return true;
+}
 
-  std::sort(code_unit_runs_.begin(), code_unit_runs_.end(),
-            [](const CodeUnitRun& a, const CodeUnitRun& b) {
-              return a.code_units.start < b.code_units.start;
-            });
+void ParagraphTxt::AddLine(size_t line_number,
+                           LineLayout& line,
+                           double& y_offset,
+                           double& prev_max_descent,
+                           double& max_word_width) {
+  LineMetrics& line_metrics = line_metrics_[line_number];
+  double line_x_offset = line.x_offset;
+  double max_ascent = line.max_ascent;
+  double max_descent = line.max_descent;
+  max_word_width = std::max(max_word_width, line.max_word_width);
+  min_left_ = std::min(min_left_, line.min_left);
+  max_right_ = std::max(max_right_, line.max_right);
+
+  size_t next_line_start = (line_number < line_metrics_.size() - 1)
+                               ? line_metrics_[line_number + 1].start_index
+                               : text_.size();
+  glyph_lines_.emplace_back(std::move(line.glyph_positions),
+                            next_line_start - line_metrics.start_index);
+  code_unit_runs_.insert(code_unit_runs_.end(), line.code_unit_runs.begin(),
+                         line.code_unit_runs.end());
+  inline_placeholder_code_unit_runs_.insert(
+      inline_placeholder_code_unit_runs_.end(),
+      line.inline_placeholder_code_unit_runs.begin(),
+      line.inline_placeholder_code_unit_runs.end());
+
+  // Calculate the baselines. This is only done on the first line.
+  if (line_number == 0) {
+    alphabetic_baseline_ = max_ascent;
+    // TODO(garyq): Ideographic baseline is currently bottom of EM
+    // box, which is not correct. This should be obtained from metrics.
+    // Skia currently does not support various baselines.
+    ideographic_baseline_ = (max_ascent + max_descent);
+  }
 
-  longest_line_ = max_right_ - min_left_;
+  line_metrics.height =
+      (line_number == 0 ? 0 : line_metrics_[line_number - 1].height) +
+      round(max_ascent + max_descent);
+  line_metrics.baseline = line_metrics.height - max_descent;
+
+  y_offset += round(max_ascent + prev_max_descent);
+  prev_max_descent = max_descent;
+
+  line_metrics.line_number = line_number;
+  line_metrics.ascent = max_ascent;
+  line_metrics.descent = max_descent;
+  line_metrics.unscaled_ascent = line.max_unscaled_ascent;
+  line_metrics.width = line_widths_[line_number];
+  line_metrics.left = line_x_offset;
+
+  final_line_count_++;
+  line_states_.push_back(
+      {line.advance, y_offset, max_word_width, min_left_, max_right_});
+
+  for (PaintRecord& paint_record : line.paint_records) {
+    paint_record.SetOffset(
+        SkPoint::Make(paint_record.offset().x() + line_x_offset, y_offset));
+    records_.emplace_back(std::move(paint_record));
+  }
 }
 
 void ParagraphTxt::UpdateLineMetrics(const SkFontMetrics& metrics,
@@ -1369,12 +1785,14 @@ double ParagraphTxt::GetLongestLine() {
 
 void ParagraphTxt::SetParagraphStyle(const ParagraphStyle& style) {
   needs_layout_ = true;
+  lines_reusable_ = false;
   paragraph_style_ = style;
 }
 
 void ParagraphTxt::SetFontCollection(
     std::shared_ptr<FontCollection> font_collection) {
   font_collection_ = std::move(font_collection);
+  lines_reusable_ = false;
 }
 
 std::shared_ptr<minikin::FontCollection>
@@ -1679,23 +2097,22 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
   // Text direction of the first line so we can extend the correct side for
   // RectWidthStyle::kMax.
   TextDirection first_line_dir = TextDirection::ltr;
-  std::map<size_t, size_t> newline_x_positions;
 
   // Lines that are actually in the requested range.
   size_t max_line = 0;
   size_t min_line = INT_MAX;
   size_t glyph_length = 0;
 
-  // Generate initial boxes and calculate metrics.
-  for (const CodeUnitRun& run : code_unit_runs_) {
+  // Generate initial boxes and calculate metrics, starting from the first run
+  // that ends inside the range.
+  const PositionIndex& index = GetPositionIndex();
+  for (size_t run_index = FindFirstRunReaching(index, start + 1);
+       run_index < code_unit_runs_.size(); ++run_index) {
+    const CodeUnitRun& run = code_unit_runs_[run_index];
     // Check to see if we are finished.
     if (run.code_units.start >= end)
       break;
 
-    // Update new line x position with the ending of last bidi run on the line
-    newline_x_positions[run.line_number] =
-        run.direction == TextDirection::ltr ? run.x_pos.end : run.x_pos.start;
-
     if (run.code_units.end <= start)
       continue;
 
@@ -1755,8 +2172,14 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
   }
 
   // Add empty rectangles representing any newline characters within the
-  // range.
-  for (size_t line_number = 0; line_number < line_metrics_.size();
+  // range, starting from the first line that ends inside it.
+  size_t first_line =
+      std::partition_point(line_metrics_.begin(), line_metrics_.end(),
+                           [start](const LineMetrics& line) {
+                             return line.end_including_newline <= start;
+                           }) -
+      line_metrics_.begin();
+  for (size_t line_number = first_line; line_number < line_metrics_.size();
        ++line_number) {
     LineMetrics& line = line_metrics_[line_number];
     if (line.start_index >= end)
@@ -1766,12 +2189,22 @@ std::vector<Paragraph::TextBox> ParagraphTxt::GetRectsForRange(
     if (line_box_metrics.find(line_number) == line_box_metrics.end()) {
       if (line.end_index != line.end_including_newline &&
           line.end_index >= start && line.end_including_newline <= end) {
-        SkScalar x;
-        auto it = newline_x_positions.find(line_number);
-        if (it != newline_x_positions.end()) {
-          x = it->second;
-        } else {
-          x = GetLineXOffset(0, false);
+        // The newline follows the end of the last run on the line that
+        // starts before the end of the range.
+        SkScalar x = GetLineXOffset(0, false);
+        if (line_number < index.line_runs.size()) {
+          const std::vector<size_t>& runs = index.line_runs[line_number];
+          auto last = std::partition_point(
+              runs.begin(), runs.end(), [this, end](size_t run_index) {
+                return code_unit_runs_[run_index].code_units.start < end;
+              });
+          if (last != runs.begin()) {
+            // Newline boxes are placed on whole pixels.
+            const CodeUnitRun& run = code_unit_runs_[*(last - 1)];
+            x = static_cast<size_t>(run.direction == TextDirection::ltr
+                                        ? run.x_pos.end
+                                        : run.x_pos.start);
+          }
         }
         SkScalar top =
             (line_number > 0) ? line_metrics_[line_number - 1].height : 0;
@@ -1886,46 +2319,45 @@ Paragraph::PositionWithAffinity ParagraphTxt::GetGlyphPositionAtCoordinate(
   if (final_line_count_ <= 0)
     return PositionWithAffinity(0, DOWNSTREAM);
 
-  size_t y_index;
-  for (y_index = 0; y_index < final_line_count_ - 1; ++y_index) {
-    if (dy < line_metrics_[y_index].height)
-      break;
-  }
-
+  // Line bottoms only grow, so the line is the first one whose bottom is
+  // below dy, or the last line.
+  size_t y_index =
+      std::upper_bound(line_metrics_.begin(),
+                       line_metrics_.begin() + final_line_count_ - 1, dy,
+                       [](double y, const LineMetrics& line) {
+                         return y < line.height;
+                       }) -
+      line_metrics_.begin();
+
+  const PositionIndex& index = GetPositionIndex();
   const std::vector<GlyphPosition>& line_glyph_position =
       glyph_lines_[y_index].positions;
   if (line_glyph_position.empty()) {
-    int line_start_index =
-        std::accumulate(glyph_lines_.begin(), glyph_lines_.begin() + y_index, 0,
-                        [](const int a, const GlyphLine& b) {
-                          return a + static_cast<int>(b.total_code_units);
-                        });
-    return PositionWithAffinity(line_start_index, DOWNSTREAM);
-  }
-
-  size_t x_index;
-  const GlyphPosition* gp = nullptr;
-  for (x_index = 0; x_index < line_glyph_position.size(); ++x_index) {
-    double glyph_end = (x_index < line_glyph_position.size() - 1)
-                           ? line_glyph_position[x_index + 1].x_pos.start
-                           : line_glyph_position[x_index].x_pos.end;
-    if (dx < glyph_end) {
-      gp = &line_glyph_position[x_index];
-      break;
-    }
-  }
-
-  if (gp == nullptr) {
-    gp = &line_glyph_position.back();
+    return PositionWithAffinity(index.glyph_line_starts[y_index], DOWNSTREAM);
   }
 
-  // Find the direction of the run that contains this glyph.
+  // A glyph extends to the start of the next one, so the glyph is the first
+  // one whose next glyph starts after dx, or the last glyph.
+  size_t x_index =
+      std::upper_bound(line_glyph_position.begin() + 1,
+                       line_glyph_position.end(), dx,
+                       [](double x, const GlyphPosition& next) {
+                         return x < next.x_pos.start;
+                       }) -
+      line_glyph_position.begin() - 1;
+  const GlyphPosition* gp = &line_glyph_position[x_index];
+
+  // Find the direction of the run that contains this glyph. Only the runs on
+  // the glyph's line can contain it.
   TextDirection direction = TextDirection::ltr;
-  for (const CodeUnitRun& run : code_unit_runs_) {
-    if (gp->code_units.start >= run.code_units.start &&
-        gp->code_units.end <= run.code_units.end) {
-      direction = run.direction;
-      break;
+  if (y_index < index.line_runs.size()) {
+    for (size_t run_index : index.line_runs[y_index]) {
+      const CodeUnitRun& run = code_unit_runs_[run_index];
+      if (gp->code_units.start >= run.code_units.start &&
+          gp->code_units.end <= run.code_units.end) {
+        direction = run.direction;
+        break;
+      }
     }
   }
 
@@ -2015,6 +2447,8 @@ bool ParagraphTxt::DidExceedMaxLines() {
 
 void ParagraphTxt::SetDirty(bool dirty) {
   needs_layout_ = dirty;
+  if (dirty)
+    lines_reusable_ = false;
 }
 
 std::vector<LineMetrics>& ParagraphTxt::GetLineMetrics() {
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "flutter/fml/compiler_specific.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "font_collection.h"
 #include "line_metrics.h"
@@ -39,6 +40,10 @@
 #include "utils/MacUtils.h"
 #include "utils/WindowsUtils.h"
 
+namespace minikin {
+class Layout;
+}
+
 namespace txt {
 
 using GlyphID = uint32_t;
@@ -71,8 +76,28 @@ class ParagraphTxt : public Paragraph {
   // number of characters. However, this is not significant for reasonably sized
   // paragraphs. It is currently recommended to break up very long paragraphs
   // (10k+ characters) to ensure speedy layout.
+  //
+  // Lines from the previous layout are reused when only the width changed or
+  // text was appended with AppendText(). Lines before the first line whose
+  // breaks changed are kept and only moved to match the new width. Lines after
+  // it are laid out again, although the words in them are usually served from
+  // the shaping cache.
   virtual void Layout(double width) override;
 
+  // Appends text to the end of the last style run. The next Layout() call
+  // keeps the lines that are unaffected by the new text, which makes growing
+  // text, such as a log, cheap to lay out again. Does nothing if the paragraph
+  // has no text.
+  void AppendText(const std::u16string& text);
+
+  // Lets Layout() break, shape and position the lines of long paragraphs on
+  // the workers of task_runner. The lines are still placed on the calling
+  // thread in order, so the result is the same as a serial layout. Paragraphs
+  // with placeholders or an ellipsis are always laid out serially. Passing
+  // nullptr turns this off, which is the default.
+  void SetLayoutTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
   virtual void Paint(SkCanvas* canvas, double x, double y) override;
 
   // Getter for paragraph_style_.
@@ -122,8 +147,8 @@ class ParagraphTxt : public Paragraph {
   std::vector<LineMetrics>& GetLineMetrics() override;
 
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
-  // be performed when this is set to true. Can also be used to prevent a new
-  // Layout from being calculated by setting to false.
+  // be performed from scratch when this is set to true. Can also be used to
+  // prevent a new Layout from being calculated by setting to false.
   void SetDirty(bool dirty = true);
 
  private:
@@ -164,6 +189,7 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
   FRIEND_TEST(ParagraphTest, TextHeightBehaviorRectsParagraph);
+  FRIEND_TEST(ParagraphTest, IdenticalRunsShareTextBlobs);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -271,10 +297,12 @@ class ParagraphTxt : public Paragraph {
 
   struct GlyphLine {
     // Glyph positions sorted by x coordinate.
-    const std::vector<GlyphPosition> positions;
-    const size_t total_code_units;
+    std::vector<GlyphPosition> positions;
+    size_t total_code_units;
 
     GlyphLine(std::vector<GlyphPosition>&& p, size_t tcu);
+
+    void Shift(double delta);
   };
 
   struct CodeUnitRun {
@@ -309,6 +337,60 @@ class ParagraphTxt : public Paragraph {
   // Holds the positions of the inline placeholders.
   std::vector<CodeUnitRun> inline_placeholder_code_unit_runs_;
 
+  // Lookups over the laid out runs and lines that let GetRectsForRange() and
+  // GetGlyphPositionAtCoordinate() binary search instead of scanning the whole
+  // paragraph. Built by the first query after each layout.
+  struct PositionIndex {
+    // The largest code unit end of code_unit_runs_[0, i], which only grows,
+    // so the first run reaching past a code unit can be binary searched.
+    std::vector<size_t> run_end_prefix_max;
+    // The indexes into code_unit_runs_ of the runs on each line, in code unit
+    // order.
+    std::vector<std::vector<size_t>> line_runs;
+    // The code unit each glyph line starts at.
+    std::vector<size_t> glyph_line_starts;
+  };
+  std::unique_ptr<PositionIndex> position_index_;
+
+  // The state of the layout after each line, which lets a later layout
+  // continue from any line that did not change.
+  struct LineState {
+    // The advance of the line before it was aligned.
+    double advance;
+    double y_offset;
+    double max_word_width;
+    double min_left;
+    double max_right;
+  };
+
+  std::vector<LineState> line_states_;
+
+  // The runs of the last layout, kept to find the lines it can reuse.
+  std::vector<BidiRun> bidi_runs_;
+
+  // Whether the lines of the last layout can be reused by the next one.
+  bool lines_reusable_ = false;
+
+  // The pool used to lay out long paragraphs, if any.
+  std::shared_ptr<fml::ConcurrentTaskRunner> layout_task_runner_;
+
+  // A line that has been laid out but not yet placed in the paragraph. The
+  // paint records and positions are relative to the start of the line.
+  struct LineLayout {
+    std::vector<PaintRecord> paint_records;
+    std::vector<GlyphPosition> glyph_positions;
+    std::vector<CodeUnitRun> code_unit_runs;
+    std::vector<CodeUnitRun> inline_placeholder_code_unit_runs;
+    double advance = 0;
+    double x_offset = 0;
+    double max_ascent = 0;
+    double max_descent = 0;
+    double max_unscaled_ascent = 0;
+    double max_word_width = 0;
+    double min_left = std::numeric_limits<double>::max();
+    double max_right = std::numeric_limits<double>::lowest();
+  };
+
   // The max width of the paragraph as provided in the most recent Layout()
   // call.
   double width_ = -1.0f;
@@ -345,9 +427,64 @@ class ParagraphTxt : public Paragraph {
   // Break the text into lines.
   bool ComputeLineBreaks();
 
+  // Breaks the text between two hard breaks into lines, starting the search
+  // for its style runs at run_index.
+  bool ComputeBlockLineBreaks(minikin::LineBreaker& breaker,
+                              size_t block_start,
+                              size_t block_end,
+                              size_t& run_index,
+                              size_t& inline_placeholder_index,
+                              std::vector<LineMetrics>* lines,
+                              std::vector<double>* widths,
+                              double* max_width);
+
+  // Returns how many ranges item_count lines or blocks should be split into
+  // to be laid out concurrently, which is 1 if they should be laid out on the
+  // calling thread.
+  size_t GetParallelSegmentCount(size_t item_count) const;
+
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
 
+  // Counts the leading lines of the previous layout that are unchanged by the
+  // line breaks and bidi runs that were just computed.
+  size_t CountReusableLines(const std::vector<LineMetrics>& previous_lines,
+                            size_t previous_line_count,
+                            size_t line_limit,
+                            const std::vector<BidiRun>& previous_bidi_runs);
+
+  // Drops every laid out line from line_count on.
+  void TruncateLines(size_t line_count);
+
+  // Returns the position index of the current layout, building it if needed.
+  const PositionIndex& GetPositionIndex();
+
+  // Returns the index of the first run in code_unit_runs_ whose end is at
+  // least code_unit, or the number of runs if there is none.
+  static size_t FindFirstRunReaching(const PositionIndex& index,
+                                     size_t code_unit);
+
+  // Moves the first line_count laid out lines to match the alignment of the
+  // paragraph at the current width.
+  void AlignLines(size_t line_count);
+
+  // Shapes and positions a single line. Returns false if a style has no font
+  // collection.
+  bool LayoutLine(size_t line_number,
+                  size_t& line_limit,
+                  size_t& placeholder_run_index,
+                  SkFont& font,
+                  minikin::Layout& layout,
+                  LineLayout* result);
+
+  // Places a laid out line below the lines before it and moves its records
+  // into the paragraph.
+  void AddLine(size_t line_number,
+               LineLayout& line,
+               double& y_offset,
+               double& prev_max_descent,
+               double& max_word_width);
+
   // Calculates and populates strut based on paragraph_style_ strut info.
   void ComputeStrut(StrutMetrics* strut, SkFont& font);
 
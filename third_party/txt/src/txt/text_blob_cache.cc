@@ -0,0 +1,156 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "text_blob_cache.h"
+
+#include <cstring>
+
+#include "third_party/skia/include/core/SkTypeface.h"
+#include "utils/JenkinsHash.h"
+
+namespace txt {
+namespace {
+
+constexpr size_t kDefaultBudgetBytes = 4 * 1024 * 1024;
+
+// An estimate of the memory used by an entry besides its glyphs, covering the
+// blob, the list node and the index node.
+constexpr size_t kEntryOverheadBytes = 192;
+
+uint32_t GetFontFlags(const SkFont& font) {
+  return (font.isEmbolden() << 0) | (font.isForceAutoHinting() << 1) |
+         (font.isEmbeddedBitmaps() << 2) | (font.isSubpixel() << 3) |
+         (font.isLinearMetrics() << 4) | (font.isBaselineSnap() << 5) |
+         (static_cast<uint32_t>(font.getEdging()) << 8) |
+         (static_cast<uint32_t>(font.getHinting()) << 12);
+}
+
+uint32_t ScalarBits(SkScalar value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+// Scalars are compared by their bits to agree with the hash, which tells -0
+// from 0.
+bool TextBlobCache::Key::operator==(const Key& other) const {
+  return typeface_id == other.typeface_id && font_flags == other.font_flags &&
+         ScalarBits(size) == ScalarBits(other.size) &&
+         ScalarBits(scale_x) == ScalarBits(other.scale_x) &&
+         ScalarBits(skew_x) == ScalarBits(other.skew_x) &&
+         glyphs == other.glyphs && positions.size() == other.positions.size() &&
+         memcmp(positions.data(), other.positions.data(),
+                positions.size() * sizeof(SkScalar)) == 0;
+}
+
+size_t TextBlobCache::KeyHash::operator()(const Key& key) const {
+  uint32_t hash = android::JenkinsHashMix(0, key.typeface_id);
+  hash = android::JenkinsHashMix(hash, key.font_flags);
+  hash = android::JenkinsHashMix(hash, ScalarBits(key.size));
+  hash = android::JenkinsHashMix(hash, ScalarBits(key.scale_x));
+  hash = android::JenkinsHashMix(hash, ScalarBits(key.skew_x));
+  hash = android::JenkinsHashMixShorts(hash, key.glyphs.data(),
+                                       key.glyphs.size());
+  hash = android::JenkinsHashMixBytes(
+      hash, reinterpret_cast<const uint8_t*>(key.positions.data()),
+      key.positions.size() * sizeof(SkScalar));
+  return static_cast<uint32_t>(android::JenkinsHashWhiten(hash));
+}
+
+TextBlobCache& TextBlobCache::GetInstance() {
+  static TextBlobCache* instance = new TextBlobCache();
+  return *instance;
+}
+
+TextBlobCache::TextBlobCache() : budget_bytes_(kDefaultBudgetBytes) {}
+
+TextBlobCache::~TextBlobCache() = default;
+
+sk_sp<SkTextBlob> TextBlobCache::GetBlob(const SkFont& font,
+                                         const SkGlyphID* glyphs,
+                                         const SkScalar* positions,
+                                         size_t count) {
+  SkTypeface* typeface = font.getTypeface();
+  Key key{typeface ? typeface->uniqueID() : 0,
+          GetFontFlags(font),
+          font.getSize(),
+          font.getScaleX(),
+          font.getSkewX(),
+          std::vector<SkGlyphID>(glyphs, glyphs + count),
+          std::vector<SkScalar>(positions, positions + count * 2)};
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+      hits_++;
+      entries_.splice(entries_.begin(), entries_, found->second);
+      return found->second->blob;
+    }
+    misses_++;
+  }
+
+  // Build the blob outside of the lock so that other threads can keep using
+  // the cache meanwhile.
+  SkTextBlobBuilder builder;
+  const SkTextBlobBuilder::RunBuffer& buffer = builder.allocRunPos(font, count);
+  memcpy(buffer.glyphs, glyphs, count * sizeof(SkGlyphID));
+  memcpy(buffer.pos, positions, count * 2 * sizeof(SkScalar));
+  sk_sp<SkTextBlob> blob = builder.make();
+
+  size_t bytes = kEntryOverheadBytes +
+                 2 * count * (sizeof(SkGlyphID) + 2 * sizeof(SkScalar));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto inserted = index_.emplace(std::move(key), entries_.end());
+  if (!inserted.second) {
+    // Another thread built the same run first.
+    entries_.splice(entries_.begin(), entries_, inserted.first->second);
+    return inserted.first->second->blob;
+  }
+  entries_.push_front({&inserted.first->first, blob, bytes});
+  inserted.first->second = entries_.begin();
+  bytes_ += bytes;
+  EvictToBudget();
+  return blob;
+}
+
+TextBlobCache::Stats TextBlobCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.entries = entries_.size();
+  stats.bytes = bytes_;
+  stats.budget_bytes = budget_bytes_;
+  return stats;
+}
+
+void TextBlobCache::SetBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_bytes_ = bytes;
+  EvictToBudget();
+}
+
+void TextBlobCache::Purge() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+void TextBlobCache::EvictToBudget() {
+  while (bytes_ > budget_bytes_ && !entries_.empty()) {
+    const Entry& entry = entries_.back();
+    bytes_ -= entry.bytes;
+    index_.erase(index_.find(*entry.key));
+    entries_.pop_back();
+    evictions_++;
+  }
+}
+
+}  // namespace txt
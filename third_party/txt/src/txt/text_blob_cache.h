@@ -0,0 +1,104 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
+#define LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace txt {
+
+// A cache of the text blobs built for shaped runs, shared by every paragraph
+// in the process.
+//
+// Runs with the same font, glyphs and glyph positions get the same blob, such
+// as the labels of a list or the cells of a table. Skia keeps the GPU data for
+// a blob keyed by the blob, so sharing it also shares the uploaded glyphs
+// between paragraphs and frames. The cache keeps a reference to each blob, so
+// a paragraph that is thrown away and rebuilt with the same text gets its
+// blobs back.
+class TextBlobCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t budget_bytes = 0;
+  };
+
+  static TextBlobCache& GetInstance();
+
+  // Returns a blob with a single run of count glyphs drawn with font, where
+  // positions holds an x and a y for each glyph. The blob is built and cached
+  // if there is no cached blob for the same run.
+  sk_sp<SkTextBlob> GetBlob(const SkFont& font,
+                            const SkGlyphID* glyphs,
+                            const SkScalar* positions,
+                            size_t count);
+
+  Stats GetStats() const;
+
+  // Sets the number of bytes of runs the cache may keep, evicting the least
+  // recently used runs if it is already over the new budget.
+  void SetBudget(size_t bytes);
+
+  // Drops every cached blob. Blobs still used by a paragraph stay alive until
+  // the paragraph releases them.
+  void Purge();
+
+ private:
+  struct Key {
+    uint32_t typeface_id;
+    uint32_t font_flags;
+    SkScalar size;
+    SkScalar scale_x;
+    SkScalar skew_x;
+    std::vector<SkGlyphID> glyphs;
+    std::vector<SkScalar> positions;
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    const Key* key;
+    sk_sp<SkTextBlob> blob;
+    size_t bytes;
+  };
+
+  mutable std::mutex mutex_;
+  // The entries, most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+  size_t bytes_ = 0;
+  size_t budget_bytes_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evictions_ = 0;
+
+  TextBlobCache();
+
+  ~TextBlobCache();
+
+  void EvictToBudget();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TextBlobCache);
+};
+
+}  // namespace txt
+
+#endif  // LIB_TXT_SRC_TEXT_BLOB_CACHE_H_
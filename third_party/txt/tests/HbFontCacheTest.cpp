@@ -20,7 +20,6 @@
 #include <log/log.h>
 
 #include <memory>
-#include <mutex>
 
 #include <hb.h>
 
@@ -32,13 +31,10 @@ namespace minikin {
 
 class HbFontCacheTest : public testing::Test {
  public:
-  virtual void TearDown() {
-    std::scoped_lock _l(gMinikinLock);
-    purgeHbFontCacheLocked();
-  }
+  virtual void TearDown() { purgeHbFontCache(); }
 };
 
-TEST_F(HbFontCacheTest, getHbFontLockedTest) {
+TEST_F(HbFontCacheTest, getHbFontTest) {
   std::shared_ptr<MinikinFontForTest> fontA(
       new MinikinFontForTest(kTestFontDir "Regular.ttf"));
 
@@ -48,31 +44,29 @@ TEST_F(HbFontCacheTest, getHbFontLockedTest) {
   std::shared_ptr<MinikinFontForTest> fontC(
       new MinikinFontForTest(kTestFontDir "BoldItalic.ttf"));
 
-  std::scoped_lock _l(gMinikinLock);
   // Never return NULL.
-  EXPECT_NE(nullptr, getHbFontLocked(fontA.get()));
-  EXPECT_NE(nullptr, getHbFontLocked(fontB.get()));
-  EXPECT_NE(nullptr, getHbFontLocked(fontC.get()));
+  EXPECT_NE(nullptr, getHbFont(fontA.get()));
+  EXPECT_NE(nullptr, getHbFont(fontB.get()));
+  EXPECT_NE(nullptr, getHbFont(fontC.get()));
 
-  EXPECT_NE(nullptr, getHbFontLocked(nullptr));
+  EXPECT_NE(nullptr, getHbFont(nullptr));
 
   // Must return same object if same font object is passed.
-  EXPECT_EQ(getHbFontLocked(fontA.get()), getHbFontLocked(fontA.get()));
-  EXPECT_EQ(getHbFontLocked(fontB.get()), getHbFontLocked(fontB.get()));
-  EXPECT_EQ(getHbFontLocked(fontC.get()), getHbFontLocked(fontC.get()));
+  EXPECT_EQ(getHbFont(fontA.get()), getHbFont(fontA.get()));
+  EXPECT_EQ(getHbFont(fontB.get()), getHbFont(fontB.get()));
+  EXPECT_EQ(getHbFont(fontC.get()), getHbFont(fontC.get()));
 
   // Different object must be returned if the passed minikinFont has different
   // ID.
-  EXPECT_NE(getHbFontLocked(fontA.get()), getHbFontLocked(fontB.get()));
-  EXPECT_NE(getHbFontLocked(fontA.get()), getHbFontLocked(fontC.get()));
+  EXPECT_NE(getHbFont(fontA.get()), getHbFont(fontB.get()));
+  EXPECT_NE(getHbFont(fontA.get()), getHbFont(fontC.get()));
 }
 
 TEST_F(HbFontCacheTest, purgeCacheTest) {
   std::shared_ptr<MinikinFontForTest> minikinFont(
       new MinikinFontForTest(kTestFontDir "Regular.ttf"));
 
-  std::scoped_lock _l(gMinikinLock);
-  hb_font_t* font = getHbFontLocked(minikinFont.get());
+  hb_font_t* font = getHbFont(minikinFont.get());
   ASSERT_NE(nullptr, font);
 
   // Set user data to identify the font object.
@@ -81,12 +75,12 @@ TEST_F(HbFontCacheTest, purgeCacheTest) {
   hb_font_set_user_data(font, &key, data, NULL, false);
   ASSERT_EQ(data, hb_font_get_user_data(font, &key));
 
-  purgeHbFontCacheLocked();
+  purgeHbFontCache();
 
   // By checking user data, confirm that the object after purge is different
   // from previously created one. Do not compare the returned pointer here since
   // memory allocator may assign same region for new object.
-  font = getHbFontLocked(minikinFont.get());
+  font = getHbFont(minikinFont.get());
   EXPECT_EQ(nullptr, hb_font_get_user_data(font, &key));
 }
 
@@ -17,6 +17,7 @@
 #include "flutter/fml/logging.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/utils/SkCustomTypeface.h"
+#include "txt/fallback_font_index.h"
 #include "txt/font_collection.h"
 #include "txt_test_utils.h"
 
@@ -138,6 +139,81 @@ TEST(FontCollectionTest, CheckSkTypefacesSorting) {
             SkFontStyle::kExpanded_Width);
 }
 
+TEST(FontCollectionTest, FallbackFontIndexFindsCoveringFamilies) {
+  const uint32_t latin_ranges[] = {0x20, 0x80, 0x100, 0x180};
+  const uint32_t cjk_ranges[] = {0x60, 0x70, 0x4E00, 0xA000};
+  minikin::SparseBitSet latin(latin_ranges, 2);
+  minikin::SparseBitSet cjk(cjk_ranges, 2);
+  FallbackFontIndex index(1, {{"Latin", &latin}, {"CJK", &cjk}});
+
+  FallbackFontIndex::Match match;
+  ASSERT_TRUE(index.Find('A', &match));
+  ASSERT_EQ(match.family_count, 1u);
+  EXPECT_EQ(index.GetFamilyName(match.families[0]), "Latin");
+
+  ASSERT_TRUE(index.Find(0x65, &match));
+  ASSERT_EQ(match.family_count, 2u);
+  EXPECT_EQ(index.GetFamilyName(match.families[0]), "Latin");
+  EXPECT_EQ(index.GetFamilyName(match.families[1]), "CJK");
+
+  ASSERT_TRUE(index.Find(0x4E2D, &match));
+  ASSERT_EQ(match.family_count, 1u);
+  EXPECT_EQ(index.GetFamilyName(match.families[0]), "CJK");
+
+  EXPECT_FALSE(index.Find(0x10, &match));
+  EXPECT_FALSE(index.Find(0x90, &match));
+  EXPECT_FALSE(index.Find(0x1F600, &match));
+
+  // [0x20, 0x60), [0x60, 0x70), [0x70, 0x80), [0x100, 0x180) and
+  // [0x4E00, 0xA000).
+  EXPECT_EQ(index.GetRangeCount(), 5u);
+}
+
+TEST(FontCollectionTest, FallbackFontIndexRoundTrips) {
+  const uint32_t ranges[] = {0x20, 0x80, 0x4E00, 0xA000};
+  minikin::SparseBitSet coverage(ranges, 2);
+  const uint64_t fingerprint =
+      FallbackFontIndex::ComputeFingerprint({{"Sans", {1}}, {"Serif", {2}}});
+  FallbackFontIndex index(fingerprint,
+                          {{"Sans", &coverage}, {"Serif", &coverage}});
+  std::vector<uint8_t> data = index.Serialize();
+
+  std::unique_ptr<FallbackFontIndex> loaded =
+      FallbackFontIndex::Deserialize(data.data(), data.size(), fingerprint);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->GetRangeCount(), index.GetRangeCount());
+  FallbackFontIndex::Match match;
+  ASSERT_TRUE(loaded->Find(0x4E2D, &match));
+  ASSERT_EQ(match.family_count, 2u);
+  EXPECT_EQ(loaded->GetFamilyName(match.families[1]), "Serif");
+  EXPECT_FALSE(loaded->Find(0x100, &match));
+
+  // An index built from other families is not loaded.
+  EXPECT_NE(FallbackFontIndex::ComputeFingerprint({{"SansSerif", {1, 2}}}),
+            fingerprint);
+  EXPECT_FALSE(FallbackFontIndex::Deserialize(
+      data.data(), data.size(),
+      FallbackFontIndex::ComputeFingerprint({{"Sans", {1}}})));
+
+  // Neither is one built from other versions of the same families, or from
+  // families that gained a typeface.
+  EXPECT_NE(
+      FallbackFontIndex::ComputeFingerprint({{"Sans", {1}}, {"Serif", {3}}}),
+      fingerprint);
+  EXPECT_NE(
+      FallbackFontIndex::ComputeFingerprint({{"Sans", {1}}, {"Serif", {2, 0}}}),
+      fingerprint);
+
+  // Neither is a truncated or corrupt one.
+  for (size_t size = 0; size < data.size(); ++size) {
+    EXPECT_FALSE(
+        FallbackFontIndex::Deserialize(data.data(), size, fingerprint));
+  }
+  data[0] ^= 0xFF;
+  EXPECT_FALSE(
+      FallbackFontIndex::Deserialize(data.data(), data.size(), fingerprint));
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
@@ -0,0 +1,192 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "gtest/gtest.h"
+#include "minikin/Hyphenator.h"
+#include "txt/hyphenation_patterns.h"
+
+namespace txt {
+namespace {
+
+// The offsets of the tables in the file made by MakeHybFile.
+constexpr size_t kAlphabetOffset = 24;
+constexpr size_t kTrieOffset = 64;
+constexpr size_t kTrieEntries = 32;
+constexpr size_t kPatternOffset = kTrieOffset + 24 + kTrieEntries * 4;
+constexpr size_t kFileSize = kPatternOffset + 20 + 4;
+
+void WriteUint32(std::vector<uint8_t>* file, size_t offset, uint32_t value) {
+  memcpy(file->data() + offset, &value, sizeof(value));
+}
+
+// Makes a hyb file for the lowercase latin alphabet whose trie matches no
+// patterns, so that its tables can be truncated or corrupted.
+std::vector<uint8_t> MakeHybFile() {
+  std::vector<uint8_t> file(kFileSize, 0);
+  WriteUint32(&file, 0, 0x62ad7968);  // Magic.
+  WriteUint32(&file, 4, 0);           // Version.
+  WriteUint32(&file, 8, kAlphabetOffset);
+  WriteUint32(&file, 12, kTrieOffset);
+  WriteUint32(&file, 16, kPatternOffset);
+  WriteUint32(&file, 20, kFileSize);
+
+  // Alphabet version 0, mapping 'a' to 'z' to the codes 1 to 26.
+  WriteUint32(&file, kAlphabetOffset, 0);
+  WriteUint32(&file, kAlphabetOffset + 4, 'a');
+  WriteUint32(&file, kAlphabetOffset + 8, 'z' + 1);
+  for (uint8_t code = 1; code <= 26; code++) {
+    file[kAlphabetOffset + 12 + code - 1] = code;
+  }
+
+  // A trie whose entries are all empty.
+  WriteUint32(&file, kTrieOffset, 0);
+  WriteUint32(&file, kTrieOffset + 4, 0x3f);   // Char mask.
+  WriteUint32(&file, kTrieOffset + 8, 6);      // Link shift.
+  WriteUint32(&file, kTrieOffset + 12, 0xfc0);  // Link mask.
+  WriteUint32(&file, kTrieOffset + 16, 12);    // Pattern shift.
+  WriteUint32(&file, kTrieOffset + 20, kTrieEntries);
+
+  // A single empty pattern entry, followed by 4 pattern bytes.
+  WriteUint32(&file, kPatternOffset, 0);
+  WriteUint32(&file, kPatternOffset + 4, 1);
+  WriteUint32(&file, kPatternOffset + 8, 20);
+  WriteUint32(&file, kPatternOffset + 12, 4);
+  return file;
+}
+
+bool IsValid(const std::vector<uint8_t>& file) {
+  return minikin::Hyphenator::isValidBinary(file.data(), file.size());
+}
+
+}  // namespace
+
+TEST(HyphenationPatternsTest, MissingOrInvalidPatternsGiveNoHyphenator) {
+  HyphenationPatterns& patterns = HyphenationPatterns::GetInstance();
+  EXPECT_EQ(patterns.GetHyphenator("", "en_US"), nullptr);
+
+  fml::ScopedTemporaryDirectory directory;
+  const std::vector<uint8_t> garbage(64, 0xAB);
+  fml::NonOwnedMapping mapping(garbage.data(), garbage.size());
+  ASSERT_TRUE(fml::WriteAtomically(directory.fd(), "hyph-fr.hyb", mapping));
+
+  EXPECT_EQ(patterns.GetHyphenator(directory.path(), "en_US"), nullptr);
+  EXPECT_EQ(patterns.GetHyphenator(directory.path(), "fr-CA"), nullptr);
+  EXPECT_FALSE(IsValid(garbage));
+}
+
+TEST(HyphenationPatternsTest, PatternsAreLoadedPerDirectory) {
+  HyphenationPatterns& patterns = HyphenationPatterns::GetInstance();
+  fml::ScopedTemporaryDirectory with_patterns;
+  fml::ScopedTemporaryDirectory without_patterns;
+  const std::vector<uint8_t> file = MakeHybFile();
+  fml::NonOwnedMapping mapping(file.data(), file.size());
+  ASSERT_TRUE(
+      fml::WriteAtomically(with_patterns.fd(), "hyph-fr.hyb", mapping));
+
+  EXPECT_NE(patterns.GetHyphenator(with_patterns.path(), "fr-CA"), nullptr);
+  EXPECT_EQ(patterns.GetHyphenator(without_patterns.path(), "fr-CA"),
+            nullptr);
+}
+
+TEST(HyphenationPatternsTest, TruncatedPatternsAreInvalid) {
+  const std::vector<uint8_t> file = MakeHybFile();
+  ASSERT_TRUE(IsValid(file));
+
+  for (size_t size = 0; size < file.size(); size++) {
+    std::vector<uint8_t> truncated(file.begin(), file.begin() + size);
+    // A header that claims the truncated size must not pass either.
+    if (size >= 24) {
+      WriteUint32(&truncated, 20, size);
+    }
+    EXPECT_FALSE(IsValid(truncated)) << "size " << size;
+  }
+}
+
+TEST(HyphenationPatternsTest, CorruptPatternsAreInvalid) {
+  struct Corruption {
+    size_t offset;
+    uint32_t value;
+  };
+  const Corruption corruptions[] = {
+      // An unknown alphabet version.
+      {kAlphabetOffset, 7},
+      // An alphabet whose code points run backwards, or past the file.
+      {kAlphabetOffset + 8, 'a' - 1},
+      {kAlphabetOffset + 8, 0xffff},
+      // A misaligned trie.
+      {12, kTrieOffset + 2},
+      // Shifts wider than the entries.
+      {kTrieOffset + 8, 32},
+      {kTrieOffset + 16, 40},
+      // More trie entries than the file holds, including ones that overflow
+      // 32 bit sizes.
+      {kTrieOffset + 20, kTrieEntries * 2},
+      {kTrieOffset + 20, 0x40000000},
+      // Pattern entries or bytes past the end of the file.
+      {kPatternOffset + 4, 8},
+      {kPatternOffset + 8, 0xfffffff0},
+      {kPatternOffset + 12, 5},
+      // Tables that start past the end of the file.
+      {8, kFileSize + 4},
+      {16, 0xfffffffc},
+  };
+  for (const Corruption& corruption : corruptions) {
+    std::vector<uint8_t> file = MakeHybFile();
+    WriteUint32(&file, corruption.offset, corruption.value);
+    EXPECT_FALSE(IsValid(file)) << "offset " << corruption.offset;
+  }
+}
+
+TEST(HyphenationPatternsTest, CorruptTrieLinksAreNotFollowed) {
+  std::vector<uint8_t> file = MakeHybFile();
+  // Link 'a' from the root to a node past the end of the trie.
+  WriteUint32(&file, kTrieOffset + 24 + 4, 1 | (40 << 6));
+  ASSERT_TRUE(IsValid(file));
+
+  std::unique_ptr<minikin::Hyphenator> hyphenator(
+      minikin::Hyphenator::loadBinary(file.data(), 2, 3));
+  const uint16_t word[] = {'a', 'a', 'a', 'a', 'a', 'a'};
+  std::vector<minikin::HyphenationType> result;
+  hyphenator->hyphenate(&result, word, 6, icu::Locale("fr"));
+  ASSERT_EQ(result.size(), 6u);
+  for (minikin::HyphenationType type : result) {
+    EXPECT_EQ(type, minikin::HyphenationType::DONT_BREAK);
+  }
+}
+
+TEST(HyphenationPatternsTest, HyphenatorCachesWords) {
+  std::unique_ptr<minikin::Hyphenator> hyphenator(
+      minikin::Hyphenator::loadBinary(nullptr, 2, 3));
+  // "ab<soft hyphen>cd" may only break after the soft hyphen.
+  const uint16_t word[] = {'a', 'b', 0xAD, 'c', 'd'};
+  const icu::Locale locale("en");
+
+  std::vector<minikin::HyphenationType> first;
+  hyphenator->hyphenate(&first, word, 5, locale);
+  EXPECT_EQ(hyphenator->getCacheHitCount(), 0u);
+  std::vector<minikin::HyphenationType> second;
+  hyphenator->hyphenate(&second, word, 5, locale);
+  EXPECT_EQ(hyphenator->getCacheHitCount(), 1u);
+
+  ASSERT_EQ(first.size(), 5u);
+  EXPECT_EQ(first[3], minikin::HyphenationType::BREAK_AND_INSERT_HYPHEN);
+  EXPECT_EQ(first[2], minikin::HyphenationType::DONT_BREAK);
+  EXPECT_EQ(first, second);
+
+  // A prefix of a cached word is not confused with the word.
+  hyphenator->hyphenate(&second, word, 3, locale);
+  EXPECT_EQ(second.size(), 3u);
+  EXPECT_EQ(hyphenator->getCacheHitCount(), 1u);
+
+  // Neither is the same word in another language.
+  hyphenator->hyphenate(&second, word, 5, icu::Locale("de"));
+  EXPECT_EQ(hyphenator->getCacheHitCount(), 1u);
+}
+
+}  // namespace txt
@@ -16,8 +16,12 @@
 
 #include <cstring>
 #include <iostream>
+#include <thread>
+#include <vector>
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
+#include "minikin/Layout.h"
 #include "render_test.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -7117,4 +7121,340 @@ TEST_F(ParagraphTest, MixedTextHeightBehaviorRectsParagraph) {
 
   ASSERT_TRUE(Snapshot());
 }
+
+TEST_F(ParagraphTest, LayoutOnMultipleThreads) {
+  const char* text =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+  auto font_collection = GetTestFontCollection();
+
+  auto layout_paragraph = [&](double font_size) {
+    txt::ParagraphStyle paragraph_style;
+    txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+    txt::TextStyle text_style;
+    text_style.font_families = std::vector<std::string>(1, "Roboto");
+    text_style.font_size = font_size;
+    builder.PushStyle(text_style);
+    builder.AddText(u16_text);
+    builder.Pop();
+    auto paragraph = BuildParagraph(builder);
+    paragraph->Layout(300);
+    return paragraph;
+  };
+
+  // Start with empty caches so that the threads race to shape and cache the
+  // same words.
+  minikin::Layout::purgeCaches();
+
+  constexpr size_t kThreadCount = 8;
+  constexpr size_t kFontSizes = 4;
+  std::vector<std::unique_ptr<ParagraphTxt>> results(kThreadCount * kFontSizes);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&, i] {
+      for (size_t j = 0; j < kFontSizes; j++) {
+        results[i * kFontSizes + j] = layout_paragraph(10 + j * 4);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t j = 0; j < kFontSizes; j++) {
+    auto expected = layout_paragraph(10 + j * 4);
+    for (size_t i = 0; i < kThreadCount; i++) {
+      auto& actual = results[i * kFontSizes + j];
+      ASSERT_EQ(actual->GetLineCount(), expected->GetLineCount());
+      ASSERT_DOUBLE_EQ(actual->GetHeight(), expected->GetHeight());
+      ASSERT_DOUBLE_EQ(actual->GetMaxIntrinsicWidth(),
+                       expected->GetMaxIntrinsicWidth());
+      ASSERT_DOUBLE_EQ(actual->GetLongestLine(), expected->GetLongestLine());
+    }
+  }
+}
+
+static std::unique_ptr<ParagraphTxt> BuildAlignedParagraph(
+    const std::u16string& text,
+    TextAlign align) {
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = align;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+  return BuildParagraph(builder);
+}
+
+static void ExpectSameLayout(ParagraphTxt& actual, ParagraphTxt& expected) {
+  ASSERT_EQ(actual.GetLineCount(), expected.GetLineCount());
+  EXPECT_DOUBLE_EQ(actual.GetHeight(), expected.GetHeight());
+  EXPECT_DOUBLE_EQ(actual.GetLongestLine(), expected.GetLongestLine());
+  EXPECT_DOUBLE_EQ(actual.GetMaxIntrinsicWidth(),
+                   expected.GetMaxIntrinsicWidth());
+  EXPECT_DOUBLE_EQ(actual.GetMinIntrinsicWidth(),
+                   expected.GetMinIntrinsicWidth());
+  for (size_t i = 0; i < actual.GetLineCount(); ++i) {
+    const LineMetrics& actual_line = actual.GetLineMetrics()[i];
+    const LineMetrics& expected_line = expected.GetLineMetrics()[i];
+    EXPECT_EQ(actual_line.start_index, expected_line.start_index);
+    EXPECT_EQ(actual_line.end_index, expected_line.end_index);
+    EXPECT_DOUBLE_EQ(actual_line.left, expected_line.left);
+    EXPECT_DOUBLE_EQ(actual_line.baseline, expected_line.baseline);
+  }
+
+  auto actual_boxes = actual.GetRectsForRange(
+      0, actual.TextSize(), Paragraph::RectHeightStyle::kMax,
+      Paragraph::RectWidthStyle::kTight);
+  auto expected_boxes = expected.GetRectsForRange(
+      0, expected.TextSize(), Paragraph::RectHeightStyle::kMax,
+      Paragraph::RectWidthStyle::kTight);
+  ASSERT_EQ(actual_boxes.size(), expected_boxes.size());
+  for (size_t i = 0; i < actual_boxes.size(); ++i) {
+    EXPECT_EQ(actual_boxes[i].rect, expected_boxes[i].rect);
+  }
+
+  for (double y = 5; y < expected.GetHeight(); y += 20) {
+    for (double x = 5; x < expected.GetMaxWidth(); x += 37) {
+      EXPECT_EQ(actual.GetGlyphPositionAtCoordinate(x, y).position,
+                expected.GetGlyphPositionAtCoordinate(x, y).position);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, RelayoutAtNewWidthMatchesFreshLayout) {
+  const std::u16string text =
+      u"Lorem ipsum dolor sit amet, consectetur adipiscing elit.\n"
+      u"Sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n"
+      u"Short line.";
+  for (TextAlign align :
+       {TextAlign::left, TextAlign::center, TextAlign::right}) {
+    auto paragraph = BuildAlignedParagraph(text, align);
+    // Narrow and wide widths exercise relayout with changed breaks, and the
+    // last two, where every line fits, exercise realigning the same lines.
+    for (double width : {300.0, 180.0, 2000.0, 1500.0}) {
+      paragraph->Layout(width);
+      auto expected = BuildAlignedParagraph(text, align);
+      expected->Layout(width);
+      ExpectSameLayout(*paragraph, *expected);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, AppendTextMatchesFreshLayout) {
+  const std::u16string first = u"First message of the log.\nSecond message";
+  const std::u16string second =
+      u" continues here and wraps onto another line.\nThird";
+  const std::u16string third = u" and\n\nfifth.";
+  for (TextAlign align :
+       {TextAlign::left, TextAlign::center, TextAlign::justify}) {
+    auto paragraph = BuildAlignedParagraph(first, align);
+    paragraph->Layout(250);
+    std::u16string text = first;
+    for (const std::u16string& appended : {second, third}) {
+      paragraph->AppendText(appended);
+      paragraph->Layout(250);
+      text += appended;
+      auto expected = BuildAlignedParagraph(text, align);
+      expected->Layout(250);
+      ExpectSameLayout(*paragraph, *expected);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, ParallelLayoutMatchesSerialLayout) {
+  // Long enough to be split across the workers, with lines that wrap, short
+  // lines and empty lines.
+  std::u16string text;
+  for (size_t i = 0; text.size() < 32 * 1024; ++i) {
+    text += u"Line " + std::u16string(i % 7 + 1, u'x');
+    if (i % 3 == 0) {
+      text += u" consectetur adipiscing elit, sed do eiusmod tempor "
+              u"incididunt ut labore et dolore magna aliqua.";
+    }
+    text += i % 11 == 0 ? u"\n\n" : u"\n";
+  }
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  for (TextAlign align :
+       {TextAlign::left, TextAlign::center, TextAlign::justify}) {
+    auto paragraph = BuildAlignedParagraph(text, align);
+    paragraph->SetLayoutTaskRunner(loop->GetTaskRunner());
+    for (double width : {300.0, 180.0}) {
+      paragraph->Layout(width);
+      auto expected = BuildAlignedParagraph(text, align);
+      expected->Layout(width);
+      ExpectSameLayout(*paragraph, *expected);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, PositionQueriesFollowRelayout) {
+  const std::u16string text =
+      u"Lorem ipsum dolor sit amet, consectetur adipiscing elit.\n\n"
+      u"Sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\n"
+      u"Ut enim ad minim veniam.";
+  auto paragraph = BuildAlignedParagraph(text, TextAlign::center);
+  paragraph->Layout(300);
+  // Builds the position index for the first layout.
+  paragraph->GetRectsForRange(0, 10, Paragraph::RectHeightStyle::kTight,
+                              Paragraph::RectWidthStyle::kTight);
+  paragraph->GetGlyphPositionAtCoordinate(10, 10);
+
+  paragraph->Layout(150);
+  auto expected = BuildAlignedParagraph(text, TextAlign::center);
+  expected->Layout(150);
+  for (size_t start = 0; start < text.size(); start += 7) {
+    for (size_t end = start + 1; end <= text.size(); end += 13) {
+      auto actual_boxes = paragraph->GetRectsForRange(
+          start, end, Paragraph::RectHeightStyle::kMax,
+          Paragraph::RectWidthStyle::kMax);
+      auto expected_boxes = expected->GetRectsForRange(
+          start, end, Paragraph::RectHeightStyle::kMax,
+          Paragraph::RectWidthStyle::kMax);
+      ASSERT_EQ(actual_boxes.size(), expected_boxes.size());
+      for (size_t i = 0; i < actual_boxes.size(); ++i) {
+        EXPECT_EQ(actual_boxes[i].rect, expected_boxes[i].rect);
+        EXPECT_EQ(actual_boxes[i].direction, expected_boxes[i].direction);
+      }
+    }
+  }
+  for (double y = -5; y < expected->GetHeight() + 20; y += 7) {
+    for (double x = -5; x < 170; x += 11) {
+      auto actual_position = paragraph->GetGlyphPositionAtCoordinate(x, y);
+      auto expected_position = expected->GetGlyphPositionAtCoordinate(x, y);
+      EXPECT_EQ(actual_position.position, expected_position.position);
+      EXPECT_EQ(actual_position.affinity, expected_position.affinity);
+    }
+  }
+}
+
+TEST_F(ParagraphTest, DISABLE_ON_WINDOWS(HitTestFollowsRunDirection)) {
+  const char* text = "Hello بمباركة world قام عن";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Noto Naskh Arabic");
+  text_style.font_size = 26;
+  text_style.color = SK_ColorBLACK;
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(GetTestCanvasWidth());
+  ASSERT_EQ(paragraph->GetLineCount(), 1ull);
+
+  // The runs of a mixed line are in visual order, so a hit on the start edge
+  // of a glyph is downstream of it in an ltr run and upstream of it in an rtl
+  // run.
+  size_t rtl_hits = 0;
+  for (size_t i = 0; i < u16_text.size(); ++i) {
+    std::vector<Paragraph::TextBox> boxes =
+        paragraph->GetRectsForRange(i, i + 1, Paragraph::RectHeightStyle::kMax,
+                                    Paragraph::RectWidthStyle::kTight);
+    if (boxes.size() != 1 || boxes[0].rect.width() < 4) {
+      continue;
+    }
+    const SkRect& rect = boxes[0].rect;
+    Paragraph::PositionWithAffinity left =
+        paragraph->GetGlyphPositionAtCoordinate(rect.left() + 1,
+                                                rect.centerY());
+    Paragraph::PositionWithAffinity right =
+        paragraph->GetGlyphPositionAtCoordinate(rect.right() - 1,
+                                                rect.centerY());
+    if (boxes[0].direction == TextDirection::ltr) {
+      EXPECT_EQ(left.affinity, Paragraph::DOWNSTREAM);
+      EXPECT_EQ(right.affinity, Paragraph::UPSTREAM);
+    } else {
+      EXPECT_EQ(left.affinity, Paragraph::UPSTREAM);
+      EXPECT_EQ(right.affinity, Paragraph::DOWNSTREAM);
+      rtl_hits++;
+    }
+  }
+  EXPECT_GT(rtl_hits, 0ull);
+}
+
+TEST_F(ParagraphTest, IdenticalRunsShareTextBlobs) {
+  const std::u16string text = u"Total amount";
+  auto first = BuildAlignedParagraph(text, TextAlign::left);
+  first->Layout(300);
+  ASSERT_EQ(first->records_.size(), 1u);
+  sk_sp<SkTextBlob> blob = sk_ref_sp(first->records_[0].text());
+
+  // A paragraph that places the same run elsewhere still shares its blob.
+  auto centered = BuildAlignedParagraph(text, TextAlign::center);
+  centered->Layout(300);
+  ASSERT_EQ(centered->records_.size(), 1u);
+  EXPECT_EQ(centered->records_[0].text(), blob.get());
+
+  // Rebuilding a paragraph that was thrown away gets the blob back.
+  first.reset();
+  centered.reset();
+  auto rebuilt = BuildAlignedParagraph(text, TextAlign::left);
+  rebuilt->Layout(300);
+  ASSERT_EQ(rebuilt->records_.size(), 1u);
+  EXPECT_EQ(rebuilt->records_[0].text(), blob.get());
+
+  auto other = BuildAlignedParagraph(u"Subtotal", TextAlign::left);
+  other->Layout(300);
+  ASSERT_EQ(other->records_.size(), 1u);
+  EXPECT_NE(other->records_[0].text(), blob.get());
+}
+
+TEST_F(ParagraphTest, RelayoutIsServedFromShapingCache) {
+  const char* text =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+
+  minikin::Layout::purgeCaches();
+  paragraph->Layout(300);
+  auto first = minikin::Layout::getCacheStats();
+  ASSERT_GT(first.misses, 0u);
+  ASSERT_GT(first.entries, 0u);
+  ASSERT_LE(first.bytes, first.budgetBytes);
+
+  paragraph->SetDirty();
+  paragraph->Layout(200);
+  auto second = minikin::Layout::getCacheStats();
+  EXPECT_EQ(second.misses, first.misses);
+  EXPECT_GT(second.hits, first.hits);
+  EXPECT_EQ(second.entries, first.entries);
+
+  // Shrinking the budget evicts the least recently used words.
+  size_t larger = minikin::Layout::addCacheBudget(first.bytes * 2);
+  size_t smaller = minikin::Layout::addCacheBudget(first.bytes / 2);
+  auto shrunk = minikin::Layout::getCacheStats();
+  EXPECT_GT(shrunk.evictions, second.evictions);
+  EXPECT_LT(shrunk.entries, second.entries);
+  EXPECT_LE(shrunk.bytes, shrunk.budgetBytes);
+
+  // The budget relaxes as the budgets are removed.
+  minikin::Layout::removeCacheBudget(smaller);
+  EXPECT_GT(minikin::Layout::getCacheStats().budgetBytes, shrunk.budgetBytes);
+  minikin::Layout::removeCacheBudget(larger);
+  EXPECT_EQ(minikin::Layout::getCacheStats().budgetBytes, second.budgetBytes);
+}
+
 }  // namespace txt